@@ -1,22 +1,42 @@
 #include "AngleSolver.h"
 #include <string.h> // for memset if needed
 #include "pid.h"
+#include "BusScheduler.h"
+#include "TrajectoryBuffer.h"
+#include "SetpointJitterBuffer.h"
+#include "EncoderConditioner.h"
+#include "JointModeSelector.h"
+#include "LoadProtector.h"
+#include "ServoProfile.h"
 // ============================================================
 // 【新增】外部引用（定义在 SystemTask.cpp 中）
 // ============================================================
-extern ServoBusManager servoBus0;
-extern ServoBusManager servoBus1;
-extern ServoBusManager servoBus2;
-extern ServoBusManager servoBus3;
+extern ServoBusManager* const servoBuses[NUM_BUSES];
 extern AngleSolver angleSolver;
-extern JointMapItem jointMap[ENCODER_TOTAL_NUM];
+extern BusScheduler busScheduler;
+extern TrajectoryBuffer trajectoryBuffer;
+extern SetpointJitterBuffer setpointBuffer;
+extern EncoderConditioner encoderConditioner;
+extern JointModeSelector jointModeSelector;
+extern LoadProtector loadProtector;
+extern volatile uint8_t g_servoStopRequest;
+extern volatile uint32_t g_servoStopRequestUs;
+extern volatile uint32_t g_servoStopLatencyUs;
 
 // ============================================================
 // 原有 AngleSolver 类实现（保持不变）
 // ============================================================
 
-AngleSolver::AngleSolver() : _initialized(false)
+AngleSolver::AngleSolver() : _profilePrimed(false), _complianceMask(0), _complianceVersion(0), _initialized(false)
 {
+    for (int i = 0; i < JOINT_COUNT; i++)
+    {
+        _compliance[i].enabled = 0;
+        _compliance[i].stiffness = COMPLIANCE_STIFFNESS_DEFAULT;
+        _compliance[i].damping = COMPLIANCE_DAMPING_DEFAULT;
+        _compliance[i].maxTorque = COMPLIANCE_TORQUE_MAX_DEFAULT;
+    }
+    memset(_lastPulses, 0, sizeof(_lastPulses));
     memset(_zeroOffsets, 0, sizeof(_zeroOffsets));
     memset(_gearRatios, 0, sizeof(_gearRatios));
     memset(_directions, 0, sizeof(_directions));
@@ -37,6 +57,11 @@ void AngleSolver::init(int16_t *zeroOffsets, float *gearRatios, int8_t *directio
 
 
 
+float AngleSolver::servoDegrees(uint8_t joint, int32_t pulses) const
+{
+    return (float)(pulses - _zeroOffsets[joint]) / servoModelPolicy(kJointMap[joint].model).stepsPerDeg;
+}
+
 void AngleSolver::setPIDParams(float pidParams[][PID_PARAMETER_NUM])
 {
     for (int i = 0; i < JOINT_COUNT; i++)
@@ -46,64 +71,470 @@ void AngleSolver::setPIDParams(float pidParams[][PID_PARAMETER_NUM])
     }
 }
 
-// 核心批量解算逻辑（保持不变）
+// 核心批量解算逻辑（两环同频运行）
 bool AngleSolver::compute(float *targetDegs, float *magActualDegs,
                           float *servoActualDegs, int16_t *outServoPulses)
+{
+    float corrections[JOINT_COUNT];
+    computeOuter(targetDegs, magActualDegs, corrections);
+    return computeInner(corrections, servoActualDegs, outServoPulses);
+}
+
+bool AngleSolver::computeOuter(const float *targetDegs, const float *magActualDegs, float *outCorrections,
+                               uint32_t validMask)
 {
     for (int i = 0; i < JOINT_COUNT; i++)
     {
+        if (!(validMask & (1UL << i)))
+        {
+            // 磁编读数无效：不积分/微分，沿用上一次的修正量
+            outCorrections[i] = _pids[i][0].Output;
+            continue;
+        }
+
         // --- 第一环 (外环: 位置环) ---
         // 目标: 上位机规划角度
         // 实际: 磁编角度
         f_PID_Calculate(&_pids[i][0], targetDegs[i], magActualDegs[i]);
+        outCorrections[i] = _pids[i][0].Output;
+    }
+    return true;
+}
 
+bool AngleSolver::computeInner(const float *corrections, const float *servoActualDegs, int16_t *outServoPulses)
+{
+    for (int i = 0; i < JOINT_COUNT; i++)
+    {
         // --- 第二环 (内环: 舵机环) ---
-        float loop2_Target = _pids[i][0].Output + servoActualDegs[i];
+        float loop2_Target = corrections[i] + servoActualDegs[i];
         float loop2_Actual = servoActualDegs[i];
         f_PID_Calculate(&_pids[i][1], loop2_Target, loop2_Actual);
 
-        // 输出脉冲
-        outServoPulses[i] = (int16_t)_pids[i][1].Output;
+        // 输出脉冲：以标定零位为基准（多圈位置范围 ±30719）
+        int32_t pulse = (int32_t)_zeroOffsets[i] + (int32_t)_pids[i][1].Output;
+        outServoPulses[i] = (int16_t)constrain(pulse, -30719, 30719);
     }
     return true;
 }
 
+uint8_t AngleSolver::computeProfile(const float *velocity, const float *accel, const int16_t *servoPulses,
+                                    const float *servoActualDegs, const float *servoSpeeds,
+                                    float periodS, uint16_t *outSpeeds, uint8_t *outAccs)
+{
+    uint8_t saturated = 0;
+    float invPeriod = 1.0f / periodS;
+    for (int i = 0; i < JOINT_COUNT; i++)
+    {
+        // 关节角度 -> 舵机步（方向只影响符号，前后周期一致即可）
+        const ServoModelPolicy &policy = servoModelPolicy(kJointMap[i].model);
+        float stepsPerDeg = _gearRatios[i] * _directions[i] * policy.stepsPerDeg;
+
+        // 目标速度：前馈与本周期目标变化量取绝对值大者
+        float ffSpeed = velocity[i] * stepsPerDeg;
+        float stepSpeed = _profilePrimed ? (float)(servoPulses[i] - _lastPulses[i]) * invPeriod : 0.0f;
+        float speed = (fabsf(stepSpeed) > fabsf(ffSpeed)) ? stepSpeed : ffSpeed;
+        _lastPulses[i] = servoPulses[i];
+
+        float errSteps = (float)(servoPulses[i] - _zeroOffsets[i]) - servoActualDegs[i] * policy.stepsPerDeg;
+        if (servoProfileLimits(policy, speed, accel[i] * stepsPerDeg, errSteps, servoSpeeds[i],
+                               outSpeeds[i], outAccs[i]))
+        {
+            saturated++;
+        }
+    }
+    _profilePrimed = true;
+    return saturated;
+}
+
+void AngleSolver::pollCompliance()
+{
+    uint32_t version = _complianceMailbox.version();
+    if (version == _complianceVersion) return;
+
+    ComplianceTable table;
+    if (!_complianceMailbox.read(table, &version)) return;   // 写入进行中，下一周期再取
+    _complianceVersion = version;
+
+    uint32_t mask = 0;
+    for (int i = 0; i < JOINT_COUNT; i++)
+    {
+        // 参数无效（负值/NaN）的关节保持原样
+        ComplianceParams p = table.joint[i];
+        if (p.stiffness >= 0.0f && p.damping >= 0.0f)
+        {
+            if (p.maxTorque > 0x7FFF) p.maxTorque = 0x7FFF;
+            _compliance[i] = p;
+        }
+        if (_compliance[i].enabled) mask |= 1UL << i;
+    }
+    _complianceMask = mask;
+}
+
+uint8_t AngleSolver::computeCompliance(const int16_t *servoPulses, const float *velocity,
+                                       const float *servoActualDegs, const float *servoSpeeds, int16_t *outTorques)
+{
+    uint8_t saturated = 0;
+    for (int i = 0; i < JOINT_COUNT; i++)
+    {
+        const ComplianceParams &p = _compliance[i];
+        float stepsPerDeg = servoModelPolicy(kJointMap[i].model).stepsPerDeg;
+
+        // 误差按舵机角度计算（目标脉冲已包含减速比与方向，减去零位后与反馈角度同一基准）
+        float errDegs = (float)(servoPulses[i] - _zeroOffsets[i]) / stepsPerDeg - servoActualDegs[i];
+        float velDegs = velocity[i] * _gearRatios[i] * _directions[i] - servoSpeeds[i] / stepsPerDeg;
+        float torque = p.stiffness * errDegs + p.damping * velDegs;
+
+        float limit = (float)p.maxTorque;
+        if (torque > limit || torque < -limit)
+        {
+            torque = (torque > 0.0f) ? limit : -limit;
+            if (p.enabled) saturated++;
+        }
+        outTorques[i] = (int16_t)torque;
+    }
+    return saturated;
+}
+
 // ============================================================
-// 【新增】辅助函数：CAN 原始值转角度 (0-16383 -> 0-360°)
+// 【新增】快速停机：先在所有总线上发出关扭矩同步写，再逐条校验
 // ============================================================
-static float convertCanToDeg(uint16_t rawValue)
+// 各总线串口互相独立，指令几乎同时发出；返回从急停请求到指令全部发出的耗时（微秒），
+// 包含请求等待解算周期开始的时间
+static uint32_t fastStopAllBuses(uint32_t requestUs)
+{
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        servoBuses[b]->fastStop();
+    }
+    uint32_t latency = micros() - requestUs;
+
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        // 校验失败的总线补发一次
+        if (servoBuses[b]->verifyTorqueOff() < servoBuses[b]->servoCount())
+        {
+            servoBuses[b]->fastStop();
+        }
+    }
+    return latency;
+}
+
+// 处理急停/恢复请求（周期开始时，以及周期间隔中被任务通知唤醒时）
+static void serviceStopRequest(bool &stopped)
+{
+    uint8_t stopRequest = g_servoStopRequest;
+    if (stopRequest == SERVO_STOP_NONE)
+    {
+        return;
+    }
+    g_servoStopRequest = SERVO_STOP_NONE;
+    if (stopRequest == SERVO_STOP_REQUEST)
+    {
+        g_servoStopLatencyUs = fastStopAllBuses(g_servoStopRequestUs);
+        stopped = true;
+    }
+    else if (stopRequest == SERVO_RESUME_REQUEST && stopped)
+    {
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->enableTorqueAll();
+        }
+        angleSolver.resetProfile();
+        stopped = false;
+    }
+}
+
+// 等到下一周期起点（与 xTaskDelayUntil 相同的节拍，超时则立即返回）；
+// 等待期间总线空闲，收到任务通知（急停请求）时立即处理，不等下一周期
+static void waitNextCycle(TickType_t &lastWake, bool &stopped)
 {
-    return (float)rawValue * 360.0f / 16384.0f;
+    lastWake += pdMS_TO_TICKS(SOLVER_PERIOD_MS);
+    while (1)
+    {
+        TickType_t left = lastWake - xTaskGetTickCount();
+        if (left == 0 || left > pdMS_TO_TICKS(SOLVER_PERIOD_MS))
+        {
+            return;
+        }
+        if (ulTaskNotifyTake(pdTRUE, left) > 0)
+        {
+            serviceStopRequest(stopped);
+        }
+    }
 }
 
 // ============================================================
-// 【新增】辅助函数：根据总线编号获取 ServoBusManager 指针
+// 同步生效：REG_WRITE 暂存目标，ACTION 统一生效
 // ============================================================
-static ServoBusManager *getBusByIndex(uint8_t busIndex)
+// 按槽位交错：先在所有总线上发出第 k 个舵机的 REG_WRITE，再依次收取应答，
+// 每个槽位只花一次往返的时间
+static void stageAllBuses()
+{
+    for (uint8_t k = 0; k < MAX_SERVOS_PER_BUS; k++)
+    {
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->stageTarget(k);
+        }
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->collectStaged();
+        }
+    }
+}
+
+static ActuationSkewStats s_actuationSkew;
+
+const ActuationSkewStats& actuationSkewStats()
 {
-    switch (busIndex)
+    return s_actuationSkew;
+}
+
+// 记录本周期最早与最晚生效的总线之差
+static void recordActuationSkew()
+{
+    uint32_t first = 0, last = 0;
+    uint8_t n = 0;
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
     {
-    case 0:
-        return &servoBus0;
-    case 1:
-        return &servoBus1;
-    case 2:
-        return &servoBus2;
-    case 3:
-        return &servoBus3;
-    default:
-        return NULL;
+        uint32_t t;
+        if (!servoBuses[b]->actuationTime(t)) continue;
+        if (n == 0 || (int32_t)(t - first) < 0) first = t;
+        if (n == 0 || (int32_t)(t - last) > 0) last = t;
+        n++;
     }
+    if (n < 2) return;
+
+    uint32_t skew = last - first;
+    s_actuationSkew.cycles++;
+    s_actuationSkew.lastUs = skew;
+    s_actuationSkew.totalUs += skew;
+    if (skew > s_actuationSkew.maxUs) s_actuationSkew.maxUs = skew;
 }
 
 // ============================================================
-// 【新增】taskSolver — 角度解算 + 电机控制任务
+// 外环任务 — 磁编环
 // ============================================================
 // 数据流:
-//   目标角度 ← sharedData.targetAngles[] (由 UpperCommTask 写入)
-//   磁编角度 ← sharedData.canRxQueue     (由 CanCommTask 写入)
-//   舵机反馈 ← ServoBusManager.readPosition()
-//   输出脉冲 → ServoBusManager.writePosition()
+//   目标角度 ← trajectoryBuffer 插值（启用轨迹时），否则 setpointBuffer 回放（收到流式目标点后），
+//              否则 sharedData.targetAngles[] 快照
+//   磁编角度 ← sharedData.sensorMailbox  (由 CanCommTask 写入，无锁)，经 encoderConditioner 调理
+//   修正量   → sharedData.outerMailbox   (由 taskSolver 内环读取)
+//   目标速度/加速度 → 同上（每周期更新，内环据此计算舵机的速度/加速度上限）
+//   关节模式   ← jointModeSelector（磁编失效/样本过期的关节改用舵机角度估计或冻结）
+// 只有收到新的磁编样本才运行外环 PID，同一样本不会被重复积分/微分；
+// SERVO_ONLY 关节不依赖磁编样本，每周期运行
+// ============================================================
+
+static OuterLoopStats s_outerStats;
+static TrackingStats s_tracking;
+static ComplianceStats s_compliance;
+
+const OuterLoopStats& outerLoopStats()
+{
+    return s_outerStats;
+}
+
+const TrackingStats& trackingStats()
+{
+    return s_tracking;
+}
+
+const ComplianceStats& complianceStats()
+{
+    return s_compliance;
+}
+
+// 记录一个周期的跟踪误差（平均值按 1/16 滑动平均）
+static void recordTracking(uint32_t errSum, uint8_t count, uint32_t errMax)
+{
+    if (count == 0) return;
+    int32_t mean = errSum / count;
+    if (s_tracking.cycles == 0)
+    {
+        s_tracking.avgErrSteps = mean;
+    }
+    else
+    {
+        s_tracking.avgErrSteps += (mean - (int32_t)s_tracking.avgErrSteps) / 16;
+    }
+    if (errMax > s_tracking.maxErrSteps) s_tracking.maxErrSteps = errMax;
+    s_tracking.cycles++;
+}
+
+// ============================================================
+// 控制模式切换：要求的模式与舵机当前模式不一致时提交给 BusScheduler（EPROM 写，
+// 在周期剩余时间内执行）；未确认时每 COMPLIANCE_MODE_RETRY_CYCLES 个周期重新提交，
+// 最多 COMPLIANCE_MODE_MAX_RETRIES 次。切换完成后 COMPLIANCE_MODE_MIN_INTERVAL_CYCLES
+// 内不再切换，上位机频繁开关柔顺控制时不会反复擦写舵机 EPROM
+// ============================================================
+#define MODE_SWITCH_UNSEEN 0xFF   // 尚未记录舵机的控制模式（启动时读到的模式不算切换）
+
+struct ModeSwitchState {
+    uint16_t wait;        // 再次提交前的等待周期
+    uint8_t  retries;     // 当前要求下连续未确认的提交次数
+    uint8_t  lastMode;    // 上一周期舵机的控制模式
+    uint8_t  lastWant;    // 上一周期要求的控制模式
+};
+
+static void requestModeChanges(uint32_t torqueRequest, ModeSwitchState *state)
+{
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        const BusTopology &topo = kHandTopology.bus[b];
+        const ServoBusManager &bus = *servoBuses[b];
+        for (uint8_t k = 0; k < topo.count; k++)
+        {
+            uint8_t joint = topo.jointIndex[k];
+            uint8_t want = ((torqueRequest >> joint) & 1) && bus.supportsTorqueModeAt(k)
+                               ? SERVO_CTRL_TORQUE : SERVO_CTRL_POSITION;
+            uint8_t mode = bus.controlModeAt(k);
+            ModeSwitchState &st = state[joint];
+            if (mode != st.lastMode)
+            {
+                if (st.lastMode != MODE_SWITCH_UNSEEN) st.wait = COMPLIANCE_MODE_MIN_INTERVAL_CYCLES;
+                st.lastMode = mode;
+                st.retries = 0;
+            }
+            if (want != st.lastWant)
+            {
+                st.lastWant = want;
+                st.retries = 0;
+            }
+            if (st.wait > 0) st.wait--;
+
+            // 离线期间不提交；重新上线后重新计数
+            if (!bus.isOnlineAt(k))
+            {
+                st.retries = 0;
+                continue;
+            }
+            if (want == mode || st.wait > 0 || st.retries >= COMPLIANCE_MODE_MAX_RETRIES)
+            {
+                continue;
+            }
+
+            ServoCommand_t cmd;
+            memset(&cmd, 0, sizeof(cmd));
+            cmd.cmdType = SERVO_CMD_CTRL_MODE;
+            cmd.busIndex = b;
+            cmd.servoId = bus.servoIdAt(k);
+            cmd.position = want;
+            if (busScheduler.submit(cmd))
+            {
+                st.wait = COMPLIANCE_MODE_RETRY_CYCLES;
+                st.retries++;
+                s_compliance.modeRequests++;
+            }
+        }
+    }
+}
+
+void taskOuterLoop(void *parameter)
+{
+    TaskSharedData_t* sharedData = (TaskSharedData_t*)parameter;
+
+    float snapshotTargets[ENCODER_TOTAL_NUM];
+    float localTargets[ENCODER_TOTAL_NUM];
+    float trajVelocity[ENCODER_TOTAL_NUM];
+    float trajAccel[ENCODER_TOTAL_NUM];
+    float canAngles[ENCODER_TOTAL_NUM];
+    float magInput[ENCODER_TOTAL_NUM];
+    RemoteSensorData_t sensorData;
+    ServoAngleSnapshot_t servoSnapshot;
+    OuterLoopOutput_t out;
+    uint32_t lastVersion = 0;
+    uint32_t lastSampleMs = 0;
+    uint32_t setpointSeen = 0;
+    uint32_t validMask = 0;
+    memset(snapshotTargets, 0, sizeof(snapshotTargets));
+    memset(canAngles, 0, sizeof(canAngles));
+    memset(&out, 0, sizeof(out));
+
+    TickType_t lastWake = xTaskGetTickCount();
+    while (1)
+    {
+        // 目标角度：取不到锁时沿用上一份快照，不阻塞外环
+        if (xSemaphoreTake(sharedData->targetAnglesMutex, 0) == pdTRUE)
+        {
+            memcpy(snapshotTargets, sharedData->targetAngles, sizeof(snapshotTargets));
+            xSemaphoreGive(sharedData->targetAnglesMutex);
+        }
+
+        // 流式目标点按播放延迟回放（未开始时保持快照），再插值一次轨迹（未启用时保持前者），
+        // 目标的导数随之作为前馈（快照没有导数，为 0）
+        uint32_t nowUs = micros();
+        memcpy(localTargets, snapshotTargets, sizeof(localTargets));
+        memset(out.accel, 0, sizeof(out.accel));
+        bool playing = setpointBuffer.sample(nowUs, localTargets, out.velocity);
+
+        // 流式目标点优先于轨迹：回放开始后有新包到达才清空轨迹（本周期即生效）。
+        // 播放延迟期间轨迹照常输出、停在原处，关节不会先跳回快照再跳到首个目标点
+        uint32_t received = setpointBuffer.stats().received;
+        if (playing && received != setpointSeen)
+        {
+            trajectoryBuffer.requestFlush(false);
+            setpointSeen = received;
+        }
+        if (trajectoryBuffer.sample(nowUs, localTargets, trajVelocity, trajAccel))
+        {
+            memcpy(out.velocity, trajVelocity, sizeof(out.velocity));
+            memcpy(out.accel, trajAccel, sizeof(out.accel));
+        }
+
+        uint32_t version;
+        bool newSample = sharedData->sensorMailbox.read(sensorData, &version) && version != lastVersion;
+        if (newSample)
+        {
+            lastVersion = version;
+            lastSampleMs = millis();
+            // 剔除无效读数与毛刺，跨圈展开并滤波
+            validMask = encoderConditioner.process(sensorData.encoderValues, sensorData.errorFlags, canAngles);
+            out.sampleTime = sensorData.timestamp;
+        }
+        bool sampleFresh = lastVersion != 0 && millis() - lastSampleMs <= ENC_SAMPLE_MAX_AGE_MS;
+
+        // 逐关节选择模式；全部健康时直接使用调理后的磁编角度
+        const float *magDegs = canAngles;
+        uint32_t runMask = newSample ? validMask : 0;
+        if (!jointModeSelector.healthy(validMask, sampleFresh))
+        {
+            const ServoAngleSnapshot_t *servo = nullptr;
+            if (sharedData->servoMailbox.read(servoSnapshot) &&
+                millis() - servoSnapshot.timeMs <= SERVO_SNAPSHOT_MAX_AGE_MS)
+            {
+                servo = &servoSnapshot;
+            }
+            memcpy(magInput, canAngles, sizeof(magInput));
+            jointModeSelector.update(validMask, sampleFresh, servo, magInput);
+            magDegs = magInput;
+            runMask |= jointModeSelector.servoOnlyMask();
+        }
+        out.servoOnlyMask = jointModeSelector.servoOnlyMask();
+        out.holdMask = jointModeSelector.holdMask();
+
+        if (runMask)
+        {
+            angleSolver.computeOuter(localTargets, magDegs, out.corrections, runMask);
+            s_outerStats.updates++;
+        }
+        else
+        {
+            s_outerStats.idleTicks++;
+        }
+        sharedData->outerMailbox.publish(out);
+
+        xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(OUTER_LOOP_PERIOD_MS));
+    }
+}
+
+// ============================================================
+// 【新增】taskSolver — 角度解算 + 电机控制任务
+// ============================================================
+// 数据流（内环）:
+//   外环修正 ← sharedData.outerMailbox   (由 taskOuterLoop 写入，无锁)
+//   舵机反馈 ← ServoBusManager.finishCycle()（上一周期末尾收取）
+//   输出脉冲 → ServoBusManager.startCycle()（与下一周期的同步读请求一次发出）
 // ============================================================
 
 void taskSolver(void *parameter)
@@ -112,102 +543,240 @@ void taskSolver(void *parameter)
     // TaskSharedData_t *sharedData = (TaskSharedData_t *)parameter;
       TaskSharedData_t* sharedData = (TaskSharedData_t*)parameter;
 
-    // 定义每条总线的舵机 ID 列表（根据你的配置：4+4+4+5）
-    const uint8_t bus0_ids[] = {1, 2, 3, 4};    // 总线0: 4个舵机
-    const uint8_t bus1_ids[] = {1, 2, 3, 4};    // 总线1: 4个舵机
-    const uint8_t bus2_ids[] = {1, 2, 3, 4};    // 总线2: 4个舵机
-    const uint8_t bus3_ids[] = {1, 2, 3, 4, 5}; // 总线3: 5个舵机
-
+    // 每条总线的舵机 ID 列表与关节索引均由 kHandTopology 在编译期生成
     // 本地数据缓冲区
-    float localTargets[ENCODER_TOTAL_NUM];
-    float canAngles[ENCODER_TOTAL_NUM];
+    OuterLoopOutput_t outer;
     float servoAngles[ENCODER_TOTAL_NUM];
+    float servoSpeeds[ENCODER_TOTAL_NUM];      // 步/s
+    int16_t servoLoads[ENCODER_TOTAL_NUM];     // 0.1%
     int16_t outPulses[ENCODER_TOTAL_NUM];
-    RemoteSensorData_t sensorData;
+    uint16_t outSpeeds[ENCODER_TOTAL_NUM];
+    uint8_t outAccs[ENCODER_TOTAL_NUM];
+    int16_t outTorques[ENCODER_TOTAL_NUM];     // 力矩模式关节的目标力矩
+    ModeSwitchState modeSwitch[ENCODER_TOTAL_NUM];   // 模式切换的重试与限速
+    bool stopped = false;
+    bool primed = false;    // outPulses 中已有上一周期的目标
+    int16_t heldPulses[ENCODER_TOTAL_NUM];      // HOLD 关节冻结的目标
+    uint32_t heldMask = 0;
+    ServoAngleSnapshot_t servoSnapshot;
+    memset(&outer, 0, sizeof(outer));
+    memset(heldPulses, 0, sizeof(heldPulses));
+    memset(outPulses, 0, sizeof(outPulses));
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++)
+    {
+        modeSwitch[i] = { 0, 0, MODE_SWITCH_UNSEEN, MODE_SWITCH_UNSEEN };
+    }
+
+    // 首个周期前先读一次反馈，之后每周期的同步读与写入一起在周期末尾发出。
+    // 预读同样占用总线，按控制事务计时
+    busScheduler.beginControl();
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        servoBuses[b]->startCycle(true);
+    }
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        servoBuses[b]->finishCycle();
+    }
+    busScheduler.endControl();
+
+    TickType_t lastWake = xTaskGetTickCount();
     while (1)
     {
+        busScheduler.beginCycle();
+
+        // ========================================
+        // 步骤 0: 处理急停/恢复请求
+        // ========================================
+        serviceStopRequest(stopped);
+
         // ========================================
-        // 步骤 1: 同步读取所有舵机位置（自动跨圈检测）
+        // 步骤 1: 舵机反馈已在上一周期末尾收取（自动跨圈检测）
         // ========================================
-        servoBus0.syncReadPositions(bus0_ids, 4);
-        servoBus1.syncReadPositions(bus1_ids, 4);
-        servoBus2.syncReadPositions(bus2_ids, 4);
-        servoBus3.syncReadPositions(bus3_ids, 5);
 
         // ========================================
         // 步骤 2: 获取多圈绝对位置并转换为角度
         // ========================================
-        for (int i = 0; i < ENCODER_TOTAL_NUM; i++)
+        uint32_t errSum = 0, errMax = 0;
+        uint8_t errCount = 0;
+        uint32_t onlineMask = 0;
+        uint32_t torqueMask = 0;                      // 舵机处于力矩模式的关节
+        uint32_t cutMask = loadProtector.cutMask();   // 上一周期已关扭矩的关节不计跟踪误差
+        memset(servoSpeeds, 0, sizeof(servoSpeeds));
+        memset(servoLoads, 0, sizeof(servoLoads));
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
         {
-            uint8_t bus = jointMap[i].busIndex;
-            uint8_t id = jointMap[i].servoID;
-            ServoBusManager *pBus = getBusByIndex(bus);
-
-            if (pBus && pBus->isOnline(id))
-            {
-                // 使用多圈绝对位置（-30719 到 30719）
-                int32_t absPos = pBus->getAbsolutePosition(id);
-                // 转换为角度（每圈 4096 步 = 360°）
-                servoAngles[i] = (float)absPos * 360.0f / 4096.0f;
-            }
-            else
+            const BusTopology &topo = kHandTopology.bus[b];
+            const ServoBusManager &bus = *servoBuses[b];
+            for (uint8_t k = 0; k < topo.count; k++)
             {
-                servoAngles[i] = 0.0f;
+                // 总线槽位与拓扑槽位一一对应（begin 时按 topo.servoIDs 建表）
+                // 使用多圈绝对位置（不截断），减去零位后按型号的每度步数转换为角度
+                // 离线舵机的角度记为 0
+                const ServoHotState &hot = bus.hotStateAt(k);
+                int32_t absPos = hot.online ? hot.absolutePosition : 0;
+                servoAngles[topo.jointIndex[k]] = hot.online ? angleSolver.servoDegrees(topo.jointIndex[k], absPos) : 0.0f;
+                if (hot.online)
+                {
+                    servoSpeeds[topo.jointIndex[k]] = hot.tracker.Speed();
+                    servoLoads[topo.jointIndex[k]] = hot.load;
+                    onlineMask |= 1UL << topo.jointIndex[k];
+                }
+                if (bus.controlModeAt(k) == SERVO_CTRL_TORQUE)
+                {
+                    torqueMask |= 1UL << topo.jointIndex[k];
+                }
+
+                // 跟踪误差：上一周期写出的目标与刚收取的反馈之差（力矩模式的关节按设计允许误差，不计入）
+                if (primed && hot.online && !((cutMask | torqueMask) & (1UL << topo.jointIndex[k])))
+                {
+                    uint32_t err = abs(outPulses[topo.jointIndex[k]] - absPos);
+                    errSum += err;
+                    if (err > errMax) errMax = err;
+                    errCount++;
+                }
             }
         }
+        if (primed && !stopped)
+        {
+            recordTracking(errSum, errCount, errMax);
+        }
+
+        // ========================================
+        // 步骤 3: 过载/堵转保护（负载随位置同步读回，本周期的写入帧即带上新的力矩限制）
+        // ========================================
+#if LOAD_PROTECT_ENABLE
+        loadProtector.update(servoLoads, onlineMask, SOLVER_PERIOD_MS * 1e-3f);
+#endif
 
         // ========================================
-        // 步骤 3: 读取 CAN 磁编角度
+        // 步骤 4: 读取外环修正量（不等待 CAN；外环尚未输出或读取冲突时沿用上一份）
         // ========================================
-        if (xQueuePeek(sharedData->canRxQueue, &sensorData, 0) == pdTRUE)
+        OuterLoopOutput_t latest;
+        uint32_t outerVersion;
+        if (sharedData->outerMailbox.read(latest, &outerVersion) && outerVersion > 0)
         {
-            for (int i = 0; i < ENCODER_TOTAL_NUM; i++)
+            outer = latest;
+            if (outer.sampleTime != 0)
             {
-                canAngles[i] = convertCanToDeg(sensorData.encoderValues[i]);
+                uint32_t age = millis() - outer.sampleTime;
+                if (age > s_outerStats.maxAgeMs) s_outerStats.maxAgeMs = age;
             }
         }
 
-        // ========================================
-        // 步骤 4: 读取目标角度
-        // ========================================
-        if (xSemaphoreTake(sharedData->targetAnglesMutex, pdMS_TO_TICKS(10)) == pdTRUE)
+        // 有关节降级时把舵机角度交给外环（估计磁编失效关节的角度）
+        if (outer.servoOnlyMask | outer.holdMask)
         {
-            memcpy(localTargets, sharedData->targetAngles, sizeof(localTargets));
-            xSemaphoreGive(sharedData->targetAnglesMutex);
+            memcpy(servoSnapshot.degs, servoAngles, sizeof(servoSnapshot.degs));
+            servoSnapshot.onlineMask = onlineMask;
+            servoSnapshot.timeMs = millis();
+            sharedData->servoMailbox.publish(servoSnapshot);
         }
 
         // ========================================
-        // 步骤 5: PID 解算
+        // 步骤 5: 内环 PID 解算
         // ========================================
-        angleSolver.compute(localTargets, canAngles, servoAngles, outPulses);
+        // HOLD 关节：进入时记下上一周期的目标，之后一直写出该目标（其他关节不受影响）
+        uint32_t enteringHold = outer.holdMask & ~heldMask;
+        for (uint8_t i = 0; enteringHold != 0 && i < ENCODER_TOTAL_NUM; i++)
+        {
+            if (enteringHold & (1UL << i)) heldPulses[i] = outPulses[i];
+        }
+        heldMask = outer.holdMask;
+
+        angleSolver.computeInner(outer.corrections, servoAngles, outPulses);
+
+        for (uint8_t i = 0; heldMask != 0 && i < ENCODER_TOTAL_NUM; i++)
+        {
+            if (heldMask & (1UL << i)) outPulses[i] = heldPulses[i];
+        }
+
+        primed = true;
 
         // ========================================
-        // 步骤 6: 同步写入所有舵机
+        // 步骤 6: 速度/加速度上限（前馈）
         // ========================================
+#if SERVO_FEEDFORWARD_ENABLE
+        s_tracking.speedSaturated += angleSolver.computeProfile(outer.velocity, outer.accel, outPulses,
+                                                                servoAngles, servoSpeeds,
+                                                                SOLVER_PERIOD_MS * 1e-3f, outSpeeds, outAccs);
+#else
         for (int i = 0; i < ENCODER_TOTAL_NUM; i++)
         {
-            uint8_t bus = jointMap[i].busIndex;
-            uint8_t id = jointMap[i].servoID;
-            ServoBusManager *pBus = getBusByIndex(bus);
+            outSpeeds[i] = SERVO_DEFAULT_SPEED;
+            outAccs[i] = SERVO_DEFAULT_ACC;
+        }
+#endif
+
+        // ========================================
+        // 步骤 7: 柔顺控制（力矩模式关节）与控制模式切换
+        // ========================================
+        angleSolver.pollCompliance();
+        s_compliance.saturated += angleSolver.computeCompliance(outPulses, outer.velocity, servoAngles,
+                                                                servoSpeeds, outTorques);
+        s_compliance.activeMask = torqueMask;
+        requestModeChanges(angleSolver.complianceMask(), modeSwitch);
 
-            if (pBus)
+        // ========================================
+        // 步骤 8: 同步写入所有舵机
+        // ========================================
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            const BusTopology &topo = kHandTopology.bus[b];
+            ServoBusManager &bus = *servoBuses[b];
+            for (uint8_t k = 0; k < topo.count; k++)
             {
-                // outPulses[i] 范围：-30719 到 30719
-                int16_t targetPos = constrain(outPulses[i], -30719, 30719);
-                pBus->setTarget(id, targetPos, 1000, 50);
+                // outPulses[] 范围：-30719 到 30719
+                uint8_t joint = topo.jointIndex[k];
+#if LOAD_PROTECT_ENABLE
+                // 关扭矩的关节不再写目标（位置指令可能重新打开扭矩）
+                uint16_t limit = loadProtector.torqueLimit(joint);
+                bus.setTorqueLimitAt(k, limit);
+                if (limit == 0) continue;
+#endif
+                // 已确认切到力矩模式的舵机只使用目标力矩字段（柔顺控制已关闭、切回尚未确认时
+                // 同样按阻抗输出，不会失力）；位置模式写型号的位置模式力矩（HLS 为电流上限）
+                int16_t targetPos = constrain(outPulses[joint], -30719, 30719);
+                int16_t torque = (torqueMask & (1UL << joint)) ? outTorques[joint] : SERVO_TORQUE_POSITION_DEFAULT;
+                bus.setTargetAt(k, targetPos, outSpeeds[joint], outAccs[joint], torque);
             }
         }
 
-        // 统一发送
-        servoBus0.syncWriteAll();
-        servoBus1.syncWriteAll();
-        servoBus2.syncWriteAll();
-        servoBus3.syncWriteAll();
+        // 统一发送：写入帧与下一周期的同步读请求一次写出（停机期间丢弃目标，
+        // 并重复下发关扭矩，防止个别舵机漏收）。ACTION 模式下目标先经 REG_WRITE
+        // 暂存，写出的是 ACTION 广播。各总线先全部拼好再背靠背写出，然后逐条收取，
+        // 各总线的线路时间相互重叠
+        busScheduler.beginControl();
+#if SERVO_ACTUATION_MODE == SERVO_ACTUATION_ACTION
+        if (!stopped)
+        {
+            stageAllBuses();
+        }
+#endif
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->prepareCycle(stopped);
+        }
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->sendCycle();
+        }
+        recordActuationSkew();
+        for (uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            servoBuses[b]->finishCycle();
+        }
+        busScheduler.endControl();
+
+        // ========================================
+        // 步骤 9: 剩余总线时间执行单舵机命令、控制模式切换与诊断（不会越过下一周期起点）
+        // ========================================
+        busScheduler.runBackground();
 
         // ========================================
-        // 步骤 7: 控制周期延时（100Hz）
+        // 步骤 10: 固定周期调度（SOLVER_PERIOD_MS，默认 100Hz），急停请求可提前唤醒
         // ========================================
-        vTaskDelay(pdMS_TO_TICKS(10));
+        waitNextCycle(lastWake, stopped);
 
     }
 }
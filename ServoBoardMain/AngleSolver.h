@@ -15,18 +15,25 @@ extern "C" {
 
 #include "TaskSharedData.h"       // 【新增】引入共享数据定义
 #include "ServoBusManager.h"      // 【新增】引入舵机总线管理器
+#include "HandTopology.h"         // 关节 <-> (总线, 舵机ID) 编译期拓扑
 
 // [新增] 定义关节数量
 #define JOINT_COUNT 21
 // [新增] 舵机脉冲/角度转换系数 (根据之前文件 STS3215: 4096=360度)
 #define STS_STEPS_PER_DEG 11.3777f 
 
+static_assert(JOINT_COUNT == ENCODER_TOTAL_NUM, "关节数量必须与磁编数量一致");
 
-// ============ 关节映射结构 ============
-// 【新增】将关节索引(0-20)映射到物理总线和舵机ID
-struct JointMapItem {
-    uint8_t busIndex;   // 总线编号 0-3
-    uint8_t servoID;    // 舵机ID
+// 柔顺控制参数（按关节，默认值见 TaskSharedData.h 的 COMPLIANCE_*）
+struct ComplianceParams {
+    uint8_t  enabled;       // 1 = 力矩模式（阻抗控制），0 = 位置模式
+    float    stiffness;     // 目标力矩单位 / °
+    float    damping;       // 目标力矩单位 / (°/s)
+    uint16_t maxTorque;     // 目标力矩上限
+};
+
+struct ComplianceTable {
+    ComplianceParams joint[JOINT_COUNT];
 };
 
 
@@ -58,6 +65,72 @@ public:
      */
     bool compute(float* targetDegs, float* magActualDegs, float* servoActualDegs, int16_t* outServoPulses);
 
+    /**
+     * @brief 外环（磁编环）：目标角度与磁编角度 -> 各关节修正量
+     * 只访问外环 PID，可与 computeInner() 在不同任务中以不同频率运行
+     * @param validMask 磁编有效掩码（EncoderConditioner 给出），无效关节不运行 PID，保持上一次的修正量
+     */
+    bool computeOuter(const float* targetDegs, const float* magActualDegs, float* outCorrections,
+                      uint32_t validMask = ENC_VALID_ALL);
+
+    /**
+     * @brief 内环（舵机环）：修正量与舵机反馈角度 -> 目标脉冲
+     * 只访问内环 PID；输出脉冲 = 零位 + 内环输出
+     */
+    bool computeInner(const float* corrections, const float* servoActualDegs, int16_t* outServoPulses);
+
+    /**
+     * @brief 舵机反馈换算：多圈绝对位置 -> 舵机角度（零位为 0°，按关节舵机型号的每度步数）
+     */
+    float servoDegrees(uint8_t joint, int32_t pulses) const;
+
+    /**
+     * @brief 舵机速度/加速度上限（前馈）
+     * 目标速度取前馈（换算为舵机步/s）与本周期目标脉冲变化量所需速度中的大者，
+     * 再加上在 SERVO_FF_CATCHUP_S 内消除跟踪误差所需的速度；加速度取目标加速度与
+     * 舵机当前速度在同一时间内变为所需速度的加速度中的大者；乘以余量后限制在 [默认值, 上限]，
+     * 上限与角度/步换算取各关节舵机型号的策略（ServoModelPolicy）
+     *
+     * @param velocity       [输入] 21个关节目标的速度 (°/s)
+     * @param accel          [输入] 21个关节目标的加速度 (°/s²)
+     * @param servoPulses    [输入] 本周期的目标脉冲 (computeInner 的输出)
+     * @param servoActualDegs[输入] 21个舵机的当前反馈角度
+     * @param servoSpeeds    [输入] 21个舵机的当前速度 (步/s)
+     * @param periodS        [输入] 内环周期 (s)
+     * @param outSpeeds      [输出] 写入舵机的速度 (步/s)
+     * @param outAccs        [输出] 写入舵机的加速度 (×100 步/s²)
+     * @return 需要的速度超过型号速度上限的关节数
+     */
+    uint8_t computeProfile(const float* velocity, const float* accel, const int16_t* servoPulses,
+                           const float* servoActualDegs, const float* servoSpeeds,
+                           float periodS, uint16_t* outSpeeds, uint8_t* outAccs);
+
+    // 丢弃上一周期的目标（停机恢复后目标变化量从头计算）
+    void resetProfile() { _profilePrimed = false; }
+
+    /**
+     * @brief 柔顺（阻抗）控制：目标脉冲与舵机反馈 -> 目标力矩
+     * 力矩 = 刚度 × (目标 - 舵机角度) + 阻尼 × (目标速度 - 舵机速度)，限制在 ±maxTorque。
+     * 对全部关节计算，只有舵机已切换到力矩模式的关节才写出
+     *
+     * @param servoPulses    [输入] 本周期的目标脉冲 (computeInner 的输出)
+     * @param velocity       [输入] 21个关节目标的速度 (°/s)
+     * @param servoActualDegs[输入] 21个舵机的当前反馈角度
+     * @param servoSpeeds    [输入] 21个舵机的当前速度 (步/s)
+     * @param outTorques     [输出] 目标力矩（带符号）
+     * @return 力矩达到上限的关节数（只计要求力矩模式的关节）
+     */
+    uint8_t computeCompliance(const int16_t* servoPulses, const float* velocity,
+                              const float* servoActualDegs, const float* servoSpeeds, int16_t* outTorques);
+
+    // 上位机修改柔顺参数（整表，单一任务调用），由 pollCompliance() 在控制周期内应用
+    void requestCompliance(const ComplianceTable& table) { _complianceMailbox.publish(table); }
+    void pollCompliance();
+
+    // 要求力矩模式的关节
+    uint32_t complianceMask() const { return _complianceMask; }
+    const ComplianceParams& compliance(uint8_t joint) const { return _compliance[joint]; }
+
     // 重置所有PID
     void resetAll();
 
@@ -69,16 +142,66 @@ private:
     // [修改] PID 实例数组: [关节ID 0-20][环ID 0=外环, 1=内环]
     PID_Info_TypeDef _pids[JOINT_COUNT][2];
 
+    // 前馈：上一周期的目标脉冲
+    int16_t _lastPulses[JOINT_COUNT];
+    bool    _profilePrimed;
+
+    // 柔顺控制
+    ComplianceParams _compliance[JOINT_COUNT];
+    uint32_t         _complianceMask;
+    SeqlockMailbox<ComplianceTable> _complianceMailbox;
+    uint32_t         _complianceVersion;    // 已应用的邮箱版本
+
     bool _initialized;
 };
 
 // 【新增】全局声明（定义在 SystemTask.cpp 中）
 extern AngleSolver  angleSolver;
-extern JointMapItem jointMap[ENCODER_TOTAL_NUM];
+
+// 总线间生效偏斜统计（每周期最早与最晚生效的总线之差）
+struct ActuationSkewStats {
+    uint32_t cycles;      // 统计的周期数（至少两条总线下发了目标）
+    uint32_t lastUs;      // 最近一个周期的偏斜
+    uint32_t maxUs;       // 最大偏斜
+    uint32_t totalUs;     // 累计偏斜（求平均）
+};
+
+const ActuationSkewStats& actuationSkewStats();
 
 // ============================================================
 // 【新增】Solver 任务函数声明
 // ============================================================
 void taskSolver(void* parameter);
 
+// 外环任务：按 OUTER_LOOP_PERIOD_MS 检查新的磁编样本，计算修正量并发布到 outerMailbox
+void taskOuterLoop(void* parameter);
+
+// 外环统计
+struct OuterLoopStats {
+    uint32_t updates;       // 计算并发布修正量的次数
+    uint32_t idleTicks;     // 没有新磁编样本的周期数
+    uint32_t maxAgeMs;      // 内环使用的修正量的最大年龄（样本时间到使用时刻）
+};
+
+const OuterLoopStats& outerLoopStats();
+
+// 跟踪统计（目标脉冲与舵机反馈之差，反馈在目标写出后立即读取）
+struct TrackingStats {
+    uint32_t cycles;          // 统计的周期数
+    uint32_t avgErrSteps;     // 各周期在线关节平均误差的滑动平均（步）
+    uint32_t maxErrSteps;     // 单个关节的最大误差（步）
+    uint32_t speedSaturated;  // 需要的速度超过上限的关节·周期数
+};
+
+const TrackingStats& trackingStats();
+
+// 柔顺控制统计
+struct ComplianceStats {
+    uint32_t activeMask;      // 舵机已处于力矩模式的关节
+    uint32_t modeRequests;    // 提交的控制模式切换次数
+    uint32_t saturated;       // 目标力矩达到上限的关节·周期数
+};
+
+const ComplianceStats& complianceStats();
+
 #endif
@@ -0,0 +1,268 @@
+#include "BusScheduler.h"
+
+// 单次事务的初始耗时估计（1Mbps，含应答；运行中按实测值修正）
+#define EST_WRITE_US        400
+#define EST_EPROM_US        1200    // 解锁 + 写入 + 加锁，三次带应答写
+#define EST_READ_US         600
+#define EST_SYNC_READ_US    1500    // 一条总线全部舵机同步读一个寄存器段
+
+// 每类事务包含的带应答收发次数（下标同 _estimateUs），最坏情况下每次都等满超时
+static const uint8_t kAckedTransactions[BUS_SCHED_EST_COUNT] = {
+    1,  // 诊断读取
+    1,  // SERVO_CMD_MOVE
+    1,  // SERVO_CMD_TORQUE
+    1,  // SERVO_CMD_WRITE_REG
+    3,  // SERVO_CMD_WRITE_EPROM：解锁 + 写入 + 加锁
+    1,  // SERVO_CMD_READ_STATUS
+    3,  // SERVO_CMD_CTRL_MODE：经 writeEprom 写模式寄存器
+    1,  // 缓存刷新：一次同步读（接收超时同为 SERVO_TX_TIMEOUT_MS）
+};
+
+/* ==================== 构造与配置 ==================== */
+
+BusScheduler::BusScheduler(ServoBusManager* const buses[], uint8_t busCount, uint32_t periodUs)
+    : _buses(buses),
+      _busCount(busCount > NUM_BUSES ? NUM_BUSES : busCount),
+      _periodUs(periodUs),
+      _cmdQueue(NULL),
+      _statusQueue(NULL),
+      _nextBus(0),
+      _cycleStartUs(0),
+      _controlStartUs(0),
+      _controlUs(0),
+      _diagBus(0),
+      _diagSlot(0),
+      _lastDiagMs(0),
+      _refreshBus(0),
+      _lastRefreshMs(0),
+      _overruns(0)
+{
+    memset(_pending, 0, sizeof(_pending));
+    memset(_stats, 0, sizeof(_stats));
+
+    _estimateUs[0]                     = EST_READ_US;   // 诊断读取
+    _estimateUs[SERVO_CMD_MOVE]        = EST_WRITE_US;
+    _estimateUs[SERVO_CMD_TORQUE]      = EST_WRITE_US;
+    _estimateUs[SERVO_CMD_WRITE_REG]   = EST_WRITE_US;
+    _estimateUs[SERVO_CMD_WRITE_EPROM] = EST_EPROM_US;
+    _estimateUs[SERVO_CMD_READ_STATUS] = EST_READ_US;
+    _estimateUs[SERVO_CMD_CTRL_MODE]   = EST_EPROM_US;
+    _estimateUs[BUS_SCHED_EST_REFRESH] = EST_SYNC_READ_US;
+}
+
+void BusScheduler::attach(QueueHandle_t cmdQueue, QueueHandle_t statusQueue)
+{
+    _cmdQueue = cmdQueue;
+    _statusQueue = statusQueue;
+}
+
+/* ==================== 周期与控制事务 ==================== */
+
+void BusScheduler::beginCycle()
+{
+    uint32_t now = micros();
+    // 上一周期（控制 + 后台）超过周期长度，说明控制事务被推迟
+    if (_cycleStartUs != 0 && now - _cycleStartUs > _periodUs + _periodUs / 10)
+    {
+        _overruns++;
+    }
+    _cycleStartUs = now;
+    _controlUs = 0;
+}
+
+void BusScheduler::beginControl()
+{
+    _controlStartUs = micros();
+}
+
+void BusScheduler::endControl()
+{
+    uint32_t elapsed = micros() - _controlStartUs;
+    _controlUs += elapsed;
+
+    BusTxStats &st = _stats[BUS_TX_CONTROL];
+    st.count++;
+    st.busyUs += elapsed;
+    if (elapsed > st.maxUs) st.maxUs = elapsed;
+}
+
+/* ==================== 后台事务 ==================== */
+
+bool BusScheduler::_fits(uint8_t estimateIndex) const
+{
+    // 每次带应答收发在无应答时最多阻塞 SERVO_TX_TIMEOUT_MS（millis 粒度，再加 1ms），
+    // 多次收发的事务（EPROM 写入）按次数累计
+    uint32_t worst = kAckedTransactions[estimateIndex] * (SERVO_TX_TIMEOUT_MS + 1) * 1000;
+    if (_estimateUs[estimateIndex] > worst) worst = _estimateUs[estimateIndex];
+
+    uint32_t deadline = _cycleStartUs + _periodUs - BUS_SCHED_GUARD_US;
+    return (int32_t)(deadline - (micros() + worst)) >= 0;
+}
+
+void BusScheduler::_dispatchCommands()
+{
+    if (!_cmdQueue) return;
+
+    ServoCommand_t cmd;
+    while (xQueueReceive(_cmdQueue, &cmd, 0) == pdTRUE)
+    {
+        submit(cmd);
+    }
+}
+
+bool BusScheduler::submit(const ServoCommand_t &cmd)
+{
+    if (cmd.busIndex >= _busCount || cmd.cmdType == 0 || cmd.cmdType > SERVO_CMD_CTRL_MODE)
+    {
+        _stats[BUS_TX_COMMAND].failures++;
+        return false;
+    }
+    PendingRing &ring = _pending[cmd.busIndex];
+    if (ring.count >= BUS_SCHED_PENDING_PER_BUS)
+    {
+        _stats[BUS_TX_COMMAND].dropped++;
+        return false;
+    }
+    ring.cmds[(ring.head + ring.count) % BUS_SCHED_PENDING_PER_BUS] = cmd;
+    ring.count++;
+    return true;
+}
+
+bool BusScheduler::_execute(ServoBusManager &bus, const ServoCommand_t &cmd)
+{
+    switch (cmd.cmdType)
+    {
+    case SERVO_CMD_MOVE:
+        return bus.moveTo(cmd.servoId, cmd.position, cmd.speed);
+    case SERVO_CMD_TORQUE:
+        return bus.setTorque(cmd.servoId, cmd.position != 0);
+    case SERVO_CMD_WRITE_REG:
+        return bus.writeRegister(cmd.servoId, cmd.regAddr, cmd.regValue);
+    case SERVO_CMD_WRITE_EPROM:
+        return bus.writeEprom(cmd.servoId, cmd.regAddr, cmd.regValue);
+    case SERVO_CMD_READ_STATUS:
+    {
+        bool ok = bus.readDiagnostics(cmd.servoId);
+        if (ok && _statusQueue)
+        {
+            ServoFeedback fb = bus.getFeedback(cmd.servoId);
+            ServoStatus_t status;
+            status.servoId     = cmd.servoId;
+            status.position    = fb.rawPosition;
+            status.speed       = fb.speed;
+            status.load        = fb.load;
+            status.voltage     = fb.voltage;
+            status.temperature = fb.temperature;
+            xQueueSend(_statusQueue, &status, 0);
+        }
+        return ok;
+    }
+    case SERVO_CMD_CTRL_MODE:
+        return bus.setControlMode(cmd.servoId, (uint8_t)cmd.position);
+    default:
+        return false;
+    }
+}
+
+void BusScheduler::_record(uint8_t txClass, uint8_t estimateIndex, uint32_t startUs, bool ok)
+{
+    uint32_t elapsed = micros() - startUs;
+
+    BusTxStats &st = _stats[txClass];
+    st.count++;
+    if (!ok) st.failures++;
+    st.busyUs += elapsed;
+    if (elapsed > st.maxUs) st.maxUs = elapsed;
+
+    // 耗时估计：超出时立即跟上，低于时缓慢回落（偏保守）
+    uint32_t &est = _estimateUs[estimateIndex];
+    est = (elapsed > est) ? elapsed : (est * 7 + elapsed) / 8;
+}
+
+void BusScheduler::runBackground()
+{
+    _dispatchCommands();
+
+    // 1. 命令：按总线轮询，每轮每条总线最多执行一个事务
+    bool progress = true;
+    bool deferred = false;
+    while (progress && !deferred)
+    {
+        progress = false;
+        for (uint8_t i = 0; i < _busCount; i++)
+        {
+            uint8_t b = (_nextBus + i) % _busCount;
+            PendingRing &ring = _pending[b];
+            if (ring.count == 0) continue;
+
+            const ServoCommand_t &cmd = ring.cmds[ring.head];
+            if (!_fits(cmd.cmdType))
+            {
+                deferred = true;
+                break;
+            }
+
+            uint32_t start = micros();
+            bool ok = _execute(*_buses[b], cmd);
+            _record(BUS_TX_COMMAND, cmd.cmdType, start, ok);
+
+            ring.head = (ring.head + 1) % BUS_SCHED_PENDING_PER_BUS;
+            ring.count--;
+            progress = true;
+        }
+    }
+    _nextBus = (_nextBus + 1) % _busCount;
+
+    bool pendingLeft = false;
+    for (uint8_t b = 0; b < _busCount; b++)
+    {
+        if (_pending[b].count) pendingLeft = true;
+    }
+    if (pendingLeft)
+    {
+        _stats[BUS_TX_COMMAND].deferred++;
+        return;   // 命令优先于诊断
+    }
+
+    // 2. 寄存器缓存刷新：按固定间隔轮询一条总线
+    if (millis() - _lastRefreshMs >= BUS_SCHED_REFRESH_PERIOD_MS)
+    {
+        if (!_fits(BUS_SCHED_EST_REFRESH))
+        {
+            _stats[BUS_TX_REFRESH].deferred++;
+        }
+        else
+        {
+            uint32_t start = micros();
+            _buses[_refreshBus]->refreshRegisterCache(SERVO_TX_TIMEOUT_MS);
+            _record(BUS_TX_REFRESH, BUS_SCHED_EST_REFRESH, start, true);
+            _refreshBus = (_refreshBus + 1) % _busCount;
+            _lastRefreshMs = millis();
+            return;   // 每周期最多一个低优先级事务
+        }
+    }
+
+    // 3. 诊断：按固定间隔轮询一个舵机
+    if (millis() - _lastDiagMs < BUS_SCHED_DIAG_PERIOD_MS) return;
+    if (!_fits(0))
+    {
+        _stats[BUS_TX_DIAGNOSTIC].deferred++;
+        return;
+    }
+
+    for (uint8_t tries = 0; tries < _busCount; tries++)
+    {
+        ServoBusManager &bus = *_buses[_diagBus];
+        if (_diagSlot < bus.servoCount())
+        {
+            uint32_t start = micros();
+            bool ok = bus.readDiagnostics(bus.servoIdAt(_diagSlot));
+            _record(BUS_TX_DIAGNOSTIC, 0, start, ok);
+            _diagSlot++;
+            _lastDiagMs = millis();
+            return;
+        }
+        _diagSlot = 0;
+        _diagBus = (_diagBus + 1) % _busCount;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef BUS_SCHEDULER_H
+#define BUS_SCHEDULER_H
+
+#include <Arduino.h>
+#include "TaskSharedData.h"
+#include "ServoBusManager.h"
+
+/* ==================== 事务类别 ==================== */
+
+// 控制事务（同步读/同步写）每周期固定先执行；命令与诊断只使用本周期剩余的总线时间
+#define BUS_TX_CONTROL       0
+#define BUS_TX_COMMAND       1   // 来自 cmdQueue 的单舵机命令
+#define BUS_TX_DIAGNOSTIC    2   // 周期性诊断读取
+#define BUS_TX_REFRESH       3   // 寄存器影子缓存的后台刷新（每次一条总线同步读一段）
+#define BUS_TX_CLASS_COUNT   4
+
+// 耗时估计下标：0 为诊断读取，1 ~ SERVO_CMD_CTRL_MODE 为命令类型，其后为缓存刷新
+#define BUS_SCHED_EST_REFRESH  (SERVO_CMD_CTRL_MODE + 1)
+#define BUS_SCHED_EST_COUNT    (BUS_SCHED_EST_REFRESH + 1)
+
+// 每个类别的吞吐统计
+struct BusTxStats {
+    uint32_t count;       // 完成的事务数
+    uint32_t failures;    // 无应答/校验失败
+    uint32_t busyUs;      // 累计占用总线时间
+    uint32_t maxUs;       // 单次最长耗时
+    uint32_t deferred;    // 因剩余时间不足推迟到后续周期的次数
+    uint32_t dropped;     // 待执行队列已满被丢弃的次数
+};
+
+/* ==================== 总线事务调度器 ==================== */
+
+// 由 taskSolver 独占调用，是唯一访问舵机总线的上下文，因此各事务之间不会在 UART 上交错。
+// 每个周期：
+//   beginCycle() -> 控制事务（beginControl()/endControl() 计时）-> runBackground()
+// runBackground() 把 cmdQueue 中的命令分发到各总线的待执行队列，按总线轮询执行；
+// 只有在 “当前时间 + 该类事务的最坏耗时” 不超过本周期截止时间时才会启动事务，
+// 最坏耗时取耗时估计与 “带应答收发次数 × 应答超时” 中的较大者（EPROM 写入为三次），
+// 截止时间为周期起点 + 周期 - BUS_SCHED_GUARD_US，保证下一周期的控制事务准时开始。
+class BusScheduler {
+public:
+    BusScheduler(ServoBusManager* const buses[], uint8_t busCount, uint32_t periodUs);
+
+    // 绑定命令/状态队列（statusQueue 可为 NULL，此时读状态结果被丢弃）
+    void attach(QueueHandle_t cmdQueue, QueueHandle_t statusQueue);
+
+    // 周期开始
+    void beginCycle();
+
+    // 控制事务计时（可多段，例如同步读与同步写分开计时）
+    void beginControl();
+    void endControl();
+
+    // 在本周期剩余时间内执行后台事务
+    void runBackground();
+
+    // 控制环自身提交的命令（与 cmdQueue 的命令同样排队执行，只能在 taskSolver 中调用）
+    // @return false 该总线的待执行队列已满
+    bool submit(const ServoCommand_t& cmd);
+
+    const BusTxStats& stats(uint8_t txClass) const { return _stats[txClass]; }
+
+    // 控制事务 + 后台事务超出周期的次数
+    uint32_t overruns() const { return _overruns; }
+
+private:
+    struct PendingRing {
+        ServoCommand_t cmds[BUS_SCHED_PENDING_PER_BUS];
+        uint8_t head;
+        uint8_t count;
+    };
+
+    ServoBusManager* const* _buses;
+    uint8_t  _busCount;
+    uint32_t _periodUs;
+
+    QueueHandle_t _cmdQueue;
+    QueueHandle_t _statusQueue;
+
+    PendingRing _pending[NUM_BUSES];
+    uint8_t  _nextBus;            // 轮询起点，避免总是先服务 0 号总线
+
+    uint32_t _cycleStartUs;
+    uint32_t _controlStartUs;
+    uint32_t _controlUs;          // 本周期控制事务累计耗时
+
+    uint8_t  _diagBus;            // 诊断轮询位置
+    uint8_t  _diagSlot;
+    uint32_t _lastDiagMs;
+
+    uint8_t  _refreshBus;         // 缓存刷新轮询位置
+    uint32_t _lastRefreshMs;
+
+    uint32_t _estimateUs[BUS_SCHED_EST_COUNT];    // 按事务类型的耗时估计（下标见 BUS_SCHED_EST_*）
+    BusTxStats _stats[BUS_TX_CLASS_COUNT];
+    uint32_t _overruns;
+
+    void _dispatchCommands();
+    bool _fits(uint8_t estimateIndex) const;
+    bool _execute(ServoBusManager& bus, const ServoCommand_t& cmd);
+    void _record(uint8_t txClass, uint8_t estimateIndex, uint32_t startUs, bool ok);
+};
+
+#endif // BUS_SCHEDULER_H
@@ -1,5 +1,6 @@
 #include "CanCommTask.h"
 #include "driver/twai.h"
+#include "DeferredLog.h"
 
 // CAN 驱动初始化
 static void setupTwai() {
@@ -18,12 +19,13 @@ static void setupTwai() {
     // 增大 RX 队列以防止在此任务忙碌时丢包
     g_config.rx_queue_len = 64; 
 
-    if (twai_driver_install(&g_config, &t_config, &f_config) == ESP_OK) {
+    esp_err_t err = twai_driver_install(&g_config, &t_config, &f_config);
+    if (err == ESP_OK) {
         twai_start();
         installed = true;
-        Serial.println("[CAN] Driver Installed OK");
+        DLOG(CAN_DRIVER_OK);
     } else {
-        // Serial.println("[CAN] Driver Install FAILED");
+        DLOG(CAN_DRIVER_FAIL, (int)err);
     }
 }
 
@@ -74,6 +76,7 @@ void taskCanComm(void *parameter) {
                     rxBuffer.timestamp = millis();
                     rxBuffer.isValid = true;
                     xQueueOverwrite(sharedData->canRxQueue, &rxBuffer);
+                    sharedData->sensorMailbox.publish(rxBuffer);
                 }
             }
             // ------------------------------------------
@@ -0,0 +1,96 @@
+#include "EncoderConditioner.h"
+#include <string.h>
+
+// 两个 14 位读数之差，按最短路径折算到 [-8192, 8191]
+static inline int32_t wrapDelta(int32_t raw, int32_t ref) {
+    int32_t d = (raw - ref) & (ENC_COUNTS_PER_REV - 1);
+    return (d >= ENC_COUNTS_PER_REV / 2) ? d - ENC_COUNTS_PER_REV : d;
+}
+
+static inline int32_t median3(int32_t a, int32_t b, int32_t c) {
+    int32_t lo = (a < b) ? a : b;
+    int32_t hi = (a < b) ? b : a;
+    int32_t m = (hi < c) ? hi : c;
+    return (lo > m) ? lo : m;
+}
+
+EncoderConditioner::EncoderConditioner() : _primedMask(0)
+{
+    memset(_unwrapped, 0, sizeof(_unwrapped));
+    memset(_hist, 0, sizeof(_hist));
+    memset(_filtered, 0, sizeof(_filtered));
+    memset(_candidate, 0, sizeof(_candidate));
+    memset(_rejectRun, 0, sizeof(_rejectRun));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint32_t EncoderConditioner::process(const uint16_t* raw, const uint8_t* errorFlags, float* outDegs)
+{
+    int32_t  step[ENCODER_TOTAL_NUM];    // 本帧对展开位置的增量
+    uint8_t  restart[ENCODER_TOTAL_NUM]; // 首个有效读数或重新锁定：滤波器从该值重新开始
+    uint32_t valid = 0;
+
+    // 1. 有效性与毛刺判断
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        uint16_t v = raw[i];
+        uint32_t bit = 1UL << i;
+        step[i] = 0;
+        restart[i] = 0;
+
+        if (v >= ENC_COUNTS_PER_REV || v == 0x3FFF || errorFlags[i] != 0) {
+            _stats.invalid++;
+            continue;
+        }
+        if (!(_primedMask & bit)) {
+            _unwrapped[i] = v;
+            _primedMask |= bit;
+            restart[i] = 1;
+            valid |= bit;
+            continue;
+        }
+
+        int32_t d = wrapDelta(v, _unwrapped[i]);
+        if (d > ENC_GLITCH_MAX_STEP || d < -ENC_GLITCH_MAX_STEP) {
+            // 与上一个毛刺相近则累计，累计够数说明位置确实变了
+            int32_t dc = wrapDelta(v, _candidate[i]);
+            bool consistent = _rejectRun[i] > 0 && dc <= ENC_GLITCH_MAX_STEP && dc >= -ENC_GLITCH_MAX_STEP;
+            _rejectRun[i] = consistent ? _rejectRun[i] + 1 : 1;
+            _candidate[i] = v;
+            if (_rejectRun[i] < ENC_GLITCH_RELOCK) {
+                _stats.glitches++;
+                continue;
+            }
+            restart[i] = 1;
+            _stats.relocks++;
+        }
+        _rejectRun[i] = 0;
+        step[i] = d;
+        valid |= bit;
+    }
+
+    // 2. 跨圈展开、三点中值、一阶低通（无效通道不推进）
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        if (!(valid & (1UL << i))) continue;
+        int32_t u = _unwrapped[i] + step[i];
+        _unwrapped[i] = u;
+        if (restart[i]) {
+            _hist[0][i] = _hist[1][i] = _hist[2][i] = u;
+            _filtered[i] = (float)u;
+        } else {
+            _hist[0][i] = _hist[1][i];
+            _hist[1][i] = _hist[2][i];
+            _hist[2][i] = u;
+            float med = (float)median3(_hist[0][i], _hist[1][i], _hist[2][i]);
+            _filtered[i] += ENC_IIR_ALPHA * (med - _filtered[i]);
+        }
+    }
+
+    // 3. 计数 -> 角度
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        outDegs[i] = _filtered[i] * (360.0f / ENC_COUNTS_PER_REV);
+    }
+
+    _stats.samples++;
+    _stats.invalidMask = ENC_VALID_ALL & ~valid;
+    return valid;
+}
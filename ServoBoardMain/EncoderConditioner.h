@@ -0,0 +1,52 @@
+#ifndef ENCODER_CONDITIONER_H
+#define ENCODER_CONDITIONER_H
+
+#include <stdint.h>
+#include "TaskSharedData.h"
+
+/* ==================== 磁编信号调理 ==================== */
+
+// 掌部板发来的 21 路 14 位磁编原始值在进入外环 PID 前统一经过：
+//   1. 有效性：0xFFFF/0x3FFF、超出 14 位或 errorFlags 置位的读数不使用，该通道本次无效；
+//   2. 毛刺剔除：与上一个接受值（按最短路径跨圈）相差超过 ENC_GLITCH_MAX_STEP 的读数剔除，
+//      连续 ENC_GLITCH_RELOCK 个相互一致的读数说明位置确实变了（如掌部板重新上电），重新锁定；
+//   3. 跨圈展开：输出连续角度，经过 0/360° 时不再跳变 360°；
+//   4. 三点中值 + 一阶低通。
+// 状态按通道存放为结构化数组，每一步对全部通道循环一遍；只由外环任务调用。
+
+// 统计（外环写，其他任务读）
+struct EncoderConditionerStats {
+    uint32_t samples;         // 处理的帧数
+    uint32_t invalid;         // 无效读数（通道·帧）
+    uint32_t glitches;        // 剔除的毛刺（通道·帧）
+    uint32_t relocks;         // 重新锁定次数
+    uint32_t invalidMask;     // 最近一帧的无效通道（位 i = 通道 i）
+};
+
+class EncoderConditioner {
+public:
+    EncoderConditioner();
+
+    /**
+     * @brief 处理一帧磁编数据
+     * @param raw        [输入] 21 路原始值 (0-16383)
+     * @param errorFlags [输入] 掌部板给出的错误标记（非 0 为无效）
+     * @param outDegs    [输出] 21 路连续角度 (°)，无效通道保持上一次的输出
+     * @return 有效通道掩码（位 i = 通道 i 本帧读数被接受）
+     */
+    uint32_t process(const uint16_t* raw, const uint8_t* errorFlags, float* outDegs);
+
+    const EncoderConditionerStats& stats() const { return _stats; }
+
+private:
+    int32_t  _unwrapped[ENCODER_TOTAL_NUM];   // 最近一个接受的读数（展开后的计数）
+    int32_t  _hist[3][ENCODER_TOTAL_NUM];     // 中值滤波历史（展开后的计数）
+    float    _filtered[ENCODER_TOTAL_NUM];    // 低通输出（计数）
+    uint16_t _candidate[ENCODER_TOTAL_NUM];   // 连续毛刺的最近一个读数
+    uint8_t  _rejectRun[ENCODER_TOTAL_NUM];   // 连续一致的毛刺数
+    uint32_t _primedMask;                     // 已收到过有效读数的通道
+
+    EncoderConditionerStats _stats;
+};
+
+#endif // ENCODER_CONDITIONER_H
@@ -0,0 +1,125 @@
+#ifndef HAND_TOPOLOGY_H
+#define HAND_TOPOLOGY_H
+
+#include <stdint.h>
+#include "TaskSharedData.h"       // ENCODER_TOTAL_NUM
+#include "ServoBusManager.h"      // NUM_BUSES / MAX_SERVOS_PER_BUS / MAX_SERVO_ID
+#include "ServoModel.h"           // SERVO_MODEL_*
+
+/* ==================== 关节映射结构 ==================== */
+
+// 将关节索引(0-20)映射到物理总线和舵机ID
+struct JointMapItem {
+    uint8_t busIndex;   // 总线编号 0-3
+    uint8_t servoID;    // 舵机ID
+    uint8_t model = SERVO_MODEL_STS;   // 舵机型号，可省略（默认 STS）
+};
+
+/* ==================== 手部拓扑描述（唯一数据源） ==================== */
+
+// 关节映射表: 将 0-20 索引映射到 (BusIndex, ServoID)
+// 请根据实际硬件连线修改，下面所有查找表均在编译期由此表生成
+// 非 STS 舵机写第三项，例如拇指换用 HLS：{3, 1, SERVO_MODEL_HLS}
+constexpr JointMapItem kJointMap[ENCODER_TOTAL_NUM] = {
+    // Bus 0 (4个关节)
+    {0, 1}, {0, 2}, {0, 3}, {0, 4},
+    // Bus 1 (4个关节)
+    {1, 1}, {1, 2}, {1, 3}, {1, 4},
+    // Bus 2 (4个关节)
+    {2, 1}, {2, 2}, {2, 3}, {2, 4},
+    // Bus 3 (5个关节)
+    {3, 1}, {3, 2}, {3, 3}, {3, 4}, {3, 5},
+    // 剩余4个关节（根据实际分配）
+    {0, 5}, {1, 5}, {2, 5}, {3, 6}  // 示例分配，请根据实际调整
+};
+
+/* ==================== 编译期生成的查找表 ==================== */
+
+// 单条总线的连续索引表（热循环按总线顺序遍历，无需逐关节分支）
+struct BusTopology {
+    uint8_t count;                              // 该总线上的舵机数量
+    uint8_t servoIDs[MAX_SERVOS_PER_BUS];       // 舵机 ID 列表（可直接用于 SYNC_READ/WRITE）
+    uint8_t models[MAX_SERVOS_PER_BUS];         // 槽位 -> 舵机型号
+    uint8_t jointIndex[MAX_SERVOS_PER_BUS];     // 槽位 -> 关节索引
+};
+
+struct HandTopology {
+    BusTopology bus[NUM_BUSES];
+    uint8_t     jointSlot[ENCODER_TOTAL_NUM];   // 关节索引 -> 所属总线中的槽位
+};
+
+namespace hand_topology_detail {
+
+constexpr bool busIndicesValid() {
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        if (kJointMap[i].busIndex >= NUM_BUSES) return false;
+    }
+    return true;
+}
+
+constexpr bool servoIDsValid() {
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        // 0xFE 为广播地址，不允许作为关节舵机 ID
+        if (kJointMap[i].servoID > MAX_SERVO_ID || kJointMap[i].servoID == 0xFE) return false;
+    }
+    return true;
+}
+
+constexpr bool modelsValid() {
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        if (kJointMap[i].model >= SERVO_MODEL_COUNT) return false;
+    }
+    return true;
+}
+
+constexpr bool noDuplicateServos() {
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        for (int j = i + 1; j < ENCODER_TOTAL_NUM; j++) {
+            if (kJointMap[i].busIndex == kJointMap[j].busIndex &&
+                kJointMap[i].servoID  == kJointMap[j].servoID) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr int servoCountOnBus(uint8_t busIndex) {
+    int n = 0;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        if (kJointMap[i].busIndex == busIndex) n++;
+    }
+    return n;
+}
+
+constexpr bool busCapacityValid() {
+    for (uint8_t b = 0; b < NUM_BUSES; b++) {
+        if (servoCountOnBus(b) > MAX_SERVOS_PER_BUS) return false;
+    }
+    return true;
+}
+
+constexpr HandTopology build() {
+    HandTopology t{};
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        BusTopology& bus = t.bus[kJointMap[i].busIndex];
+        t.jointSlot[i] = bus.count;
+        bus.servoIDs[bus.count]   = kJointMap[i].servoID;
+        bus.models[bus.count]     = kJointMap[i].model;
+        bus.jointIndex[bus.count] = (uint8_t)i;
+        bus.count++;
+    }
+    return t;
+}
+
+} // namespace hand_topology_detail
+
+static_assert(hand_topology_detail::busIndicesValid(),   "kJointMap: 总线编号超出 NUM_BUSES");
+static_assert(hand_topology_detail::servoIDsValid(),     "kJointMap: 舵机 ID 超出 MAX_SERVO_ID");
+static_assert(hand_topology_detail::modelsValid(),       "kJointMap: 未知的舵机型号");
+static_assert(hand_topology_detail::noDuplicateServos(), "kJointMap: 同一总线上存在重复的舵机 ID");
+static_assert(hand_topology_detail::busCapacityValid(),  "kJointMap: 单总线舵机数超出 MAX_SERVOS_PER_BUS");
+
+constexpr HandTopology kHandTopology = hand_topology_detail::build();
+
+#endif
@@ -0,0 +1,39 @@
+#include "JointModeSelector.h"
+#include <string.h>
+
+JointModeSelector::JointModeSelector()
+    : _servoOnlyMask(0), _holdMask(ENC_VALID_ALL), _primedMask(0)   // 收到第一帧有效磁编前全部冻结
+{
+    memset(_offset, 0, sizeof(_offset));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void JointModeSelector::update(uint32_t validMask, bool sampleFresh, const ServoAngleSnapshot_t* servo, float* magDegs)
+{
+    uint32_t encOk = sampleFresh ? (validMask & ENC_VALID_ALL) : 0;
+    _primedMask |= encOk;
+
+    uint32_t servoOk = servo ? servo->onlineMask : 0;
+    uint32_t servoOnly = ~encOk & _primedMask & servoOk & ENC_VALID_ALL;
+    uint32_t hold = ~encOk & ~servoOnly & ENC_VALID_ALL;
+
+    // 新进入 SERVO_ONLY 的关节记录偏差（此时 magDegs 为最后的有效磁编角度）
+    uint32_t entering = servoOnly & ~_servoOnlyMask;
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        uint32_t bit = 1UL << i;
+        if (entering & bit) {
+            _offset[i] = magDegs[i] - servo->degs[i];
+        }
+        if (servoOnly & bit) {
+            magDegs[i] = servo->degs[i] + _offset[i];
+        }
+    }
+
+    uint32_t changed = (servoOnly ^ _servoOnlyMask) | (hold ^ _holdMask);
+    _stats.transitions += __builtin_popcount(changed);
+    _stats.servoOnlyTicks += __builtin_popcount(servoOnly);
+    _stats.holdTicks += __builtin_popcount(hold);
+
+    _servoOnlyMask = servoOnly;
+    _holdMask = hold;
+}
@@ -0,0 +1,57 @@
+#ifndef JOINT_MODE_SELECTOR_H
+#define JOINT_MODE_SELECTOR_H
+
+#include <stdint.h>
+#include "TaskSharedData.h"
+
+/* ==================== 关节降级模式 ==================== */
+
+// 外环每个周期按磁编有效性与样本年龄逐关节选择控制方式（JOINT_MODE_*）：
+//   FULL       磁编有效且样本新鲜，正常级联；
+//   SERVO_ONLY 磁编无效，但该关节有过有效磁编且舵机在线：以舵机角度 + 进入时记录的
+//              (磁编 - 舵机) 偏差代替磁编角度，外环 PID 照常运行（按当前 1:1 减速比）；
+//   HOLD       无法估计：内环冻结该关节的舵机目标。
+// 降级关节需要舵机角度快照，刚失效的第一个周期通常先进入 HOLD（舵机目标冻结，
+// 记录的偏差因此准确），快照到达后转为 SERVO_ONLY；磁编恢复后直接回到 FULL。
+// 各关节的 PID 状态都不复位；全部健康时只做一次比较。
+
+// 统计（外环写，其他任务读）
+struct JointModeStats {
+    uint32_t transitions;       // 模式切换次数（关节·次）
+    uint32_t servoOnlyTicks;    // SERVO_ONLY 的关节·周期数
+    uint32_t holdTicks;         // HOLD 的关节·周期数
+};
+
+class JointModeSelector {
+public:
+    JointModeSelector();
+
+    // 是否全部关节都应走快速路径（磁编全部有效、样本新鲜、当前没有降级关节）
+    bool healthy(uint32_t validMask, bool sampleFresh) const {
+        return sampleFresh && validMask == ENC_VALID_ALL && (_servoOnlyMask | _holdMask) == 0;
+    }
+
+    /**
+     * @brief 选择各关节模式，并把 SERVO_ONLY 关节的磁编角度替换为估计值
+     * @param validMask   最近一帧的磁编有效掩码（EncoderConditioner 给出）
+     * @param sampleFresh 磁编样本未超过 ENC_SAMPLE_MAX_AGE_MS
+     * @param servo       舵机角度快照，nullptr 表示不可用（未发布或已过期）
+     * @param magDegs     输入：调理后的磁编角度（无效通道为最后的有效值）；
+     *                    输出：SERVO_ONLY 关节替换为估计角度
+     */
+    void update(uint32_t validMask, bool sampleFresh, const ServoAngleSnapshot_t* servo, float* magDegs);
+
+    uint32_t servoOnlyMask() const { return _servoOnlyMask; }
+    uint32_t holdMask() const { return _holdMask; }
+    const JointModeStats& stats() const { return _stats; }
+
+private:
+    uint32_t _servoOnlyMask;
+    uint32_t _holdMask;
+    uint32_t _primedMask;                 // 有过有效磁编的关节
+    float    _offset[ENCODER_TOTAL_NUM];  // SERVO_ONLY：磁编角度 - 舵机角度
+
+    JointModeStats _stats;
+};
+
+#endif // JOINT_MODE_SELECTOR_H
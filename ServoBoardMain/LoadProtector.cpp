@@ -0,0 +1,96 @@
+#include "LoadProtector.h"
+#include "ServoModel.h"
+#include <string.h>
+
+LoadProtector::LoadProtector()
+    : _derateMask(0), _cutMask(0), _limitVersion(0)
+{
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        LoadLimit& lim = _limits.joint[i];
+        lim.contLoad = LOAD_CONT_DEFAULT;
+        lim.derateTorque = LOAD_DERATE_TORQUE_DEFAULT;
+        lim.derateHeat = LOAD_DERATE_HEAT_S;
+        lim.cutHeat = LOAD_CUT_HEAT_S;
+    }
+    memset(_heat, 0, sizeof(_heat));
+    memset(_state, LOAD_STATE_NORMAL, sizeof(_state));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void LoadProtector::_applyLimits(const LoadLimitTable& table)
+{
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        const LoadLimit& lim = table.joint[i];
+        if (lim.contLoad == 0 || lim.contLoad > SERVO_TORQUE_LIMIT_MAX) continue;
+        if (!(lim.derateHeat > 0.0f) || !(lim.cutHeat > lim.derateHeat)) continue;
+        _limits.joint[i] = lim;
+        if (_limits.joint[i].derateTorque > SERVO_TORQUE_LIMIT_MAX) {
+            _limits.joint[i].derateTorque = SERVO_TORQUE_LIMIT_MAX;
+        }
+    }
+}
+
+void LoadProtector::update(const int16_t* loads, uint32_t onlineMask, float dt)
+{
+    uint32_t version = _limitMailbox.version();
+    if (version != _limitVersion) {
+        LoadLimitTable table;
+        if (_limitMailbox.read(table, &version)) {
+            _applyLimits(table);
+            _limitVersion = version;
+        }
+    }
+
+    uint32_t derate = 0, cut = 0;
+    float peakHeat = 0.0f;
+    for (uint8_t i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        uint32_t bit = 1UL << i;
+        const LoadLimit& lim = _limits.joint[i];
+
+        if (onlineMask & bit) {
+            uint16_t load = (uint16_t)(loads[i] < 0 ? -loads[i] : loads[i]);
+            if (load > _stats.peakLoad) _stats.peakLoad = load;
+
+            float r = (float)load / lim.contLoad;
+            float h = _heat[i] + (r * r - 1.0f) * dt;
+            if (h < 0.0f) h = 0.0f;
+            if (h > lim.cutHeat) h = lim.cutHeat;
+            _heat[i] = h;
+
+            float release = lim.derateHeat * LOAD_RELEASE_RATIO;
+            uint8_t s = _state[i];
+            if (s == LOAD_STATE_NORMAL && h >= lim.derateHeat) {
+                s = LOAD_STATE_DERATE;
+                _stats.derates++;
+            } else if (s == LOAD_STATE_DERATE && h >= lim.cutHeat) {
+                s = LOAD_STATE_CUT;
+                _stats.cuts++;
+            } else if (s == LOAD_STATE_DERATE && h < release) {
+                s = LOAD_STATE_NORMAL;
+                _stats.releases++;
+            } else if (s == LOAD_STATE_CUT && h < lim.derateHeat) {
+                s = LOAD_STATE_DERATE;   // 先以降额力矩恢复，继续冷却到释放阈值才回到 NORMAL
+            }
+            _state[i] = s;
+        }
+
+        if (_state[i] == LOAD_STATE_DERATE) derate |= bit;
+        if (_state[i] == LOAD_STATE_CUT) cut |= bit;
+        float ratio = _heat[i] / lim.cutHeat;
+        if (ratio > peakHeat) peakHeat = ratio;
+    }
+
+    _derateMask = derate;
+    _cutMask = cut;
+    uint16_t pct = (uint16_t)(peakHeat * 100.0f);
+    if (pct > _stats.peakHeatPct) _stats.peakHeatPct = pct;
+}
+
+uint16_t LoadProtector::torqueLimit(uint8_t joint) const
+{
+    switch (_state[joint]) {
+    case LOAD_STATE_DERATE: return _limits.joint[joint].derateTorque;
+    case LOAD_STATE_CUT:    return 0;
+    default:                return SERVO_TORQUE_LIMIT_MAX;
+    }
+}
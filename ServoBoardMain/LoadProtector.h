@@ -0,0 +1,87 @@
+#ifndef LOAD_PROTECTOR_H
+#define LOAD_PROTECTOR_H
+
+#include <stdint.h>
+#include "TaskSharedData.h"
+#include "SeqlockMailbox.h"
+
+/* ==================== 过载/堵转保护 ==================== */
+
+// 内环每个控制周期用同步读回的负载逐关节做 I²t 式累计（参数见 TaskSharedData.h 的 LOAD_*）：
+//   heat += ((|负载| / 持续负载)² - 1) × dt，限制在 [0, 关扭矩阈值]；
+//   NORMAL -> DERATE：heat 达到降额阈值，力矩限制降到降额值；
+//   DERATE -> CUT   ：降额后 heat 仍升到关扭矩阈值，关闭扭矩；
+//   逐级恢复        ：CUT 在 heat 低于降额阈值时回到 DERATE，
+//                     DERATE 在 heat 低于 降额阈值 × LOAD_RELEASE_RATIO 时回到 NORMAL。
+// 堵转表现为持续高负载，与过载一样由累计热量处理；短时的高负载峰值不会触发。
+// 离线关节保持状态与热量。限制由内环任务使用，上位机经 requestLimits() 整表修改。
+
+#define LOAD_STATE_NORMAL   0
+#define LOAD_STATE_DERATE   1
+#define LOAD_STATE_CUT      2
+
+struct LoadLimit {
+    uint16_t contLoad;        // 可持续负载 (0.1%)
+    uint16_t derateTorque;    // 降额后的力矩限制 (0.1%)
+    float    derateHeat;      // 降额阈值 (s)
+    float    cutHeat;         // 关扭矩阈值 (s)
+};
+
+struct LoadLimitTable {
+    LoadLimit joint[ENCODER_TOTAL_NUM];
+};
+
+// 统计（内环写，其他任务读）
+struct LoadProtectionStats {
+    uint32_t derates;         // 进入降额（关节·次）
+    uint32_t cuts;            // 关闭扭矩（关节·次）
+    uint32_t releases;        // 恢复到 NORMAL（关节·次）
+    uint16_t peakLoad;        // 在线关节出现过的最大 |负载| (0.1%)
+    uint16_t peakHeatPct;     // 出现过的最大 heat / 关扭矩阈值 (%)
+};
+
+class LoadProtector {
+public:
+    LoadProtector();
+
+    /**
+     * @brief 上位机修改限制（任意任务调用，下一个控制周期生效）
+     *        持续负载为 0 或阈值不递增的关节沿用原有限制
+     */
+    void requestLimits(const LoadLimitTable& table) { _limitMailbox.publish(table); }
+
+    /**
+     * @brief 每个控制周期调用一次
+     * @param loads      [输入] 各关节负载（带符号，0.1%）
+     * @param onlineMask [输入] 本周期读到反馈的关节
+     * @param dt         控制周期 (s)
+     */
+    void update(const int16_t* loads, uint32_t onlineMask, float dt);
+
+    /**
+     * @brief 关节的力矩限制：SERVO_TORQUE_LIMIT_MAX（NORMAL）、降额值（DERATE）或 0（CUT）
+     */
+    uint16_t torqueLimit(uint8_t joint) const;
+
+    uint8_t  state(uint8_t joint) const { return _state[joint]; }
+    uint32_t derateMask() const { return _derateMask; }
+    uint32_t cutMask() const { return _cutMask; }
+    const LoadLimit& limit(uint8_t joint) const { return _limits.joint[joint]; }
+    const LoadProtectionStats& stats() const { return _stats; }
+
+private:
+    void _applyLimits(const LoadLimitTable& table);
+
+    LoadLimitTable _limits;
+    float          _heat[ENCODER_TOTAL_NUM];
+    uint8_t        _state[ENCODER_TOTAL_NUM];
+    uint32_t       _derateMask;
+    uint32_t       _cutMask;
+
+    SeqlockMailbox<LoadLimitTable> _limitMailbox;
+    uint32_t                       _limitVersion;   // 已应用的邮箱版本
+
+    LoadProtectionStats _stats;
+};
+
+#endif // LOAD_PROTECTOR_H
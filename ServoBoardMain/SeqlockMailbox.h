@@ -0,0 +1,63 @@
+#ifndef SEQLOCK_MAILBOX_H
+#define SEQLOCK_MAILBOX_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+// 读者遇到写入进行中时的重试次数上限（写者被抢占时读者不会一直自旋）
+#define SEQLOCK_READ_RETRIES  16
+
+/* ==================== 无锁邮箱（seqlock） ==================== */
+
+// 单写者、多读者，只保留最新一份数据：
+// - 写者：序号置为奇数 -> 拷贝数据 -> 序号置为偶数，任何时候都不会阻塞；
+// - 读者：读序号 -> 拷贝数据 -> 再读序号，两次相同且为偶数说明拷贝完整，否则重试。
+// 跨核心的任务之间交换控制数据时不需要互斥锁，读者不会推迟写者。
+// T 必须可按字节拷贝（POD 结构体/数组）。
+template <typename T>
+class SeqlockMailbox {
+public:
+    SeqlockMailbox() : _seq(0) {
+        memset(&_data, 0, sizeof(_data));
+    }
+
+    // 发布一份新数据（只能由同一个任务调用）
+    void publish(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&_data, &value, sizeof(T));
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief 读取最新数据
+     * @param version 输出：已发布的次数（0 表示尚未发布过），可用于判断是否有新数据
+     * @return false 重试次数用尽（写入一直在进行），out 内容无效，调用者沿用上一份
+     */
+    bool read(T& out, uint32_t* version = nullptr) const {
+        for (uint8_t retry = 0; retry < SEQLOCK_READ_RETRIES; retry++) {
+            uint32_t s1 = _seq.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            memcpy(&out, &_data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == s1) {
+                if (version) *version = s1 >> 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 已发布的次数（不读取数据）
+    uint32_t version() const {
+        return _seq.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<uint32_t> _seq;
+    T _data;
+};
+
+#endif // SEQLOCK_MAILBOX_H
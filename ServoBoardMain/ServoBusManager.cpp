@@ -1,26 +1,78 @@
 #include "ServoBusManager.h"
 
+/* ==================== 复位后保留的圈数 ==================== */
+
+// 放在 .noinit 段，软件复位/看门狗复位后不会被清零；上电后由魔数和校验判定无效。
+// 舵机本身未断电时，据此继续计圈，避免多圈绝对位置在复位后丢失。
+#define PERSISTED_TURNS_MAGIC  0x54524E53u   // "TRNS"
+
+struct PersistedTurns {
+    uint32_t magic;
+    uint8_t  count;
+    uint8_t  ids[MAX_SERVOS_PER_BUS];
+    int32_t  turns[MAX_SERVOS_PER_BUS];
+    int16_t  raw[MAX_SERVOS_PER_BUS];
+    uint32_t checksum;
+};
+
+static __NOINIT_ATTR PersistedTurns s_persistedTurns[NUM_BUSES];
+
+static uint32_t persistedTurnsChecksum(const PersistedTurns& p) {
+    // FNV-1a，覆盖 checksum 字段之前的全部内容
+    const uint8_t* data = (const uint8_t*)&p;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(PersistedTurns, checksum); i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
 /* ==================== 构造函数 ==================== */
 
 ServoBusManager::ServoBusManager() {
     _serial = nullptr;
+    _busIndex = 0;
     _writeCount = 0;
-
-    // 初始化反馈缓存
-    for (int i = 0; i <= MAX_SERVO_ID; i++) {
-        _feedback[i].online = false;
-        _feedback[i].rawPosition = 0;
-        _feedback[i].absolutePosition = 0;
-        _feedback[i].turnCount = 0;
-        _feedback[i].lastRawPosition = 0;
-        _feedback[i].initialized = false;
-        _feedback[i].lastUpdate = 0;
+    _count = 0;
+    _writeGroupCount = 0;
+    _readGroupCount = 0;
+    _baud = 1000000;
+    _cycleActive = false;
+    _cycleStartUs = 0;
+    _cycleTxBytes = 0;
+    _cycleTimeoutMs = 2;
+    memset(&_cycleStats, 0, sizeof(_cycleStats));
+    _stageSlot = SERVO_SLOT_NONE;
+    _stagedCount = 0;
+    _cyclePrepared = false;
+    _actuateBytes = 0;
+    _actuated = false;
+    _actuateUs = 0;
+
+    memset(_ids, 0, sizeof(_ids));
+    memset(_model, SERVO_MODEL_STS, sizeof(_model));
+    memset(_ctrlMode, SERVO_CTRL_POSITION, sizeof(_ctrlMode));
+    memset(_writePending, 0, sizeof(_writePending));
+    memset(_idToSlot, SERVO_SLOT_NONE, sizeof(_idToSlot));
+    memset(_limitCut, 0, sizeof(_limitCut));
+
+    // 初始化反馈缓存与力矩限制（上电时舵机的力矩限制来自 EPROM，未降额前不写）
+    for (uint8_t i = 0; i < MAX_SERVOS_PER_BUS; i++) {
+        _hot[i].absolutePosition = 0;
+        _hot[i].tracker.Reset();
+        _hot[i].load = 0;
+        _hot[i].online = 0;
+        _limit[i] = SERVO_TORQUE_LIMIT_MAX;
+        _limitReg[i] = SERVO_TORQUE_LIMIT_MAX;
     }
+    memset(_diag, 0, sizeof(_diag));
 }
 
 /* ==================== 初始化 ==================== */
 
-void ServoBusManager::begin(uint8_t busIndex, int rxPin, int txPin, uint32_t baud) {
+void ServoBusManager::begin(uint8_t busIndex, int rxPin, int txPin,
+                            const uint8_t* ids, uint8_t count, uint32_t baud,
+                            const uint8_t* models) {
     // ESP32-P4 串口映射
     HardwareSerial* s = nullptr;
     switch (busIndex) {
@@ -32,162 +84,582 @@ void ServoBusManager::begin(uint8_t busIndex, int rxPin, int txPin, uint32_t bau
     }
 
     _serial = s;
+    _busIndex = busIndex;
+    _baud = baud;
     s->begin(baud, SERIAL_8N1, rxPin, txPin);
     
     // 绑定串口到飞特库
     _sms.pSerial = s;
+    _sms.IOTimeOut = SERVO_TX_TIMEOUT_MS;
+
+    // 建立槽位表（重复或越界的 ID 被忽略）
+    _count = 0;
+    memset(_idToSlot, SERVO_SLOT_NONE, sizeof(_idToSlot));
+    for (uint8_t i = 0; i < count && _count < MAX_SERVOS_PER_BUS; i++) {
+        uint8_t id = ids[i];
+        if (id > MAX_SERVO_ID || _idToSlot[id] != SERVO_SLOT_NONE) continue;
+        _idToSlot[id] = _count;
+        _ids[_count] = id;
+        _model[_count] = (models && models[i] < SERVO_MODEL_COUNT) ? models[i] : SERVO_MODEL_STS;
+        _count++;
+    }
+
+    _buildGroups();
+    _restorePersistedTurns();
+    _regCache.Attach(&_sms, _ids, _count);
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        const ServoModelPolicy& policy = _policyAt(slot);
+        _regCache.SetLayout(_ids[slot], policy.refreshRanges, policy.refreshRangeCount, policy.lockAddr);
+    }
+
+    // 运行模式保存在 EPROM 中，上次运行留下的力矩模式要如实记录，由控制环决定是否切回
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        const ServoModelPolicy& policy = _policyAt(slot);
+        _ctrlMode[slot] = SERVO_CTRL_POSITION;
+        uint8_t mode = 0;
+        if (policy.torqueModeValue != 0 && _regCache.ReadByte(_ids[slot], policy.modeAddr, mode) &&
+            mode == policy.torqueModeValue) {
+            _ctrlMode[slot] = SERVO_CTRL_TORQUE;
+        }
+    }
+
+    // 流水线周期的接收超时：模型时间的两倍，至少 1ms（millis 粒度再加 1ms）
+    _cycleTimeoutMs = cycleModelUs() * 2 / 1000 + 2;
 }
 
-/* ==================== 同步写入 ==================== */
+void ServoBusManager::_buildGroups() {
+    _writeGroupCount = 0;
+    _readGroupCount = 0;
+
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        const ServoModelPolicy& policy = _policyAt(slot);
+
+        // 写入：同型号一组
+        uint8_t g = 0;
+        while (g < _writeGroupCount && _writeGroups[g].model != _model[slot]) g++;
+        if (g == _writeGroupCount) {
+            _writeGroups[g].model = _model[slot];
+            _writeGroups[g].count = 0;
+            _writeGroupCount++;
+        }
+        _writeGroups[g].slots[_writeGroups[g].count++] = slot;
+
+        // 读取：反馈地址/长度相同即可共用一帧
+        g = 0;
+        while (g < _readGroupCount &&
+               (_readGroups[g].addr != policy.feedbackAddr || _readGroups[g].len != policy.feedbackLen)) g++;
+        if (g == _readGroupCount) {
+            _readGroups[g].addr = policy.feedbackAddr;
+            _readGroups[g].len = policy.feedbackLen;
+            _readGroups[g].count = 0;
+            _readGroupCount++;
+        }
+        ReadGroup& rg = _readGroups[g];
+        rg.slots[rg.count] = slot;
+        rg.ids[rg.count] = _ids[slot];
+        rg.count++;
+    }
+}
 
-void ServoBusManager::setTarget(uint8_t id, int16_t position, uint16_t speed, uint8_t acc) {
-    if (_writeCount >= MAX_SERVOS_PER_BUS) return;
+/* ==================== 同步写入 ==================== */
 
-    // 限制目标位置范围 (-30719 到 30719)
-    if (position < -30719) position = -30719;
-    if (position > 30719) position = 30719;
+void ServoBusManager::setTarget(uint8_t id, int16_t position, uint16_t speed, uint8_t acc, int16_t torque) {
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return;
+    setTargetAt(slot, position, speed, acc, torque);
+}
 
-    _writeIDs[_writeCount] = id;
-    _writePos[_writeCount] = position;
-    _writeSpd[_writeCount] = speed;
-    _writeAcc[_writeCount] = acc;
-    _writeCount++;
+void ServoBusManager::setTargetAt(uint8_t slot, int16_t position, uint16_t speed, uint8_t acc, int16_t torque) {
+    if (slot >= _count) return;
+
+    // 按型号限制目标位置范围（STS/HLS 为 -30719 到 30719）
+    const ServoModelPolicy& policy = _policyAt(slot);
+    if (position < policy.minPosition) position = policy.minPosition;
+    if (position > policy.maxPosition) position = policy.maxPosition;
+
+    _writePos[slot] = position;
+    _writeSpd[slot] = speed;
+    _writeAcc[slot] = acc;
+    _writeTorque[slot] = (torque == SERVO_TORQUE_POSITION_DEFAULT) ? policy.positionTorque : torque;
+    if (!_writePending[slot]) {
+        _writePending[slot] = 1;
+        _writeCount++;
+    }
 }
 
 void ServoBusManager::syncWriteAll() {
     if (_writeCount == 0 || !_serial) return;
 
-    // 调用飞特库的同步写函数
-    _sms.SyncWritePosEx(_writeIDs, _writeCount, _writePos, _writeSpd, _writeAcc);
-    
+    // 每个型号组一帧：按该型号的写入块打包
+    uint8_t ids[MAX_SERVOS_PER_BUS];
+    uint8_t data[MAX_SERVOS_PER_BUS * 8];
+    for (uint8_t g = 0; g < _writeGroupCount; g++) {
+        const ModelGroup& group = _writeGroups[g];
+        const ServoModelPolicy& policy = servoModelPolicy(group.model);
+        uint8_t n = 0;
+        for (uint8_t k = 0; k < group.count; k++) {
+            uint8_t slot = group.slots[k];
+            if (!_writePending[slot]) continue;
+            ids[n] = _ids[slot];
+            policy.packTarget(data + n * policy.writeLen,
+                              _writePos[slot], _writeSpd[slot], _writeAcc[slot], _writeTorque[slot]);
+            _writePending[slot] = 0;
+            n++;
+        }
+        if (n > 0) {
+            _sms.syncWrite(ids, n, policy.writeAddr, data, policy.writeLen);
+        }
+    }
+
     // 清空缓存
     _writeCount = 0;
 }
 
-/* ==================== 同步读取（带跨圈检测） ==================== */
+/* ==================== 快速停机 ==================== */
+
+void ServoBusManager::_syncWriteTorque(uint8_t enable) {
+    if (!_serial || _count == 0) return;
 
-int ServoBusManager::syncReadPositions(const uint8_t* ids, uint8_t count) {
-    if (!_serial || count == 0) return 0;
+    uint8_t data[MAX_SERVOS_PER_BUS];
+    memset(data, enable, _count);
 
-    // 飞特舵机内存表地址
-    const uint8_t ADDR_PRESENT_POSITION = 56;  // 位置地址
-    const uint8_t LEN_POSITION = 2;            // 位置长度（2 字节）
+    // 各型号扭矩开关地址相同时只发一帧
+    uint8_t ids[MAX_SERVOS_PER_BUS];
+    uint8_t sent[SERVO_MODEL_COUNT];
+    uint8_t sentCount = 0;
+    for (uint8_t g = 0; g < _writeGroupCount; g++) {
+        uint8_t addr = servoModelPolicy(_writeGroups[g].model).torqueEnableAddr;
+        bool done = false;
+        for (uint8_t k = 0; k < sentCount; k++) done |= (sent[k] == addr);
+        if (done) continue;
+
+        uint8_t n = 0;
+        for (uint8_t slot = 0; slot < _count; slot++) {
+            if (_policyAt(slot).torqueEnableAddr == addr) ids[n++] = _ids[slot];
+        }
+        _sms.syncWrite(ids, n, addr, data, 1);
+        sent[sentCount++] = addr;
+    }
+}
+
+void ServoBusManager::fastStop() {
+    _writeCount = 0;
+    _stagedCount = 0;
+    memset(_writePending, 0, sizeof(_writePending));
+    _syncWriteTorque(0);
+}
+
+void ServoBusManager::enableTorqueAll() {
+    _syncWriteTorque(1);
+    // 保护关闭的舵机也被打开了：由本周期的 prepareCycle() 重新关闭
+    memset(_limitCut, 0, sizeof(_limitCut));
+}
+
+int ServoBusManager::verifyTorqueOff() {
+    if (!_serial || _count == 0) return 0;
+
+    // 目前各型号扭矩开关地址相同（40），按 0 号槽位的地址一次读全部舵机
+    int confirmed = 0;
+    _sms.syncReadBegin(_count, 1, 5);  // 5ms 超时，停机路径不能长时间阻塞
+    _sms.syncReadPacketTx(_ids, _count, _policyAt(0).torqueEnableAddr, 1);
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        uint8_t torque = 1;
+        if (_sms.syncReadPacketRx(_ids[slot], &torque) == 1 && torque == 0) {
+            confirmed++;
+        }
+    }
+    _sms.syncReadEnd();
+    return confirmed;
+}
+
+/* ==================== 单舵机事务 ==================== */
+
+bool ServoBusManager::writeRegister(uint8_t id, uint8_t addr, uint8_t value) {
+    if (!_serial || slotOf(id) == SERVO_SLOT_NONE) return false;
+    if (_sms.writeByte(id, addr, value) != 1) return false;
+    _regCache.AssumeByte(id, addr, value);
+    return true;
+}
+
+bool ServoBusManager::writeEprom(uint8_t id, uint8_t addr, uint8_t value) {
+    uint8_t slot = slotOf(id);
+    if (!_serial || slot == SERVO_SLOT_NONE) return false;
+    uint8_t lockAddr = _policyAt(slot).lockAddr;
+    if (_sms.writeByte(id, lockAddr, 0) != 1) return false;
+    bool ok = (_sms.writeByte(id, addr, value) == 1);
+    if (ok) _regCache.AssumeByte(id, addr, value);
+    // 无论写入是否成功都要重新加锁
+    ok &= (_sms.writeByte(id, lockAddr, 1) == 1);
+    return ok;
+}
+
+bool ServoBusManager::setTorque(uint8_t id, bool enable) {
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return false;
+    return writeRegister(id, _policyAt(slot).torqueEnableAddr, enable ? 1 : 0);
+}
+
+bool ServoBusManager::moveTo(uint8_t id, int16_t position, uint16_t speed, uint8_t acc) {
+    uint8_t slot = slotOf(id);
+    if (!_serial || slot == SERVO_SLOT_NONE) return false;
+    const ServoModelPolicy& policy = _policyAt(slot);
+    if (position < policy.minPosition) position = policy.minPosition;
+    if (position > policy.maxPosition) position = policy.maxPosition;
+
+    uint8_t buf[8];
+    policy.packTarget(buf, position, speed, acc, policy.positionTorque);
+    return _sms.genWrite(id, policy.writeAddr, buf, policy.writeLen) == 1;
+}
+
+bool ServoBusManager::readDiagnostics(uint8_t id) {
+    uint8_t slot = slotOf(id);
+    if (!_serial || slot == SERVO_SLOT_NONE) return false;
+
+    // 负载(60-61) + 电压(62) + 温度(63) 连续读取
+    const ServoModelPolicy& policy = _policyAt(slot);
+    uint8_t rxBuf[4];
+    if (_sms.Read(id, policy.diagAddr, rxBuf, sizeof(rxBuf)) != sizeof(rxBuf)) {
+        return false;
+    }
+    ServoDiagnostics& diag = _diag[slot];
+    diag.load = policy.decodeLoad(rxBuf);
+    diag.voltage = rxBuf[2];
+    diag.temperature = rxBuf[3];
+    diag.lastUpdate = millis();
+    return true;
+}
+
+bool ServoBusManager::setControlMode(uint8_t id, uint8_t mode) {
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return false;
+    const ServoModelPolicy& policy = _policyAt(slot);
+    if (policy.torqueModeValue == 0) return mode == SERVO_CTRL_POSITION;
+
+    uint8_t value = (mode == SERVO_CTRL_TORQUE) ? policy.torqueModeValue : 0;
+    if (!writeEprom(id, policy.modeAddr, value)) return false;
+    _ctrlMode[slot] = (mode == SERVO_CTRL_TORQUE) ? SERVO_CTRL_TORQUE : SERVO_CTRL_POSITION;
+    return true;
+}
+
+/* ==================== 过载保护（力矩限制） ==================== */
+
+void ServoBusManager::setTorqueLimitAt(uint8_t slot, uint16_t limit) {
+    if (slot >= _count) return;
+    _limit[slot] = (limit > SERVO_TORQUE_LIMIT_MAX) ? SERVO_TORQUE_LIMIT_MAX : limit;
+}
+
+void ServoBusManager::_syncWriteLimits() {
+    // 每个型号组最多两帧：先写力矩限制（恢复扭矩时已是降额后的值），再写扭矩开关
+    uint8_t ids[MAX_SERVOS_PER_BUS];
+    uint8_t data[MAX_SERVOS_PER_BUS * 2];
+    for (uint8_t g = 0; g < _writeGroupCount; g++) {
+        const ModelGroup& group = _writeGroups[g];
+        const ServoModelPolicy& policy = servoModelPolicy(group.model);
+
+        uint8_t n = 0;
+        for (uint8_t k = 0; policy.packTorqueLimit && k < group.count; k++) {
+            uint8_t slot = group.slots[k];
+            uint16_t limit = _limit[slot];
+            if (limit == 0 || limit == _limitReg[slot]) continue;
+            ids[n] = _ids[slot];
+            policy.packTorqueLimit(data + n * policy.torqueLimitLen, limit);
+            _limitReg[slot] = limit;
+            n++;
+        }
+        if (n > 0) {
+            _sms.syncWrite(ids, n, policy.torqueLimitAddr, data, policy.torqueLimitLen);
+        }
+
+        // 关扭矩的槽位每周期都写；恢复的槽位只写一次
+        n = 0;
+        for (uint8_t k = 0; k < group.count; k++) {
+            uint8_t slot = group.slots[k];
+            bool cut = (_limit[slot] == 0);
+            if (!cut && !_limitCut[slot]) continue;
+            ids[n] = _ids[slot];
+            data[n] = cut ? 0 : 1;
+            _limitCut[slot] = cut;
+            n++;
+        }
+        if (n > 0) {
+            _sms.syncWrite(ids, n, policy.torqueEnableAddr, data, 1);
+        }
+    }
+}
+
+/* ==================== 同步读取（带跨圈检测） ==================== */
+
+int ServoBusManager::syncReadPositions() {
+    if (!_serial || _count == 0) return 0;
 
     int successCount = 0;
 
-    // 使用飞特库的同步读功能
+    // 每个反馈布局一帧 SYNC_READ（全部为同一布局时与单型号总线相同，只有一帧）
+    for (uint8_t g = 0; g < _readGroupCount; g++) {
+        successCount += _readGroup(_readGroups[g], 100);  // 100ms 超时
+    }
+
+    _savePersistedTurns();
+
+    return successCount;
+}
+
+int ServoBusManager::_readGroup(const ReadGroup& group, uint32_t timeoutMs) {
     // 1. 初始化同步读
-    _sms.syncReadBegin(count, LEN_POSITION, 100);  // 100ms 超时
+    _sms.syncReadBegin(group.count, group.len, timeoutMs);
 
-    // 2. 发送同步读请求
-    int ret = _sms.syncReadPacketTx((uint8_t*)ids, count, ADDR_PRESENT_POSITION, LEN_POSITION);
-    if (ret != count) {
-        _sms.syncReadEnd();
-        return 0;
-    }
+    // 2. 发送同步读请求并接收应答
+    uint32_t sampleUs = micros();
+    _sms.syncReadPacketTx((uint8_t*)group.ids, group.count, group.addr, group.len);
+
+    // 3. 解析
+    int successCount = _parseReadGroup(group, sampleUs);
+
+    // 4. 结束同步读
+    _sms.syncReadEnd();
+    return successCount;
+}
+
+int ServoBusManager::_parseReadGroup(const ReadGroup& group, uint32_t sampleUs) {
+    int successCount = 0;
+    uint32_t now = millis();
+
+    // 按各槽位的型号解析返回包（缺失/校验失败的舵机标记为离线）
+    for (uint8_t k = 0; k < group.count; k++) {
+        uint8_t slot = group.slots[k];
+        uint8_t rxBuf[8];
+
+        int rxLen = _sms.syncReadPacketRx(group.ids[k], rxBuf);
+
+        if (rxLen == group.len) {
+            const ServoModelPolicy& policy = _policyAt(slot);
+            int16_t rawPos, speed, load;
+            policy.decodeFeedback(rxBuf, rawPos, speed, load);
+
+            // 更新多圈位置（基于速度和采样间隔的跨圈检测；单圈型号不使用速度预测）
+            _updateMultiTurnPosition(slot, rawPos, speed, sampleUs, policy.multiTurn);
 
-    // 3. 接收并解析每个舵机的返回包
-    for (uint8_t i = 0; i < count; i++) {
-        uint8_t id = ids[i];
-        uint8_t rxBuf[LEN_POSITION];
-        
-        int rxLen = _sms.syncReadPacketRx(id, rxBuf);
-        
-        if (rxLen == LEN_POSITION) {
-            // 解析位置数据（小端序）
-            int16_t rawPos = (rxBuf[1] << 8) | rxBuf[0];
-            
-            // 更新多圈位置（自动跨圈检测）
-            _updateMultiTurnPosition(id, rawPos);
-            
             // 更新状态
-            _feedback[id].online = true;
-            _feedback[id].lastUpdate = millis();
+            _hot[slot].online = 1;
+            _hot[slot].load = load;
+            _diag[slot].speed = speed;
+            _diag[slot].load = load;
+            _diag[slot].lastUpdate = now;
             successCount++;
         } else {
-            _feedback[id].online = false;
+            _hot[slot].online = 0;
         }
     }
+    return successCount;
+}
 
-    // 4. 结束同步读
-    _sms.syncReadEnd();
+/* ==================== 流水线总线周期 ==================== */
 
-    return successCount;
+void ServoBusManager::startCycle(bool stopped) {
+    prepareCycle(stopped);
+    sendCycle();
+}
+
+void ServoBusManager::prepareCycle(bool stopped) {
+    _cycleActive = false;
+    _cyclePrepared = false;
+    if (!_serial || _count == 0) return;
+
+    // 1. 本周期的写入帧与下一周期的同步读请求拼接，一次写出（只清空一次接收缓冲）
+    const ReadGroup& group = _readGroups[0];
+    _sms.syncReadBegin(group.count, group.len, _cycleTimeoutMs);
+
+    _cycleStartUs = micros();
+    _sms.txBurstBegin(_burstBuf, sizeof(_burstBuf));
+    if (stopped) {
+        fastStop();          // 停机期间丢弃目标，并重复下发关扭矩
+    } else {
+        // 已暂存的目标由 ACTION 广播统一生效（放在最前，6 字节，各总线相同），
+        // 未暂存的（离线/未确认）随后用 SYNC_WRITE 补发
+        if (_stagedCount > 0) {
+            _sms.RegWriteAction();
+        }
+        syncWriteAll();
+    }
+    _actuateBytes = stopped ? 0 : _sms.txBurstSent + _sms.txBurstLen;
+    if (!stopped) {
+        _syncWriteLimits();  // 生效帧之后：不影响生效时刻，同一周期起作用
+    }
+    _sms.syncReadPacketSend((uint8_t*)group.ids, group.count, group.addr, group.len);
+    _stagedCount = 0;
+    _cyclePrepared = true;
+}
+
+void ServoBusManager::sendCycle() {
+    _actuated = false;
+    if (!_cyclePrepared) return;
+    _cyclePrepared = false;
+
+    // 发送缓冲原本为空，帧随写出立即上线；生效时刻为生效帧最后一个字节离开线路
+    uint32_t writeUs = micros();
+    _cycleTxBytes = _sms.txBurstEnd();
+    _actuated = _actuateBytes > 0;
+    _actuateUs = writeUs + _wireUs(_actuateBytes);
+    _cycleActive = true;
 }
 
-/* ==================== 跨圈检测核心算法 ==================== */
+bool ServoBusManager::stageTarget(uint8_t slot) {
+    _stageSlot = SERVO_SLOT_NONE;
+    if (!_serial || slot >= _count || !_writePending[slot] || !_hot[slot].online) return false;
+
+    const ServoModelPolicy& policy = _policyAt(slot);
+    uint8_t data[8];
+    policy.packTarget(data, _writePos[slot], _writeSpd[slot], _writeAcc[slot], _writeTorque[slot]);
+    _sms.regWriteSend(_ids[slot], policy.writeAddr, data, policy.writeLen);
+    _writePending[slot] = 0;
+    _stageSlot = slot;
+    return true;
+}
 
-void ServoBusManager::_updateMultiTurnPosition(uint8_t id, int16_t newRawPos) {
-    if (id > MAX_SERVO_ID) return;
+bool ServoBusManager::collectStaged() {
+    if (_stageSlot == SERVO_SLOT_NONE) return false;
+    uint8_t slot = _stageSlot;
+    _stageSlot = SERVO_SLOT_NONE;
 
-    ServoFeedback& fb = _feedback[id];
-    
-    // 首次初始化
-    if (!fb.initialized) {
-        fb.rawPosition = newRawPos;
-        fb.lastRawPosition = newRawPos;
-        fb.absolutePosition = newRawPos;
-        fb.turnCount = 0;
-        fb.initialized = true;
-        return;
+    if (_sms.regWriteAck(_ids[slot])) {
+        _stagedCount++;
+        _cycleStats.staged++;
+        return true;
     }
+    // 舵机可能没有收到：本周期改用 SYNC_WRITE 补发（即使已暂存，ACTION 生效的也是同一目标）
+    _writePending[slot] = 1;
+    _cycleStats.stageFailures++;
+    return false;
+}
 
-    // 计算位置变化量
-    int16_t delta = newRawPos - fb.lastRawPosition;
+int ServoBusManager::finishCycle() {
+    if (!_cycleActive) return 0;
+    _cycleActive = false;
 
-    // 跨圈检测阈值（当变化量超过半圈时认为发生了跨圈）
-    const int16_t HALF_TURN = 2048;  // 4096 / 2
+    // 2. 收取第一组应答；其余反馈布局（混用型号时）逐组补读
+    const ReadGroup& group = _readGroups[0];
+    int rxBytes = _sms.syncReadPacketCollect();
+    int successCount = _parseReadGroup(group, _cycleStartUs);
+    _sms.syncReadEnd();
+    for (uint8_t g = 1; g < _readGroupCount; g++) {
+        successCount += _readGroup(_readGroups[g], _cycleTimeoutMs);
+    }
+    uint32_t elapsed = micros() - _cycleStartUs;
+
+    _savePersistedTurns();
+
+    // 3. 统计：线路时间按实际收发字节计算（每字节 10 bit）
+    _cycleStats.cycles++;
+    _cycleStats.txBytes += _cycleTxBytes;
+    _cycleStats.rxBytes += rxBytes;
+    _cycleStats.wireUs  += _wireUs(_cycleTxBytes + rxBytes);
+    _cycleStats.busyUs  += elapsed;
+    _cycleStats.lastUs   = elapsed;
+    if (elapsed > _cycleStats.maxUs) _cycleStats.maxUs = elapsed;
+    _cycleStats.modelUs  = cycleModelUs();
+    return successCount;
+}
 
-    if (delta > HALF_TURN) {
-        // 反向跨圈（从 4095 -> 0）
-        fb.turnCount--;
-    } else if (delta < -HALF_TURN) {
-        // 正向跨圈（从 0 -> 4095）
-        fb.turnCount++;
+uint32_t ServoBusManager::cycleModelUs() const {
+    // 写入帧 + 同步读请求 + 全部应答的线路时间，加上每个应答的处理间隔
+    uint32_t txBytes = 0;
+    for (uint8_t g = 0; g < _writeGroupCount; g++) {
+        const ServoModelPolicy& policy = servoModelPolicy(_writeGroups[g].model);
+        txBytes += 8 + _writeGroups[g].count * (policy.writeLen + 1);
     }
+    uint32_t rxBytes = 0;
+    for (uint8_t g = 0; g < _readGroupCount; g++) {
+        txBytes += 8 + _readGroups[g].count;
+        rxBytes += _readGroups[g].count * (_readGroups[g].len + 6);
+    }
+    return _wireUs(txBytes + rxBytes) + _count * SERVO_REPLY_GAP_US;
+}
 
-    // 更新数据
-    fb.rawPosition = newRawPos;
-    fb.lastRawPosition = newRawPos;
-    
-    // 计算绝对位置 = 圈数 * 4096 + 当前位置
-    fb.absolutePosition = (int32_t)fb.turnCount * 4096 + newRawPos;
+/* ==================== 跨圈检测 ==================== */
+
+void ServoBusManager::_updateMultiTurnPosition(uint8_t slot, int16_t newRawPos, int16_t speed, uint32_t sampleUs, bool speedValid) {
+    ServoHotState& fb = _hot[slot];
+
+    // 跨圈判断由 MultiTurnTracker 完成；超出 ±30719 时只置饱和标志，不再截断
+    fb.tracker.Update(newRawPos, speed, sampleUs, speedValid);
+    fb.absolutePosition = fb.tracker.Absolute();
+}
+
+void ServoBusManager::_restorePersistedTurns() {
+    const PersistedTurns& p = s_persistedTurns[_busIndex];
+    if (p.magic != PERSISTED_TURNS_MAGIC || p.checksum != persistedTurnsChecksum(p)) return;
+
+    // 拓扑不一致时丢弃（ID 列表必须完全相同）
+    if (p.count != _count || memcmp(p.ids, _ids, _count) != 0) return;
+
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        _hot[slot].tracker.Restore(p.turns[slot], p.raw[slot]);
+        _hot[slot].absolutePosition = _hot[slot].tracker.Absolute();
+    }
+}
 
-    // 限制在有效范围内 (-30719 到 30719)
-    if (fb.absolutePosition > 30719) {
-        fb.absolutePosition = 30719;
-    } else if (fb.absolutePosition < -30719) {
-        fb.absolutePosition = -30719;
+void ServoBusManager::_savePersistedTurns() const {
+    PersistedTurns& p = s_persistedTurns[_busIndex];
+    memset(&p, 0, sizeof(p));
+    p.magic = PERSISTED_TURNS_MAGIC;
+    p.count = _count;
+    memcpy(p.ids, _ids, _count);
+    for (uint8_t slot = 0; slot < _count; slot++) {
+        p.turns[slot] = _hot[slot].tracker.TurnCount();
+        p.raw[slot]   = _hot[slot].tracker.Raw();
     }
+    p.checksum = persistedTurnsChecksum(p);
 }
 
 /* ==================== 数据访问 ==================== */
 
 int16_t ServoBusManager::getRawPosition(uint8_t id) const {
-    if (id > MAX_SERVO_ID) return -1;
-    return _feedback[id].rawPosition;
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return -1;
+    return _hot[slot].tracker.Raw();
 }
 
 int32_t ServoBusManager::getAbsolutePosition(uint8_t id) const {
-    if (id > MAX_SERVO_ID) return 0;
-    return _feedback[id].absolutePosition;
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return 0;
+    return _hot[slot].absolutePosition;
 }
 
 void ServoBusManager::resetTurnCounter(uint8_t id) {
-    if (id > MAX_SERVO_ID) return;
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return;
     
-    ServoFeedback& fb = _feedback[id];
-    fb.turnCount = 0;
-    fb.absolutePosition = fb.rawPosition;
+    ServoHotState& fb = _hot[slot];
+    fb.tracker.ResetTurns();
+    fb.absolutePosition = fb.tracker.Absolute();
+    _savePersistedTurns();
 }
 
-const ServoFeedback& ServoBusManager::getFeedback(uint8_t id) const {
-    static ServoFeedback dummy;
-    if (id > MAX_SERVO_ID) return dummy;
-    return _feedback[id];
+ServoFeedback ServoBusManager::getFeedback(uint8_t id) const {
+    ServoFeedback fb;
+    memset(&fb, 0, sizeof(fb));
+
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return fb;
+
+    const ServoHotState&    hot  = _hot[slot];
+    const ServoDiagnostics& diag = _diag[slot];
+    fb.rawPosition      = hot.tracker.Raw();
+    fb.absolutePosition = hot.absolutePosition;
+    fb.turnCount        = hot.tracker.TurnCount();
+    fb.initialized      = hot.tracker.Initialized();
+    fb.saturated        = hot.tracker.Saturated();
+    fb.online           = hot.online;
+    fb.speed            = diag.speed;
+    fb.load             = diag.load;
+    fb.voltage          = diag.voltage;
+    fb.temperature      = diag.temperature;
+    fb.lastUpdate       = diag.lastUpdate;
+    return fb;
 }
 
 bool ServoBusManager::isOnline(uint8_t id) const {
-    if (id > MAX_SERVO_ID) return false;
-    return _feedback[id].online;
+    uint8_t slot = slotOf(id);
+    if (slot == SERVO_SLOT_NONE) return false;
+    return _hot[slot].online;
 }
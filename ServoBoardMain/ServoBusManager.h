@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 #include "SMS_STS.h"
+#include "MultiTurnTracker.h"
+#include "ServoRegisterCache.h"
+#include "ServoModel.h"
 
 /* ==================== 配置参数 ==================== */
 
@@ -10,35 +13,82 @@
 #define MAX_SERVOS_PER_BUS     8      // 单总线最大舵机数
 #define MAX_SERVO_ID           32     // 支持的最大舵机 ID
 
-/* ==================== 舵机反馈数据（支持多圈） ==================== */
+#define SERVO_SLOT_NONE        0xFF   // ID -> 槽位映射中的“未分配”标记
+#define SERVO_TX_TIMEOUT_MS    2      // 单舵机事务的应答超时（限制离线舵机占用总线的时间）
+#define SERVO_REPLY_GAP_US     30     // 同步读中每个应答的处理间隔（时序模型估计值，可按实测修正）
+#define SERVO_BURST_BUF_LEN    208    // 流水线周期拼接发送缓冲（写入帧 + 力矩限制帧 + 同步读请求）
 
-struct ServoFeedback {
-    // 原始反馈数据（0-4096）
-    int16_t rawPosition;       // 单圈位置 (0-4096)
-    int16_t speed;             // 速度（带符号）
-    int16_t load;              // 负载（带符号）
-    uint8_t voltage;           // 电压 (0.1V)
-    uint8_t temperature;       // 温度 (℃)
-    
-    // 多圈跟踪数据
-    int32_t absolutePosition;  // 绝对位置（多圈累计，范围 -30719 到 30719）
-    int16_t turnCount;         // 圈数计数器
-    int16_t lastRawPosition;   // 上一次的原始位置（用于跨圈检测）
-    bool    initialized;       // 是否已初始化
-    
-    // 状态标志
-    bool    online;            // 是否在线
+// 拼接缓冲按最坏情况给足，否则中途提前写出会打断背靠背发送：ACTION 广播 6 字节；
+// 每个型号组一帧目标（8 + n*(7+1)）、一帧力矩限制（8 + n*3）、一帧扭矩开关（8 + n*2）；同步读请求 8 + n
+static_assert(SERVO_BURST_BUF_LEN >= 6 + SERVO_MODEL_COUNT * 24 + MAX_SERVOS_PER_BUS * (8 + 3 + 2) + 8 + MAX_SERVOS_PER_BUS,
+              "SERVO_BURST_BUF_LEN 放不下一个周期的全部帧");
+static_assert((7 + 1) * MAX_SERVOS_PER_BUS + 4 <= 255, "单总线舵机数超出一帧 SYNC_WRITE 的上限");
+static_assert(MAX_SERVOS_PER_BUS <= SERVO_REG_MAX_SERVOS, "寄存器缓存放不下一条总线的全部舵机");
+static_assert(MAX_SERVOS_PER_BUS <= SCS_SYNC_READ_MAX_IDN, "同步读接收缓冲放不下一条总线的全部应答");
+
+/* ==================== 舵机反馈数据（槽位存储） ==================== */
+
+// 热数据：每个控制周期都会读写，紧凑排列
+struct ServoHotState {
+    int32_t          absolutePosition;  // 绝对位置（多圈累计，不截断；超出 ±30719 时 tracker 置饱和标志）
+    MultiTurnTracker tracker;           // 多圈估计器（单圈位置/圈数/速度/标志）
+    int16_t          load;              // 负载（带符号，0.1%，随位置一起同步读回）
+    uint8_t          online;            // 是否在线
+};
+
+// 冷数据：仅诊断/上报使用，与热数据分开存放
+struct ServoDiagnostics {
+    int16_t  speed;            // 速度（带符号）
+    int16_t  load;             // 负载（带符号）
+    uint8_t  voltage;          // 电压 (0.1V)
+    uint8_t  temperature;      // 温度 (℃)
     uint32_t lastUpdate;       // 最后更新时间戳
 };
 
+// 对外的完整反馈视图（由热/冷数据拼装）
+struct ServoFeedback {
+    int16_t  rawPosition;
+    int16_t  speed;
+    int16_t  load;
+    uint8_t  voltage;
+    uint8_t  temperature;
+    int32_t  absolutePosition;
+    int32_t  turnCount;
+    bool     initialized;
+    bool     saturated;         // 绝对位置超出舵机多圈范围
+    bool     online;
+    uint32_t lastUpdate;
+};
+
+// 流水线总线周期统计（累计值，线路时间按每字节 10 bit 计算）
+struct BusCycleStats {
+    uint32_t cycles;      // 完成的周期数
+    uint32_t txBytes;     // 发送字节
+    uint32_t rxBytes;     // 接收字节
+    uint32_t wireUs;      // 线路实际占用时间（收发字节折算）
+    uint32_t busyUs;      // 从发出到收齐应答的实测时间
+    uint32_t lastUs;      // 最近一个周期的实测时间
+    uint32_t maxUs;       // 单周期最长实测时间
+    uint32_t modelUs;     // 时序模型给出的单周期时间
+    uint32_t staged;      // REG_WRITE 暂存并确认的目标数
+    uint32_t stageFailures; // REG_WRITE 未确认（改用本周期 SYNC_WRITE 补发）
+};
+
 /* ==================== 舵机总线管理器 ==================== */
 
 class ServoBusManager {
 public:
     ServoBusManager();
 
-    /* 初始化串口总线 */
-    void begin(uint8_t busIndex, int rxPin, int txPin, uint32_t baud = 1000000);
+    /**
+     * @brief 初始化串口总线，并按给定顺序建立 ID -> 槽位映射
+     * @param ids 本总线上的舵机 ID 列表（槽位 k 对应 ids[k]）
+     * @param count 舵机数量（不超过 MAX_SERVOS_PER_BUS）
+     * @param models 各槽位的舵机型号 SERVO_MODEL_*（NULL 表示全部为 STS）
+     */
+    void begin(uint8_t busIndex, int rxPin, int txPin,
+               const uint8_t* ids, uint8_t count, uint32_t baud = 1000000,
+               const uint8_t* models = nullptr);
 
     /* ========== 同步写入（控制） ========== */
     
@@ -48,11 +98,20 @@ public:
      * @param position 目标位置 (-30719 到 30719，支持多圈)
      * @param speed 速度
      * @param acc 加速度
+     * @param torque 目标力矩（仅 HLS 型号有效，其他型号忽略）；默认使用型号的位置模式力矩上限
+     */
+    void setTarget(uint8_t id, int16_t position, uint16_t speed = 1000, uint8_t acc = 50,
+                   int16_t torque = SERVO_TORQUE_POSITION_DEFAULT);
+
+    /**
+     * @brief 按槽位设置目标位置（热循环使用，免去 ID 查找）
+     * 同一周期内重复设置同一槽位时以最后一次为准
      */
-    void setTarget(uint8_t id, int16_t position, uint16_t speed = 1000, uint8_t acc = 50);
+    void setTargetAt(uint8_t slot, int16_t position, uint16_t speed = 1000, uint8_t acc = 50,
+                     int16_t torque = SERVO_TORQUE_POSITION_DEFAULT);
 
     /**
-     * @brief 同步写入所有缓存的目标位置
+     * @brief 同步写入所有缓存的目标位置（每个型号组一帧 SYNC_WRITE）
      * 调用后会清空缓存
      */
     void syncWriteAll();
@@ -60,12 +119,153 @@ public:
     /* ========== 同步读取（反馈） ========== */
     
     /**
-     * @brief 同步读取指定舵机列表的位置（自动进行跨圈检测）
-     * @param ids 舵机 ID 数组
-     * @param count 舵机数量
+     * @brief 同步读取本总线全部舵机的位置与速度（基于速度的跨圈检测）
+     * 反馈布局相同的型号共用一帧 SYNC_READ
      * @return 成功读取的舵机数量
      */
-    int syncReadPositions(const uint8_t* ids, uint8_t count);
+    int syncReadPositions();
+
+    /* ========== 流水线总线周期 ========== */
+
+    /**
+     * @brief 周期后半段：把本周期的 SYNC_WRITE（停机时为关扭矩帧）与下一周期的 SYNC_READ
+     *        拼接后一次写出，不等待应答
+     * 多条总线先依次调用 startCycle()，再依次调用 finishCycle()，各总线的收发时间相互重叠
+     */
+    void startCycle(bool stopped);
+
+    /**
+     * @brief startCycle() 的两步：prepareCycle() 只拼接帧，sendCycle() 一次写出
+     * 各总线先全部 prepareCycle() 再依次 sendCycle()，写出之间只隔一次串口写调用，
+     * 使各总线的生效帧背靠背发出
+     */
+    void prepareCycle(bool stopped);
+    void sendCycle();
+
+    /**
+     * @brief 收取 startCycle() 发出的同步读应答并更新反馈
+     * @return 成功读取的舵机数量
+     */
+    int finishCycle();
+
+    /**
+     * @brief 用 REG_WRITE 暂存某槽位的待写入目标（只发送，不等待应答；离线舵机跳过）
+     * 多条总线先依次 stageTarget()，再依次 collectStaged()，各总线的往返时间相互重叠；
+     * 暂存过目标的总线在 startCycle() 中以 ACTION 广播代替 SYNC_WRITE，目标同时生效
+     * @return true 已发送，需要随后调用 collectStaged()
+     */
+    bool stageTarget(uint8_t slot);
+
+    /**
+     * @brief 收取 stageTarget() 的应答；未确认的目标留待 startCycle() 用 SYNC_WRITE 补发
+     * @return true 舵机已确认暂存
+     */
+    bool collectStaged();
+
+    /**
+     * @brief 最近一次 startCycle() 中目标生效的时刻（生效帧最后一个字节离开线路的估计时间）
+     * @return false 本周期没有下发目标（停机或无待写入目标）
+     */
+    bool actuationTime(uint32_t& us) const { us = _actuateUs; return _actuated; }
+
+    /**
+     * @brief 时序模型：一个流水线周期的预计总线时间（us）
+     */
+    uint32_t cycleModelUs() const;
+
+    const BusCycleStats& cycleStats() const { return _cycleStats; }
+
+    /* ========== 过载保护（力矩限制） ========== */
+
+    /**
+     * @brief 设置槽位的力矩限制，只在变化时随下一次 prepareCycle() 写出（在生效帧之后，
+     *        与目标同一周期生效）；停机期间保留，恢复后重新下发
+     * @param limit 0 关闭扭矩（每周期重复下发，防止漏收；该槽位不应再设置目标）；
+     *              SERVO_TORQUE_LIMIT_MAX 不限制；其间为 RAM 区力矩限制
+     *              （没有力矩限制寄存器的型号只区分开/关）
+     */
+    void setTorqueLimitAt(uint8_t slot, uint16_t limit);
+    uint16_t torqueLimitAt(uint8_t slot) const { return _limit[slot]; }
+
+    /* ========== 快速停机 ========== */
+
+    /**
+     * @brief 一次 SYNC_WRITE 关闭本总线全部舵机扭矩（无应答、无延时），并丢弃未发送的目标
+     */
+    void fastStop();
+
+    /**
+     * @brief 同步读 TORQUE_ENABLE 校验停机结果
+     * @return 确认扭矩已关闭的舵机数量
+     */
+    int verifyTorqueOff();
+
+    /**
+     * @brief 一次 SYNC_WRITE 打开本总线全部舵机扭矩（从停机恢复）
+     */
+    void enableTorqueAll();
+
+    /* ========== 单舵机事务（非热循环，由 BusScheduler 在周期剩余时间内调用） ========== */
+
+    /**
+     * @brief 写 RAM 区单字节寄存器（带应答）
+     */
+    bool writeRegister(uint8_t id, uint8_t addr, uint8_t value);
+
+    /**
+     * @brief 写 EPROM 区单字节寄存器（解锁 -> 写入 -> 加锁）
+     */
+    bool writeEprom(uint8_t id, uint8_t addr, uint8_t value);
+
+    /**
+     * @brief 单个舵机扭矩开关
+     */
+    bool setTorque(uint8_t id, bool enable);
+
+    /**
+     * @brief 单个舵机位置指令（控制环运行时会被下一周期的目标覆盖）
+     */
+    bool moveTo(uint8_t id, int16_t position, uint16_t speed, uint8_t acc = 50);
+
+    /**
+     * @brief 读取负载/电压/温度（一次 4 字节读），结果存入诊断数据，可用 getFeedback() 取得
+     */
+    bool readDiagnostics(uint8_t id);
+
+    /**
+     * @brief 切换控制模式 SERVO_CTRL_*（写 EPROM 区运行模式寄存器）
+     * 成功后 controlModeAt() 随之改变，热循环据此按力矩或位置写入目标
+     * @return false 写入失败或该型号没有力矩模式
+     */
+    bool setControlMode(uint8_t id, uint8_t mode);
+
+    /**
+     * @brief 寄存器影子缓存的后台刷新：对全部舵机同步读一个配置段（一次带应答收发）
+     * 发现舵机掉电复位等原因造成的寄存器变化；上面的单舵机写入会同步更新缓存
+     */
+    void refreshRegisterCache(uint32_t timeoutMs) { _regCache.RefreshNext(timeoutMs); }
+    const ServoRegisterCacheStats& registerCacheStats() const { return _regCache.Stats(); }
+
+    /* ========== 槽位访问（热循环） ========== */
+
+    uint8_t servoCount() const { return _count; }
+    uint32_t baud() const { return _baud; }
+    uint8_t servoIdAt(uint8_t slot) const { return _ids[slot]; }
+    uint8_t modelAt(uint8_t slot) const { return _model[slot]; }
+    uint8_t controlModeAt(uint8_t slot) const { return _ctrlMode[slot]; }
+    bool    supportsTorqueModeAt(uint8_t slot) const { return _policyAt(slot).torqueModeValue != 0; }
+    bool    isOnlineAt(uint8_t slot) const { return _hot[slot].online; }
+    int32_t getAbsolutePositionAt(uint8_t slot) const { return _hot[slot].absolutePosition; }
+    const ServoHotState& hotStateAt(uint8_t slot) const { return _hot[slot]; }
+
+    /**
+     * @brief 舵机 ID -> 槽位，未挂在本总线上返回 SERVO_SLOT_NONE
+     */
+    uint8_t slotOf(uint8_t id) const {
+        return (id <= MAX_SERVO_ID) ? _idToSlot[id] : SERVO_SLOT_NONE;
+    }
+
+    /* ========== 按 ID 访问 ========== */
 
     /**
      * @brief 获取舵机原始位置（0-4096）
@@ -75,7 +275,7 @@ public:
     int16_t getRawPosition(uint8_t id) const;
 
     /**
-     * @brief 获取舵机绝对位置（多圈累计，-30719 到 30719）
+     * @brief 获取舵机绝对位置（多圈累计，不截断，可用 getFeedback().saturated 判断越界）
      * @param id 舵机 ID
      * @return 绝对位置值，失败返回 0
      */
@@ -90,7 +290,7 @@ public:
     /**
      * @brief 获取完整的舵机反馈数据
      */
-    const ServoFeedback& getFeedback(uint8_t id) const;
+    ServoFeedback getFeedback(uint8_t id) const;
 
     /**
      * @brief 检查舵机是否在线
@@ -98,22 +298,82 @@ public:
     bool isOnline(uint8_t id) const;
 
 private:
-    SMS_STS _sms;                    // 飞特舵机协议对象
+    // 同型号槽位组（SYNC_WRITE 按组发送）
+    struct ModelGroup {
+        uint8_t model;
+        uint8_t count;
+        uint8_t slots[MAX_SERVOS_PER_BUS];
+    };
+
+    // 反馈布局相同的槽位组（SYNC_READ 按组发送）
+    struct ReadGroup {
+        uint8_t addr;
+        uint8_t len;
+        uint8_t count;
+        uint8_t slots[MAX_SERVOS_PER_BUS];
+        uint8_t ids[MAX_SERVOS_PER_BUS];
+    };
+
+    SMS_STS _sms;                    // 飞特协议对象（帧格式各型号通用，编码由型号策略完成）
+    ServoRegisterCache _regCache;    // 配置寄存器影子缓存（BusScheduler 后台刷新）
     HardwareSerial* _serial;         // 串口指针
+    uint8_t _busIndex;               // 总线编号（用于复位后恢复圈数）
+    uint32_t _baud;                  // 波特率（时序模型用）
 
-    /* 同步写缓存 */
-    uint8_t  _writeIDs[MAX_SERVOS_PER_BUS];
+    /* 槽位表 */
+    uint8_t _count;                          // 已分配槽位数
+    uint8_t _ids[MAX_SERVOS_PER_BUS];        // 槽位 -> 舵机 ID（连续，可直接用于 SYNC_READ）
+    uint8_t _model[MAX_SERVOS_PER_BUS];      // 槽位 -> 型号 SERVO_MODEL_*
+    uint8_t _idToSlot[MAX_SERVO_ID + 1];     // 舵机 ID -> 槽位
+    uint8_t _ctrlMode[MAX_SERVOS_PER_BUS];   // 槽位 -> 舵机当前的控制模式 SERVO_CTRL_*
+
+    ModelGroup _writeGroups[SERVO_MODEL_COUNT];
+    uint8_t    _writeGroupCount;
+    ReadGroup  _readGroups[SERVO_MODEL_COUNT];
+    uint8_t    _readGroupCount;
+
+    /* 同步写缓存（按槽位） */
     int16_t  _writePos[MAX_SERVOS_PER_BUS];
     uint16_t _writeSpd[MAX_SERVOS_PER_BUS];
     uint8_t  _writeAcc[MAX_SERVOS_PER_BUS];
+    int16_t  _writeTorque[MAX_SERVOS_PER_BUS];
+    uint8_t  _writePending[MAX_SERVOS_PER_BUS];
     uint8_t  _writeCount;
 
-    /* 反馈数据缓存 */
-    ServoFeedback _feedback[MAX_SERVO_ID + 1];
+    /* 流水线周期 */
+    uint8_t       _burstBuf[SERVO_BURST_BUF_LEN];
+    bool          _cycleActive;
+    uint32_t      _cycleStartUs;
+    uint16_t      _cycleTxBytes;
+    uint32_t      _cycleTimeoutMs;
+    BusCycleStats _cycleStats;
+    uint8_t       _stageSlot;        // 已发送 REG_WRITE、等待应答的槽位
+    uint8_t       _stagedCount;      // 本周期已确认暂存的目标数
+    bool          _cyclePrepared;
+    uint16_t      _actuateBytes;     // 发送缓冲中生效帧（ACTION/SYNC_WRITE）的字节数
+    bool          _actuated;
+    uint32_t      _actuateUs;
+
+    /* 力矩限制（按槽位） */
+    uint16_t _limit[MAX_SERVOS_PER_BUS];       // 要求的限制（0 = 关扭矩）
+    uint16_t _limitReg[MAX_SERVOS_PER_BUS];    // 已写入舵机的力矩限制寄存器值
+    uint8_t  _limitCut[MAX_SERVOS_PER_BUS];    // 已因保护关闭扭矩
+
+    /* 反馈数据（按槽位存放，热/冷分离） */
+    ServoHotState    _hot[MAX_SERVOS_PER_BUS];
+    ServoDiagnostics _diag[MAX_SERVOS_PER_BUS];
 
     /* 内部辅助函数 */
-    void _updateMultiTurnPosition(uint8_t id, int16_t newRawPos);
+    void _updateMultiTurnPosition(uint8_t slot, int16_t newRawPos, int16_t speed, uint32_t sampleUs, bool speedValid);
+    void _restorePersistedTurns();
+    void _savePersistedTurns() const;
+    void _buildGroups();
+    int  _readGroup(const ReadGroup& group, uint32_t timeoutMs);
+    int  _parseReadGroup(const ReadGroup& group, uint32_t sampleUs);
+    uint32_t _wireUs(uint32_t bytes) const { return (uint32_t)((uint64_t)bytes * 10 * 1000000 / _baud); }
+    void _syncWriteTorque(uint8_t enable);
+    void _syncWriteLimits();
+    const ServoModelPolicy& _policyAt(uint8_t slot) const { return servoModelPolicy(_model[slot]); }
 };
 
 #endif
-
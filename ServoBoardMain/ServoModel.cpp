@@ -0,0 +1,148 @@
+#include "ServoModel.h"
+#include "SCServo.h"
+
+// 各型号的编码均由 FTServo 的编译期寄存器描述 (<Model>_Map) 生成，字节序固定为该型号的默认值
+
+// 接口单位 -> 寄存器单位，向上取整（速度/加速度是上限，换算后不能变小；0 仍为 0 = 不限制）
+static inline uint32_t scaleUp(uint32_t value, uint32_t from, uint32_t to) {
+    return (value * from + to - 1) / to;
+}
+
+/* ==================== SMS/STS ==================== */
+
+static void stsPackTarget(uint8_t* buf, int16_t position, uint16_t speed, uint8_t acc, int16_t /*torque*/) {
+    SMS_STS_Map::PosEx::Pack<0>(buf, acc, position, 0, speed);
+}
+
+static void stsDecodeFeedback(const uint8_t* buf, int16_t& position, int16_t& speed, int16_t& load) {
+    position = SMS_STS_Map::PresentPosition::Get<0>(buf);
+    speed    = SMS_STS_Map::PresentSpeed::Get<0>(buf + 2);
+    load     = SMS_STS_Map::PresentLoad::Get<0>(buf + 4);
+}
+
+static int16_t stsDecodeLoad(const uint8_t* buf) {
+    return SMS_STS_Map::PresentLoad::Get<0>(buf);
+}
+
+static void stsPackTorqueLimit(uint8_t* buf, uint16_t limit) {
+    SMS_STS_Map::TorqueLimit::Put<0>(buf, limit);
+}
+
+/* ==================== HLS ==================== */
+
+// 寄存器单位取自策略表（speedUnit/accUnit），与前馈限幅、跟踪仿真使用同一组数值
+static void hlsPackTarget(uint8_t* buf, int16_t position, uint16_t speed, uint8_t acc, int16_t torque) {
+    const ServoModelPolicy& policy = kServoModels[SERVO_MODEL_HLS];
+    uint32_t hlsSpeed = scaleUp(speed, SERVO_SPEED_UNIT, policy.speedUnit);
+    uint32_t hlsAcc = scaleUp(acc, SERVO_ACC_UNIT, policy.accUnit);
+    uint32_t hlsAccMax = (uint32_t)policy.maxAcc * SERVO_ACC_UNIT / policy.accUnit;
+    if (hlsAcc > hlsAccMax) hlsAcc = hlsAccMax;
+    HLSCL_Map::PosEx::Pack<0>(buf, (int)hlsAcc, position, torque, (int)hlsSpeed);
+}
+
+// 反馈速度换算回接口单位（步/s），与 STS 一致，多圈跨圈预测与柔顺阻尼直接使用
+static void hlsDecodeFeedback(const uint8_t* buf, int16_t& position, int16_t& speed, int16_t& load) {
+    const ServoModelPolicy& policy = kServoModels[SERVO_MODEL_HLS];
+    int32_t v = (int32_t)HLSCL_Map::PresentSpeed::Get<0>(buf + 2) * policy.speedUnit / SERVO_SPEED_UNIT;
+    position = HLSCL_Map::PresentPosition::Get<0>(buf);
+    speed    = (int16_t)constrain(v, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+    load     = HLSCL_Map::PresentLoad::Get<0>(buf + 4);
+}
+
+static int16_t hlsDecodeLoad(const uint8_t* buf) {
+    return HLSCL_Map::PresentLoad::Get<0>(buf);
+}
+
+static void hlsPackTorqueLimit(uint8_t* buf, uint16_t limit) {
+    HLSCL_Map::TorqueLimit::Put<0>(buf, limit);
+}
+
+/* ==================== SCSCL ==================== */
+
+static void scsclPackTarget(uint8_t* buf, int16_t position, uint16_t speed, uint8_t /*acc*/, int16_t /*torque*/) {
+    SCSCL_Map::Pos::Pack<1>(buf, position, 0, speed);   // 无加速度寄存器，时间为 0 表示按速度运行
+}
+
+static void scsclDecodeFeedback(const uint8_t* buf, int16_t& position, int16_t& speed, int16_t& load) {
+    position = SCSCL_Map::PresentPosition::Get<1>(buf);
+    speed    = SCSCL_Map::PresentSpeed::Get<1>(buf + 2);
+    load     = SCSCL_Map::PresentLoad::Get<1>(buf + 4);
+}
+
+static int16_t scsclDecodeLoad(const uint8_t* buf) {
+    return SCSCL_Map::PresentLoad::Get<1>(buf);
+}
+
+/* ==================== 缓存刷新段 ==================== */
+
+static const ServoRegisterRange kStsRefreshRanges[] = {
+    {SMS_STS_MIN_ANGLE_LIMIT_L, 4},   // 角度限制（多圈模式为 0）
+    {SMS_STS_CW_DEAD,           2},   // 死区
+    {SMS_STS_OFS_L,             3},   // 位置校正 + 运行模式
+    {SMS_STS_TORQUE_ENABLE,     2},   // 扭矩开关 + 加速度
+    {SMS_STS_TORQUE_LIMIT_L,    2},   // 扭矩限制
+    {SMS_STS_LOCK,              1},   // EPROM 锁
+};
+
+static const ServoRegisterRange kHlsRefreshRanges[] = {
+    {HLSCL_MIN_ANGLE_LIMIT_L,   4},
+    {HLSCL_CW_DEAD,             2},
+    {HLSCL_OFS_L,               3},   // 位置校正 + 运行模式（2 = 恒力矩）
+    {HLSCL_TORQUE_ENABLE,       2},
+    {HLSCL_TORQUE_LIMIT_L,      2},
+    {HLSCL_LOCK,                1},
+};
+
+// SCSCL 没有位置校正/运行模式/加速度/RAM 力矩限制，锁在地址 48
+static const ServoRegisterRange kScsclRefreshRanges[] = {
+    {SCSCL_MIN_ANGLE_LIMIT_L,   4},
+    {SCSCL_CW_DEAD,             2},
+    {SCSCL_TORQUE_ENABLE,       1},
+    {SCSCL_LOCK,                1},
+};
+
+#define RANGES(table) table, (uint8_t)(sizeof(table) / sizeof(table[0]))
+
+/* ==================== 策略表 ==================== */
+
+const ServoModelPolicy kServoModels[SERVO_MODEL_COUNT] = {
+    // SERVO_MODEL_STS
+    {
+        "STS",
+        SMS_STS_Map::PosEx::Addr, SMS_STS_Map::PosEx::Len, stsPackTarget, 0,
+        SERVO_SPEED_UNIT, SERVO_ACC_UNIT, SERVO_STS_SPEED_MAX, SERVO_STS_ACC_MAX,
+        -30719, 30719, SERVO_STS_STEPS_PER_DEG, true,
+        SMS_STS_PRESENT_POSITION_L, 6, stsDecodeFeedback,
+        SMS_STS_PRESENT_LOAD_L, stsDecodeLoad,
+        SMS_STS_TORQUE_ENABLE, SMS_STS_LOCK,
+        RANGES(kStsRefreshRanges),
+        SMS_STS_MODE, 0,
+        SMS_STS_Map::TorqueLimit::Addr, SMS_STS_Map::TorqueLimit::Width, stsPackTorqueLimit,
+    },
+    // SERVO_MODEL_HLS
+    {
+        "HLS",
+        HLSCL_Map::PosEx::Addr, HLSCL_Map::PosEx::Len, hlsPackTarget, SERVO_HLS_POSITION_TORQUE,
+        SERVO_HLS_SPEED_UNIT, SERVO_HLS_ACC_UNIT, SERVO_HLS_SPEED_MAX, SERVO_HLS_ACC_MAX,
+        -30719, 30719, SERVO_STS_STEPS_PER_DEG, true,
+        HLSCL_PRESENT_POSITION_L, 6, hlsDecodeFeedback,
+        HLSCL_PRESENT_LOAD_L, hlsDecodeLoad,
+        HLSCL_TORQUE_ENABLE, HLSCL_LOCK,
+        RANGES(kHlsRefreshRanges),
+        HLSCL_MODE, 2,                       // 2 = 恒力矩（电流）模式，目标力矩带符号
+        HLSCL_Map::TorqueLimit::Addr, HLSCL_Map::TorqueLimit::Width, hlsPackTorqueLimit,
+    },
+    // SERVO_MODEL_SCSCL
+    {
+        "SCSCL",
+        SCSCL_Map::Pos::Addr, SCSCL_Map::Pos::Len, scsclPackTarget, 0,
+        SERVO_SPEED_UNIT, 0, SERVO_SCSCL_SPEED_MAX, 0,
+        0, 1023, SERVO_SCSCL_STEPS_PER_DEG, false,
+        SCSCL_PRESENT_POSITION_L, 6, scsclDecodeFeedback,
+        SCSCL_PRESENT_LOAD_L, scsclDecodeLoad,
+        SCSCL_TORQUE_ENABLE, SCSCL_LOCK,
+        RANGES(kScsclRefreshRanges),
+        0, 0,
+        0, 0, nullptr,                       // 地址 48 为 EPROM 锁，没有 RAM 力矩限制
+    },
+};
@@ -0,0 +1,103 @@
+#ifndef SERVO_MODEL_H
+#define SERVO_MODEL_H
+
+#include <stdint.h>
+#include "ServoRegisterCache.h"
+
+/* ==================== 舵机型号 ==================== */
+
+// 同一条总线上可以混用不同型号：帧格式相同，只是内存表布局/字节序/编码不同，
+// 由下面的策略表描述。ServoBusManager 按型号分组，每组每周期一次 SYNC_WRITE，
+// 反馈布局相同的型号共用一次 SYNC_READ，增加型号不会增加逐个舵机的往返。
+#define SERVO_MODEL_STS        0   // SMS/STS 系列（默认）
+#define SERVO_MODEL_HLS        1   // HLS 系列，目标写入块带力矩
+#define SERVO_MODEL_SCSCL      2   // SCSCL 系列，单圈、无加速度、大端序
+#define SERVO_MODEL_COUNT      3
+
+#define SERVO_TORQUE_LIMIT_MAX 1000   // 力矩限制/负载满量程（最大力矩的 0.1%），各型号相同
+
+// 写入接口统一使用 STS 的单位：速度 步/s，加速度 100 步/s²，由各型号的打包函数换算为寄存器单位。
+// HLS 的速度寄存器单位为 50 步/s（HLSCL 示例：V*50 步/s，A*100 步/s²）
+#define SERVO_SPEED_UNIT          1     // 接口速度单位（步/s）
+#define SERVO_ACC_UNIT            100   // 接口加速度单位（步/s²）
+#define SERVO_HLS_SPEED_UNIT      50
+#define SERVO_HLS_ACC_UNIT        100
+
+// 各型号的速度/加速度上限（接口单位，前馈限幅用）与每度步数。
+// SCSCL 每圈 1024 步 = 300°，示例的最高速度为 1500；HLS 按所用型号的额定转速修改
+#define SERVO_STS_STEPS_PER_DEG   (4096.0f / 360.0f)
+#define SERVO_STS_SPEED_MAX       3400    // 步/s
+#define SERVO_STS_ACC_MAX         254     // ×100 步/s²
+#ifndef SERVO_HLS_SPEED_MAX
+#define SERVO_HLS_SPEED_MAX       3400
+#endif
+#define SERVO_HLS_ACC_MAX         254
+#define SERVO_SCSCL_STEPS_PER_DEG (1024.0f / 300.0f)
+#define SERVO_SCSCL_SPEED_MAX     1500
+
+// HLS 位置模式下写入块的目标力矩字段是电流上限（×6.5 mA），写 0 会让舵机没有输出力矩
+#ifndef SERVO_HLS_POSITION_TORQUE
+#define SERVO_HLS_POSITION_TORQUE 500
+#endif
+
+// setTarget 的力矩参数取此值时使用型号的位置模式力矩（positionTorque）
+#define SERVO_TORQUE_POSITION_DEFAULT INT16_MIN
+
+// 控制模式（写入块相同：力矩模式下舵机只使用目标力矩字段）
+#define SERVO_CTRL_POSITION    0
+#define SERVO_CTRL_TORQUE      1
+
+/* ==================== 型号策略 ==================== */
+
+struct ServoModelPolicy {
+    const char* name;
+
+    /* 目标写入（SYNC_WRITE 块） */
+    uint8_t writeAddr;              // 写入块起始地址
+    uint8_t writeLen;               // 写入块长度
+    void (*packTarget)(uint8_t* buf, int16_t position, uint16_t speed, uint8_t acc, int16_t torque);
+    int16_t positionTorque;         // 位置模式下的目标力矩字段（HLS 为电流上限），写入块没有该字段时为 0
+    uint16_t speedUnit;             // 速度寄存器单位（步/s）
+    uint16_t accUnit;               // 加速度寄存器单位（步/s²），0 表示没有加速度寄存器
+    uint16_t maxSpeed;              // 速度上限（步/s）
+    uint8_t maxAcc;                 // 加速度上限（×100 步/s²），没有加速度寄存器时为 0
+    int16_t minPosition;            // 目标位置范围
+    int16_t maxPosition;
+    float   stepsPerDeg;            // 每度步数
+    bool    multiTurn;              // 是否支持多圈（否则跨圈检测不使用速度预测）
+
+    /* 反馈（位置 + 速度 + 负载，连续 6 字节，每周期同步读） */
+    uint8_t feedbackAddr;
+    uint8_t feedbackLen;
+    void (*decodeFeedback)(const uint8_t* buf, int16_t& position, int16_t& speed, int16_t& load);
+
+    /* 诊断（负载 + 电压 + 温度，连续 4 字节） */
+    uint8_t diagAddr;
+    int16_t (*decodeLoad)(const uint8_t* buf);
+
+    /* 控制寄存器 */
+    uint8_t torqueEnableAddr;
+    uint8_t lockAddr;
+
+    /* 寄存器缓存后台刷新的段表（只含该型号存在的配置/控制寄存器） */
+    const ServoRegisterRange* refreshRanges;
+    uint8_t refreshRangeCount;
+
+    /* 运行模式（EPROM），torqueModeValue 为力矩模式的取值，0 表示该型号没有力矩模式 */
+    uint8_t modeAddr;
+    uint8_t torqueModeValue;
+
+    /* RAM 区力矩限制（过载降额用），nullptr 表示该型号没有此寄存器，只能关扭矩 */
+    uint8_t torqueLimitAddr;
+    uint8_t torqueLimitLen;
+    void (*packTorqueLimit)(uint8_t* buf, uint16_t limit);
+};
+
+extern const ServoModelPolicy kServoModels[SERVO_MODEL_COUNT];
+
+// 未知型号按 STS 处理
+inline const ServoModelPolicy& servoModelPolicy(uint8_t model) {
+    return kServoModels[model < SERVO_MODEL_COUNT ? model : SERVO_MODEL_STS];
+}
+
+#endif // SERVO_MODEL_H
@@ -0,0 +1,28 @@
+#include "ServoProfile.h"
+#include "TaskSharedData.h"
+#include <math.h>
+
+bool servoProfileLimits(const ServoModelPolicy& policy, float targetSpeed, float targetAccel,
+                        float errSteps, float servoSpeed, uint16_t& outSpeed, uint8_t& outAcc)
+{
+    // 加上追赶跟踪误差所需的速度（只按目标速度限速时，落后的舵机永远追不上）
+    float speed = targetSpeed + errSteps / SERVO_FF_CATCHUP_S;
+
+    // 需要的加速度：目标加速度前馈与舵机当前速度变为所需速度的加速度取大者
+    float acc = fmaxf(fabsf(targetAccel), fabsf(speed - servoSpeed) / SERVO_FF_CATCHUP_S);
+
+    float speedLimit = fabsf(speed) * SERVO_FF_MARGIN;
+    float accLimit = acc * SERVO_FF_MARGIN / 100.0f;
+    bool saturated = false;
+    if (speedLimit >= policy.maxSpeed)
+    {
+        speedLimit = policy.maxSpeed;
+        saturated = true;
+    }
+    if (accLimit > policy.maxAcc) accLimit = policy.maxAcc;
+
+    // 没有加速度寄存器的型号（maxAcc = 0）写默认值，打包时忽略
+    outSpeed = (speedLimit > SERVO_DEFAULT_SPEED) ? (uint16_t)speedLimit : SERVO_DEFAULT_SPEED;
+    outAcc = (accLimit > SERVO_DEFAULT_ACC) ? (uint8_t)accLimit : SERVO_DEFAULT_ACC;
+    return saturated;
+}
@@ -0,0 +1,27 @@
+#ifndef SERVO_PROFILE_H
+#define SERVO_PROFILE_H
+
+#include <stdint.h>
+#include "ServoModel.h"
+
+/* ==================== 舵机速度/加速度上限（前馈） ==================== */
+
+// AngleSolver::computeProfile 逐关节调用（参数见 TaskSharedData.h 的 SERVO_FF_* / SERVO_DEFAULT_*）：
+//   速度   = 目标速度 + 跟踪误差 / 追赶时间；
+//   加速度 = 目标加速度与“舵机当前速度 -> 所需速度”在追赶时间内完成所需加速度的大者；
+//   乘以余量后限制在 [默认值, 型号上限]。与硬件无关，主机基准直接调用。
+
+/**
+ * @param policy      舵机型号（上限取 maxSpeed / maxAcc）
+ * @param targetSpeed 目标速度 (步/s)
+ * @param targetAccel 目标加速度 (步/s²)
+ * @param errSteps    跟踪误差：目标脉冲 - 舵机位置 (步)
+ * @param servoSpeed  舵机当前速度 (步/s)
+ * @param outSpeed    [输出] 写入舵机的速度 (步/s)
+ * @param outAcc      [输出] 写入舵机的加速度 (×100 步/s²)
+ * @return 需要的速度是否超过型号的速度上限
+ */
+bool servoProfileLimits(const ServoModelPolicy& policy, float targetSpeed, float targetAccel,
+                        float errSteps, float servoSpeed, uint16_t& outSpeed, uint8_t& outAcc);
+
+#endif // SERVO_PROFILE_H
@@ -0,0 +1,177 @@
+#include "SetpointJitterBuffer.h"
+#include <string.h>
+
+// 模运算下 a 是否早于 b
+static inline bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+SetpointJitterBuffer::SetpointJitterBuffer()
+    : _head(0), _tail(0), _delayUs(SETPOINT_PLAYOUT_DELAY_MS * 1000), _resetRequest(false),
+      _count(0), _started(false), _playedSeq(0), _lastSeq(0), _hasLastSeq(false),
+      _lastArrivalUs(0), _lastHostUs(0), _recvMask(0), _holdTicks(0), _jitterQ4(0),
+      _offsetCur(0), _offsetPrev(0), _offsetCount(0), _hasOffset(false)
+{
+    memset(_lastPos, 0, sizeof(_lastPos));
+    memset(_lastVel, 0, sizeof(_lastVel));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/* ==================== 生产者 ==================== */
+
+bool SetpointJitterBuffer::push(const SetpointPacket& pkt) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= SETPOINT_ARRIVAL_QUEUE_LEN) {
+        return false;
+    }
+    _arrivals[head & (SETPOINT_ARRIVAL_QUEUE_LEN - 1)] = pkt;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/* ==================== 消费者 ==================== */
+
+uint32_t SetpointJitterBuffer::_offset() const {
+    if (!_hasOffset) return _offsetCur;          // 第一个窗口尚未结束
+    if (_offsetCount == 0) return _offsetPrev;
+    return before(_offsetCur, _offsetPrev) ? _offsetCur : _offsetPrev;
+}
+
+void SetpointJitterBuffer::_accept(const SetpointPacket& pkt, uint32_t hostNow) {
+    // 1. 序号：缺口先计为丢包，乱序补回时扣除；按序到达的包更新到达抖动 J += (|D| - J) / 16
+    if (_hasLastSeq) {
+        int16_t diff = (int16_t)(pkt.seq - _lastSeq);
+        if (diff > 0) {
+            if (diff > 1) _stats.lost += diff - 1;
+            int32_t d = (int32_t)(pkt.arrivalUs - _lastArrivalUs) - (int32_t)(pkt.hostTimeUs - _lastHostUs);
+            if (d < 0) d = -d;
+            _jitterQ4 += d - (_jitterQ4 + 8) / 16;
+            _stats.jitterUs = _jitterQ4 / 16;
+            _recvMask = (diff < 32) ? (_recvMask << diff) | 1 : 1;
+            _lastSeq = pkt.seq;
+            _lastArrivalUs = pkt.arrivalUs;
+            _lastHostUs = pkt.hostTimeUs;
+        } else if (-diff < 32 && !(_recvMask & (1u << -diff))) {
+            _recvMask |= 1u << -diff;
+            if (_stats.lost > 0) _stats.lost--;
+        } else {
+            _stats.duplicates++;
+            return;
+        }
+    } else {
+        _recvMask = 1;
+        _lastSeq = pkt.seq;
+        _lastArrivalUs = pkt.arrivalUs;
+        _lastHostUs = pkt.hostTimeUs;
+        _hasLastSeq = true;
+    }
+    _stats.received++;
+
+    // 保持期间又收到新包：之前的保持是欠载（流结束后的保持不计）
+    _stats.underrunTicks += _holdTicks;
+    _holdTicks = 0;
+
+    // 2. 时钟偏移：窗口内传输时间的最小值，窗口结束时滚动（跟随两侧时钟的漂移）
+    uint32_t transit = pkt.arrivalUs - pkt.hostTimeUs;
+    if (_offsetCount == 0 || before(transit, _offsetCur)) _offsetCur = transit;
+    if (++_offsetCount >= SETPOINT_OFFSET_WINDOW) {
+        _offsetPrev = _offsetCur;
+        _offsetCount = 0;
+        _hasOffset = true;
+    }
+
+    // 3. 已过播放时刻的包（包括乱序到达、所在区间已播放过的包）不再使用
+    if (_started && ((int16_t)(pkt.seq - _playedSeq) <= 0 || !before(hostNow, pkt.hostTimeUs))) {
+        _stats.late++;
+        return;
+    }
+
+    // 4. 按序号插入（通常按序到达，直接追加）；缓冲满时丢弃最早的包
+    if (_count == SETPOINT_JITTER_CAPACITY) {
+        memmove(&_buf[0], &_buf[1], sizeof(SetpointPacket) * (SETPOINT_JITTER_CAPACITY - 1));
+        _count--;
+    }
+    uint8_t i = _count;
+    while (i > 0 && (int16_t)(pkt.seq - _buf[i - 1].seq) < 0) {
+        _buf[i] = _buf[i - 1];
+        i--;
+    }
+    _buf[i] = pkt;
+    _count++;
+}
+
+bool SetpointJitterBuffer::sample(uint32_t nowUs, float* pos, float* vel) {
+    uint32_t delay = _delayUs.load(std::memory_order_relaxed);
+    uint32_t head = _head.load(std::memory_order_acquire);
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+    // 1. 复位请求：丢弃已到达与待播放的包，重新估计时钟偏移
+    if (_resetRequest.exchange(false, std::memory_order_acquire)) {
+        tail = head;
+        _count = 0;
+        _started = false;
+        _hasLastSeq = false;
+        _holdTicks = 0;
+        _offsetCount = 0;
+        _hasOffset = false;
+    }
+
+    // 2. 取出新到达的包
+    for (; tail != head; tail++) {
+        const SetpointPacket& pkt = _arrivals[tail & (SETPOINT_ARRIVAL_QUEUE_LEN - 1)];
+        // 播放位置（主机时间轴）随偏移估计更新，先以当前估计判断迟到
+        _accept(pkt, nowUs - _offset() - delay);
+    }
+    _tail.store(tail, std::memory_order_release);
+
+    if (_count == 0) {
+        memset(vel, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+        if (_started) memcpy(pos, _lastPos, sizeof(_lastPos));
+        return _started;
+    }
+
+    // 3. 当前时刻在主机时间轴上的播放位置；丢弃已经播放完的区间
+    uint32_t hostNow = nowUs - _offset() - delay;
+    while (_count >= 2 && !before(hostNow, _buf[1].hostTimeUs)) {
+        memmove(&_buf[0], &_buf[1], sizeof(SetpointPacket) * (_count - 1));
+        _count--;
+    }
+
+    const SetpointPacket& a = _buf[0];
+    if (before(hostNow, a.hostTimeUs)) {
+        // 第一个点还没到播放时刻
+        memset(vel, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+        if (_started) memcpy(pos, _lastPos, sizeof(_lastPos));
+        return _started;
+    }
+
+    // 4. 新区间开始：记录该包从到达到开始播放的等待时间
+    if (!_started || a.seq != _playedSeq) {
+        uint32_t wait = nowUs - a.arrivalUs;
+        _stats.waitAvgUs = _stats.waitAvgUs ? _stats.waitAvgUs + ((int32_t)(wait - _stats.waitAvgUs) / 16) : wait;
+        if (wait > _stats.waitMaxUs) _stats.waitMaxUs = wait;
+        _playedSeq = a.seq;
+        _started = true;
+    }
+
+    // 5. 区间内线性插值（跨丢包缺口时即为丢包隐藏）；没有下一个点时保持
+    if (_count >= 2) {
+        const SetpointPacket& b = _buf[1];
+        uint32_t spanUs = b.hostTimeUs - a.hostTimeUs;
+        float frac = (float)(hostNow - a.hostTimeUs) / (float)spanUs;
+        float invSpanS = 1e6f / (float)spanUs;
+        for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+            _lastPos[j] = a.pos[j] + (b.pos[j] - a.pos[j]) * frac;
+            _lastVel[j] = (b.pos[j] - a.pos[j]) * invSpanS;
+        }
+        if ((int16_t)(b.seq - a.seq) > 1) _stats.concealedTicks++;
+    } else {
+        memcpy(_lastPos, a.pos, sizeof(_lastPos));
+        memset(_lastVel, 0, sizeof(_lastVel));
+        _holdTicks++;
+    }
+
+    memcpy(pos, _lastPos, sizeof(_lastPos));
+    memcpy(vel, _lastVel, sizeof(_lastVel));
+    return true;
+}
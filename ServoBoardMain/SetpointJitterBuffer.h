@@ -0,0 +1,105 @@
+#ifndef SETPOINT_JITTER_BUFFER_H
+#define SETPOINT_JITTER_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+#include "TaskSharedData.h"
+
+/* ==================== 目标点抖动缓冲 ==================== */
+
+// 上位机按自己的时钟给每个目标点打上序号与时间戳，板上不再“收到即生效”，
+// 而是按固定延迟回放：
+//   播放时刻 = 主机时间戳 + 时钟偏移 + 播放延迟
+// - 时钟偏移取最近 SETPOINT_OFFSET_WINDOW 个包 (到达时刻 - 主机时间戳) 的最小值，
+//   即传输最快的包，USB CDC 攒包造成的额外延迟都落在播放延迟里被吸收；
+// - 外环每个周期按当前时刻在相邻两个目标点之间线性插值，丢包时跨过缺口插值（丢包隐藏），
+//   缓冲耗尽时保持最后一个目标点；
+// - 播放延迟可在运行时设置，用延迟换平滑度。
+// 生产者 (UpperCommTask) 只把到达的包放入无锁队列，排序、回放与统计都在消费者 (taskOuterLoop)。
+
+static_assert((SETPOINT_ARRIVAL_QUEUE_LEN & (SETPOINT_ARRIVAL_QUEUE_LEN - 1)) == 0, "到达队列长度必须为 2 的幂");
+
+struct SetpointPacket {
+    uint16_t seq;
+    uint32_t hostTimeUs;                  // 主机时间戳
+    uint32_t arrivalUs;                   // 到达时刻（设备 micros）
+    float    pos[ENCODER_TOTAL_NUM];
+};
+
+// 统计（消费者写，其他任务读）
+struct SetpointStreamStats {
+    uint32_t received;        // 收到的包
+    uint32_t lost;            // 序号缺口（未收到的包）
+    uint32_t late;            // 到达时已过播放时刻而被丢弃的包（含乱序到达的包）
+    uint32_t duplicates;      // 重复的包
+    uint32_t concealedTicks;  // 跨丢包缺口插值的周期数
+    uint32_t underrunTicks;   // 缓冲耗尽、只能保持的周期数（之后又有新包到达才计入，流结束后的保持不算）
+    uint32_t jitterUs;        // 到达间隔抖动估计（RFC 3550 平滑方式）
+    uint32_t waitAvgUs;       // 包从到达到开始播放的平均等待时间（实测播放延迟）
+    uint32_t waitMaxUs;
+};
+
+class SetpointJitterBuffer {
+public:
+    SetpointJitterBuffer();
+
+    /* ========== 生产者（上位机通信任务） ========== */
+
+    // 放入一个到达的包（arrivalUs 由调用者在收到时填写），队列满时丢弃
+    bool push(const SetpointPacket& pkt);
+
+    // 设置播放延迟（下一次 sample 时生效）
+    void setPlayoutDelay(uint32_t delayUs) { _delayUs.store(delayUs, std::memory_order_relaxed); }
+    uint32_t playoutDelay() const { return _delayUs.load(std::memory_order_relaxed); }
+
+    // 请求停止回放并清空缓冲（改用目标角度快照或轨迹时调用，下一次 sample 时生效）
+    void requestReset() { _resetRequest.store(true, std::memory_order_release); }
+
+    /* ========== 消费者（外环任务） ========== */
+
+    /**
+     * @brief 计算 nowUs 时刻应播放的目标角度
+     * @param vel 输出：当前区间的斜率 (°/s)，作为舵机速度前馈；保持时为 0
+     * @return false 尚未开始播放（没有收到过目标点，或第一个点还没到播放时刻），pos 保持不变；
+     *         开始播放后一直返回 true，断流时保持最后的输出，直到 requestReset
+     */
+    bool sample(uint32_t nowUs, float* pos, float* vel);
+
+    const SetpointStreamStats& stats() const { return _stats; }
+
+private:
+    /* 生产者 -> 消费者的到达队列 */
+    SetpointPacket        _arrivals[SETPOINT_ARRIVAL_QUEUE_LEN];
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+    std::atomic<uint32_t> _delayUs;
+    std::atomic<bool>     _resetRequest;
+
+    /* 消费者私有：按序号排列的待播放包 */
+    SetpointPacket _buf[SETPOINT_JITTER_CAPACITY];
+    uint8_t  _count;
+    bool     _started;                   // 已开始播放
+    float    _lastPos[ENCODER_TOTAL_NUM];
+    float    _lastVel[ENCODER_TOTAL_NUM];
+    uint16_t _playedSeq;                 // 当前播放区间起点的序号
+    uint16_t _lastSeq;                   // 收到的最大序号
+    bool     _hasLastSeq;
+    uint32_t _lastArrivalUs;
+    uint32_t _lastHostUs;
+    uint32_t _recvMask;                  // 位 i：序号 _lastSeq - i 已收到（识别重复包、乱序补回的丢包）
+    uint32_t _holdTicks;                 // 当前连续保持的周期数
+    int32_t  _jitterQ4;                  // 抖动估计 ×16
+
+    /* 时钟偏移：两段窗口的最小值 */
+    uint32_t _offsetCur;
+    uint32_t _offsetPrev;
+    uint16_t _offsetCount;
+    bool     _hasOffset;
+
+    SetpointStreamStats _stats;
+
+    void _accept(const SetpointPacket& pkt, uint32_t hostNow);
+    uint32_t _offset() const;
+};
+
+#endif // SETPOINT_JITTER_BUFFER_H
@@ -1,10 +1,22 @@
 #include "SystemTask.h"
 #include "ServoBusManager.h"  // 新增
 #include "AngleSolver.h"      // 新增
+#include "DeferredLog.h"
+#include "BusScheduler.h"
+#include "TrajectoryBuffer.h"
+#include "SetpointJitterBuffer.h"
+#include "EncoderConditioner.h"
+#include "JointModeSelector.h"
+#include "LoadProtector.h"
+#include <esp_heap_caps.h>
 
 
 // =============== 全局变量定义 ===============
 volatile uint8_t g_calibrationUIStatus = 0;
+volatile uint8_t g_servoStopRequest = SERVO_STOP_NONE;  // 【新增】急停/恢复请求（可在中断中写入）
+volatile uint32_t g_servoStopRequestUs = 0;             // 最近一次急停请求的时间戳（micros，先于请求写入）
+volatile uint32_t g_servoStopLatencyUs = 0;             // 【新增】最近一次急停从请求到指令全部发出的耗时
+volatile uint8_t g_zeroCaptureRequest = 0;              // 记录当前舵机位置为零位（由 System_Loop 处理）
 
 // 共享数据实例
 TaskSharedData_t sharedData;
@@ -13,6 +25,7 @@ TaskSharedData_t sharedData;
 TaskHandle_t taskUpperCommHandle = NULL;
 TaskHandle_t taskCanCommHandle   = NULL;
 TaskHandle_t taskSolverHandle    = NULL;  // 【新增】解算任务句柄
+TaskHandle_t taskOuterLoopHandle = NULL;  // 外环任务句柄
 
 // 注意：原 ino 中的 ServoManager 相关变量已被注释，因未启用 ServoCtrlTask，
 // 若后续需启用，请在该文件中取消注释并添加相应头文件。
@@ -23,6 +36,9 @@ ServoManager* servoManagers[NUM_SERVO_BUSES] = {
     &servoManager0,
     &servoManager1
 };
+// 启用时在 begin() 之前挂接标定数据库（与本板共用一个 NVS 镜像）：
+//   servoManager0.AttachCalibrationStore(&calibrationStore);
+//   servoManager1.AttachCalibrationStore(&calibrationStore);
 */
 
 
@@ -35,22 +51,61 @@ ServoBusManager servoBus3;
 // 【新增】角度解算器实例
 AngleSolver angleSolver;
 
+// 轨迹缓冲（UpperCommTask 写入，taskOuterLoop 插值）
+TrajectoryBuffer trajectoryBuffer;
 
-// 【新增】关节映射表: 将 0-20 索引映射到 (BusIndex, ServoID)
-// 请根据实际硬件连线修改
-JointMapItem jointMap[ENCODER_TOTAL_NUM] = {
-    // Bus 0 (4个关节)
-    {0, 1}, {0, 2}, {0, 3}, {0, 4},
-    // Bus 1 (4个关节)
-    {1, 1}, {1, 2}, {1, 3}, {1, 4},
-    // Bus 2 (4个关节)
-    {2, 1}, {2, 2}, {2, 3}, {2, 4},
-    // Bus 3 (5个关节)
-    {3, 1}, {3, 2}, {3, 3}, {3, 4}, {3, 5},
-    // 剩余4个关节（根据实际分配）
-    {0, 5}, {1, 5}, {2, 5}, {3, 6}  // 示例分配，请根据实际调整
+// 流式目标点抖动缓冲（UpperCommTask 写入，taskOuterLoop 回放）
+SetpointJitterBuffer setpointBuffer;
+
+// 磁编信号调理（taskOuterLoop 使用）
+EncoderConditioner encoderConditioner;
+
+// 关节降级模式（taskOuterLoop 使用）
+JointModeSelector jointModeSelector;
+
+// 过载/堵转保护（taskSolver 使用，UpperCommTask 修改限制）
+LoadProtector loadProtector;
+
+// 标定数据库（NVS），提供各关节零位
+CalibrationStore calibrationStore;
+
+static_assert(kHandTopology.bus[0].count <= CALIB_MAX_SERVOS_PER_BUS && kHandTopology.bus[1].count <= CALIB_MAX_SERVOS_PER_BUS &&
+              kHandTopology.bus[2].count <= CALIB_MAX_SERVOS_PER_BUS && kHandTopology.bus[3].count <= CALIB_MAX_SERVOS_PER_BUS,
+              "标定镜像每条总线最多记录 CALIB_MAX_SERVOS_PER_BUS 个舵机");
+
+
+// =============== 【新增】静态分配的 RTOS 对象 ===============
+// 任务栈、任务控制块、队列存储与互斥锁全部放在静态存储区（核心分配见 TaskSharedData.h），
+// 启动时不再从堆上分配，内存占用在链接时即可确定
+static StackType_t  s_upperCommStack[UPPER_COMM_TASK_STACK_SIZE];
+static StackType_t  s_canCommStack[CAN_COMM_TASK_STACK_SIZE];
+static StackType_t  s_solverStack[SOLVER_TASK_STACK_SIZE];
+static StackType_t  s_outerLoopStack[OUTER_LOOP_TASK_STACK_SIZE];
+static StaticTask_t s_upperCommTcb;
+static StaticTask_t s_canCommTcb;
+static StaticTask_t s_solverTcb;
+static StaticTask_t s_outerLoopTcb;
+
+static uint8_t       s_cmdQueueStorage[CMD_QUEUE_LEN * sizeof(ServoCommand_t)];
+static uint8_t       s_statusQueueStorage[STATUS_QUEUE_LEN * sizeof(ServoStatus_t)];
+static uint8_t       s_canRxQueueStorage[CAN_RX_QUEUE_LEN * sizeof(RemoteSensorData_t)];
+static uint8_t       s_canTxQueueStorage[CAN_TX_QUEUE_LEN * sizeof(RemoteCommand_t)];
+static StaticQueue_t s_cmdQueueBuf;
+static StaticQueue_t s_statusQueueBuf;
+static StaticQueue_t s_canRxQueueBuf;
+static StaticQueue_t s_canTxQueueBuf;
+
+static StaticSemaphore_t s_targetAnglesMutexBuf;
+
+
+// 按总线编号索引的总线表，热循环直接按下标访问（关节映射见 HandTopology.h）
+ServoBusManager* const servoBuses[NUM_BUSES] = {
+    &servoBus0, &servoBus1, &servoBus2, &servoBus3
 };
 
+// 【新增】总线事务调度器（仅由 taskSolver 调用），负责在控制周期剩余时间内执行 cmdQueue 命令和诊断
+BusScheduler busScheduler(servoBuses, NUM_BUSES, SOLVER_PERIOD_MS * 1000);
+
 
 // =============== 系统初始化函数 ===============
 void System_Init() {
@@ -63,40 +118,62 @@ void System_Init() {
 
 
     
-    // 1. 创建队列 (资源分配)
-    sharedData.cmdQueue    = xQueueCreate(5, sizeof(ServoCommand_t));
-    sharedData.statusQueue = xQueueCreate(3, sizeof(ServoStatus_t));
-    sharedData.canRxQueue  = xQueueCreate(1, sizeof(RemoteSensorData_t));
-    sharedData.canTxQueue  = xQueueCreate(5, sizeof(RemoteCommand_t));
-
-    
-    if (!sharedData.cmdQueue || !sharedData.statusQueue ||
-        !sharedData.canRxQueue || !sharedData.canTxQueue) {
-        while (1);
-    }
+    // 1. 创建队列 (静态存储，不会因堆不足而失败)
+    sharedData.cmdQueue    = xQueueCreateStatic(CMD_QUEUE_LEN, sizeof(ServoCommand_t),
+                                                s_cmdQueueStorage, &s_cmdQueueBuf);
+    sharedData.statusQueue = xQueueCreateStatic(STATUS_QUEUE_LEN, sizeof(ServoStatus_t),
+                                                s_statusQueueStorage, &s_statusQueueBuf);
+    sharedData.canRxQueue  = xQueueCreateStatic(CAN_RX_QUEUE_LEN, sizeof(RemoteSensorData_t),
+                                                s_canRxQueueStorage, &s_canRxQueueBuf);
+    sharedData.canTxQueue  = xQueueCreateStatic(CAN_TX_QUEUE_LEN, sizeof(RemoteCommand_t),
+                                                s_canTxQueueStorage, &s_canTxQueueBuf);
 
     // 【新增】创建目标角度互斥锁
-    sharedData.targetAnglesMutex = xSemaphoreCreateMutex();
-    if (!sharedData.targetAnglesMutex) {
-        while (1);
-    }
+    sharedData.targetAnglesMutex = xSemaphoreCreateMutexStatic(&s_targetAnglesMutexBuf);
+
+    busScheduler.attach(sharedData.cmdQueue, sharedData.statusQueue);
 
     // 【新增】初始化目标角度为 0（防止上电飞车）
     memset(sharedData.targetAngles, 0, sizeof(sharedData.targetAngles));
 
 
-servoBus0.begin(0, 16, 17, 1000000);  // 总线0: RX=16, TX=17, 波特率1Mbps
-servoBus1.begin(1, 18, 19, 1000000);  // 总线1: RX=18, TX=19
-servoBus2.begin(2, 20, 21, 1000000);  // 总线2: RX=20, TX=21（根据实际修改）
-servoBus3.begin(3, 22, 23, 1000000);  // 总线3: RX=22, TX=23（根据实际修改）
+    // 槽位顺序与 kHandTopology 一致，热循环可直接按槽位访问
+    const BusTopology* topo = kHandTopology.bus;
+    servoBus0.begin(0, 16, 17, topo[0].servoIDs, topo[0].count, 1000000, topo[0].models);  // 总线0: RX=16, TX=17, 波特率1Mbps
+    servoBus1.begin(1, 18, 19, topo[1].servoIDs, topo[1].count, 1000000, topo[1].models);  // 总线1: RX=18, TX=19
+    servoBus2.begin(2, 20, 21, topo[2].servoIDs, topo[2].count, 1000000, topo[2].models);  // 总线2: RX=20, TX=21（根据实际修改）
+    servoBus3.begin(3, 22, 23, topo[3].servoIDs, topo[3].count, 1000000, topo[3].models);  // 总线3: RX=22, TX=23（根据实际修改）
 
     // 【新增】初始化 AngleSolver
     int16_t zeros[ENCODER_TOTAL_NUM];
     float   ratios[ENCODER_TOTAL_NUM];
     int8_t  dirs[ENCODER_TOTAL_NUM];
 
+    // 标定数据有效时使用保存的零位，否则使用默认中位
+    bool calibValid = calibrationStore.Load();
+
+    // 标定库记录本板的总线拓扑与波特率；只有变化时才写 NVS，正常上电不擦写 Flash
+    bool calibDirty = false;
+    for (uint8_t b = 0; b < NUM_BUSES; b++) {
+        if (!calibrationStore.MatchesTopology(b, topo[b].servoIDs, topo[b].count)) {
+            calibrationStore.SetBusServos(b, topo[b].servoIDs, topo[b].count);
+            calibDirty = true;
+        }
+        CalibBusRecord* busRecord = calibrationStore.Bus(b);
+        if (busRecord->baud != servoBuses[b]->baud()) {
+            busRecord->baud = servoBuses[b]->baud();
+            calibDirty = true;
+        }
+    }
+    if (calibDirty) {
+        calibrationStore.Save();
+    }
+
     for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
-        zeros[i]  = 2048;   // 默认中位
+        const CalibServoRecord* rec = calibValid
+            ? calibrationStore.FindServo(kJointMap[i].busIndex, kJointMap[i].servoID)
+            : nullptr;
+        zeros[i]  = rec ? rec->zeroOffset : 2048;
         ratios[i] = 1.0f;
         dirs[i]   = 1;
     }
@@ -111,37 +188,214 @@ servoBus3.begin(3, 22, 23, 1000000);  // 总线3: RX=22, TX=23（根据实际修
 
 
     // 创建上位机通信任务
-    xTaskCreate(
+    taskUpperCommHandle = xTaskCreateStaticPinnedToCore(
         taskUpperComm,
         "UpperComm",
         UPPER_COMM_TASK_STACK_SIZE,
         &sharedData,
         TASK_UPPER_COMM_PRIORITY,
-        &taskUpperCommHandle
+        s_upperCommStack,
+        &s_upperCommTcb,
+        TASK_UPPER_COMM_CORE
     );
 
     // 4.3 【新增】CAN 通信任务
-    xTaskCreate(
+    taskCanCommHandle = xTaskCreateStaticPinnedToCore(
         taskCanComm,
         "CanComm",
         CAN_COMM_TASK_STACK_SIZE,
         &sharedData,
         TASK_CAN_COMM_PRIORITY,
-        &taskCanCommHandle
+        s_canCommStack,
+        &s_canCommTcb,
+        TASK_CAN_COMM_CORE
     );
 
     // 【新增】创建解算任务
-    xTaskCreate(taskSolver, 
+    taskSolverHandle = xTaskCreateStaticPinnedToCore(
+        taskSolver,
         "Solver",
-         SOLVER_TASK_STACK_SIZE, 
-         &sharedData,
-        TASK_SOLVER_PRIORITY, 
-        &taskSolverHandle);
+        SOLVER_TASK_STACK_SIZE,
+        &sharedData,
+        TASK_SOLVER_PRIORITY,
+        s_solverStack,
+        &s_solverTcb,
+        TASK_SOLVER_CORE
+    );
+
+    // 外环（磁编环）任务，与内环分开调度
+    taskOuterLoopHandle = xTaskCreateStaticPinnedToCore(
+        taskOuterLoop,
+        "OuterLoop",
+        OUTER_LOOP_TASK_STACK_SIZE,
+        &sharedData,
+        TASK_OUTER_LOOP_PRIORITY,
+        s_outerLoopStack,
+        &s_outerLoopTcb,
+        TASK_OUTER_LOOP_CORE
+    );
 
     Serial.println("✅ FreeRTOS tasks created successfully.");
     Serial.println("System ready. Commands: s(停止), r(恢复)");
 }
 
+// =============== 【新增】资源报告 ===============
+// 报告经延迟日志发出（由 UpperComm 任务排空），不在 loop 中直接写串口。
+// CPU 占用为两次报告之间该任务占单个核心的百分比（需开启 configGENERATE_RUN_TIME_STATS）
+struct TaskRuntimeSample {
+    uint32_t lastCounter;
+};
+
+static uint32_t cpuPermyriad(TaskHandle_t handle, TaskRuntimeSample &sample, uint32_t elapsed)
+{
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t counter = ulTaskGetRunTimeCounter(handle);
+    uint32_t delta = counter - sample.lastCounter;
+    sample.lastCounter = counter;
+    return elapsed ? (uint32_t)((uint64_t)delta * 10000 / elapsed) : 0;
+#else
+    return 0;
+#endif
+}
+
+template <LogFormatId ID>
+static void reportTask(TaskHandle_t handle, TaskRuntimeSample &sample, uint32_t elapsed)
+{
+    if (!handle) return;
+    uint32_t stackFree = uxTaskGetStackHighWaterMark(handle);
+    uint32_t cpu = cpuPermyriad(handle, sample, elapsed);
+    DeferredLog::Log<ID>(stackFree, cpu / 100, cpu % 100);
+}
+
+// 手处于零位姿态时（与磁编标定同时）调用：各关节当前的舵机多圈位置即零位，下次上电生效
+static void captureServoZeros()
+{
+    uint32_t captured = 0, offline = 0;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        const ServoBusManager* bus = servoBuses[kJointMap[i].busIndex];
+        uint8_t slot = kHandTopology.jointSlot[i];
+        if (!bus->isOnlineAt(slot)) {
+            offline++;
+            continue;
+        }
+        CalibServoRecord* rec = calibrationStore.EnsureServo(kJointMap[i].busIndex, kJointMap[i].servoID);
+        if (!rec) continue;
+        const int32_t limit = MultiTurnTracker::POSITION_LIMIT;
+        int32_t pos = bus->getAbsolutePositionAt(slot);
+        rec->zeroOffset = (int16_t)constrain(pos, -limit, limit);
+        captured++;
+    }
+    bool saved = (captured > 0) && calibrationStore.Save();
+    DLOG(CALIB_ZERO, captured, offline, saved ? 1u : 0u);
+}
+
+static void reportResources()
+{
+    static TaskRuntimeSample upperComm, canComm, solver, outerLoop, loop, idle[2];
+    static uint32_t lastTotal = 0;
+
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    uint32_t total = 0;
+#endif
+    uint32_t elapsed = total - lastTotal;
+    lastTotal = total;
+
+    DLOG(RES_HEAP,
+         (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT),
+         (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT),
+         (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT));
+
+    reportTask<DLOG_RES_TASK_UPPER_COMM>(taskUpperCommHandle, upperComm, elapsed);
+    reportTask<DLOG_RES_TASK_CAN_COMM>(taskCanCommHandle, canComm, elapsed);
+    reportTask<DLOG_RES_TASK_SOLVER>(taskSolverHandle, solver, elapsed);
+    reportTask<DLOG_RES_TASK_OUTER_LOOP>(taskOuterLoopHandle, outerLoop, elapsed);
+    reportTask<DLOG_RES_TASK_LOOP>(xTaskGetCurrentTaskHandle(), loop, elapsed);
+
+    for (uint8_t core = 0; core < 2; core++)
+    {
+        uint32_t cpu = cpuPermyriad(xTaskGetIdleTaskHandleForCore(core), idle[core], elapsed);
+        DLOG(RES_CORE_IDLE, core, cpu / 100, cpu % 100);
+    }
+
+    // 总线事务调度统计（控制 / 命令 / 诊断）
+    for (uint8_t c = 0; c < BUS_TX_CLASS_COUNT; c++)
+    {
+        const BusTxStats &st = busScheduler.stats(c);
+        DLOG(SCHED_CLASS_TIME, c, st.count, st.count ? st.busyUs / st.count : 0, st.maxUs);
+        DLOG(SCHED_CLASS_ERRORS, c, st.failures, st.deferred, st.dropped);
+    }
+    DLOG(SCHED_OVERRUN, busScheduler.overruns());
+
+    // 流水线总线周期：时序模型与实测对比、线路利用率
+    for (uint8_t b = 0; b < NUM_BUSES; b++)
+    {
+        const BusCycleStats &cs = servoBuses[b]->cycleStats();
+        if (cs.cycles == 0) continue;
+        uint32_t wirePerCycle = cs.wireUs / cs.cycles;
+        DLOG(BUS_CYCLE_TIME, b, cs.modelUs, cs.busyUs / cs.cycles, cs.maxUs);
+        DLOG(BUS_CYCLE_UTIL, b, wirePerCycle * 1000 / (SOLVER_PERIOD_MS * 1000),
+             cs.busyUs ? (uint32_t)((uint64_t)cs.wireUs * 1000 / cs.busyUs) : 0,
+             (cs.txBytes + cs.rxBytes) / cs.cycles);
+        DLOG(BUS_STAGE, b, cs.staged, cs.stageFailures);
+    }
+
+    const ActuationSkewStats &skew = actuationSkewStats();
+    if (skew.cycles > 0)
+    {
+        DLOG(ACT_SKEW, skew.totalUs / skew.cycles, skew.maxUs, skew.lastUs);
+    }
+
+    // 轨迹缓冲
+    TrajectoryStatus traj = trajectoryBuffer.status();
+    DLOG(TRAJ_STATUS, traj.queued, traj.bufferedUs / 1000, traj.segments);
+    DLOG(TRAJ_ERRORS, traj.underruns, traj.overflows);
+
+    // 流式目标点：丢包/迟到/欠载与实测播放延迟
+    const SetpointStreamStats &jb = setpointBuffer.stats();
+    if (jb.received > 0)
+    {
+        DLOG(JB_STREAM, jb.received, jb.lost, jb.late, jb.underrunTicks);
+        DLOG(JB_TIMING, jb.jitterUs, setpointBuffer.playoutDelay() / 1000, jb.waitAvgUs, jb.waitMaxUs);
+    }
+
+    // 多速率控制：外环更新次数与内环使用的修正量年龄
+    const OuterLoopStats &outer = outerLoopStats();
+    DLOG(OUTER_LOOP, outer.updates, outer.idleTicks, outer.maxAgeMs);
+
+    // 磁编信号调理：无效读数、毛刺与重新锁定
+    const EncoderConditionerStats &enc = encoderConditioner.stats();
+    DLOG(ENC_COND, enc.invalid, enc.glitches, enc.relocks, enc.invalidMask);
+
+    // 关节降级模式
+    const JointModeStats &modes = jointModeSelector.stats();
+    DLOG(JOINT_MODE, jointModeSelector.servoOnlyMask(), jointModeSelector.holdMask(),
+         modes.transitions, modes.servoOnlyTicks + modes.holdTicks);
+
+    // 舵机跟踪误差（速度/加速度前馈的效果）
+    const TrackingStats &track = trackingStats();
+    if (track.cycles > 0)
+    {
+        DLOG(TRACKING, track.avgErrSteps, track.maxErrSteps, track.speedSaturated);
+    }
+
+    // 过载/堵转保护
+    const LoadProtectionStats &load = loadProtector.stats();
+    DLOG(LOAD_PROTECT, loadProtector.derateMask(), loadProtector.cutMask(), load.peakLoad, load.peakHeatPct);
+    if (load.derates + load.cuts > 0)
+    {
+        DLOG(LOAD_EVENTS, load.derates, load.cuts, load.releases);
+    }
+
+    // 柔顺控制（力矩模式关节）
+    const ComplianceStats &comp = complianceStats();
+    if (angleSolver.complianceMask() | comp.activeMask)
+    {
+        DLOG(COMPLIANCE, angleSolver.complianceMask(), comp.activeMask, comp.modeRequests, comp.saturated);
+    }
+}
+
 // =============== 主循环函数 ===============
 void System_Loop() {
     static uint32_t lastPrintTime = 0;
@@ -152,6 +406,19 @@ void System_Loop() {
     //     printCanMonitor(); // 若需此函数，请将其移到 UpperCommTask 或单独文件
     // }
 
+    // 【新增】周期性资源报告（栈余量/堆/CPU 占用）
+    static uint32_t lastReportTime = 0;
+    if (millis() - lastReportTime >= RESOURCE_REPORT_PERIOD_MS) {
+        lastReportTime = millis();
+        reportResources();
+    }
+
+    // 标定请求：记录零位并写入 NVS（擦写 Flash 耗时较长，放在最低优先级的 loop 中执行）
+    if (g_zeroCaptureRequest) {
+        g_zeroCaptureRequest = 0;
+        captureServoZeros();
+    }
+
     // 必须保留延时，防止触发看门狗！
     vTaskDelay(pdMS_TO_TICKS(10));
 }
\ No newline at end of file
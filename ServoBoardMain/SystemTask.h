@@ -21,6 +21,10 @@
 
 // 全局状态标志位（跨任务共享）
 extern volatile uint8_t g_calibrationUIStatus;
+extern volatile uint8_t g_servoStopRequest;
+extern volatile uint32_t g_servoStopRequestUs;
+extern volatile uint32_t g_servoStopLatencyUs;
+extern volatile uint8_t g_zeroCaptureRequest;
 
 // 系统初始化函数（替代 setup() 中的逻辑）
 void System_Init();
@@ -7,6 +7,7 @@
 #include "ServoManager.h"
 #include <freertos/semphr.h>  // 【新增】互斥锁头文件
 #include "CanCommTask.h"
+#include "SeqlockMailbox.h"
 
 
 
@@ -21,16 +22,146 @@
 #define TWAI_RX_PIN 48  // 请根据实际 P4 硬件连接修改
 
 
+// --- 【新增】舵机急停请求（g_servoStopRequest 取值） ---
+// 单字节写入，可在任意任务或中断中置位，由 taskSolver 在下一个周期开始时执行；
+// 置位急停前先写 g_servoStopRequestUs = micros()，急停耗时从该时刻起算。
+// 置位急停后再对 taskSolverHandle 发任务通知（xTaskNotifyGive，中断中用 vTaskNotifyGiveFromISR），
+// taskSolver 在周期间隔中被唤醒后立即执行，不等下一周期
+#define SERVO_STOP_NONE     0
+#define SERVO_STOP_REQUEST  1   // 所有总线立即关闭扭矩
+#define SERVO_RESUME_REQUEST 2  // 重新打开扭矩，恢复闭环控制
+
+
 // 任务优先级定义
 #define TASK_UPPER_COMM_PRIORITY 1
 // #define TASK_SERVO_CTRL_PRIORITY 2  //已弃用
 #define TASK_CAN_COMM_PRIORITY   3  // 【新增】CAN通信优先级
 #define TASK_SOLVER_PRIORITY      4   // 【新增】解算任务优先级（最高，保证实时性）
+#define TASK_OUTER_LOOP_PRIORITY  3   // 外环（磁编环），与 CAN 任务同核同级
+
+// ============ 【新增】任务核心分配 ============
+// 核心 1：解算任务（含 4 条舵机总线的同步读写），独占控制核心
+// 核心 0：上位机 USB 串口与 CAN(TWAI) 通信，与控制环隔离
+#define TASK_SOLVER_CORE          1
+#define TASK_CAN_COMM_CORE        0
+#define TASK_UPPER_COMM_CORE      0
+#define TASK_OUTER_LOOP_CORE      0   // 外环只依赖 CAN 数据，不占用控制核心
+
+// 多速率级联控制：
+//   内环（舵机环）在 taskSolver 中以 SOLVER_PERIOD_MS 运行，受总线时间限制，
+//     可根据任务统计包/总线周期统计中的余量提高控制频率；
+//   外环（磁编环）在 taskOuterLoop 中以 OUTER_LOOP_PERIOD_MS 检查新的磁编样本，
+//     只在掌部板发来新样本时更新，修正量经无锁邮箱交给内环，内环从不等待 CAN。
+//     外环轮询比内环快并不是为了更高的控制频率：磁编样本与内环周期不同步到达，
+//     轮询间隔越短，样本到达后越早发布，内环下一周期取到的修正量越新
+#define SOLVER_PERIOD_MS          10
+#define OUTER_LOOP_PERIOD_MS      5
+
+// 轨迹缓冲（上位机下发样条段/路径点，外环按周期插值，见 TrajectoryBuffer.h）
+#define TRAJ_SEGMENT_CAPACITY     32    // 段数（2 的幂）
+#define TRAJ_STATUS_PERIOD_MS     20    // 启用轨迹时上行缓冲状态包的周期（上位机据此流控）
+
+// 流式目标点抖动缓冲（SetpointJitterBuffer）
+#define SETPOINT_ARRIVAL_QUEUE_LEN  8     // 通信任务 -> 外环的到达队列（2 的幂）
+#define SETPOINT_JITTER_CAPACITY    16    // 待播放的目标点数
+#define SETPOINT_PLAYOUT_DELAY_MS   30    // 默认播放延迟（上位机可通过下行帧修改）
+#define SETPOINT_OFFSET_WINDOW      128   // 时钟偏移最小值的窗口长度（包数）
+
+// 磁编信号调理（EncoderConditioner，外环使用前对 21 路磁编统一处理）
+#define ENC_COUNTS_PER_REV          16384 // 14 位磁编
+#define ENC_GLITCH_MAX_STEP         1024  // 相邻样本的最大合理变化（计数，约 22.5°），超过视为毛刺
+#define ENC_GLITCH_RELOCK           3     // 连续这么多个相互一致的“毛刺”后接受为新位置
+#define ENC_IIR_ALPHA               0.5f  // 中值滤波后的一阶低通系数（1.0 关闭低通）
+#define ENC_VALID_ALL               ((1UL << ENCODER_TOTAL_NUM) - 1)
+
+// 关节降级模式（JointModeSelector，外环按磁编有效性与样本年龄逐关节选择）
+#define JOINT_MODE_FULL             0     // 级联：磁编外环 + 舵机内环
+#define JOINT_MODE_SERVO_ONLY       1     // 磁编不可用：以舵机角度 + 失效时记录的偏差代替磁编角度
+#define JOINT_MODE_HOLD             2     // 无法估计（舵机离线/从未有过有效磁编）：冻结舵机目标
+#define ENC_SAMPLE_MAX_AGE_MS       50    // 磁编样本超过此年龄时全部关节视为磁编无效
+#define SERVO_SNAPSHOT_MAX_AGE_MS   (3 * SOLVER_PERIOD_MS)  // 舵机角度快照的最大年龄
+
+// 舵机目标生效方式
+//   SERVO_ACTUATION_SYNC   ：各总线的 SYNC_WRITE 依次发出，帧一收完即生效，
+//                            各总线帧长不同、发出时刻不同，总线间存在生效偏斜
+//   SERVO_ACTUATION_ACTION ：先在各总线上逐个 REG_WRITE 暂存目标（多条总线交错进行），
+//                            再背靠背广播 ACTION，全部关节同时生效；每周期多占用约
+//                            舵机数 × (帧 + 应答) 的总线时间
+#define SERVO_ACTUATION_SYNC      0
+#define SERVO_ACTUATION_ACTION    1
+#define SERVO_ACTUATION_MODE      SERVO_ACTUATION_ACTION
+
+// 舵机速度/加速度前馈（AngleSolver::computeProfile，逐关节计算见 ServoProfile.h）
+//   写入块中的速度/加速度是舵机内部梯形规划的上限。开启时逐关节计算：
+//   速度 = 目标速度（轨迹导数或每周期目标变化量）+ 跟踪误差 / 追赶时间，
+//   加速度 = 目标加速度与“舵机当前速度 -> 所需速度”在追赶时间内完成所需加速度的大者，
+//   乘以余量后只在需要时抬高上限（不超过型号的 maxSpeed/maxAcc，见 ServoModel.h）；关闭时固定为默认值
+#define SERVO_FEEDFORWARD_ENABLE  1
+#define SERVO_FF_CATCHUP_S        0.05f   // 跟踪误差的追赶时间 (s)
+#define SERVO_DEFAULT_SPEED       1000    // 步/s，同时是前馈的下限
+#define SERVO_DEFAULT_ACC         50      // ×100 步/s²，同时是前馈的下限
+#define SERVO_FF_MARGIN           1.25f
+
+// 过载/堵转保护（LoadProtector，每个控制周期按同步读回的负载逐关节计算）
+//   负载单位为最大力矩的 0.1%（0-1000）。热量按 I²t 累计：每秒增加 (负载/持续负载)² - 1，
+//   不低于 0；达到降额阈值后把舵机 RAM 区力矩限制降到降额值，降额后仍继续升温
+//   （被外力反拖或型号没有力矩限制寄存器）到关扭矩阈值时关闭扭矩。
+//   关扭矩后热量降到降额阈值以下先以降额力矩恢复，降到 降额阈值 × 释放比例 以下解除降额。
+//   以下为默认值，上位机可逐关节修改
+#define LOAD_PROTECT_ENABLE       1
+#define LOAD_CONT_DEFAULT         500     // 可持续负载 (0.1%)
+#define LOAD_DERATE_TORQUE_DEFAULT 400    // 降额后的力矩限制 (0.1%)，应低于可持续负载
+#define LOAD_DERATE_HEAT_S        1.0f    // 降额阈值（满负载堵转约 0.33s 达到）
+#define LOAD_CUT_HEAT_S           3.0f    // 关扭矩阈值
+#define LOAD_RELEASE_RATIO        0.5f
+
+// 柔顺（阻抗）控制（AngleSolver::computeCompliance，仅对有力矩模式的型号如 HLS 有效）
+//   力矩 = 刚度 × (目标 - 舵机角度) + 阻尼 × (目标速度 - 舵机速度)，限制在 ±最大力矩，
+//   写入位置模式使用的同一写入块的目标力矩字段，不增加总线字节。逐关节选择，
+//   舵机运行模式在 EPROM 中，切换由 BusScheduler 在周期剩余时间内完成，确认后才按力矩控制。
+//   每次切换要写 3 次 EPROM（解锁、运行模式、加锁），EPROM 的擦写寿命有限：同一关节两次切换
+//   至少间隔 COMPLIANCE_MODE_MIN_INTERVAL_CYCLES，间隔内的改变延后到间隔结束（按最后的要求），
+//   连续 COMPLIANCE_MODE_MAX_RETRIES 次未确认后不再重试，直到要求的模式改变
+#define COMPLIANCE_STIFFNESS_DEFAULT  20.0f   // 目标力矩单位 / °（舵机角度）
+#define COMPLIANCE_DAMPING_DEFAULT    0.5f    // 目标力矩单位 / (°/s)
+#define COMPLIANCE_TORQUE_MAX_DEFAULT 500     // 目标力矩上限（HLS 目标力矩寄存器单位）
+#define COMPLIANCE_MODE_RETRY_CYCLES  50      // 模式切换未确认时重新提交的间隔（控制周期）
+#define COMPLIANCE_MODE_MIN_INTERVAL_CYCLES 200 // 同一关节两次模式切换的最小间隔（控制周期，约 2s）
+#define COMPLIANCE_MODE_MAX_RETRIES   5       // 连续未确认的提交次数上限
+
+// ============ 【新增】总线事务调度 ============
+// 每个控制周期末尾为下一周期的控制事务预留的时间，后台事务必须在此之前结束
+#define BUS_SCHED_GUARD_US        1000
+#define BUS_SCHED_PENDING_PER_BUS 8     // 每条总线待执行的后台事务上限
+#define BUS_SCHED_DIAG_PERIOD_MS  200   // 诊断轮询（电压/温度/负载）间隔，每次一个舵机
+#define BUS_SCHED_REFRESH_PERIOD_MS 500 // 寄存器缓存刷新间隔，每次一条总线的一个配置段
+
+// ============ 【新增】任务统计上报 ============
+#define TASK_STATS_PERIOD_MS      1000  // 上行任务统计包 (Type 0x04) 周期
+// 统计包中的任务编号
+#define TASK_STAT_UPPER_COMM      0
+#define TASK_STAT_CAN_COMM        1
+#define TASK_STAT_SOLVER          2
+#define TASK_STAT_IDLE_CORE0      3
+#define TASK_STAT_IDLE_CORE1      4
+#define TASK_STAT_OUTER_LOOP      5
+#define TASK_STAT_COUNT           6
 
 // ============ 任务堆栈 ============
 #define UPPER_COMM_TASK_STACK_SIZE 8192
 #define CAN_COMM_TASK_STACK_SIZE   4096
 #define SOLVER_TASK_STACK_SIZE     8192  // 【新增】解算任务堆栈
+#define OUTER_LOOP_TASK_STACK_SIZE 4096  // 外环任务堆栈
+// 以上均为字节数（ESP-IDF 的 StackType_t 为 uint8_t），可按资源报告中的栈余量调整
+
+// ============ 队列深度 ============
+#define CMD_QUEUE_LEN       5
+#define STATUS_QUEUE_LEN    3
+#define CAN_RX_QUEUE_LEN    1     // 只保留最新一帧（xQueueOverwrite/Peek）
+#define CAN_TX_QUEUE_LEN    5
+
+// ============ 资源报告 ============
+#define RESOURCE_REPORT_PERIOD_MS  5000  // 栈余量/堆/CPU 占用报告周期
 
 
 
@@ -52,13 +183,40 @@ typedef struct {
     bool     isValid;
 } RemoteSensorData_t;
 
-// 舵机指令
+// 外环输出：各关节的修正量（外环 PID 输出，内环目标 = 修正量 + 舵机当前角度）
+// 与目标的导数（轨迹/流式目标点给出，快照为 0），由内环换算为舵机的速度/加速度上限
+typedef struct {
+    float    corrections[ENCODER_TOTAL_NUM];
+    float    velocity[ENCODER_TOTAL_NUM];      // °/s
+    float    accel[ENCODER_TOTAL_NUM];         // °/s²
+    uint32_t sampleTime;    // 所用磁编样本的时间戳 (millis)，0 表示尚无样本
+    uint32_t servoOnlyMask; // JOINT_MODE_SERVO_ONLY 的关节（位 i = 关节 i）
+    uint32_t holdMask;      // JOINT_MODE_HOLD 的关节
+} OuterLoopOutput_t;
+
+// 舵机角度快照：有关节降级时由内环发布，外环据此估计磁编失效关节的角度
+typedef struct {
+    float    degs[ENCODER_TOTAL_NUM];    // 舵机多圈角度 (°)
+    uint32_t onlineMask;                 // 在线的舵机（按关节）
+    uint32_t timeMs;
+} ServoAngleSnapshot_t;
+
+// 舵机指令（经 cmdQueue 交给 BusScheduler，在控制周期剩余的总线时间内执行）
+#define SERVO_CMD_MOVE          0x01  // position/speed（控制环运行时会被下一周期覆盖）
+#define SERVO_CMD_TORQUE        0x02  // position: 0 关闭扭矩，非 0 打开
+#define SERVO_CMD_WRITE_REG     0x03  // 写 RAM 区寄存器 regAddr = regValue
+#define SERVO_CMD_WRITE_EPROM   0x04  // 写 EPROM 区寄存器（自动解锁/加锁）
+#define SERVO_CMD_READ_STATUS   0x05  // 读取位置/速度/负载/电压/温度，结果放入 statusQueue
+#define SERVO_CMD_CTRL_MODE     0x06  // position: SERVO_CTRL_*（运行模式在 EPROM，自动解锁/加锁）
+
 typedef struct {
     uint8_t cmdType;
     uint8_t servoId;
     int16_t position;
     uint16_t speed;
     uint8_t busIndex;
+    uint8_t regAddr;      // 【新增】SERVO_CMD_WRITE_REG / SERVO_CMD_WRITE_EPROM 使用
+    uint8_t regValue;
 } ServoCommand_t;
 
 // 舵机状态
@@ -84,6 +242,11 @@ typedef struct {
     // 由 UpperCommTask 写入，由 taskSolver 读取
     float targetAngles[ENCODER_TOTAL_NUM];
     SemaphoreHandle_t targetAnglesMutex;
+
+    // 控制环数据通路（无锁邮箱，只保留最新一份；canRxQueue 仍供上位机上传使用）
+    SeqlockMailbox<RemoteSensorData_t> sensorMailbox;   // CanCommTask -> taskOuterLoop
+    SeqlockMailbox<OuterLoopOutput_t>  outerMailbox;    // taskOuterLoop -> taskSolver
+    SeqlockMailbox<ServoAngleSnapshot_t> servoMailbox;  // taskSolver -> taskOuterLoop（仅有关节降级时）
 } TaskSharedData_t;
 
 #endif
\ No newline at end of file
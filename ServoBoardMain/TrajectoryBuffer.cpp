@@ -0,0 +1,222 @@
+#include "TrajectoryBuffer.h"
+#include <string.h>
+
+TrajectoryBuffer::TrajectoryBuffer()
+    : _head(0), _tail(0), _queuedUs(0), _flushRequest(TRAJ_FLUSH_NONE), _flushCount(0),
+      _hasLastWaypoint(false), _seenFlushCount(0), _engaged(false), _active(false),
+      _segStartUs(0), _segDurationUs(0), _durationS(0.0f),
+      _segments(0), _underruns(0), _overflows(0), _remainingUs(0), _engagedFlag(0)
+{
+    memset(_lastWaypoint, 0, sizeof(_lastWaypoint));
+    memset(_coef, 0, sizeof(_coef));
+    memset(_endPos, 0, sizeof(_endPos));
+    memset(_endVel, 0, sizeof(_endVel));
+    memset(_endAcc, 0, sizeof(_endAcc));
+}
+
+/* ==================== 生产者 ==================== */
+
+bool TrajectoryBuffer::push(const TrajectorySegment& seg) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= TRAJ_SEGMENT_CAPACITY) {
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    TrajectorySegment& slot = _ring[head & (TRAJ_SEGMENT_CAPACITY - 1)];
+    slot = seg;
+    if (slot.durationUs < TRAJ_MIN_DURATION_US) slot.durationUs = TRAJ_MIN_DURATION_US;
+    _queuedUs.fetch_add(slot.durationUs, std::memory_order_relaxed);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+uint8_t TrajectoryBuffer::pushWaypoints(const float* points, uint8_t count, uint32_t intervalUs) {
+    if (intervalUs < TRAJ_MIN_DURATION_US) intervalUs = TRAJ_MIN_DURATION_US;
+    float dt = intervalUs * 1e-6f;
+
+    // 上次追加之后有过清空：上一个点已不在轨迹上，不再用于差分
+    uint32_t flushes = _flushCount.load(std::memory_order_acquire);
+    if (flushes != _seenFlushCount) {
+        _seenFlushCount = flushes;
+        _hasLastWaypoint = false;
+    }
+
+    TrajectorySegment seg;
+    seg.type = TRAJ_SEGMENT_CUBIC;
+    seg.durationUs = intervalUs;
+    memset(seg.acc, 0, sizeof(seg.acc));
+
+    uint8_t pushed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const float* cur = points + i * ENCODER_TOTAL_NUM;
+        const float* prev = (i > 0) ? cur - ENCODER_TOTAL_NUM : (_hasLastWaypoint ? _lastWaypoint : cur);
+        for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+            seg.pos[j] = cur[j];
+            // 中间点：中心差分；最后一点：单侧差分
+            seg.vel[j] = (i + 1 < count) ? (cur[j + ENCODER_TOTAL_NUM] - prev[j]) / (2.0f * dt)
+                                         : (cur[j] - prev[j]) / dt;
+        }
+        if (!push(seg)) break;
+        memcpy(_lastWaypoint, cur, sizeof(_lastWaypoint));
+        _hasLastWaypoint = true;
+        pushed++;
+    }
+    return pushed;
+}
+
+void TrajectoryBuffer::requestFlush(bool hold) {
+    _flushRequest.store(hold ? TRAJ_FLUSH_HOLD : TRAJ_FLUSH_RELEASE, std::memory_order_release);
+    _flushCount.fetch_add(1, std::memory_order_release);
+}
+
+/* ==================== 消费者 ==================== */
+
+// 取出下一段，以当前终点状态为起点计算系数（归一化时间 s = t / T）
+bool TrajectoryBuffer::_activate(uint32_t startUs) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+
+    const TrajectorySegment& seg = _ring[tail & (TRAJ_SEGMENT_CAPACITY - 1)];
+    float T = seg.durationUs * 1e-6f;
+    float T2 = T * T;
+    bool quintic = (seg.type == TRAJ_SEGMENT_QUINTIC);
+
+    for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        float p0 = _endPos[j], v0 = _endVel[j] * T, a0 = _endAcc[j] * T2;
+        float d  = seg.pos[j] - p0;
+        float v1 = seg.vel[j] * T;
+        _coef[0][j] = p0;
+        _coef[1][j] = v0;
+        if (quintic) {
+            float a1 = seg.acc[j] * T2;
+            _coef[2][j] = 0.5f * a0;
+            _coef[3][j] =  10.0f * d - 6.0f * v0 - 4.0f * v1 - 0.5f * (3.0f * a0 - a1);
+            _coef[4][j] = -15.0f * d + 8.0f * v0 + 7.0f * v1 + 0.5f * (3.0f * a0 - 2.0f * a1);
+            _coef[5][j] =   6.0f * d - 3.0f * v0 - 3.0f * v1 - 0.5f * (a0 - a1);
+            _endAcc[j] = seg.acc[j];
+        } else {
+            // 三次 Hermite：起点加速度不受约束，终点加速度由系数求出，交给下一段
+            _coef[2][j] =  3.0f * d - 2.0f * v0 - v1;
+            _coef[3][j] = -2.0f * d + v0 + v1;
+            _coef[4][j] = 0.0f;
+            _coef[5][j] = 0.0f;
+            _endAcc[j] = (2.0f * _coef[2][j] + 6.0f * _coef[3][j]) / T2;
+        }
+        _endPos[j] = seg.pos[j];
+        _endVel[j] = seg.vel[j];
+    }
+
+    _segStartUs = startUs;
+    _segDurationUs = seg.durationUs;
+    _durationS = T;
+    _active = true;
+    _queuedUs.fetch_sub(seg.durationUs, std::memory_order_relaxed);
+    _tail.store(tail + 1, std::memory_order_release);
+    _segments.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// 停在当前终点，速度/加速度归零（下一段从静止开始）
+void TrajectoryBuffer::_hold() {
+    _active = false;
+    memset(_endVel, 0, sizeof(_endVel));
+    memset(_endAcc, 0, sizeof(_endAcc));
+}
+
+bool TrajectoryBuffer::sample(uint32_t nowUs, float* pos, float* vel, float* acc) {
+    // 1. 清空请求：丢弃队列中的段
+    uint8_t flush = _flushRequest.exchange(TRAJ_FLUSH_NONE, std::memory_order_acquire);
+    if (flush != TRAJ_FLUSH_NONE) {
+        uint32_t head = _head.load(std::memory_order_acquire);
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        for (; tail != head; tail++) {
+            _queuedUs.fetch_sub(_ring[tail & (TRAJ_SEGMENT_CAPACITY - 1)].durationUs, std::memory_order_relaxed);
+        }
+        _tail.store(tail, std::memory_order_release);
+
+        if (flush == TRAJ_FLUSH_HOLD && _engaged) {
+            // 停在当前输出：以本时刻的位置作为终点
+            if (_active) {
+                float s = (float)(nowUs - _segStartUs) / _segDurationUs;
+                if (s > 1.0f) s = 1.0f;
+                for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+                    _endPos[j] = _coef[0][j] + s * (_coef[1][j] + s * (_coef[2][j] +
+                                 s * (_coef[3][j] + s * (_coef[4][j] + s * _coef[5][j]))));
+                }
+            }
+            _hold();
+        } else {
+            _engaged = false;
+            _active = false;
+        }
+    }
+
+    // 2. 未启用时跟随快照；有新段时以快照为起点启用
+    if (!_engaged) {
+        memcpy(_endPos, pos, sizeof(_endPos));
+        _hold();
+        if (!_activate(nowUs)) {
+            memset(vel, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+            memset(acc, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+            _engagedFlag.store(0, std::memory_order_relaxed);
+            _remainingUs.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        _engaged = true;
+        _engagedFlag.store(1, std::memory_order_relaxed);
+    } else if (!_active) {
+        // 停住期间收到新段：从现在开始
+        _activate(nowUs);
+    }
+
+    // 3. 当前段结束则首尾相接切到下一段；缓冲耗尽则停在终点
+    while (_active && nowUs - _segStartUs >= _segDurationUs) {
+        uint32_t endUs = _segStartUs + _segDurationUs;
+        if (!_activate(endUs)) {
+            bool moving = false;
+            for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+                moving |= (_endVel[j] != 0.0f);
+            }
+            if (moving) _underruns.fetch_add(1, std::memory_order_relaxed);
+            _hold();
+        }
+    }
+
+    if (!_active) {
+        memcpy(pos, _endPos, sizeof(_endPos));
+        memset(vel, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+        memset(acc, 0, sizeof(float) * ENCODER_TOTAL_NUM);
+        _remainingUs.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 4. 插值：Horner 形式，逐系数对全部关节循环（结构化数组，便于编译器向量化）
+    uint32_t elapsed = nowUs - _segStartUs;
+    float s = (float)elapsed / _segDurationUs;
+    float invT = 1.0f / _durationS;
+    float invT2 = invT * invT;
+    for (uint8_t j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        pos[j] = _coef[0][j] + s * (_coef[1][j] + s * (_coef[2][j] +
+                 s * (_coef[3][j] + s * (_coef[4][j] + s * _coef[5][j]))));
+        vel[j] = (_coef[1][j] + s * (2.0f * _coef[2][j] + s * (3.0f * _coef[3][j] +
+                 s * (4.0f * _coef[4][j] + s * 5.0f * _coef[5][j])))) * invT;
+        acc[j] = (2.0f * _coef[2][j] + s * (6.0f * _coef[3][j] +
+                 s * (12.0f * _coef[4][j] + s * 20.0f * _coef[5][j]))) * invT2;
+    }
+    _remainingUs.store(_segDurationUs - elapsed, std::memory_order_relaxed);
+    return true;
+}
+
+TrajectoryStatus TrajectoryBuffer::status() const {
+    TrajectoryStatus st;
+    uint32_t head = _head.load(std::memory_order_acquire);
+    uint32_t tail = _tail.load(std::memory_order_acquire);
+    st.engaged    = _engagedFlag.load(std::memory_order_relaxed);
+    st.queued     = (uint8_t)(head - tail);
+    st.bufferedUs = _queuedUs.load(std::memory_order_relaxed) + _remainingUs.load(std::memory_order_relaxed);
+    st.segments   = _segments.load(std::memory_order_relaxed);
+    st.underruns  = _underruns.load(std::memory_order_relaxed);
+    st.overflows  = _overflows.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,117 @@
+#ifndef TRAJECTORY_BUFFER_H
+#define TRAJECTORY_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+#include "TaskSharedData.h"
+
+/* ==================== 轨迹缓冲 ==================== */
+
+// 上位机一次下发一段或几段样条（终点状态 + 时长），板上按控制周期插值 21 个关节：
+// - 段首尾相接排在设备时间轴上，上位机只需保证缓冲不空，USB 抖动不再直接变成目标台阶；
+// - 每段的起点是上一段的实际终点（位置/速度/加速度），系数在段生效时由消费者计算，
+//   因此清空、断流后重新开始都从当前输出平滑衔接；
+// - 生产者 (UpperCommTask) 与消费者 (taskOuterLoop) 之间为单生产者单消费者无锁环形队列。
+//
+// 单位：位置 °，速度 °/s，加速度 °/s²
+
+#define TRAJ_SEGMENT_CUBIC     0   // 三次 Hermite：终点位置 + 速度
+#define TRAJ_SEGMENT_QUINTIC   1   // 五次：终点位置 + 速度 + 加速度
+
+#define TRAJ_MIN_DURATION_US   1000    // 段时长下限（过短的段按此处理）
+
+#define TRAJ_FLUSH_NONE        0
+#define TRAJ_FLUSH_HOLD        1   // 清空并停在当前输出
+#define TRAJ_FLUSH_RELEASE     2   // 清空并交还给 targetAngles 快照
+
+static_assert((TRAJ_SEGMENT_CAPACITY & (TRAJ_SEGMENT_CAPACITY - 1)) == 0, "轨迹缓冲容量必须为 2 的幂");
+
+struct TrajectorySegment {
+    uint8_t  type;                           // TRAJ_SEGMENT_*
+    uint32_t durationUs;
+    float    pos[ENCODER_TOTAL_NUM];
+    float    vel[ENCODER_TOTAL_NUM];
+    float    acc[ENCODER_TOTAL_NUM];         // 仅五次段使用
+};
+
+// 缓冲状态（上行状态包与资源报告使用）
+struct TrajectoryStatus {
+    uint8_t  engaged;       // 是否由轨迹提供目标（否则使用 targetAngles 快照）
+    uint8_t  queued;        // 队列中未开始的段数
+    uint32_t bufferedUs;    // 队列 + 当前段剩余的时长
+    uint32_t segments;      // 累计执行的段数
+    uint32_t underruns;     // 运动中（终点速度非零）缓冲耗尽的次数
+    uint32_t overflows;     // 队列已满被拒绝的段数
+};
+
+class TrajectoryBuffer {
+public:
+    TrajectoryBuffer();
+
+    /* ========== 生产者（上位机通信任务） ========== */
+
+    // 追加一段，队列已满时返回 false
+    bool push(const TrajectorySegment& seg);
+
+    /**
+     * @brief 追加一串等间隔路径点（每个 ENCODER_TOTAL_NUM 个位置），转为三次段
+     * 中间点速度取相邻两点的中心差分，最后一点取单侧差分（继续流式下发时保持连续），
+     * 需要停在最后一点时，上位机再补发一个相同的点
+     * @return 实际入队的点数
+     */
+    uint8_t pushWaypoints(const float* points, uint8_t count, uint32_t intervalUs);
+
+    // 请求清空：hold = true 时停在当前输出，否则交还给 targetAngles 快照（下一次 sample 时生效）
+    // 任意任务可调用：只写原子量，生产者下次追加路径点时自行丢弃差分用的上一个点
+    void requestFlush(bool hold);
+
+    /* ========== 消费者（外环任务） ========== */
+
+    /**
+     * @brief 计算 nowUs 时刻各关节的目标位置、速度与加速度（结构化数组，逐系数对全部关节循环）
+     * @param pos 输入：当前的 targetAngles 快照（未启用轨迹时作为第一段的起点）；输出：轨迹位置
+     * @param vel/acc 输出：轨迹的一阶/二阶导数，作为舵机速度/加速度前馈
+     * @return false 未启用轨迹，pos 保持不变，vel/acc 为 0
+     */
+    bool sample(uint32_t nowUs, float* pos, float* vel, float* acc);
+
+    // 状态快照（任意任务可调用，各字段独立读取）
+    TrajectoryStatus status() const;
+
+private:
+    /* 环形队列（容量为 2 的幂） */
+    TrajectorySegment _ring[TRAJ_SEGMENT_CAPACITY];
+    std::atomic<uint32_t> _head;         // 生产者写位置
+    std::atomic<uint32_t> _tail;         // 消费者读位置
+    std::atomic<uint32_t> _queuedUs;     // 队列中段的总时长
+    std::atomic<uint8_t>  _flushRequest; // TRAJ_FLUSH_*
+    std::atomic<uint32_t> _flushCount;   // 清空请求计数，生产者据此得知发生过清空
+
+    /* 生产者私有：上一个路径点，用于中心差分 */
+    float    _lastWaypoint[ENCODER_TOTAL_NUM];
+    bool     _hasLastWaypoint;
+    uint32_t _seenFlushCount;
+
+    /* 消费者私有 */
+    bool     _engaged;
+    bool     _active;                     // 是否有正在执行的段
+    uint32_t _segStartUs;
+    uint32_t _segDurationUs;
+    float    _durationS;
+    float    _coef[6][ENCODER_TOTAL_NUM]; // 归一化时间 s ∈ [0,1] 上的多项式系数
+    float    _endPos[ENCODER_TOTAL_NUM];  // 当前段终点（即下一段起点）
+    float    _endVel[ENCODER_TOTAL_NUM];
+    float    _endAcc[ENCODER_TOTAL_NUM];
+
+    /* 统计（消费者写，其他任务读） */
+    std::atomic<uint32_t> _segments;
+    std::atomic<uint32_t> _underruns;
+    std::atomic<uint32_t> _overflows;
+    std::atomic<uint32_t> _remainingUs;
+    std::atomic<uint8_t>  _engagedFlag;
+
+    bool _activate(uint32_t startUs);
+    void _hold();
+};
+
+#endif // TRAJECTORY_BUFFER_H
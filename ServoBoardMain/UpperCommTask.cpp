@@ -1,12 +1,62 @@
 #include "UpperCommTask.h"
 #include "CanCommTask.h"
+#include "DeferredLog.h"
+#include "TrajectoryBuffer.h"
+#include "SetpointJitterBuffer.h"
+#include "LoadProtector.h"
+#include "AngleSolver.h"
 extern volatile uint8_t g_calibrationUIStatus;
+extern volatile uint8_t g_servoStopRequest;
+extern volatile uint32_t g_servoStopRequestUs;
+extern volatile uint8_t g_zeroCaptureRequest;
+extern TaskSharedData_t sharedData;
+extern TaskHandle_t taskUpperCommHandle;
+extern TaskHandle_t taskCanCommHandle;
+extern TaskHandle_t taskSolverHandle;
+extern TaskHandle_t taskOuterLoopHandle;
+extern TrajectoryBuffer trajectoryBuffer;
+extern SetpointJitterBuffer setpointBuffer;
+extern LoadProtector loadProtector;
 
 // --- 协议定义 ---
 #define PROTOCOL_HEADER 0xFE
 #define PROTOCOL_TAIL 0xFF
 #define PACKET_TYPE_SENSOR 0x01
 #define PACKET_TYPE_CALIB_ACK 0x02
+#define PACKET_TYPE_LOG 0x03       // 【新增】延迟日志（格式编号 + 参数，由上位机查 LogFormats.h 格式化）
+#define PACKET_TYPE_TASK_STATS 0x04 // 【新增】任务运行时间统计
+#define PACKET_TYPE_TRAJ_STATUS 0x05 // 轨迹缓冲状态（上位机据此流控）
+
+// --- 下行帧: [FE][LEN][TYPE][PAYLOAD...][SUM][FF]，LEN = TYPE + PAYLOAD + SUM + TAIL，
+//     SUM = ~(LEN + TYPE + PAYLOAD 各字节)，LEN 必须与该类型的负载长度一致 ---
+// 急停 's' / 恢复 'r' 在帧解析之前处理，任何时候都立即生效：帧头之后的 's'、'r' 与转义字节本身
+// 以 [7D][原字节 ^ 0x20] 发送（LEN/SUM 按转义前计算）。帧外的 'c'/0xCA 仍为单字节指令
+#define DOWN_ESCAPE              0x7D
+#define DOWN_ESCAPE_XOR          0x20
+#define DOWN_TYPE_TRAJ_CUBIC     0x10  // [DUR_MS(2)] + 21 × [POS(2) VEL(2)]
+#define DOWN_TYPE_TRAJ_QUINTIC   0x11  // [DUR_MS(2)] + 21 × [POS(2) VEL(2) ACC(2)]
+#define DOWN_TYPE_TRAJ_WAYPOINTS 0x12  // [N][DT_MS(2)] + N × 21 × [POS(2)]
+#define DOWN_TYPE_TRAJ_FLUSH     0x13  // [MODE]: 0 停在当前输出，1 交还给目标角度快照
+#define DOWN_TYPE_TARGET_ANGLES  0x14  // 21 × [POS(2)] 目标角度快照（清空轨迹与流式目标点）
+#define DOWN_TYPE_SETPOINT       0xCB  // [SEQ(2)][HOST_TS_US(4)] + 21 × [POS(2)]，按播放延迟回放
+#define DOWN_TYPE_SETPOINT_DELAY 0x15  // [DELAY_MS(2)] 流式目标点的播放延迟
+#define DOWN_TYPE_LOAD_LIMITS    0x16  // 21 × [CONT(2) DERATE_TORQUE(2) DERATE_HEAT_MS(2) CUT_HEAT_MS(2)] 过载保护限制
+#define DOWN_TYPE_COMPLIANCE     0x17  // 21 × [ENABLE(1) STIFFNESS(2) DAMPING(2) MAX_TORQUE(2)] 柔顺控制
+
+// 轨迹定点格式（有符号 16 位，大端序）
+#define TRAJ_POS_LSB        0.01f  // °
+#define TRAJ_VEL_LSB        0.1f   // °/s
+#define TRAJ_ACC_LSB        1.0f   // °/s²
+#define TRAJ_MAX_WAYPOINTS  5      // 单帧路径点数（受 LEN 一字节限制）
+
+// 柔顺参数定点格式（无符号 16 位，大端序）
+#define COMPLIANCE_STIFFNESS_LSB 0.1f   // 目标力矩单位 / °
+#define COMPLIANCE_DAMPING_LSB   0.01f  // 目标力矩单位 / (°/s)
+
+#define DOWN_FRAME_TIMEOUT_MS 50   // 帧内字节间隔超过此值时丢弃半帧
+#define DOWN_FRAME_MAX_WIRE   (2 * 255 + 1)  // 帧头之后的最大线路字节数（每字节都转义 + LEN）
+
+#define LOG_DRAIN_PER_CYCLE 8      // 每个通信周期最多发送的日志条数
 
 // 内部辅助：发送数据包
 void sendDataPacket(ServoStatus_t *pServo, RemoteSensorData_t *pSensor)
@@ -61,9 +111,282 @@ void sendDataPacket(ServoStatus_t *pServo, RemoteSensorData_t *pSensor)
 }
 
 // ============================================================
-// 【新增】安全写入目标角度到共享数据
+// 【新增】发送一条延迟日志（二进制，不在固件端格式化）
+// ============================================================
+// 负载: [ID_H][ID_L][CORE][ARGC][TS(4)][ARG0(4)]...，多字节均为大端序
+// 本任务同时负责排空日志缓冲区，所有上行帧都在同一任务中写串口，不会交错
+static void sendLogPacket(const LogEntry &entry)
+{
+    uint8_t buffer[8 + 8 + 4 * DLOG_MAX_ARGS];
+    size_t idx = 0;
+
+    buffer[idx++] = PROTOCOL_HEADER;
+    buffer[idx++] = 0x00; // 长度占位
+    buffer[idx++] = PACKET_TYPE_LOG;
+    buffer[idx++] = (entry.formatId >> 8) & 0xFF;
+    buffer[idx++] = entry.formatId & 0xFF;
+    buffer[idx++] = entry.core;
+    buffer[idx++] = entry.argc;
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        buffer[idx++] = (entry.timestampUs >> shift) & 0xFF;
+    }
+    for (uint8_t i = 0; i < entry.argc; i++)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            buffer[idx++] = (entry.args[i] >> shift) & 0xFF;
+        }
+    }
+    buffer[idx++] = PROTOCOL_TAIL;
+    buffer[1] = (uint8_t)(idx - 2);
+
+    Serial.write(buffer, idx);
+}
+
+// ============================================================
+// 【新增】发送任务运行时间统计
+// ============================================================
+// 负载: [ELAPSED(4)] + N × [TASK_ID][CORE][RUNTIME(4)][STACK_FREE(2)]，大端序
+// ELAPSED 与 RUNTIME 为两次上报之间的增量（运行时间计数器单位，ESP-IDF 下为微秒），
+// 上位机据此计算各任务占单核的百分比；空闲任务的占比即该核心的余量
+static void sendTaskStatsPacket()
+{
+    static uint32_t lastTotal = 0;
+    static uint32_t lastCounter[TASK_STAT_COUNT] = {0};
+
+    const TaskHandle_t handles[TASK_STAT_COUNT] = {
+        taskUpperCommHandle,
+        taskCanCommHandle,
+        taskSolverHandle,
+        xTaskGetIdleTaskHandleForCore(0),
+        xTaskGetIdleTaskHandleForCore(1),
+        taskOuterLoopHandle,
+    };
+    const uint8_t cores[TASK_STAT_COUNT] = {
+        TASK_UPPER_COMM_CORE, TASK_CAN_COMM_CORE, TASK_SOLVER_CORE, 0, 1, TASK_OUTER_LOOP_CORE
+    };
+
+    uint8_t buffer[8 + 4 + TASK_STAT_COUNT * 8];
+    size_t idx = 0;
+
+    buffer[idx++] = PROTOCOL_HEADER;
+    buffer[idx++] = 0x00; // 长度占位
+    buffer[idx++] = PACKET_TYPE_TASK_STATS;
+
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    uint32_t total = 0;
+#endif
+    uint32_t elapsed = total - lastTotal;
+    lastTotal = total;
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        buffer[idx++] = (elapsed >> shift) & 0xFF;
+    }
+
+    for (uint8_t i = 0; i < TASK_STAT_COUNT; i++)
+    {
+        uint32_t runtime = 0;
+        uint16_t stackFree = 0;
+        if (handles[i])
+        {
+#if configGENERATE_RUN_TIME_STATS
+            uint32_t counter = ulTaskGetRunTimeCounter(handles[i]);
+            runtime = counter - lastCounter[i];
+            lastCounter[i] = counter;
+#endif
+            uint32_t hwm = uxTaskGetStackHighWaterMark(handles[i]);
+            stackFree = (hwm > 0xFFFF) ? 0xFFFF : (uint16_t)hwm;
+        }
+        buffer[idx++] = i;
+        buffer[idx++] = cores[i];
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            buffer[idx++] = (runtime >> shift) & 0xFF;
+        }
+        buffer[idx++] = (stackFree >> 8) & 0xFF;
+        buffer[idx++] = stackFree & 0xFF;
+    }
+
+    buffer[idx++] = PROTOCOL_TAIL;
+    buffer[1] = (uint8_t)(idx - 2);
+
+    Serial.write(buffer, idx);
+}
+
+// ============================================================
+// 发送轨迹缓冲状态
 // ============================================================
-void applyTargetAngles(TaskSharedData_t* sharedData, float* angles, uint8_t count) {
+// 负载: [ENGAGED][QUEUED][BUFFERED_MS(2)][SEGMENTS(4)][UNDERRUNS(4)][OVERFLOWS(4)]，大端序
+static void sendTrajStatusPacket(const TrajectoryStatus &st)
+{
+    uint8_t buffer[8 + 16];
+    size_t idx = 0;
+
+    buffer[idx++] = PROTOCOL_HEADER;
+    buffer[idx++] = 0x00; // 长度占位
+    buffer[idx++] = PACKET_TYPE_TRAJ_STATUS;
+    buffer[idx++] = st.engaged;
+    buffer[idx++] = st.queued;
+    uint32_t bufferedMs = st.bufferedUs / 1000;
+    if (bufferedMs > 0xFFFF) bufferedMs = 0xFFFF;
+    buffer[idx++] = (bufferedMs >> 8) & 0xFF;
+    buffer[idx++] = bufferedMs & 0xFF;
+    const uint32_t counters[3] = {st.segments, st.underruns, st.overflows};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            buffer[idx++] = (counters[i] >> shift) & 0xFF;
+        }
+    }
+    buffer[idx++] = PROTOCOL_TAIL;
+    buffer[1] = (uint8_t)(idx - 2);
+
+    Serial.write(buffer, idx);
+}
+
+// ============================================================
+// 下行帧解析
+// ============================================================
+struct DownlinkParser {
+    uint8_t  state;        // 0 空闲，1 等待 LEN，2 接收帧体
+    uint8_t  escaped;      // 上一个字节是转义字节
+    uint8_t  len;
+    uint8_t  idx;
+    uint8_t  sum;
+    uint16_t rawLen;
+    uint32_t lastByteMs;
+    uint8_t  body[255];    // TYPE + PAYLOAD + SUM + TAIL（转义后）
+    uint8_t  raw[DOWN_FRAME_MAX_WIRE];    // 帧头之后收到的线路字节，帧无效时从中重新找帧头
+    uint8_t  rescan[DOWN_FRAME_MAX_WIRE];
+};
+
+// 各类型的负载长度，0 表示未知类型或点数非法（路径点帧的长度由第一个负载字节决定）
+static uint8_t downlinkPayloadLen(uint8_t type, uint8_t first)
+{
+    switch (type)
+    {
+    case DOWN_TYPE_TRAJ_CUBIC:     return 2 + ENCODER_TOTAL_NUM * 4;
+    case DOWN_TYPE_TRAJ_QUINTIC:   return 2 + ENCODER_TOTAL_NUM * 6;
+    case DOWN_TYPE_TRAJ_WAYPOINTS:
+        return (first >= 1 && first <= TRAJ_MAX_WAYPOINTS) ? 3 + first * ENCODER_TOTAL_NUM * 2 : 0;
+    case DOWN_TYPE_TRAJ_FLUSH:     return 1;
+    case DOWN_TYPE_TARGET_ANGLES:  return ENCODER_TOTAL_NUM * 2;
+    case DOWN_TYPE_SETPOINT:       return 6 + ENCODER_TOTAL_NUM * 2;
+    case DOWN_TYPE_SETPOINT_DELAY: return 2;
+    case DOWN_TYPE_LOAD_LIMITS:    return ENCODER_TOTAL_NUM * 8;
+    case DOWN_TYPE_COMPLIANCE:     return ENCODER_TOTAL_NUM * 7;
+    default:                       return 0;
+    }
+}
+
+static int16_t readS16BE(const uint8_t *p)
+{
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void handleTrajSegment(const uint8_t *payload, uint8_t len, uint8_t type)
+{
+    bool quintic = (type == DOWN_TYPE_TRAJ_QUINTIC);
+    uint8_t stride = quintic ? 6 : 4;
+    if (len != 2 + ENCODER_TOTAL_NUM * stride) return;
+
+    TrajectorySegment seg;
+    seg.type = quintic ? TRAJ_SEGMENT_QUINTIC : TRAJ_SEGMENT_CUBIC;
+    seg.durationUs = (uint32_t)(((uint16_t)payload[0] << 8) | payload[1]) * 1000;
+    const uint8_t *p = payload + 2;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++, p += stride)
+    {
+        seg.pos[i] = readS16BE(p) * TRAJ_POS_LSB;
+        seg.vel[i] = readS16BE(p + 2) * TRAJ_VEL_LSB;
+        seg.acc[i] = quintic ? readS16BE(p + 4) * TRAJ_ACC_LSB : 0.0f;
+    }
+    trajectoryBuffer.push(seg);
+}
+
+static void handleTrajWaypoints(const uint8_t *payload, uint8_t len)
+{
+    if (len < 3) return;
+    uint8_t count = payload[0];
+    if (count == 0 || count > TRAJ_MAX_WAYPOINTS || len != 3 + count * ENCODER_TOTAL_NUM * 2) return;
+
+    uint32_t intervalUs = (uint32_t)(((uint16_t)payload[1] << 8) | payload[2]) * 1000;
+    float points[TRAJ_MAX_WAYPOINTS * ENCODER_TOTAL_NUM];
+    const uint8_t *p = payload + 3;
+    for (int i = 0; i < count * ENCODER_TOTAL_NUM; i++, p += 2)
+    {
+        points[i] = readS16BE(p) * TRAJ_POS_LSB;
+    }
+    trajectoryBuffer.pushWaypoints(points, count, intervalUs);
+}
+
+static void handleSetpoint(const uint8_t *payload, uint8_t len)
+{
+    if (len != 6 + ENCODER_TOTAL_NUM * 2) return;
+
+    SetpointPacket pkt;
+    pkt.arrivalUs = micros();
+    pkt.seq = ((uint16_t)payload[0] << 8) | payload[1];
+    pkt.hostTimeUs = ((uint32_t)payload[2] << 24) | ((uint32_t)payload[3] << 16) |
+                     ((uint32_t)payload[4] << 8) | payload[5];
+    const uint8_t *p = payload + 6;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++, p += 2)
+    {
+        pkt.pos[i] = readS16BE(p) * TRAJ_POS_LSB;
+    }
+    // 轨迹缓冲由外环在回放开始后清空（播放延迟期间保持当前输出）
+    setpointBuffer.push(pkt);
+}
+
+static void handleLoadLimits(const uint8_t *payload, uint8_t len)
+{
+    if (len != ENCODER_TOTAL_NUM * 8) return;
+
+    // 无效的关节（持续负载为 0 或阈值不递增）由 LoadProtector 沿用原有限制
+    LoadLimitTable table;
+    const uint8_t *p = payload;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++, p += 8)
+    {
+        LoadLimit &lim = table.joint[i];
+        lim.contLoad = ((uint16_t)p[0] << 8) | p[1];
+        lim.derateTorque = ((uint16_t)p[2] << 8) | p[3];
+        lim.derateHeat = (((uint16_t)p[4] << 8) | p[5]) * 1e-3f;
+        lim.cutHeat = (((uint16_t)p[6] << 8) | p[7]) * 1e-3f;
+    }
+    loadProtector.requestLimits(table);
+}
+
+// ENABLE 的改变会切换舵机运行模式，每次切换写 3 次舵机 EPROM（解锁、运行模式、加锁），
+// EPROM 擦写寿命有限。同一关节两次切换至少间隔 COMPLIANCE_MODE_MIN_INTERVAL_CYCLES 个
+// 控制周期，间隔内的改变延后生效；上位机不应把 ENABLE 当作高频开关使用，
+// 只改刚度/阻尼/最大力矩不写 EPROM
+static void handleCompliance(const uint8_t *payload, uint8_t len)
+{
+    if (len != ENCODER_TOTAL_NUM * 7) return;
+
+    ComplianceTable table;
+    const uint8_t *p = payload;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++, p += 7)
+    {
+        ComplianceParams &c = table.joint[i];
+        c.enabled = p[0] ? 1 : 0;
+        c.stiffness = (((uint16_t)p[1] << 8) | p[2]) * COMPLIANCE_STIFFNESS_LSB;
+        c.damping = (((uint16_t)p[3] << 8) | p[4]) * COMPLIANCE_DAMPING_LSB;
+        c.maxTorque = ((uint16_t)p[5] << 8) | p[6];
+    }
+    angleSolver.requestCompliance(table);
+}
+
+// ============================================================
+// 安全写入目标角度到共享数据
+// ============================================================
+static void applyTargetAngles(TaskSharedData_t* sharedData, float* angles, uint8_t count) {
+    // 新的目标快照优先于轨迹与流式目标点：清空两者并交还给快照
+    trajectoryBuffer.requestFlush(false);
+    setpointBuffer.requestReset();
     if (count > ENCODER_TOTAL_NUM) count = ENCODER_TOTAL_NUM;
     if (xSemaphoreTake(sharedData->targetAnglesMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         for (int i = 0; i < count; i++) {
@@ -72,6 +395,143 @@ void applyTargetAngles(TaskSharedData_t* sharedData, float* angles, uint8_t coun
         xSemaphoreGive(sharedData->targetAnglesMutex);
     }
 }
+
+static void handleTargetAngles(const uint8_t *payload, uint8_t len)
+{
+    if (len != ENCODER_TOTAL_NUM * 2) return;
+
+    float angles[ENCODER_TOTAL_NUM];
+    const uint8_t *p = payload;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++, p += 2)
+    {
+        angles[i] = readS16BE(p) * TRAJ_POS_LSB;
+    }
+    applyTargetAngles(&sharedData, angles, ENCODER_TOTAL_NUM);
+}
+
+static void handleDownlinkFrame(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+    switch (type)
+    {
+    case DOWN_TYPE_TRAJ_CUBIC:
+    case DOWN_TYPE_TRAJ_QUINTIC:
+        handleTrajSegment(payload, len, type);
+        break;
+    case DOWN_TYPE_TRAJ_WAYPOINTS:
+        handleTrajWaypoints(payload, len);
+        break;
+    case DOWN_TYPE_TRAJ_FLUSH:
+        if (len == 1) trajectoryBuffer.requestFlush(payload[0] == 0);
+        break;
+    case DOWN_TYPE_TARGET_ANGLES:
+        handleTargetAngles(payload, len);
+        break;
+    case DOWN_TYPE_SETPOINT:
+        handleSetpoint(payload, len);
+        break;
+    case DOWN_TYPE_SETPOINT_DELAY:
+        if (len == 2) setpointBuffer.setPlayoutDelay((uint32_t)(((uint16_t)payload[0] << 8) | payload[1]) * 1000);
+        break;
+    case DOWN_TYPE_LOAD_LIMITS:
+        handleLoadLimits(payload, len);
+        break;
+    case DOWN_TYPE_COMPLIANCE:
+        handleCompliance(payload, len);
+        break;
+    default:
+        break;
+    }
+}
+
+enum DownlinkStep {
+    DOWN_STEP_IDLE,     // 不属于下行帧
+    DOWN_STEP_FRAME,    // 帧内字节（已处理）
+    DOWN_STEP_RESYNC,   // 帧无效：帧头之后的字节需要重新扫描
+};
+
+static DownlinkStep stepDownlink(DownlinkParser &parser, uint8_t rxByte)
+{
+    if (parser.state == 0)
+    {
+        if (rxByte != PROTOCOL_HEADER) return DOWN_STEP_IDLE;
+        parser.state = 1;
+        parser.escaped = 0;
+        parser.rawLen = 0;
+        return DOWN_STEP_FRAME;
+    }
+
+    parser.raw[parser.rawLen++] = rxByte;
+    if (parser.escaped)
+    {
+        parser.escaped = 0;
+        rxByte ^= DOWN_ESCAPE_XOR;
+    }
+    else if (rxByte == DOWN_ESCAPE)
+    {
+        parser.escaped = 1;
+        return DOWN_STEP_FRAME;
+    }
+
+    if (parser.state == 1)
+    {
+        if (rxByte < 4) return DOWN_STEP_RESYNC;   // 至少包含 TYPE、1 字节负载、SUM 与 TAIL
+        parser.len = rxByte;
+        parser.sum = rxByte;
+        parser.idx = 0;
+        parser.state = 2;
+        return DOWN_STEP_FRAME;
+    }
+
+    parser.body[parser.idx++] = rxByte;
+    // 收到 TYPE 与第一个负载字节后即可确定帧长，不等到 LEN 个字节收完
+    if (parser.idx == 2 && parser.len != downlinkPayloadLen(parser.body[0], parser.body[1]) + 3)
+    {
+        return DOWN_STEP_RESYNC;
+    }
+    if (parser.idx < parser.len - 1)
+    {
+        parser.sum += rxByte;
+        return DOWN_STEP_FRAME;
+    }
+    if (parser.idx == parser.len - 1)
+    {
+        return ((uint8_t)~parser.sum == rxByte) ? DOWN_STEP_FRAME : DOWN_STEP_RESYNC;
+    }
+    if (rxByte != PROTOCOL_TAIL) return DOWN_STEP_RESYNC;
+    parser.state = 0;
+    handleDownlinkFrame(parser.body[0], parser.body + 1, parser.len - 3);
+    return DOWN_STEP_FRAME;
+}
+
+// 返回 true 表示该字节属于下行帧（已处理），否则按单字节指令处理
+static bool feedDownlink(DownlinkParser &parser, uint8_t rxByte)
+{
+    uint32_t now = millis();
+    if (parser.state != 0 && now - parser.lastByteMs > DOWN_FRAME_TIMEOUT_MS)
+    {
+        parser.state = 0;  // 半帧超时，丢弃
+    }
+    parser.lastByteMs = now;
+
+    DownlinkStep step = stepDownlink(parser, rxByte);
+    if (step != DOWN_STEP_RESYNC) return step == DOWN_STEP_FRAME;
+
+    // 帧头/长度/校验错误：假帧头或截断的帧后面可能紧跟着下一帧，
+    // 从帧头之后的字节重新找帧头；再次失败时从新帧头之后继续，扫描位置单调前进
+    uint16_t n = parser.rawLen;
+    memcpy(parser.rescan, parser.raw, n);
+    parser.state = 0;
+    for (uint16_t i = 0; i < n; i++)
+    {
+        if (stepDownlink(parser, parser.rescan[i]) == DOWN_STEP_RESYNC)
+        {
+            i -= parser.rawLen;
+            parser.state = 0;
+        }
+    }
+    return true;
+}
+
 // --- 主任务函数 ---
 void taskUpperComm(void *parameter)
 {
@@ -80,15 +540,47 @@ void taskUpperComm(void *parameter)
 
     Serial.println("<<<SYS_READY>>>"); // 启动标志
 
+    // 日志改为二进制上行，由本任务（最低优先级）排空
+    DeferredLog::SetSink(sendLogPacket);
+
+    uint32_t lastStatsTime = millis();
+    uint32_t lastTrajStatusTime = millis();
+    static DownlinkParser parser;
+
     for (;;)
     {
         // ====================================================
         // [Part 1] 接收：处理来自 PC 的指令 (RX)
         // ====================================================
-        if (Serial.available())
+        // 每周期取完全部已到达的字节（下行帧可能上百字节）
+        while (Serial.available())
         {
             uint8_t rxByte = Serial.read();
 
+            // 's' 急停：所有总线立即关闭扭矩；'r' 恢复。先于帧解析，半帧/损坏的帧不会挡住急停
+            // （帧内的这两个字节已被转义）
+            if (rxByte == 's')
+            {
+                g_servoStopRequestUs = micros();
+                g_servoStopRequest = SERVO_STOP_REQUEST;
+                if (taskSolverHandle)
+                {
+                    xTaskNotifyGive(taskSolverHandle);
+                }
+                continue;
+            }
+            if (rxByte == 'r')
+            {
+                g_servoStopRequest = SERVO_RESUME_REQUEST;
+                continue;
+            }
+
+            // 下行帧（轨迹等）
+            if (feedDownlink(parser, rxByte))
+            {
+                continue;
+            }
+
             // 简单指令解析: 'c' 或 0xCA 触发校准
             if (rxByte == 'c' || rxByte == 0xCA)
             {
@@ -101,23 +593,9 @@ void taskUpperComm(void *parameter)
                 if (xQueueSend(sharedData->canTxQueue, &cmd, 0) == pdTRUE)
                 {
                     g_calibrationUIStatus = 1; // 设置本地状态为 PENDING
+                    g_zeroCaptureRequest = 1;  // 同一姿态下记录舵机零位
                 }
             }
-            // 简单指令解析: 'b' 或 0xCB 设置目标角度
-            if (rxByte == 'b' || rxByte == 0xCB)
-            {
-                float parsedAngles[ENCODER_TOTAL_NUM];
-                // ... 原有的解析逻辑，将字节流转为 float 数组 ...
-                for (int i = 0; i < ENCODER_TOTAL_NUM; i++)
-                {
-                    //  memcpy(&parsedAngles[i], &payload[i * 4], sizeof(float));
-                }
-
-                // 【新增】将目标角度写入共享数据，供 taskSolver 读取
-                applyTargetAngles(sharedData, parsedAngles, ENCODER_TOTAL_NUM);
-            }
-
-            // 可以在此扩展其他指令，例如 's' 停止等
         }
 
         // ====================================================
@@ -136,6 +614,27 @@ void taskUpperComm(void *parameter)
             sendDataPacket(NULL, NULL);
         }
 
+        // 周期性上报任务运行时间统计
+        if (millis() - lastStatsTime >= TASK_STATS_PERIOD_MS)
+        {
+            lastStatsTime = millis();
+            sendTaskStatsPacket();
+        }
+
+        // 启用轨迹或队列非空时上报缓冲状态
+        if (millis() - lastTrajStatusTime >= TRAJ_STATUS_PERIOD_MS)
+        {
+            lastTrajStatusTime = millis();
+            TrajectoryStatus trajStatus = trajectoryBuffer.status();
+            if (trajStatus.engaged || trajStatus.queued)
+            {
+                sendTrajStatusPacket(trajStatus);
+            }
+        }
+
+        // 排空延迟日志（每周期限量，避免挤占传感器数据）
+        DeferredLog::Drain(LOG_DRAIN_PER_CYCLE);
+
         // 任务调度延时
         // 既要保证 input 响应快，又要避免 output 发送太快堵塞串口
         vTaskDelay(pdMS_TO_TICKS(5));
@@ -5,6 +5,8 @@ import threading
 import sys
 import struct
 import os
+import re
+from collections import deque
 
 # 尝试导入 colorama 以支持 Windows 颜色显示
 try:
@@ -29,6 +31,25 @@ TARGET_BAUDRATE = 921600
 ENCODER_COUNT = 21
 CMD_CALIBRATE = b'\xCA'  # 校准触发指令
 ERROR_VAL_FLAG = 0xFFFF  # 固件中定义的错误标记
+LOG_FORMATS_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "libraries", "DeferredLog", "LogFormats.h")
+LOG_HISTORY = 8  # 界面上保留的日志行数
+TASK_STAT_NAMES = ["UpperComm", "CanComm", "Solver", "IDLE0", "IDLE1", "OuterLoop"]  # 与 TaskSharedData.h 中 TASK_STAT_* 一致
+
+# 轨迹下行帧 (与 UpperCommTask.cpp 中 DOWN_TYPE_* / TRAJ_*_LSB 一致)
+DOWN_TYPE_TRAJ_CUBIC = 0x10
+DOWN_TYPE_TRAJ_QUINTIC = 0x11
+DOWN_TYPE_TRAJ_WAYPOINTS = 0x12
+DOWN_TYPE_TRAJ_FLUSH = 0x13
+DOWN_TYPE_TARGET_ANGLES = 0x14
+DOWN_TYPE_SETPOINT = 0xCB
+DOWN_TYPE_SETPOINT_DELAY = 0x15
+DOWN_TYPE_LOAD_LIMITS = 0x16
+DOWN_TYPE_COMPLIANCE = 0x17
+TRAJ_POS_LSB = 0.01  # °
+TRAJ_VEL_LSB = 0.1  # °/s
+TRAJ_ACC_LSB = 1.0  # °/s²
+TRAJ_MAX_WAYPOINTS = 5
 
 
 # ================= 状态管理类 =================
@@ -46,6 +67,15 @@ class MachineState:
         self.connected_port = None
         self.ser = None
 
+        # 固件延迟日志 (Type 0x03)
+        self.logs = deque(maxlen=LOG_HISTORY)
+
+        # 任务运行时间统计 (Type 0x04): {任务编号: (核心, CPU%, 栈余量)}
+        self.task_stats = {}
+
+        # 轨迹缓冲状态 (Type 0x05)
+        self.traj_status = None
+
 
 state = MachineState()
 
@@ -85,6 +115,165 @@ def process_ack_packet(payload):
         state.calib_timestamp = time.time()
 
 
+def load_log_formats(path=LOG_FORMATS_PATH):
+    """ 从固件的 LogFormats.h 读取格式表，编号即条目顺序 """
+    try:
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+    except OSError:
+        return []
+    pattern = re.compile(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+    return pattern.findall(text)
+
+
+LOG_FORMATS = load_log_formats()
+LOG_CONVERSION = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?([diuxXcfeg%])')
+
+
+def format_log(fmt, words):
+    """ 按 C 格式串还原参数类型：整数为 32 位，浮点为 float 位模式 """
+    args = []
+    for conv in LOG_CONVERSION.findall(fmt):
+        if conv == '%':
+            continue
+        word = words[len(args)] if len(args) < len(words) else 0
+        if conv in 'fge':
+            args.append(struct.unpack('>f', struct.pack('>I', word))[0])
+        elif conv in 'di':
+            args.append(word - (1 << 32) if word & 0x80000000 else word)
+        else:
+            args.append(word)
+    try:
+        return fmt % tuple(args)
+    except (TypeError, ValueError):
+        return f"{fmt} {words}"
+
+
+def process_log_packet(payload):
+    """ 解析延迟日志包 (Type 0x03) """
+    if len(payload) < 8: return
+    fmt_id = (payload[0] << 8) | payload[1]
+    core = payload[2]
+    argc = payload[3]
+    timestamp_us = struct.unpack('>I', bytes(payload[4:8]))[0]
+    if len(payload) != 8 + 4 * argc: return
+    words = list(struct.unpack(f'>{argc}I', bytes(payload[8:])))
+
+    if fmt_id < len(LOG_FORMATS):
+        text = format_log(LOG_FORMATS[fmt_id][1], words)
+    else:
+        text = f"<未知日志 {fmt_id}> {words}"
+    state.logs.append(f"[{timestamp_us / 1e6:10.3f}] C{core} {text}")
+
+
+def process_task_stats_packet(payload):
+    """ 解析任务运行时间统计包 (Type 0x04) """
+    if len(payload) < 4 or (len(payload) - 4) % 8 != 0: return
+    elapsed = struct.unpack('>I', bytes(payload[0:4]))[0]
+    stats = {}
+    for off in range(4, len(payload), 8):
+        task_id, core, runtime, stack_free = struct.unpack('>BBIH', bytes(payload[off:off + 8]))
+        cpu = runtime * 100.0 / elapsed if elapsed else 0.0
+        stats[task_id] = (core, cpu, stack_free)
+    state.task_stats = stats
+
+
+def process_traj_status_packet(payload):
+    """ 解析轨迹缓冲状态包 (Type 0x05) """
+    if len(payload) != 16: return
+    engaged, queued, buffered_ms, segments, underruns, overflows = struct.unpack('>BBHIII', bytes(payload))
+    state.traj_status = {
+        "engaged": bool(engaged), "queued": queued, "buffered_ms": buffered_ms,
+        "segments": segments, "underruns": underruns, "overflows": overflows,
+        "time": time.time(),
+    }
+
+
+# ================= 轨迹下行 =================
+def _fixed(value, lsb):
+    return max(-32768, min(32767, int(round(value / lsb))))
+
+
+DOWN_ESCAPE = 0x7D
+DOWN_ESCAPED = (ord('s'), ord('r'), DOWN_ESCAPE)  # 急停/恢复字节在帧内必须转义
+
+
+def build_frame(pkt_type, payload):
+    """ 下行帧: [FE] [LEN] [TYPE] [PAYLOAD...] [SUM] [FF]，LEN = TYPE + PAYLOAD + SUM + TAIL，
+        SUM = ~(LEN + TYPE + PAYLOAD)；帧头之后的 's'/'r'/0x7D 以 [7D][b ^ 0x20] 发送 """
+    body = bytearray([len(payload) + 3, pkt_type]) + bytes(payload)
+    body.append(~sum(body) & 0xFF)
+    body.append(0xFF)
+    frame = bytearray([0xFE])
+    for b in body:
+        frame += bytes([DOWN_ESCAPE, b ^ 0x20]) if b in DOWN_ESCAPED else bytes([b])
+    return bytes(frame)
+
+
+def build_traj_segment(duration_ms, positions, velocities, accelerations=None):
+    """ 一段样条（终点状态，单位 °、°/s、°/s²）；给出加速度时为五次段，否则为三次段 """
+    payload = bytearray(struct.pack('>H', int(duration_ms)))
+    for i in range(ENCODER_COUNT):
+        payload += struct.pack('>hh', _fixed(positions[i], TRAJ_POS_LSB), _fixed(velocities[i], TRAJ_VEL_LSB))
+        if accelerations is not None:
+            payload += struct.pack('>h', _fixed(accelerations[i], TRAJ_ACC_LSB))
+    pkt_type = DOWN_TYPE_TRAJ_CUBIC if accelerations is None else DOWN_TYPE_TRAJ_QUINTIC
+    return build_frame(pkt_type, payload)
+
+
+def build_traj_waypoints(interval_ms, points):
+    """ 等间隔路径点（每点 21 个角度），超过单帧上限时拆成多帧 """
+    frames = b''
+    for start in range(0, len(points), TRAJ_MAX_WAYPOINTS):
+        chunk = points[start:start + TRAJ_MAX_WAYPOINTS]
+        payload = bytearray(struct.pack('>BH', len(chunk), int(interval_ms)))
+        for point in chunk:
+            payload += struct.pack(f'>{ENCODER_COUNT}h', *[_fixed(a, TRAJ_POS_LSB) for a in point])
+        frames += build_frame(DOWN_TYPE_TRAJ_WAYPOINTS, payload)
+    return frames
+
+
+def build_traj_flush(hold=True):
+    """ 清空轨迹缓冲：hold=True 停在当前输出，否则交还给目标角度快照 """
+    return build_frame(DOWN_TYPE_TRAJ_FLUSH, bytes([0 if hold else 1]))
+
+
+def build_target_angles(angles):
+    """ 目标角度快照（21 个角度，°），清空轨迹与流式目标点 """
+    return build_frame(DOWN_TYPE_TARGET_ANGLES, struct.pack(f'>{ENCODER_COUNT}h',
+                                                            *[_fixed(a, TRAJ_POS_LSB) for a in angles]))
+
+
+def build_setpoint(seq, host_time_us, angles):
+    """ 流式目标点：序号 + 本机时间戳 (us)，板上按固定延迟回放 """
+    payload = bytearray(struct.pack('>HI', seq & 0xFFFF, int(host_time_us) & 0xFFFFFFFF))
+    payload += struct.pack(f'>{ENCODER_COUNT}h', *[_fixed(a, TRAJ_POS_LSB) for a in angles])
+    return build_frame(DOWN_TYPE_SETPOINT, payload)
+
+
+def build_setpoint_delay(delay_ms):
+    """ 设置流式目标点的播放延迟 """
+    return build_frame(DOWN_TYPE_SETPOINT_DELAY, struct.pack('>H', int(delay_ms)))
+
+
+def build_load_limits(limits):
+    """ 过载保护限制：21 个 (持续负载‰, 降额力矩‰, 降额阈值 s, 关扭矩阈值 s)，持续负载为 0 的关节不修改 """
+    payload = bytearray()
+    for cont, derate, derate_s, cut_s in limits:
+        payload += struct.pack('>4H', int(cont), int(derate), int(round(derate_s * 1000)), int(round(cut_s * 1000)))
+    return build_frame(DOWN_TYPE_LOAD_LIMITS, payload)
+
+
+def build_compliance(params):
+    """ 柔顺控制：21 个 (是否力矩模式, 刚度 力矩/°, 阻尼 力矩/(°/s), 最大力矩)，仅 HLS 舵机生效。
+    改变“是否力矩模式”会擦写舵机 EPROM，固件对同一关节限速（约 2s 一次），不要当作高频开关 """
+    payload = bytearray()
+    for enabled, stiffness, damping, max_torque in params:
+        payload += struct.pack('>B3H', 1 if enabled else 0, int(round(stiffness * 10)),
+                               int(round(damping * 100)), int(max_torque))
+    return build_frame(DOWN_TYPE_COMPLIANCE, payload)
+
+
 def parse_stream(buffer):
     """ 从字节流中提取完整数据帧 """
     # 协议格式: [FE] [LEN] [TYPE] [PAYLOAD...] [FF]
@@ -120,6 +309,12 @@ def parse_stream(buffer):
                     process_data_packet(payload)
                 elif pkt_type == 0x02:
                     process_ack_packet(payload)
+                elif pkt_type == 0x03:
+                    process_log_packet(payload)
+                elif pkt_type == 0x04:
+                    process_task_stats_packet(payload)
+                elif pkt_type == 0x05:
+                    process_traj_status_packet(payload)
 
             # 移除已处理帧
             buffer = buffer[frame_len:]
@@ -232,6 +427,28 @@ def print_ui():
 
     # 清除行尾多余字符，防止残留
     print(f"\n当前状态: {msg}\033[K")
+
+    # --- 任务负载 ---
+    if state.task_stats:
+        print("-" * 65)
+        print(f"{Style.BRIGHT}任务负载 (占单核 %):{Style.RESET_ALL}")
+        for task_id, (core, cpu, stack_free) in sorted(state.task_stats.items()):
+            name = TASK_STAT_NAMES[task_id] if task_id < len(TASK_STAT_NAMES) else f"#{task_id}"
+            print(f"  {name:<10} 核心{core}  CPU {cpu:6.2f}%  栈余量 {stack_free:5d} B\033[K")
+
+    # --- 轨迹缓冲 ---
+    traj = state.traj_status
+    if traj and time.time() - traj["time"] < 1.0:
+        print("-" * 65)
+        mode = f"{Fore.GREEN}轨迹{Style.RESET_ALL}" if traj["engaged"] else "快照"
+        print(f"轨迹缓冲: {mode}  排队 {traj['queued']:2d} 段  缓冲 {traj['buffered_ms']:5d} ms  "
+              f"已执行 {traj['segments']}  欠载 {traj['underruns']}  溢出 {traj['overflows']}\033[K")
+
+    # --- 固件日志 ---
+    print("-" * 65)
+    print(f"{Style.BRIGHT}固件日志:{Style.RESET_ALL}")
+    for line in state.logs:
+        print(f"{line}\033[K")
     print(f"\n{Fore.BLACK}{Style.DIM}(按 'q' 退出程序){Style.RESET_ALL}")
 
 
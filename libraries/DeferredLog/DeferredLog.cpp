@@ -0,0 +1,211 @@
+#include "DeferredLog.h"
+#include <atomic>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+static_assert((DLOG_RING_SIZE & (DLOG_RING_SIZE - 1)) == 0, "DLOG_RING_SIZE must be a power of two");
+
+/* ==================== 每核心环形缓冲区 ==================== */
+
+// 有界多生产者队列：每个槽位带序号，seq == pos 表示可写，seq == pos + 1 表示可读。
+// 生产者用 CAS 抢占写位置，写完后发布序号；被抢占的生产者不会阻塞其他生产者。
+struct LogCell {
+    std::atomic<uint32_t> seq;
+    LogEntry entry;
+};
+
+struct LogRing {
+    std::atomic<uint32_t> head;      // 下一个写位置（生产者共享）
+    std::atomic<uint32_t> dropped;   // 累计丢弃数
+    uint32_t tail;                   // 下一个读位置（仅排空任务使用）
+    uint32_t reportedDropped;        // 已上报的丢弃数（仅排空任务使用）
+    LogCell cells[DLOG_RING_SIZE];
+
+    LogRing() : head(0), dropped(0), tail(0), reportedDropped(0) {
+        for (uint32_t i = 0; i < DLOG_RING_SIZE; i++) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+};
+
+static LogRing s_rings[DLOG_NUM_CORES];
+static LogSink s_sink = DeferredLog::TextSink;
+
+static inline uint8_t currentCore() {
+#ifdef ARDUINO
+    return (uint8_t)xPortGetCoreID() % DLOG_NUM_CORES;
+#else
+    return 0;
+#endif
+}
+
+static inline uint32_t timestampUs() {
+#ifdef ARDUINO
+    return micros();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+bool DeferredLog::Push(LogFormatId id, const uint32_t* args, uint8_t argc) {
+    uint8_t core = currentCore();
+    LogRing& ring = s_rings[core];
+
+    uint32_t pos = ring.head.load(std::memory_order_relaxed);
+    LogCell* cell;
+    for (;;) {
+        cell = &ring.cells[pos & (DLOG_RING_SIZE - 1)];
+        uint32_t seq = cell->seq.load(std::memory_order_acquire);
+        int32_t dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (ring.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            // 缓冲区已满
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = ring.head.load(std::memory_order_relaxed);
+        }
+    }
+
+    if (argc > DLOG_MAX_ARGS) argc = DLOG_MAX_ARGS;
+    LogEntry& e = cell->entry;
+    e.timestampUs = timestampUs();
+    e.formatId = id;
+    e.core = core;
+    e.argc = argc;
+    for (uint8_t i = 0; i < argc; i++) {
+        e.args[i] = args[i];
+    }
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+size_t DeferredLog::Drain(size_t maxEntries) {
+    size_t count = 0;
+    for (uint8_t core = 0; core < DLOG_NUM_CORES; core++) {
+        LogRing& ring = s_rings[core];
+
+        while (count < maxEntries) {
+            LogCell& cell = ring.cells[ring.tail & (DLOG_RING_SIZE - 1)];
+            if (cell.seq.load(std::memory_order_acquire) != ring.tail + 1) break;  // 空，或生产者尚未写完
+            LogEntry entry = cell.entry;
+            cell.seq.store(ring.tail + DLOG_RING_SIZE, std::memory_order_release);
+            ring.tail++;
+            s_sink(entry);
+            count++;
+        }
+
+        uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != ring.reportedDropped) {
+            ring.reportedDropped = dropped;
+            LogEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.timestampUs = timestampUs();
+            entry.formatId = DLOG_LOG_DROPPED;
+            entry.core = core;
+            entry.argc = 2;
+            entry.args[0] = core;
+            entry.args[1] = dropped;
+            s_sink(entry);
+        }
+    }
+    return count;
+}
+
+void DeferredLog::SetSink(LogSink sink) {
+    s_sink = sink ? sink : TextSink;
+}
+
+uint32_t DeferredLog::Dropped(uint8_t core) {
+    return (core < DLOG_NUM_CORES) ? s_rings[core].dropped.load(std::memory_order_relaxed) : 0;
+}
+
+/* ==================== 格式化 ==================== */
+
+size_t DeferredLog::FormatEntry(const LogEntry& entry, char* buf, size_t len) {
+    if (len == 0) return 0;
+    const char* f = Format(entry.formatId);
+    size_t out = 0;
+    uint8_t argIndex = 0;
+
+    while (*f != '\0' && out + 1 < len) {
+        if (*f != '%') {
+            buf[out++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            buf[out++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // 取出一个完整的转换说明（标志/宽度/精度 + 转换字符）
+        char spec[16];
+        size_t n = 0;
+        while (*f != '\0' && n < sizeof(spec) - 1) {
+            char c = *f++;
+            spec[n++] = c;
+            if (n > 1 && IsConversion(c)) break;
+        }
+        spec[n] = '\0';
+        char conv = spec[n - 1];
+
+        uint32_t word = (argIndex < entry.argc) ? entry.args[argIndex] : 0;
+        argIndex++;
+
+        int written;
+        if (IsFloatConversion(conv)) {
+            float v;
+            memcpy(&v, &word, sizeof(v));
+            written = snprintf(buf + out, len - out, spec, (double)v);
+        } else if (conv == 'd' || conv == 'i') {
+            written = snprintf(buf + out, len - out, spec, (int)(int32_t)word);
+        } else if (IsConversion(conv)) {
+            written = snprintf(buf + out, len - out, spec, (unsigned)word);
+        } else {
+            written = snprintf(buf + out, len - out, "%s", spec);
+        }
+        if (written < 0) break;
+        out += ((size_t)written < len - out) ? (size_t)written : len - out - 1;
+    }
+    buf[out] = '\0';
+    return out;
+}
+
+void DeferredLog::TextSink(const LogEntry& entry) {
+    char text[160];
+    FormatEntry(entry, text, sizeof(text));
+#ifdef ARDUINO
+    Serial.printf("[%lu.%03lu] %s\n", (unsigned long)(entry.timestampUs / 1000000),
+                  (unsigned long)(entry.timestampUs / 1000 % 1000), text);
+#else
+    printf("[%lu.%03lu] %s\n", (unsigned long)(entry.timestampUs / 1000000),
+           (unsigned long)(entry.timestampUs / 1000 % 1000), text);
+#endif
+}
+
+/* ==================== 排空任务 ==================== */
+
+#ifdef ARDUINO
+
+static void drainTask(void* parameter) {
+    TickType_t period = pdMS_TO_TICKS((uint32_t)(uintptr_t)parameter);
+    if (period == 0) period = 1;
+    for (;;) {
+        DeferredLog::Drain();
+        vTaskDelay(period);
+    }
+}
+
+bool DeferredLog::StartDrainTask(uint32_t priority, uint32_t stackSize, uint32_t periodMs) {
+    return xTaskCreate(drainTask, "LogDrain", stackSize, (void*)(uintptr_t)periodMs, priority, NULL) == pdPASS;
+}
+
+#endif
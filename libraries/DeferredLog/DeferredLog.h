@@ -0,0 +1,154 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include "LogFormats.h"
+
+// 延迟日志：热路径只把 “格式编号 + 参数” 写入当前核心的无锁环形缓冲区，
+// 由低优先级任务取出后格式化/发送，避免在总线通信或控制循环中阻塞在串口上。
+//
+// 每个核心一个多生产者单消费者环形缓冲区（按槽位序号实现，无锁，可在中断中调用）；
+// 缓冲区满时丢弃新日志并累加丢弃计数，排空时以 LOG_DROPPED 条目上报。
+// 除 StartDrainTask() 外不依赖 Arduino，可在 Linux 主机上编译测试。
+
+#define DLOG_MAX_ARGS   4
+#define DLOG_RING_SIZE  64     // 每个核心的条目数，必须为 2 的幂
+#define DLOG_NUM_CORES  2
+
+// 格式编号：DLOG_<名称>
+enum LogFormatId : uint16_t {
+#define DLOG_ENUM_ENTRY(name, fmt) DLOG_##name,
+    DLOG_FORMATS(DLOG_ENUM_ENTRY)
+#undef DLOG_ENUM_ENTRY
+    DLOG_FORMAT_COUNT
+};
+
+// 格式串表（编号 -> 格式串）
+inline constexpr const char* kLogFormats[DLOG_FORMAT_COUNT] = {
+#define DLOG_FORMAT_ENTRY(name, fmt) fmt,
+    DLOG_FORMATS(DLOG_FORMAT_ENTRY)
+#undef DLOG_FORMAT_ENTRY
+};
+
+// 一条日志记录（参数统一按 32 位保存，浮点为 float 的位模式）
+struct LogEntry {
+    uint32_t timestampUs;
+    uint16_t formatId;
+    uint8_t  core;
+    uint8_t  argc;
+    uint32_t args[DLOG_MAX_ARGS];
+};
+
+// 日志输出函数（在排空任务中调用）
+typedef void (*LogSink)(const LogEntry& entry);
+
+class DeferredLog {
+public:
+    /**
+     * @brief 记录一条日志（无锁，不格式化）
+     * 参数个数与类型在编译期与格式串核对，一般通过 DLOG() 宏调用
+     */
+    template <LogFormatId ID, typename... Args>
+    static bool Log(Args... args) {
+        static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "too many log arguments");
+        static_assert(CountConversions(kLogFormats[ID]) == sizeof...(Args),
+                      "log argument count does not match format string");
+        static_assert(ArgsMatch<ID, Args...>(std::index_sequence_for<Args...>{}),
+                      "log argument type does not match format conversion");
+        const uint32_t words[sizeof...(Args) + 1] = {ToWord(args)..., 0};
+        return Push(ID, words, sizeof...(Args));
+    }
+
+    // 写入当前核心的环形缓冲区，满时丢弃并返回 false
+    static bool Push(LogFormatId id, const uint32_t* args, uint8_t argc);
+
+    /**
+     * @brief 取出最多 maxEntries 条日志交给输出函数（只能由一个任务调用）
+     * @return 取出的条目数
+     */
+    static size_t Drain(size_t maxEntries = (size_t)-1);
+
+    // 设置输出函数（默认 TextSink）
+    static void SetSink(LogSink sink);
+
+    // 将一条日志格式化为文本（不含换行），返回写入长度
+    static size_t FormatEntry(const LogEntry& entry, char* buf, size_t len);
+
+    // 文本输出：Arduino 下写 Serial，主机下写 stdout
+    static void TextSink(const LogEntry& entry);
+
+    // 指定核心累计丢弃的条目数
+    static uint32_t Dropped(uint8_t core);
+
+    static const char* Format(uint16_t id) {
+        return (id < DLOG_FORMAT_COUNT) ? kLogFormats[id] : "?";
+    }
+
+#ifdef ARDUINO
+    /**
+     * @brief 创建低优先级排空任务，周期性调用 Drain()
+     * 若已有任务负责排空（例如上位机通信任务），不要再调用本函数
+     */
+    static bool StartDrainTask(uint32_t priority = 1, uint32_t stackSize = 4096, uint32_t periodMs = 20);
+#endif
+
+    /* ========== 格式串编译期解析 ========== */
+
+    static constexpr bool IsFloatConversion(char c) {
+        return c == 'f' || c == 'e' || c == 'g';
+    }
+
+    static constexpr bool IsConversion(char c) {
+        return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' || c == 'c' || IsFloatConversion(c);
+    }
+
+    // 第 n 个转换说明符的转换字符，不存在返回 0
+    static constexpr char ConversionAt(const char* f, size_t n) {
+        for (size_t i = 0; f[i] != '\0'; i++) {
+            if (f[i] != '%') continue;
+            i++;
+            if (f[i] == '%') continue;
+            while (f[i] != '\0' && !IsConversion(f[i])) i++;
+            if (f[i] == '\0') return 0;
+            if (n == 0) return f[i];
+            n--;
+        }
+        return 0;
+    }
+
+    static constexpr size_t CountConversions(const char* f) {
+        size_t n = 0;
+        while (ConversionAt(f, n) != 0) n++;
+        return n;
+    }
+
+private:
+    template <typename T>
+    static uint32_t ToWord(T v) {
+        if constexpr (std::is_floating_point<T>::value) {
+            float f = (float)v;
+            uint32_t w;
+            memcpy(&w, &f, sizeof(w));
+            return w;
+        } else {
+            static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                          "log arguments must be integers, enums or floating point");
+            return (uint32_t)(int32_t)v;
+        }
+    }
+
+    template <LogFormatId ID, typename... Args, size_t... I>
+    static constexpr bool ArgsMatch(std::index_sequence<I...>) {
+        return ((IsFloatConversion(ConversionAt(kLogFormats[ID], I)) ==
+                 std::is_floating_point<Args>::value) && ... && true);
+    }
+};
+
+// 用法：DLOG(SERVO_LIMIT_START, servoID);
+#define DLOG(name, ...) DeferredLog::Log<DLOG_##name>(__VA_ARGS__)
+
+#endif // DEFERRED_LOG_H
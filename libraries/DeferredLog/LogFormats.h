@@ -0,0 +1,53 @@
+#ifndef LOG_FORMATS_H
+#define LOG_FORMATS_H
+
+// 延迟日志格式表：X(名称, 格式串)
+//
+// 固件只记录 “格式编号 + 参数”，格式化在排空任务（DeferredLog::TextSink）
+// 或上位机（client.py 直接解析本文件）中完成，因此：
+//   - 只允许在末尾追加条目，不要调整已有条目的顺序（编号即下标）；
+//   - 格式串不带换行；
+//   - 最多 DLOG_MAX_ARGS 个参数，支持 %d %i %u %x %X %c（按 32 位整数记录）
+//     和 %f %e %g（按 float 记录），以及 %%，可带宽度/精度/标志。
+#define DLOG_FORMATS(X) \
+    X(LOG_DROPPED,            "[log] 核心 %u 缓冲区溢出，累计丢弃 %u 条日志") \
+    X(CAN_DRIVER_OK,          "[CAN] Driver Installed OK") \
+    X(CAN_DRIVER_FAIL,        "[CAN] Driver Install FAILED, err %d") \
+    X(SERVO_READ_SINGLE_FAIL, "ServoManager::readSinglePoseLoad 舵机 %d 读取指令失败, 通信错误类型 %d") \
+    X(SERVO_LIMIT_START,      "开始寻找舵机 %d 的极限位置...") \
+    X(SERVO_LIMIT_PROGRESS,   "舵机 %d - 当前位置: %d | 负载: %d") \
+    X(SERVO_LIMIT_FOUND,      "舵机 %d 负载 %d 超过阈值，极限位置 %d") \
+    X(SERVO_LIMIT_READ_RETRY, "读取总线%d上舵机%d失败，正进行下一次尝试") \
+    X(SERVO_LIMIT_TIMEOUT,    "舵机 %d 寻找超时，使用保守值") \
+    X(SERVO_LIMIT_ALL_START,  "总线 %d 开始并行寻找 %d 个舵机的极限位置...") \
+    X(SERVO_OVERLOAD,         "ServoManager::SyncReadPosLoad 总线%d上的舵机%d的负载%d超限, 系统急停") \
+    X(RES_HEAP,               "[res] 空闲堆 %u B, 最大空闲块 %u B, 历史最低 %u B") \
+    X(RES_TASK_UPPER_COMM,    "[res] UpperComm 栈余量 %u B, CPU %u.%02u%%") \
+    X(RES_TASK_CAN_COMM,      "[res] CanComm   栈余量 %u B, CPU %u.%02u%%") \
+    X(RES_TASK_SOLVER,        "[res] Solver    栈余量 %u B, CPU %u.%02u%%") \
+    X(RES_TASK_LOOP,          "[res] loop      栈余量 %u B, CPU %u.%02u%%") \
+    X(RES_CORE_IDLE,          "[res] 核心 %u 空闲 %u.%02u%%") \
+    X(SCHED_CLASS_TIME,       "[sched] 类别 %u: 事务 %u, 平均 %u us, 最大 %u us") \
+    X(SCHED_CLASS_ERRORS,     "[sched] 类别 %u: 失败 %u, 推迟 %u, 丢弃 %u") \
+    X(SCHED_OVERRUN,          "[sched] 控制周期超时 %u 次") \
+    X(BUS_CYCLE_TIME,         "[bus] 总线 %u: 模型 %u us, 实测平均 %u us, 最大 %u us") \
+    X(BUS_CYCLE_UTIL,         "[bus] 总线 %u: 线路占用 %u‰ 周期, 线路/实测 %u‰, 平均 %u B/周期") \
+    X(BUS_STAGE,              "[bus] 总线 %u: REG_WRITE 暂存 %u, 未确认 %u") \
+    X(ACT_SKEW,               "[act] 总线间生效偏斜: 平均 %u us, 最大 %u us, 最近 %u us") \
+    X(RES_TASK_OUTER_LOOP,    "[res] OuterLoop 栈余量 %u B, CPU %u.%02u%%") \
+    X(OUTER_LOOP,             "[outer] 外环更新 %u 次, 无新样本 %u 次, 修正量最大年龄 %u ms") \
+    X(TRAJ_STATUS,            "[traj] 排队 %u 段, 缓冲 %u ms, 已执行 %u 段") \
+    X(TRAJ_ERRORS,            "[traj] 欠载 %u 次, 溢出 %u 段") \
+    X(JB_STREAM,              "[jb] 收到 %u, 丢失 %u, 迟到 %u, 欠载 %u 周期") \
+    X(JB_TIMING,              "[jb] 到达抖动 %u us, 播放延迟 设定 %u ms / 实测平均 %u us, 最大 %u us") \
+    X(TRACKING,               "[ff] 跟踪误差 平均 %u 步, 最大 %u 步, 速度达到上限 %u 关节·周期") \
+    X(ENC_COND,               "[enc] 无效读数 %u, 剔除毛刺 %u, 重新锁定 %u 次, 当前无效通道 0x%06x") \
+    X(JOINT_MODE,             "[mode] 仅舵机环 0x%06x, 冻结 0x%06x, 切换 %u 次, 降级 %u 关节·周期") \
+    X(LOAD_PROTECT,           "[load] 降额 0x%06x, 关扭矩 0x%06x, 峰值负载 %u‰, 峰值热量 %u%%") \
+    X(LOAD_EVENTS,            "[load] 降额 %u 次, 关扭矩 %u 次, 恢复 %u 次") \
+    X(COMPLIANCE,             "[comp] 要求力矩模式 0x%06x, 已切换 0x%06x, 模式切换提交 %u 次, 力矩饱和 %u 关节·周期") \
+    X(CALIB_ZERO,             "[calib] 记录舵机零位 %u 个关节, 离线 %u 个, NVS 写入结果 %u (1=成功)") \
+    X(SERVO_INIT_READ_FAIL,   "ServoManager::InitializeAllServos 总线 %d 读取初始位置失败") \
+    X(SERVO_INIT_ABORT,       "ServoManager::InitializeAllServos 总线 %d 标定中止 (急停 %d, 极限查找完成 %d)，不保存、不移动")
+
+#endif // LOG_FORMATS_H
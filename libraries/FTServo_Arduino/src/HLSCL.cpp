@@ -22,72 +22,46 @@ HLSCL::HLSCL(u8 End, u8 Level):SCSerial(End, Level)
 
 int HLSCL::WritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC, u16 Torque)
 {
-	if(Position<0){
-		Position = -Position;
-		Position |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, Position);
-	Host2SCS(bBuf+3, bBuf+4, Torque);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[HLSCL_Map::PosEx::Len];
+	HLSCL_Map::PosEx::Pack(End, bBuf, ACC, Position, Torque, Speed);
 	
-	return genWrite(ID, HLSCL_ACC, bBuf, 7);
+	return genWrite(ID, HLSCL_Map::PosEx::Addr, bBuf, sizeof(bBuf));
 }
 
 int HLSCL::RegWritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC, u16 Torque)
 {
-	if(Position<0){
-		Position = -Position;
-		Position |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, Position);
-	Host2SCS(bBuf+3, bBuf+4, Torque);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[HLSCL_Map::PosEx::Len];
+	HLSCL_Map::PosEx::Pack(End, bBuf, ACC, Position, Torque, Speed);
 	
-	return regWrite(ID, HLSCL_ACC, bBuf, 7);
+	return regWrite(ID, HLSCL_Map::PosEx::Addr, bBuf, sizeof(bBuf));
 }
 
-void HLSCL::SyncWritePosEx(u8 ID[], u8 IDN, s16 Position[], u16 Speed[], u8 ACC[], u16 Torque[])
+int HLSCL::SyncWritePosEx(u8 ID[], u8 IDN, const s16 Position[], const u16 Speed[], const u8 ACC[], const u16 Torque[])
 {
-    u8 offbuf[7*IDN];
-    for(u8 i = 0; i<IDN; i++){
-		if(Position[i]<0){
-			Position[i] = -Position[i];
-			Position[i] |= (1<<15);
-		}
-		if(ACC){
-			offbuf[i*7] = ACC[i];
-		}else{
-			offbuf[i*7] = 0;
-		}
-        Host2SCS(offbuf+i*7+1, offbuf+i*7+2, Position[i]);
-        Host2SCS(offbuf+i*7+3, offbuf+i*7+4, Torque[i]);
-        Host2SCS(offbuf+i*7+5, offbuf+i*7+6, Speed[i]);
-    }
-    syncWrite(ID, IDN, HLSCL_ACC, offbuf, 7);
+	typedef HLSCL_Map::PosEx Block;
+	u8 offbuf[SCS_SYNC_WRITE_MAX_DATA];
+	if(IDN>Block::MaxSyncIDN){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	for(u8 i = 0; i<IDN; i++){
+		Block::Pack(End, offbuf+i*Block::Len, SCSArg(ACC, i), Position[i], SCSArg(Torque, i), SCSArg(Speed, i));
+	}
+	return syncWrite(ID, IDN, Block::Addr, offbuf, Block::Len);
 }
 
-void HLSCL::SyncWriteSpe(u8 ID[], u8 IDN, s16 Speed[], u8 ACC[], u16 Torque[])
+int HLSCL::SyncWriteSpe(u8 ID[], u8 IDN, const s16 Speed[], const u8 ACC[], const u16 Torque[])
 {
-    u8 offbuf[7*IDN];
-    for(u8 i = 0; i<IDN; i++){
-		if(Speed[i]<0){
-			Speed[i] = -Speed[i];
-			Speed[i] |= (1<<15);
-		}
-		if(ACC){
-			offbuf[i*7] = ACC[i];
-		}else{
-			offbuf[i*7] = 0;
-		}
-        Host2SCS(offbuf+i*7+1, offbuf+i*7+2, 0);
-        Host2SCS(offbuf+i*7+3, offbuf+i*7+4, Torque[i]);
-        Host2SCS(offbuf+i*7+5, offbuf+i*7+6, Speed[i]);
-    }
-    syncWrite(ID, IDN, HLSCL_ACC, offbuf, 7);
+	typedef HLSCL_Map::PosEx Block;
+	u8 offbuf[SCS_SYNC_WRITE_MAX_DATA];
+	if(IDN>Block::MaxSyncIDN){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	for(u8 i = 0; i<IDN; i++){
+		Block::Pack(End, offbuf+i*Block::Len, SCSArg(ACC, i), 0, SCSArg(Torque, i), Speed[i]);
+	}
+	return syncWrite(ID, IDN, Block::Addr, offbuf, Block::Len);
 }
 
 int HLSCL::WheelMode(u8 ID)
@@ -102,26 +76,15 @@ int HLSCL::EleMode(u8 ID)
 
 int HLSCL::WriteSpe(u8 ID, s16 Speed, u8 ACC, u16 Torque)
 {
-	if(Speed<0){
-		Speed = -Speed;
-		Speed |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, 0);
-	Host2SCS(bBuf+3, bBuf+4, Torque);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[HLSCL_Map::PosEx::Len];
+	HLSCL_Map::PosEx::Pack(End, bBuf, ACC, 0, Torque, Speed);
 	
-	return genWrite(ID, HLSCL_ACC, bBuf, 7);
+	return genWrite(ID, HLSCL_Map::PosEx::Addr, bBuf, sizeof(bBuf));
 }
 
 int HLSCL::WriteEle(u8 ID, s16 Torque)
 {
-	if(Torque<0){
-		Torque = -Torque;
-		Torque |= (1<<15);
-	}
-	return writeWord(ID, HLSCL_GOAL_TORQUE_L, Torque);
+	return writeWord(ID, HLSCL_Map::GoalTorque::Addr, HLSCL_Map::GoalTorque::Encode(Torque));
 }
 
 int HLSCL::EnableTorque(u8 ID, u8 Enable)
@@ -166,9 +129,7 @@ int HLSCL::ReadPos(int ID)
 	}else{
 		Pos = readWord(ID, HLSCL_PRESENT_POSITION_L);
 	}
-	if(Pos&(1<<15)){
-		Pos = -(Pos&~(1<<15));
-	}
+	Pos = HLSCL_Map::PresentPosition::Decode(Pos);
 	
 	return Pos;
 }
@@ -183,9 +144,7 @@ int HLSCL::ReadSpeed(int ID)
 	}else{
 		Speed = readWord(ID, HLSCL_PRESENT_SPEED_L);
 	}
-	if(Speed&(1<<15)){
-		Speed = -(Speed&~(1<<15));
-	}	
+	Speed = HLSCL_Map::PresentSpeed::Decode(Speed);
 	return Speed;
 }
 
@@ -199,9 +158,7 @@ int HLSCL::ReadLoad(int ID)
 	}else{
 		Load = readWord(ID, HLSCL_PRESENT_LOAD_L);
 	}
-	if(Load&(1<<10)){
-		Load = -(Load&~(1<<10));
-	}
+	Load = HLSCL_Map::PresentLoad::Decode(Load);
 	return Load;
 }
 
@@ -248,9 +205,7 @@ int HLSCL::ReadCurrent(int ID)
 	}else{
 		Current = readWord(ID, HLSCL_PRESENT_CURRENT_L);
 	}
-	if(Current&(1<<15)){
-		Current = -(Current&~(1<<15));
-	}	
+	Current = HLSCL_Map::PresentCurrent::Decode(Current);
 	return Current;
 }
 
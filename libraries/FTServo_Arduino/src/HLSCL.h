@@ -54,6 +54,22 @@
 #define HLSCL_PRESENT_CURRENT_H 70
 
 #include "SCSerial.h"
+#include "SCSRegMap.h"
+
+//内存表编译期描述
+struct HLSCL_Map
+{
+	typedef SCSReg<HLSCL_ACC, 1> Acc;
+	typedef SCSReg<HLSCL_GOAL_POSITION_L, 2, 15> GoalPosition;
+	typedef SCSReg<HLSCL_GOAL_TORQUE_L, 2, 15> GoalTorque;
+	typedef SCSReg<HLSCL_GOAL_SPEED_L, 2, 15> GoalSpeed;
+	typedef SCSReg<HLSCL_TORQUE_LIMIT_L, 2> TorqueLimit;//RAM区力矩限制(0~1000)
+	typedef SCSReg<HLSCL_PRESENT_POSITION_L, 2, 15> PresentPosition;
+	typedef SCSReg<HLSCL_PRESENT_SPEED_L, 2, 15> PresentSpeed;
+	typedef SCSReg<HLSCL_PRESENT_LOAD_L, 2, 10> PresentLoad;
+	typedef SCSReg<HLSCL_PRESENT_CURRENT_L, 2, 15> PresentCurrent;
+	typedef SCSBlock<Acc, GoalPosition, GoalTorque, GoalSpeed> PosEx;//ACC,位置,力矩,速度
+};
 
 class HLSCL : public SCSerial
 {
@@ -63,8 +79,8 @@ public:
 	HLSCL(u8 End, u8 Level);
 	int WritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC = 0, u16 Torque = 0);//普通写单个舵机位置指令
 	int RegWritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC = 0, u16 Torque = 0);//异步写单个舵机位置指令(RegWriteAction生效)
-	void SyncWritePosEx(u8 ID[], u8 IDN, s16 Position[], u16 Speed[], u8 ACC[], u16 Torque[]);//同步写多个舵机位置指令
-	void SyncWriteSpe(u8 ID[], u8 IDN, s16 Speed[], u8 ACC[], u16 Torque[]);//同步写多个舵机速度指令
+	int SyncWritePosEx(u8 ID[], u8 IDN, const s16 Position[], const u16 Speed[], const u8 ACC[], const u16 Torque[]);//同步写多个舵机位置指令(超出单帧上限时不发送，返回0)
+	int SyncWriteSpe(u8 ID[], u8 IDN, const s16 Speed[], const u8 ACC[], const u16 Torque[]);//同步写多个舵机速度指令(超出单帧上限时不发送，返回0)
 	int ServoMode(u8 ID);//Servo模式
 	int WheelMode(u8 ID);//恒速模式
 	int EleMode(u8 ID);//恒力模式
@@ -7,30 +7,56 @@
 
 #include <stddef.h>
 #include "SCS.h"
+#include "SCSerial.h"
 
-SCS::SCS()
+template<class Transport>
+SCS<Transport>::SCS()
 {
 	Level = 1;//除广播指令所有指令返回应答
 	u8Status = 0;
+	syncReadRxBuff = syncReadRxStore;
+	syncReadRxBuffLen = 0;
+	syncReadRxBuffMax = 0;
+	txBurstBuf = NULL;
+	txBurstLen = 0;
+	txBurstMax = 0;
+	txBurstSent = 0;
 }
 
-SCS::SCS(u8 End)
+template<class Transport>
+SCS<Transport>::SCS(u8 End)
 {
 	Level = 1;
 	this->End = End;
 	u8Status = 0;
+	syncReadRxBuff = syncReadRxStore;
+	syncReadRxBuffLen = 0;
+	syncReadRxBuffMax = 0;
+	txBurstBuf = NULL;
+	txBurstLen = 0;
+	txBurstMax = 0;
+	txBurstSent = 0;
 }
 
-SCS::SCS(u8 End, u8 Level)
+template<class Transport>
+SCS<Transport>::SCS(u8 End, u8 Level)
 {
 	this->Level = Level;
 	this->End = End;
 	u8Status = 0;
+	syncReadRxBuff = syncReadRxStore;
+	syncReadRxBuffLen = 0;
+	syncReadRxBuffMax = 0;
+	txBurstBuf = NULL;
+	txBurstLen = 0;
+	txBurstMax = 0;
+	txBurstSent = 0;
 }
 
 //1个16位数拆分为2个8位数
 //DataL为低位，DataH为高位
-void SCS::Host2SCS(u8 *DataL, u8* DataH, u16 Data)
+template<class Transport>
+void SCS<Transport>::Host2SCS(u8 *DataL, u8* DataH, u16 Data)
 {
 	if(End){
 		*DataL = (Data>>8);
@@ -43,7 +69,8 @@ void SCS::Host2SCS(u8 *DataL, u8* DataH, u16 Data)
 
 //2个8位数组合为1个16位数
 //DataL为低位，DataH为高位
-u16 SCS::SCS2Host(u8 DataL, u8 DataH)
+template<class Transport>
+u16 SCS<Transport>::SCS2Host(u8 DataL, u8 DataH)
 {
 	u16 Data;
 	if(End){
@@ -58,74 +85,152 @@ u16 SCS::SCS2Host(u8 DataL, u8 DataH)
 	return Data;
 }
 
-void SCS::writeBuf(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen, u8 Fun)
+template<class Transport>
+void SCS<Transport>::writeBuf(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen, u8 Fun)
 {
+	//整帧组装后一次写出
+	u8 bBuf[SCS_MAX_FRAME_LEN];
 	u8 msgLen = 2;
-	u8 bBuf[6];
-	u8 CheckSum = 0;
+	u8 Size;
 	bBuf[0] = 0xff;
 	bBuf[1] = 0xff;
 	bBuf[2] = ID;
 	bBuf[4] = Fun;
 	if(nDat){
 		msgLen += nLen + 1;
-		bBuf[3] = msgLen;
 		bBuf[5] = MemAddr;
-		writeSCS(bBuf, 6);
-		
+		for(u8 i=0; i<nLen; i++){
+			bBuf[6+i] = nDat[i];
+		}
+		Size = 6 + nLen;
 	}else{
-		bBuf[3] = msgLen;
-		writeSCS(bBuf, 5);
+		Size = 5;
 	}
-	CheckSum = ID + msgLen + Fun + MemAddr;
-	u8 i = 0;
+	bBuf[3] = msgLen;
+	u8 CheckSum = ID + msgLen + Fun + MemAddr;
 	if(nDat){
-		for(i=0; i<nLen; i++){
+		for(u8 i=0; i<nLen; i++){
 			CheckSum += nDat[i];
 		}
-		writeSCS(nDat, nLen);
 	}
-	writeSCS(~CheckSum);
+	bBuf[Size++] = ~CheckSum;
+	writeFrame(bBuf, Size);
+}
+
+template<class Transport>
+void SCS<Transport>::writeFrame(const u8 *Frame, u16 Len)
+{
+	if(txBurstBuf){
+		//放不下时先写出已拼接的帧，总线上的帧顺序与调用顺序一致
+		if(txBurstLen+Len>txBurstMax && txBurstLen){
+			io().writeSCS(txBurstBuf, txBurstLen);
+			txBurstSent += txBurstLen;
+			txBurstLen = 0;
+		}
+		if(Len<=txBurstMax){
+			for(u16 i=0; i<Len; i++){
+				txBurstBuf[txBurstLen++] = Frame[i];
+			}
+			return;
+		}
+		txBurstSent += Len;
+	}
+	io().writeSCS(Frame, Len);
+}
+
+//开始拼接发送
+//Buf为调用者提供的缓冲，放不下时先写出已拼接的部分（会打断一次写出，应按最坏情况给足缓冲）
+template<class Transport>
+void SCS<Transport>::txBurstBegin(u8 *Buf, u16 Max)
+{
+	io().rFlushSCS();
+	txBurstBuf = Buf;
+	txBurstLen = 0;
+	txBurstMax = Max;
+	txBurstSent = 0;
+}
+
+template<class Transport>
+int SCS<Transport>::txBurstEnd()
+{
+	int Len = txBurstSent + txBurstLen;
+	if(txBurstBuf && txBurstLen){
+		io().writeSCS(txBurstBuf, txBurstLen);
+	}
+	io().wFlushSCS();
+	txBurstBuf = NULL;
+	txBurstLen = 0;
+	txBurstSent = 0;
+	return Len;
 }
 
 //普通写指令
 //舵机ID，MemAddr内存表地址，写入数据，写入长度
-int SCS::genWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen)
+template<class Transport>
+int SCS<Transport>::genWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, MemAddr, nDat, nLen, INST_WRITE);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
 
 //异步写指令
 //舵机ID，MemAddr内存表地址，写入数据，写入长度
-int SCS::regWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen)
+template<class Transport>
+int SCS<Transport>::regWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, MemAddr, nDat, nLen, INST_REG_WRITE);
-	wFlushSCS();
+	io().wFlushSCS();
+	return Ack(ID);
+}
+
+//异步写指令分两步：先在多条总线上依次发送，再依次接收应答，各总线的往返时间相互重叠
+template<class Transport>
+void SCS<Transport>::regWriteSend(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen)
+{
+	io().rFlushSCS();
+	writeBuf(ID, MemAddr, nDat, nLen, INST_REG_WRITE);
+	io().wFlushSCS();
+}
+
+template<class Transport>
+int SCS<Transport>::regWriteAck(u8 ID)
+{
 	return Ack(ID);
 }
 
 //异步写执行指令
-//舵机ID
-int SCS::RegWriteAction(u8 ID)
+//舵机ID，拼接发送时只能为广播ID（广播无应答）
+template<class Transport>
+int SCS<Transport>::RegWriteAction(u8 ID)
 {
-	rFlushSCS();
+	if(txBurstBuf){
+		writeBuf(0xfe, 0, NULL, 0, INST_REG_ACTION);
+		return 1;
+	}
+	io().rFlushSCS();
 	writeBuf(ID, 0, NULL, 0, INST_REG_ACTION);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
 
 //同步写指令
 //舵机ID[]数组，IDN数组长度，MemAddr内存表地址，写入数据，写入长度
-void SCS::syncWrite(u8 ID[], u8 IDN, u8 MemAddr, u8 *nDat, u8 nLen)
+template<class Transport>
+int SCS<Transport>::syncWrite(u8 ID[], u8 IDN, u8 MemAddr, u8 *nDat, u8 nLen)
 {
-	rFlushSCS();
+	//帧长 (nLen+1)*IDN+4 不能超过 255，超出时整帧不发送（只发一部分舵机会让调用者误以为全部生效）
+	if((nLen+1)*IDN+4>255){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	if(!txBurstBuf){
+		io().rFlushSCS();
+	}
+	u8 bBuf[SCS_MAX_FRAME_LEN];
 	u8 mesLen = ((nLen+1)*IDN+4);
-	u8 Sum = 0;
-	u8 bBuf[7];
 	bBuf[0] = 0xff;
 	bBuf[1] = 0xff;
 	bBuf[2] = 0xfe;
@@ -133,47 +238,54 @@ void SCS::syncWrite(u8 ID[], u8 IDN, u8 MemAddr, u8 *nDat, u8 nLen)
 	bBuf[4] = INST_SYNC_WRITE;
 	bBuf[5] = MemAddr;
 	bBuf[6] = nLen;
-	writeSCS(bBuf, 7);
+	u16 Size = 7;
 
-	Sum = 0xfe + mesLen + INST_SYNC_WRITE + MemAddr + nLen;
+	u8 Sum = 0xfe + mesLen + INST_SYNC_WRITE + MemAddr + nLen;
 	u8 i, j;
 	for(i=0; i<IDN; i++){
-		writeSCS(ID[i]);
-		writeSCS(nDat+i*nLen, nLen);
+		bBuf[Size++] = ID[i];
 		Sum += ID[i];
 		for(j=0; j<nLen; j++){
+			bBuf[Size++] = nDat[i*nLen+j];
 			Sum += nDat[i*nLen+j];
 		}
 	}
-	writeSCS(~Sum);
-	wFlushSCS();
+	bBuf[Size++] = ~Sum;
+	writeFrame(bBuf, Size);
+	if(!txBurstBuf){
+		io().wFlushSCS();
+	}
+	return Size;
 }
 
-int SCS::writeByte(u8 ID, u8 MemAddr, u8 bDat)
+template<class Transport>
+int SCS<Transport>::writeByte(u8 ID, u8 MemAddr, u8 bDat)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, MemAddr, &bDat, 1, INST_WRITE);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
 
-int SCS::writeWord(u8 ID, u8 MemAddr, u16 wDat)
+template<class Transport>
+int SCS<Transport>::writeWord(u8 ID, u8 MemAddr, u16 wDat)
 {
 	u8 bBuf[2];
 	Host2SCS(bBuf+0, bBuf+1, wDat);
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, MemAddr, bBuf, 2, INST_WRITE);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
 
 //读指令
 //舵机ID，MemAddr内存表地址，返回数据nData，数据长度nLen
-int SCS::Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen)
+template<class Transport>
+int SCS<Transport>::Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, MemAddr, &nLen, 1, INST_READ);
-	wFlushSCS();
+	io().wFlushSCS();
 	u8Error = 0;
 	if(!checkHead()){
 		u8Error = ERR_NO_REPLY;
@@ -181,7 +293,7 @@ int SCS::Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen)
 	}
 	u8 bBuf[4];
 	u8Status = 0;
-	if(readSCS(bBuf, 3)!=3){
+	if(io().readSCS(bBuf, 3)!=3){
 		u8Error = ERR_NO_REPLY;
 		return 0;
 	}
@@ -193,12 +305,12 @@ int SCS::Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen)
 		u8Error = ERR_BUFF_LEN;
 		return 0;
 	}
-	int Size = readSCS(nData, nLen);
+	int Size = io().readSCS(nData, nLen);
 	if(Size!=nLen){
 		u8Error = ERR_NO_REPLY;
 		return 0;
 	}
-	if(readSCS(bBuf+3, 1)!=1){
+	if(io().readSCS(bBuf+3, 1)!=1){
 		u8Error = ERR_NO_REPLY;
 		return 0;
 	}
@@ -217,7 +329,8 @@ int SCS::Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen)
 }
 
 //读1字节，超时返回-1
-int SCS::readByte(u8 ID, u8 MemAddr)
+template<class Transport>
+int SCS<Transport>::readByte(u8 ID, u8 MemAddr)
 {
 	u8 bDat;
 	int Size = Read(ID, MemAddr, &bDat, 1);
@@ -229,7 +342,8 @@ int SCS::readByte(u8 ID, u8 MemAddr)
 }
 
 //读2字节，超时返回-1
-int SCS::readWord(u8 ID, u8 MemAddr)
+template<class Transport>
+int SCS<Transport>::readWord(u8 ID, u8 MemAddr)
 {	
 	u8 nDat[2];
 	int Size;
@@ -242,11 +356,12 @@ int SCS::readWord(u8 ID, u8 MemAddr)
 }
 
 //Ping指令，返回舵机ID，超时返回-1
-int	SCS::Ping(u8 ID)
+template<class Transport>
+int	SCS<Transport>::Ping(u8 ID)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, 0, NULL, 0, INST_PING);
-	wFlushSCS();
+	io().wFlushSCS();
 	u8Status = 0;
 	if(!checkHead()){
 		u8Error = ERR_NO_REPLY;
@@ -254,7 +369,7 @@ int	SCS::Ping(u8 ID)
 	}
 	u8 bBuf[4];
 	u8Error = 0;
-	if(readSCS(bBuf, 4)!=4){
+	if(io().readSCS(bBuf, 4)!=4){
 		u8Error = ERR_NO_REPLY;
 		return -1;
 	}
@@ -275,13 +390,14 @@ int	SCS::Ping(u8 ID)
 	return bBuf[0];
 }
 
-int SCS::checkHead()
+template<class Transport>
+int SCS<Transport>::checkHead()
 {
 	u8 bDat;
 	u8 bBuf[] = {0, 0};
 	u8 Cnt = 0;
 	while(1){
-		if(!readSCS(&bDat, 1)){
+		if(!io().readSCS(&bDat, 1)){
 			return 0;
 		}
 		bBuf[1] = bBuf[0];
@@ -297,7 +413,8 @@ int SCS::checkHead()
 	return 1;
 }
 
-int	SCS::Ack(u8 ID)
+template<class Transport>
+int	SCS<Transport>::Ack(u8 ID)
 {
 	u8Error = 0;
 	if(ID!=0xfe && Level){
@@ -307,7 +424,7 @@ int	SCS::Ack(u8 ID)
 		}
 		u8Status = 0;
 		u8 bBuf[4];
-		if(readSCS(bBuf, 4)!=4){
+		if(io().readSCS(bBuf, 4)!=4){
 			u8Error = ERR_NO_REPLY;
 			return 0;
 		}
@@ -329,47 +446,75 @@ int	SCS::Ack(u8 ID)
 	return 1;
 }
 
-int	SCS::syncReadPacketTx(u8 ID[], u8 IDN, u8 MemAddr, u8 nLen)
+template<class Transport>
+int	SCS<Transport>::syncReadPacketTx(u8 ID[], u8 IDN, u8 MemAddr, u8 nLen)
+{
+	io().rFlushSCS();
+	syncReadPacketSend(ID, IDN, MemAddr, nLen);
+	io().wFlushSCS();
+	return syncReadPacketCollect();
+}
+
+template<class Transport>
+void SCS<Transport>::syncReadPacketSend(u8 ID[], u8 IDN, u8 MemAddr, u8 nLen)
 {
-	rFlushSCS();
 	syncReadRxPacketLen = nLen;
+	if(syncReadRxBuffMax==0 || IDN*(nLen+6)>syncReadRxBuffMax){
+		u8Error = ERR_BUFF_LEN;
+		return;
+	}
+	u8 bBuf[SCS_MAX_FRAME_LEN];
 	u8 checkSum = (4+0xfe) + IDN + MemAddr + nLen + INST_SYNC_READ;
 	u8 i;
-	writeSCS(0xff);
-	writeSCS(0xff);
-	writeSCS(0xfe);
-	writeSCS(IDN+4);
-	writeSCS(INST_SYNC_READ);
-	writeSCS(MemAddr);
-	writeSCS(nLen);
+	bBuf[0] = 0xff;
+	bBuf[1] = 0xff;
+	bBuf[2] = 0xfe;
+	bBuf[3] = IDN+4;
+	bBuf[4] = INST_SYNC_READ;
+	bBuf[5] = MemAddr;
+	bBuf[6] = nLen;
 	for(i=0; i<IDN; i++){
-		writeSCS(ID[i]);
+		bBuf[7+i] = ID[i];
 		checkSum += ID[i];
 	}
-	checkSum = ~checkSum;
-	writeSCS(checkSum);
-	wFlushSCS();
-	
-	syncReadRxBuffLen = readSCS(syncReadRxBuff, syncReadRxBuffMax, syncTimeOut);
+	bBuf[7+IDN] = ~checkSum;
+	writeFrame(bBuf, 8+IDN);
+}
+
+template<class Transport>
+int SCS<Transport>::syncReadPacketCollect()
+{
+	if(syncReadRxBuffMax==0){
+		syncReadRxBuffLen = 0;
+		return 0;
+	}
+	syncReadRxBuffLen = io().readSCS(syncReadRxBuff, syncReadRxBuffMax, syncTimeOut);
 	return syncReadRxBuffLen;
 }
 
-void SCS::syncReadBegin(u8 IDN, u8 rxLen, u32 TimeOut)
+template<class Transport>
+int SCS<Transport>::syncReadBegin(u8 IDN, u8 rxLen, u32 TimeOut)
 {
-	syncReadRxBuffMax = IDN*(rxLen+6);
-	syncReadRxBuff = new u8[syncReadRxBuffMax];
+	syncReadRxBuffLen = 0;
 	syncTimeOut = TimeOut;
+	if(IDN*(rxLen+6)>SCS_SYNC_READ_BUF_LEN){
+		syncReadRxBuffMax = 0;
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	syncReadRxBuffMax = IDN*(rxLen+6);
+	return 1;
 }
 
-void SCS::syncReadEnd()
+template<class Transport>
+void SCS<Transport>::syncReadEnd()
 {
-	if(syncReadRxBuff){
-		delete syncReadRxBuff;
-		syncReadRxBuff = NULL;
-	}
+	syncReadRxBuffLen = 0;
+	syncReadRxBuffMax = 0;
 }
 
-int SCS::syncReadPacketRx(u8 ID, u8 *nDat)
+template<class Transport>
+int SCS<Transport>::syncReadPacketRx(u8 ID, u8 *nDat)
 {
 	u16 syncReadRxBuffIndex = 0;
 	syncReadRxPacket = nDat;
@@ -408,7 +553,8 @@ int SCS::syncReadPacketRx(u8 ID, u8 *nDat)
 	return 0;
 }
 
-int SCS::syncReadRxPacketToByte()
+template<class Transport>
+int SCS<Transport>::syncReadRxPacketToByte()
 {
 	if(syncReadRxPacketIndex>=syncReadRxPacketLen){
 		u8Error = ERR_BUFF_LEN;
@@ -417,7 +563,8 @@ int SCS::syncReadRxPacketToByte()
 	return syncReadRxPacket[syncReadRxPacketIndex++];
 }
 
-int SCS::syncReadRxPacketToWrod(u8 negBit)
+template<class Transport>
+int SCS<Transport>::syncReadRxPacketToWrod(u8 negBit)
 {
 	if((syncReadRxPacketIndex+1)>=syncReadRxPacketLen){
 		u8Error = ERR_BUFF_LEN;
@@ -433,18 +580,23 @@ int SCS::syncReadRxPacketToWrod(u8 negBit)
 	return Word;
 }
 
-int SCS::Reset(u8 ID)
+template<class Transport>
+int SCS<Transport>::Reset(u8 ID)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, 0, NULL, 0, INST_RESET);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
 
-int SCS::Recal(u8 ID)
+template<class Transport>
+int SCS<Transport>::Recal(u8 ID)
 {
-	rFlushSCS();
+	io().rFlushSCS();
 	writeBuf(ID, 0, NULL, 0, INST_CAL);
-	wFlushSCS();
+	io().wFlushSCS();
 	return Ack(ID);
 }
+
+//显式实例化：协议层代码只在本文件编译一次
+template class SCS<SCSerial>;
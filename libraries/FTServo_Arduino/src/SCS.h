@@ -10,6 +10,27 @@
 
 #include "INST.h"
 
+//单帧最大长度：FF FF ID LEN + LEN(<=255) 字节
+#define SCS_MAX_FRAME_LEN 259
+
+//同步读接收缓冲：最多 SCS_SYNC_READ_MAX_IDN 个舵机、每个舵机 SCS_SYNC_READ_MAX_LEN 字节，
+//每个应答另有 6 字节帧头/校验；缓冲在对象内，同步读不再从堆上分配
+#ifndef SCS_SYNC_READ_MAX_IDN
+#define SCS_SYNC_READ_MAX_IDN 8
+#endif
+#ifndef SCS_SYNC_READ_MAX_LEN
+#define SCS_SYNC_READ_MAX_LEN 16
+#endif
+#define SCS_SYNC_READ_BUF_LEN (SCS_SYNC_READ_MAX_IDN*(SCS_SYNC_READ_MAX_LEN+6))
+
+//协议层，以 CRTP 方式调用传输层 Transport（即派生类，例如 SCSerial）
+//I/O 为普通成员调用，可以被内联；Transport 需要提供：
+//	int writeSCS(const unsigned char *nDat, int nLen);//输出整帧
+//	int readSCS(unsigned char *nDat, int nLen);//输入nLen字节，字节间超时
+//	int readSCS(unsigned char *nDat, int nLen, unsigned long TimeOut);//输入nLen字节，总超时
+//	void rFlushSCS();
+//	void wFlushSCS();
+template<class Transport>
 class SCS{
 public:
 	SCS();
@@ -17,8 +38,10 @@ public:
 	SCS(u8 End, u8 Level);
 	int genWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen);//普通写指令
 	int regWrite(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen);//异步写指令
-	int RegWriteAction(u8 ID = 0xfe);//异步写执行指令
-	void syncWrite(u8 ID[], u8 IDN, u8 MemAddr, u8 *nDat, u8 nLen);//同步写指令
+	int RegWriteAction(u8 ID = 0xfe);//异步写执行指令（拼接发送时只追加广播帧）
+	void regWriteSend(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen);//只发送异步写指令（不等待应答）
+	int regWriteAck(u8 ID);//接收regWriteSend的应答
+	int syncWrite(u8 ID[], u8 IDN, u8 MemAddr, u8 *nDat, u8 nLen);//同步写指令，返回帧长度，超出单帧上限时不发送并返回0
 	int writeByte(u8 ID, u8 MemAddr, u8 bDat);//写1个字节
 	int writeWord(u8 ID, u8 MemAddr, u16 wDat);//写2个字节
 	int Read(u8 ID, u8 MemAddr, u8 *nData, u8 nLen);//读指令
@@ -26,10 +49,14 @@ public:
 	int readWord(u8 ID, u8 MemAddr);//读2个字节
 	int Ping(u8 ID);//Ping指令
 	int syncReadPacketTx(u8 ID[], u8 IDN, u8 MemAddr, u8 nLen);//同步读指令包发送
+	void syncReadPacketSend(u8 ID[], u8 IDN, u8 MemAddr, u8 nLen);//只发送同步读指令包（不清空接收、不等待应答）
+	int syncReadPacketCollect();//接收同步读应答，返回接收字节数
+	void txBurstBegin(u8 *Buf, u16 Max);//开始拼接发送：之后的同步写/同步读请求先放入Buf，只在开始时清空一次接收
+	int txBurstEnd();//一次写出拼接的全部帧，返回本次拼接写出的总字节数
 	int syncReadPacketRx(u8 ID, u8 *nDat);//同步读返回包解码，成功返回内存字节数，失败返回0
 	int syncReadRxPacketToByte();//解码一个字节
 	int syncReadRxPacketToWrod(u8 negBit=0);//解码两个字节，negBit为方向为，negBit=0表示无方向
-	void syncReadBegin(u8 IDN, u8 rxLen, u32 TimeOut);//同步读开始
+	int syncReadBegin(u8 IDN, u8 rxLen, u32 TimeOut);//同步读开始，应答超出接收缓冲时返回0，随后的同步读不发送
 	void syncReadEnd();//同步读结束
 	int Reset(u8 ID);//重置舵机状态
 	int Recal(u8 ID);//重置舵机中位
@@ -45,17 +72,17 @@ public:
 	u8 *syncReadRxPacket;
 	u8 *syncReadRxBuff;
 	u16 syncReadRxBuffLen;
-	u16 syncReadRxBuffMax;
+	u16 syncReadRxBuffMax;//本次同步读的应答长度，0表示未开始或被拒绝
+	u8 syncReadRxStore[SCS_SYNC_READ_BUF_LEN];
 	u32 syncTimeOut;
+	u8 *txBurstBuf;//拼接发送缓冲（NULL表示逐帧写出）
+	u16 txBurstLen;
+	u16 txBurstMax;
+	u16 txBurstSent;//缓冲放不下时提前写出的字节数
 protected:
-	virtual int writeSCS(unsigned char *nDat, int nLen) = 0;
-	virtual int readSCS(unsigned char *nDat, int nLen) = 0;
-	virtual int readSCS(unsigned char *nDat, int nLen, unsigned long TimeOut) = 0;
-	virtual int writeSCS(unsigned char bDat) = 0;
-	virtual void rFlushSCS() = 0;
-	virtual void wFlushSCS() = 0;
-protected:
+	Transport &io(){ return *static_cast<Transport*>(this); }
 	void writeBuf(u8 ID, u8 MemAddr, u8 *nDat, u8 nLen, u8 Fun);
+	void writeFrame(const u8 *Frame, u16 Len);//写出一帧（拼接发送时追加到缓冲）
 	void Host2SCS(u8 *DataL, u8* DataH, u16 Data);//1个16位数拆分为2个8位数
 	u16	SCS2Host(u8 DataL, u8 DataH);//2个8位数组合为1个16位数
 	int	Ack(u8 ID);//返回应答
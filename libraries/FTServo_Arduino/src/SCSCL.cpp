@@ -22,44 +22,32 @@ SCSCL::SCSCL(u8 End, u8 Level):SCSerial(End, Level)
 
 int SCSCL::WritePos(u8 ID, u16 Position, u16 Time, u16 Speed)
 {
-	u8 bBuf[6];
-	Host2SCS(bBuf+0, bBuf+1, Position);
-	Host2SCS(bBuf+2, bBuf+3, Time);
-	Host2SCS(bBuf+4, bBuf+5, Speed);
+	u8 bBuf[SCSCL_Map::Pos::Len];
+	SCSCL_Map::Pos::Pack(End, bBuf, Position, Time, Speed);
 	
-	return genWrite(ID, SCSCL_GOAL_POSITION_L, bBuf, 6);
+	return genWrite(ID, SCSCL_Map::Pos::Addr, bBuf, sizeof(bBuf));
 }
 
 int SCSCL::RegWritePos(u8 ID, u16 Position, u16 Time, u16 Speed)
 {
-	u8 bBuf[6];
-	Host2SCS(bBuf+0, bBuf+1, Position);
-	Host2SCS(bBuf+2, bBuf+3, Time);
-	Host2SCS(bBuf+4, bBuf+5, Speed);
+	u8 bBuf[SCSCL_Map::Pos::Len];
+	SCSCL_Map::Pos::Pack(End, bBuf, Position, Time, Speed);
 	
-	return regWrite(ID, SCSCL_GOAL_POSITION_L, bBuf, 6);
-}
-
-void SCSCL::SyncWritePos(u8 ID[], u8 IDN, u16 Position[], u16 Time[], u16 Speed[])
-{
-    u8 offbuf[6*IDN];
-    for(u8 i = 0; i<IDN; i++){
-		u16 T, V;
-		if(Time){
-			T = Time[i];
-		}else{
-			T = 0;
-		}
-		if(Speed){
-			V = Speed[i];
-		}else{
-			V = 0;
-		}
-        Host2SCS(offbuf+i*6+0, offbuf+i*6+1, Position[i]);
-        Host2SCS(offbuf+i*6+2, offbuf+i*6+3, T);
-        Host2SCS(offbuf+i*6+4, offbuf+i*6+5, V);
-    }
-    syncWrite(ID, IDN, SCSCL_GOAL_POSITION_L, offbuf, 6);
+	return regWrite(ID, SCSCL_Map::Pos::Addr, bBuf, sizeof(bBuf));
+}
+
+int SCSCL::SyncWritePos(u8 ID[], u8 IDN, const u16 Position[], const u16 Time[], const u16 Speed[])
+{
+	typedef SCSCL_Map::Pos Block;
+	u8 offbuf[SCS_SYNC_WRITE_MAX_DATA];
+	if(IDN>Block::MaxSyncIDN){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	for(u8 i = 0; i<IDN; i++){
+		Block::Pack(End, offbuf+i*Block::Len, Position[i], SCSArg(Time, i), SCSArg(Speed, i));
+	}
+	return syncWrite(ID, IDN, Block::Addr, offbuf, Block::Len);
 }
 
 int SCSCL::EnableTorque(u8 ID, u8 Enable)
@@ -109,9 +97,7 @@ int SCSCL::ReadSpeed(int ID)
 	}else{
 		Speed = readWord(ID, SCSCL_PRESENT_SPEED_L);
 	}
-	if(Speed&(1<<15)){
-		Speed = -(Speed&~(1<<15));
-	}	
+	Speed = SCSCL_Map::PresentSpeed::Decode(Speed);
 	return Speed;
 }
 
@@ -125,9 +111,7 @@ int SCSCL::ReadLoad(int ID)
 	}else{
 		Load = readWord(ID, SCSCL_PRESENT_LOAD_L);
 	}
-	if(Load&(1<<10)){
-		Load = -(Load&~(1<<10));
-	}	
+	Load = SCSCL_Map::PresentLoad::Decode(Load);
 	return Load;
 }
 
@@ -174,9 +158,7 @@ int SCSCL::ReadCurrent(int ID)
 	}else{
 		Current = readWord(ID, SCSCL_PRESENT_CURRENT_L);
 	}
-	if(Current&(1<<15)){
-		Current = -(Current&~(1<<15));
-	}	
+	Current = SCSCL_Map::PresentCurrent::Decode(Current);
 	return Current;
 }
 
@@ -192,12 +174,8 @@ int SCSCL::PWMMode(u8 ID)
 
 int SCSCL::WritePWM(u8 ID, s16 pwmOut)
 {
-	if(pwmOut<0){
-		pwmOut = -pwmOut;
-		pwmOut |= (1<<10);
-	}
-	u8 bBuf[2];
-	Host2SCS(bBuf+0, bBuf+1, pwmOut);
+	u8 bBuf[SCSCL_Map::PWM::Len];
+	SCSCL_Map::PWM::Pack(End, bBuf, pwmOut);
 	
-	return genWrite(ID, SCSCL_GOAL_TIME_L, bBuf, 2);
+	return genWrite(ID, SCSCL_Map::PWM::Addr, bBuf, sizeof(bBuf));
 }
@@ -47,6 +47,22 @@
 #define SCSCL_PRESENT_CURRENT_H 70
 
 #include "SCSerial.h"
+#include "SCSRegMap.h"
+
+//内存表编译期描述
+struct SCSCL_Map
+{
+	typedef SCSReg<SCSCL_GOAL_POSITION_L, 2> GoalPosition;
+	typedef SCSReg<SCSCL_GOAL_TIME_L, 2> GoalTime;
+	typedef SCSReg<SCSCL_GOAL_SPEED_L, 2> GoalSpeed;
+	typedef SCSReg<SCSCL_GOAL_TIME_L, 2, 10> GoalPWM;//PWM模式下复用时间寄存器
+	typedef SCSReg<SCSCL_PRESENT_POSITION_L, 2> PresentPosition;
+	typedef SCSReg<SCSCL_PRESENT_SPEED_L, 2, 15> PresentSpeed;
+	typedef SCSReg<SCSCL_PRESENT_LOAD_L, 2, 10> PresentLoad;
+	typedef SCSReg<SCSCL_PRESENT_CURRENT_L, 2, 15> PresentCurrent;
+	typedef SCSBlock<GoalPosition, GoalTime, GoalSpeed> Pos;//位置,时间,速度
+	typedef SCSBlock<GoalPWM> PWM;
+};
 
 class SCSCL : public SCSerial
 {
@@ -56,7 +72,7 @@ public:
 	SCSCL(u8 End, u8 Level);
 	int WritePos(u8 ID, u16 Position, u16 Time, u16 Speed = 0);//普通写单个舵机位置指令
 	int RegWritePos(u8 ID, u16 Position, u16 Time, u16 Speed = 0);//异步写单个舵机位置指令(RegWriteAction生效)
-	void SyncWritePos(u8 ID[], u8 IDN, u16 Position[], u16 Time[], u16 Speed[]);//同步写多个舵机位置指令
+	int SyncWritePos(u8 ID[], u8 IDN, const u16 Position[], const u16 Time[], const u16 Speed[]);//同步写多个舵机位置指令(超出单帧上限时不发送，返回0)
 	int PWMMode(u8 ID);//PWM模式
 	int WritePWM(u8 ID, s16 pwmOut);//PWM输出模式指令
 	int EnableTorque(u8 ID, u8 Enable);//扭矩控制指令
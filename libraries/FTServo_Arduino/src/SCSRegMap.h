@@ -0,0 +1,138 @@
+/*
+ * SCSRegMap.h
+ * 飞特串行舵机内存表编译期描述与编解码
+ *
+ * 每个寄存器用 SCSReg<地址, 宽度, 符号位> 描述（符号位为 0 表示无符号，
+ * 否则为“符号位 + 幅值”表示，例如位置用 bit15，负载/PWM 用 bit10），
+ * 连续写入的一组寄存器用 SCSBlock<起始寄存器, 寄存器...> 描述。
+ * 编码、解码、打包全部在编译期展开：偏移与长度为常量，
+ * 大小端通过模板参数选择，每帧只按 End 分派一次，不再逐字段判断。
+ */
+
+#ifndef _SCS_REG_MAP_H
+#define _SCS_REG_MAP_H
+
+#include "INST.h"
+
+//同步写单帧的最大数据长度：帧长 (nLen+1)*IDN+4 不能超过 255
+#define SCS_SYNC_WRITE_MAX_DATA 251
+
+//寄存器描述
+template<u8 A, u8 W, u8 S = 0>
+struct SCSReg
+{
+	static_assert(W==1 || W==2, "寄存器宽度只能为1或2字节");
+	static_assert(S<W*8, "符号位超出寄存器宽度");
+	static constexpr u8 Addr = A;
+	static constexpr u8 Width = W;
+	static constexpr u8 SignBit = S;
+
+	//主机值 -> 寄存器原始值（符号-幅值编码）
+	static constexpr u16 Encode(int Value)
+	{
+		return (S && Value<0) ? (u16)((u16)(-Value) | (1<<S)) : (u16)Value;
+	}
+
+	//寄存器原始值 -> 主机值（与各型号 ReadXxx 的解码一致，-1 等错误值原样参与运算）
+	static constexpr int Decode(int Raw)
+	{
+		return (S && (Raw&(1<<S))) ? -(Raw&~(1<<S)) : Raw;
+	}
+
+	//按大小端写入/读出，End=0 为低字节在前，End=1 为高字节在前
+	template<u8 End>
+	static inline void Put(u8 *Buf, int Value)
+	{
+		u16 Raw = Encode(Value);
+		if(W==1){
+			Buf[0] = (u8)Raw;
+		}else if(End){
+			Buf[0] = (u8)(Raw>>8);
+			Buf[1] = (u8)(Raw&0xff);
+		}else{
+			Buf[0] = (u8)(Raw&0xff);
+			Buf[1] = (u8)(Raw>>8);
+		}
+	}
+
+	template<u8 End>
+	static inline int Get(const u8 *Buf)
+	{
+		int Raw;
+		if(W==1){
+			Raw = Buf[0];
+		}else if(End){
+			Raw = (Buf[0]<<8) | Buf[1];
+		}else{
+			Raw = (Buf[1]<<8) | Buf[0];
+		}
+		return Decode(Raw);
+	}
+};
+
+template<class... Regs>
+struct SCSLastEnd;
+
+template<class Reg>
+struct SCSLastEnd<Reg>
+{
+	static constexpr u8 Value = Reg::Addr + Reg::Width;
+};
+
+template<class Reg, class... Rest>
+struct SCSLastEnd<Reg, Rest...>
+{
+	static constexpr u8 Value = SCSLastEnd<Rest...>::Value;
+};
+
+//连续写入块：从 First 开始，按地址递增列出块内所有寄存器（中间不留空）
+template<class First, class... Regs>
+struct SCSBlock
+{
+	static constexpr u8 Addr = First::Addr;
+	static constexpr u8 Len = SCSLastEnd<First, Regs...>::Value - First::Addr;
+	static constexpr u8 MaxSyncIDN = SCS_SYNC_WRITE_MAX_DATA/(Len+1);
+
+	//按块内顺序打包一组值到 Buf（长度 Len）
+	template<u8 End, class... Values>
+	static inline void Pack(u8 *Buf, Values... Vals)
+	{
+		static_assert(sizeof...(Values)==sizeof...(Regs)+1, "参数个数与块内寄存器个数不一致");
+		Put<End, First, Regs...>(Buf, Vals...);
+	}
+
+	//按实例的 End 分派（每帧一次）
+	template<class... Values>
+	static inline void Pack(u8 End, u8 *Buf, Values... Vals)
+	{
+		if(End){
+			Pack<1>(Buf, Vals...);
+		}else{
+			Pack<0>(Buf, Vals...);
+		}
+	}
+
+private:
+	template<u8 End, class Reg>
+	static inline void Put(u8 *Buf, int Value)
+	{
+		Reg::template Put<End>(Buf+Reg::Addr-Addr, Value);
+	}
+
+	template<u8 End, class Reg, class Next, class... Rest, class... Values>
+	static inline void Put(u8 *Buf, int Value, Values... Vals)
+	{
+		static_assert(Reg::Addr+Reg::Width==Next::Addr, "块内寄存器必须连续");
+		Reg::template Put<End>(Buf+Reg::Addr-Addr, Value);
+		Put<End, Next, Rest...>(Buf, Vals...);
+	}
+};
+
+//取数组第 i 个元素，数组为空指针时返回 0（SyncWrite 系列的可选参数）
+template<class T>
+static inline int SCSArg(const T *Array, u8 i)
+{
+	return Array ? Array[i] : 0;
+}
+
+#endif
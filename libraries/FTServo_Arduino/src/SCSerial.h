@@ -16,23 +16,117 @@
 
 #include "SCS.h"
 
-class SCSerial : public SCS
+//接收暂存区大小：单舵机应答（6 + 数据）一般一次取完
+#define SCSERIAL_RX_STAGE_LEN 64
+
+//串口传输层：按 available() 一次取出全部已到达字节，协议层的逐字节读取从暂存区返回，
+//不再每字节调用一次串口驱动；整帧一次写出
+class SCSerial : public SCS<SCSerial>
 {
+	friend class SCS<SCSerial>;
 public:
 	SCSerial();
 	SCSerial(u8 End);
 	SCSerial(u8 End, u8 Level);
 
 protected:
-	int writeSCS(unsigned char *nDat, int nLen);//输出nLen字节
+	int writeSCS(const unsigned char *nDat, int nLen);//输出nLen字节
 	int readSCS(unsigned char *nDat, int nLen);//输入nLen字节
 	int readSCS(unsigned char *nDat, int nLen, unsigned long TimeOut);
-	int writeSCS(unsigned char bDat);//输出1字节
 	void rFlushSCS();//
 	void wFlushSCS();//
 public:
 	unsigned long IOTimeOut;//输入输出超时
 	HardwareSerial *pSerial;//串口指针
+private:
+	int readAvailable(unsigned char *nDat, int nLen);//取出已到达的字节（不等待）
+	u8 rxStage[SCSERIAL_RX_STAGE_LEN];
+	u8 rxStagePos;
+	u8 rxStageLen;
 };
 
-#endif
\ No newline at end of file
+//协议层在 SCS.cpp 中显式实例化
+extern template class SCS<SCSerial>;
+
+inline int SCSerial::readAvailable(unsigned char *nDat, int nLen)
+{
+	//先取暂存区
+	if(rxStagePos<rxStageLen){
+		int n = rxStageLen - rxStagePos;
+		if(n>nLen){
+			n = nLen;
+		}
+		if(nDat){
+			memcpy(nDat, rxStage+rxStagePos, n);
+		}
+		rxStagePos += n;
+		return n;
+	}
+	int Avail = pSerial->available();
+	if(Avail<=0){
+		return 0;
+	}
+	//大块读取直接读入目标缓冲区
+	if(nDat && nLen>=SCSERIAL_RX_STAGE_LEN){
+		if(Avail>nLen){
+			Avail = nLen;
+		}
+		return pSerial->read(nDat, Avail);
+	}
+	//小块读取先填满暂存区，多出的字节留给下一次读取
+	if(Avail>SCSERIAL_RX_STAGE_LEN){
+		Avail = SCSERIAL_RX_STAGE_LEN;
+	}
+	rxStageLen = pSerial->read(rxStage, Avail);
+	rxStagePos = 0;
+	return readAvailable(nDat, nLen);
+}
+
+inline int SCSerial::readSCS(unsigned char *nDat, int nLen, unsigned long TimeOut)
+{
+	int Size = 0;
+	unsigned long t_begin = millis();
+	while(Size<nLen){
+		Size += readAvailable(nDat ? nDat+Size : NULL, nLen-Size);
+		if(millis()-t_begin>TimeOut){
+			break;
+		}
+	}
+	return Size;
+}
+
+inline int SCSerial::readSCS(unsigned char *nDat, int nLen)
+{
+	int Size = 0;
+	unsigned long t_begin = millis();
+	while(Size<nLen){
+		int n = readAvailable(nDat ? nDat+Size : NULL, nLen-Size);
+		if(n){
+			Size += n;
+			t_begin = millis();
+		}else if(millis()-t_begin>IOTimeOut){
+			break;
+		}
+	}
+	return Size;
+}
+
+inline int SCSerial::writeSCS(const unsigned char *nDat, int nLen)
+{
+	if(nDat==NULL){
+		return 0;
+	}
+	return pSerial->write(nDat, nLen);
+}
+
+inline void SCSerial::rFlushSCS()
+{
+	rxStagePos = rxStageLen = 0;
+	while(pSerial->read()!=-1);
+}
+
+inline void SCSerial::wFlushSCS()
+{
+}
+
+#endif
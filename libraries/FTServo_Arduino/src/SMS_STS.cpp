@@ -22,78 +22,46 @@ SMS_STS::SMS_STS(u8 End, u8 Level):SCSerial(End, Level)
 
 int SMS_STS::WritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC)
 {
-	if(Position<0){
-		Position = -Position;
-		Position |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, Position);
-	Host2SCS(bBuf+3, bBuf+4, 0);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[SMS_STS_Map::PosEx::Len];
+	SMS_STS_Map::PosEx::Pack(End, bBuf, ACC, Position, 0, Speed);
 	
-	return genWrite(ID, SMS_STS_ACC, bBuf, 7);
+	return genWrite(ID, SMS_STS_Map::PosEx::Addr, bBuf, sizeof(bBuf));
 }
 
 int SMS_STS::RegWritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC)
 {
-	if(Position<0){
-		Position = -Position;
-		Position |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, Position);
-	Host2SCS(bBuf+3, bBuf+4, 0);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[SMS_STS_Map::PosEx::Len];
+	SMS_STS_Map::PosEx::Pack(End, bBuf, ACC, Position, 0, Speed);
 	
-	return regWrite(ID, SMS_STS_ACC, bBuf, 7);
-}
-
-void SMS_STS::SyncWritePosEx(u8 ID[], u8 IDN, s16 Position[], u16 Speed[], u8 ACC[])
-{
-    u8 offbuf[7*IDN];
-    for(u8 i = 0; i<IDN; i++){
-		if(Position[i]<0){
-			Position[i] = -Position[i];
-			Position[i] |= (1<<15);
-		}
-		u16 V;
-		if(Speed){
-			V = Speed[i];
-		}else{
-			V = 0;
-		}
-		if(ACC){
-			offbuf[i*7] = ACC[i];
-		}else{
-			offbuf[i*7] = 0;
-		}
-        Host2SCS(offbuf+i*7+1, offbuf+i*7+2, Position[i]);
-        Host2SCS(offbuf+i*7+3, offbuf+i*7+4, 0);
-        Host2SCS(offbuf+i*7+5, offbuf+i*7+6, V);
-    }
-    syncWrite(ID, IDN, SMS_STS_ACC, offbuf, 7);
-}
-
-void SMS_STS::SyncWriteSpe(u8 ID[], u8 IDN, s16 Speed[], u8 ACC[])
-{
-    u8 offbuf[7*IDN];
-    for(u8 i = 0; i<IDN; i++){
-		if(Speed[i]<0){
-			Speed[i] = -Speed[i];
-			Speed[i] |= (1<<15);
-		}
-		if(ACC){
-			offbuf[i*7] = ACC[i];
-		}else{
-			offbuf[i*7] = 0;
-		}
-        Host2SCS(offbuf+i*7+1, offbuf+i*7+2, 0);
-        Host2SCS(offbuf+i*7+3, offbuf+i*7+4, 0);
-        Host2SCS(offbuf+i*7+5, offbuf+i*7+6, Speed[i]);
-    }
-    syncWrite(ID, IDN, SMS_STS_ACC, offbuf, 7);
+	return regWrite(ID, SMS_STS_Map::PosEx::Addr, bBuf, sizeof(bBuf));
+}
+
+int SMS_STS::SyncWritePosEx(u8 ID[], u8 IDN, const s16 Position[], const u16 Speed[], const u8 ACC[])
+{
+	typedef SMS_STS_Map::PosEx Block;
+	u8 offbuf[SCS_SYNC_WRITE_MAX_DATA];
+	if(IDN>Block::MaxSyncIDN){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	for(u8 i = 0; i<IDN; i++){
+		Block::Pack(End, offbuf+i*Block::Len, SCSArg(ACC, i), Position[i], 0, SCSArg(Speed, i));
+	}
+	return syncWrite(ID, IDN, Block::Addr, offbuf, Block::Len);
+}
+
+int SMS_STS::SyncWriteSpe(u8 ID[], u8 IDN, const s16 Speed[], const u8 ACC[])
+{
+	typedef SMS_STS_Map::PosEx Block;
+	u8 offbuf[SCS_SYNC_WRITE_MAX_DATA];
+	if(IDN>Block::MaxSyncIDN){
+		u8Error = ERR_BUFF_LEN;
+		return 0;
+	}
+	for(u8 i = 0; i<IDN; i++){
+		Block::Pack(End, offbuf+i*Block::Len, SCSArg(ACC, i), 0, 0, Speed[i]);
+	}
+	return syncWrite(ID, IDN, Block::Addr, offbuf, Block::Len);
 }
 
 int SMS_STS::WheelMode(u8 ID)
@@ -103,17 +71,10 @@ int SMS_STS::WheelMode(u8 ID)
 
 int SMS_STS::WriteSpe(u8 ID, s16 Speed, u8 ACC)
 {
-	if(Speed<0){
-		Speed = -Speed;
-		Speed |= (1<<15);
-	}
-	u8 bBuf[7];
-	bBuf[0] = ACC;
-	Host2SCS(bBuf+1, bBuf+2, 0);
-	Host2SCS(bBuf+3, bBuf+4, 0);
-	Host2SCS(bBuf+5, bBuf+6, Speed);
+	u8 bBuf[SMS_STS_Map::PosEx::Len];
+	SMS_STS_Map::PosEx::Pack(End, bBuf, ACC, 0, 0, Speed);
 	
-	return genWrite(ID, SMS_STS_ACC, bBuf, 7);
+	return genWrite(ID, SMS_STS_Map::PosEx::Addr, bBuf, sizeof(bBuf));
 }
 
 int SMS_STS::EnableTorque(u8 ID, u8 Enable)
@@ -155,9 +116,7 @@ int SMS_STS::ReadPos(int ID)
 	}else{
 		Pos = readWord(ID, SMS_STS_PRESENT_POSITION_L);
 	}
-	if(Pos&(1<<15)){
-		Pos = -(Pos&~(1<<15));
-	}
+	Pos = SMS_STS_Map::PresentPosition::Decode(Pos);
 	
 	return Pos;
 }
@@ -172,9 +131,7 @@ int SMS_STS::ReadSpeed(int ID)
 	}else{
 		Speed = readWord(ID, SMS_STS_PRESENT_SPEED_L);
 	}
-	if(Speed&(1<<15)){
-		Speed = -(Speed&~(1<<15));
-	}	
+	Speed = SMS_STS_Map::PresentSpeed::Decode(Speed);
 	return Speed;
 }
 
@@ -188,9 +145,7 @@ int SMS_STS::ReadLoad(int ID)
 	}else{
 		Load = readWord(ID, SMS_STS_PRESENT_LOAD_L);
 	}
-	if(Load&(1<<10)){
-		Load = -(Load&~(1<<10));
-	}
+	Load = SMS_STS_Map::PresentLoad::Decode(Load);
 	return Load;
 }
 
@@ -237,9 +192,7 @@ int SMS_STS::ReadCurrent(int ID)
 	}else{
 		Current = readWord(ID, SMS_STS_PRESENT_CURRENT_L);
 	}
-	if(Current&(1<<15)){
-		Current = -(Current&~(1<<15));
-	}	
+	Current = SMS_STS_Map::PresentCurrent::Decode(Current);
 	return Current;
 }
 
@@ -53,6 +53,22 @@
 #define SMS_STS_PRESENT_CURRENT_H 70
 
 #include "SCSerial.h"
+#include "SCSRegMap.h"
+
+//内存表编译期描述
+struct SMS_STS_Map
+{
+	typedef SCSReg<SMS_STS_ACC, 1> Acc;
+	typedef SCSReg<SMS_STS_GOAL_POSITION_L, 2, 15> GoalPosition;
+	typedef SCSReg<SMS_STS_GOAL_TIME_L, 2> GoalTime;
+	typedef SCSReg<SMS_STS_GOAL_SPEED_L, 2, 15> GoalSpeed;
+	typedef SCSReg<SMS_STS_TORQUE_LIMIT_L, 2> TorqueLimit;//RAM区力矩限制(0~1000)
+	typedef SCSReg<SMS_STS_PRESENT_POSITION_L, 2, 15> PresentPosition;
+	typedef SCSReg<SMS_STS_PRESENT_SPEED_L, 2, 15> PresentSpeed;
+	typedef SCSReg<SMS_STS_PRESENT_LOAD_L, 2, 10> PresentLoad;
+	typedef SCSReg<SMS_STS_PRESENT_CURRENT_L, 2, 15> PresentCurrent;
+	typedef SCSBlock<Acc, GoalPosition, GoalTime, GoalSpeed> PosEx;//ACC,位置,时间,速度
+};
 
 class SMS_STS : public SCSerial
 {
@@ -62,8 +78,8 @@ public:
 	SMS_STS(u8 End, u8 Level);
 	int WritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC = 0);//普通写单个舵机位置指令
 	int RegWritePosEx(u8 ID, s16 Position, u16 Speed, u8 ACC = 0);//异步写单个舵机位置指令(RegWriteAction生效)
-	void SyncWritePosEx(u8 ID[], u8 IDN, s16 Position[], u16 Speed[], u8 ACC[]);//同步写多个舵机位置指令
-	void SyncWriteSpe(u8 ID[], u8 IDN, s16 Speed[], u8 ACC[]);//同步写多个舵机速度指令
+	int SyncWritePosEx(u8 ID[], u8 IDN, const s16 Position[], const u16 Speed[], const u8 ACC[]);//同步写多个舵机位置指令(超出单帧上限时不发送，返回0)
+	int SyncWriteSpe(u8 ID[], u8 IDN, const s16 Speed[], const u8 ACC[]);//同步写多个舵机速度指令(超出单帧上限时不发送，返回0)
 	int ServoMode(u8 ID);//Servo模式
 	int WheelMode(u8 ID);//恒速模式
 	int WriteSpe(u8 ID, s16 Speed, u8 ACC = 0);//恒速模式控制指令
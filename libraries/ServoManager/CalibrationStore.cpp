@@ -0,0 +1,171 @@
+#include "CalibrationStore.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+
+#define CALIB_NVS_NAMESPACE "calib"
+#define CALIB_NVS_KEY       "image"
+#endif
+
+CalibrationStore::CalibrationStore() {
+    Clear();
+    valid_ = false;
+}
+
+void CalibrationStore::Clear() {
+    memset(&image_, 0, sizeof(image_));
+    image_.magic = CALIB_STORE_MAGIC;
+    image_.version = CALIB_STORE_VERSION;
+    image_.size = sizeof(CalibStoreImage);
+    Seal(image_);
+    valid_ = true;
+}
+
+uint32_t CalibrationStore::Crc32(const uint8_t* data, size_t len) {
+    // CRC-32 (IEEE 802.3)，逐位计算，只在上电和保存时调用
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+void CalibrationStore::Seal(CalibStoreImage& image) {
+    image.crc = Crc32((const uint8_t*)&image, offsetof(CalibStoreImage, crc));
+}
+
+bool CalibrationStore::Validate(const CalibStoreImage& image) {
+    if (image.magic != CALIB_STORE_MAGIC) return false;
+    if (image.version != CALIB_STORE_VERSION) return false;
+    if (image.size != sizeof(CalibStoreImage)) return false;
+    if (image.crc != Crc32((const uint8_t*)&image, offsetof(CalibStoreImage, crc))) return false;
+
+    for (uint8_t b = 0; b < CALIB_MAX_BUSES; b++) {
+        const CalibBusRecord& bus = image.buses[b];
+        if (bus.count > CALIB_MAX_SERVOS_PER_BUS) return false;
+        for (uint8_t i = 0; i < bus.count; i++) {
+            // 0xFE 为广播地址，0xFF 非法
+            if (bus.servos[i].id >= 0xFE) return false;
+            for (uint8_t j = i + 1; j < bus.count; j++) {
+                if (bus.servos[i].id == bus.servos[j].id) return false;
+            }
+        }
+    }
+    return true;
+}
+
+CalibBusRecord* CalibrationStore::Bus(uint8_t busID) {
+    return (busID < CALIB_MAX_BUSES) ? &image_.buses[busID] : nullptr;
+}
+
+const CalibBusRecord* CalibrationStore::Bus(uint8_t busID) const {
+    return (busID < CALIB_MAX_BUSES) ? &image_.buses[busID] : nullptr;
+}
+
+CalibServoRecord* CalibrationStore::FindServo(uint8_t busID, uint8_t servoID) {
+    CalibBusRecord* bus = Bus(busID);
+    if (!bus) return nullptr;
+    for (uint8_t i = 0; i < bus->count; i++) {
+        if (bus->servos[i].id == servoID) return &bus->servos[i];
+    }
+    return nullptr;
+}
+
+CalibServoRecord* CalibrationStore::EnsureServo(uint8_t busID, uint8_t servoID) {
+    CalibServoRecord* rec = FindServo(busID, servoID);
+    if (rec) return rec;
+
+    CalibBusRecord* bus = Bus(busID);
+    if (!bus || bus->count >= CALIB_MAX_SERVOS_PER_BUS) return nullptr;
+    rec = &bus->servos[bus->count++];
+    memset(rec, 0, sizeof(*rec));
+    rec->id = servoID;
+    rec->zeroOffset = 2048;
+    rec->limitPos = 2048;
+    return rec;
+}
+
+bool CalibrationStore::SetBusServos(uint8_t busID, const uint8_t* ids, uint8_t count) {
+    CalibBusRecord* bus = Bus(busID);
+    if (!bus || count > CALIB_MAX_SERVOS_PER_BUS) return false;
+
+    CalibServoRecord servos[CALIB_MAX_SERVOS_PER_BUS];
+    for (uint8_t i = 0; i < count; i++) {
+        const CalibServoRecord* old = FindServo(busID, ids[i]);
+        if (old) {
+            servos[i] = *old;
+        } else {
+            memset(&servos[i], 0, sizeof(servos[i]));
+            servos[i].id = ids[i];
+            servos[i].zeroOffset = 2048;
+            servos[i].limitPos = 2048;
+        }
+    }
+    memset(bus->servos, 0, sizeof(bus->servos));
+    memcpy(bus->servos, servos, count * sizeof(CalibServoRecord));
+    bus->count = count;
+    return true;
+}
+
+bool CalibrationStore::MatchesTopology(uint8_t busID, const uint8_t* ids, uint8_t count) const {
+    const CalibBusRecord* bus = Bus(busID);
+    if (!valid_ || !bus || bus->count != count) return false;
+    for (uint8_t i = 0; i < count; i++) {
+        bool found = false;
+        for (uint8_t j = 0; j < bus->count; j++) {
+            if (bus->servos[j].id == ids[i]) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+#ifdef ARDUINO
+
+bool CalibrationStore::Load() {
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(CALIB_NVS_NAMESPACE, true)) {
+        if (prefs.getBytesLength(CALIB_NVS_KEY) == sizeof(CalibStoreImage)) {
+            CalibStoreImage tmp;
+            if (prefs.getBytes(CALIB_NVS_KEY, &tmp, sizeof(tmp)) == sizeof(tmp) && Validate(tmp)) {
+                image_ = tmp;
+                ok = true;
+            }
+        }
+        prefs.end();
+    }
+
+    if (!ok) {
+        Clear();
+        valid_ = false;   // 空镜像可用于写入，但不代表已有标定
+    } else {
+        valid_ = true;
+    }
+    return ok;
+}
+
+bool CalibrationStore::Save() {
+    Seal(image_);
+    Preferences prefs;
+    if (!prefs.begin(CALIB_NVS_NAMESPACE, false)) return false;
+    size_t written = prefs.putBytes(CALIB_NVS_KEY, &image_, sizeof(image_));
+    prefs.end();
+    valid_ = (written == sizeof(image_));
+    return valid_;
+}
+
+#else
+
+// 主机构建没有 NVS，仅保留内存中的镜像
+bool CalibrationStore::Load() { return valid_ = Validate(image_); }
+bool CalibrationStore::Save() { Seal(image_); valid_ = true; return true; }
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef CALIBRATION_STORE_H
+#define CALIBRATION_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 标定数据库：零位、极限位置、圈数、检测到的舵机 ID 与各总线波特率。
+// 整体作为一个定长镜像存入 NVS，带魔数/版本/长度/CRC32 校验。
+// 镜像格式与校验逻辑不依赖 Arduino，可在 Linux 主机上编译测试；
+// 仅 Load()/Save() 的 NVS 读写部分依赖 ESP32 Preferences 库。
+
+#define CALIB_STORE_MAGIC            0x424C4143u  // "CALB"
+#define CALIB_STORE_VERSION          1
+#define CALIB_MAX_BUSES              4
+#define CALIB_MAX_SERVOS_PER_BUS     8
+
+// 单个舵机的标定记录
+struct CalibServoRecord {
+    enum Flags : uint8_t {
+        FLAG_MULTI_TURN = 0x01,    // 已配置为多圈模式（角度限制清零）
+        FLAG_LIMIT      = 0x02,    // limitPos 有效（已完成极限位置查找）
+        FLAG_TURNS      = 0x04,    // turns/lastRaw 有效
+    };
+
+    uint8_t  id;
+    uint8_t  flags;
+    int16_t  zeroOffset;   // 零位脉冲
+    int16_t  lastRaw;      // 保存时的单圈位置
+    uint16_t limitPos;     // 极限位置
+    int32_t  turns;        // 保存时的圈数
+};
+
+// 单条总线的标定记录
+struct CalibBusRecord {
+    uint32_t baud;         // 0 表示未记录
+    uint8_t  count;        // 检测到的舵机数
+    uint8_t  reserved[3];
+    CalibServoRecord servos[CALIB_MAX_SERVOS_PER_BUS];
+};
+
+// 存储镜像（即 NVS 中的字节布局）
+struct CalibStoreImage {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;         // sizeof(CalibStoreImage)，防止结构体变化后误读旧数据
+    CalibBusRecord buses[CALIB_MAX_BUSES];
+    uint32_t crc;          // 覆盖 crc 字段之前全部内容的 CRC32
+};
+
+class CalibrationStore {
+public:
+    CalibrationStore();
+
+    /* ========== 纯数据操作（主机可测） ========== */
+
+    // 清空为一个空的有效镜像
+    void Clear();
+
+    // 计算并写入 CRC
+    static void Seal(CalibStoreImage& image);
+
+    // 检查魔数、版本、长度、CRC 以及各字段范围
+    static bool Validate(const CalibStoreImage& image);
+
+    static uint32_t Crc32(const uint8_t* data, size_t len);
+
+    // 当前镜像是否有效（Load 成功或 Clear 之后）
+    bool IsValid() const { return valid_; }
+
+    CalibBusRecord* Bus(uint8_t busID);
+    const CalibBusRecord* Bus(uint8_t busID) const;
+
+    // 查找指定总线上的舵机记录，不存在返回 nullptr
+    CalibServoRecord* FindServo(uint8_t busID, uint8_t servoID);
+
+    // 查找或新增舵机记录（总线已满返回 nullptr）
+    CalibServoRecord* EnsureServo(uint8_t busID, uint8_t servoID);
+
+    // 将总线记录重置为给定 ID 列表：已有记录保留标定值，新 ID 使用默认值
+    bool SetBusServos(uint8_t busID, const uint8_t* ids, uint8_t count);
+
+    // 检查存储的 ID 集合与期望是否一致（无视顺序）
+    bool MatchesTopology(uint8_t busID, const uint8_t* ids, uint8_t count) const;
+
+    const CalibStoreImage& Image() const { return image_; }
+    CalibStoreImage& Image() { return image_; }
+
+    /* ========== NVS 持久化（仅 ESP32） ========== */
+
+    // 从 NVS 读取，校验失败时保留一个空镜像并返回 false
+    bool Load();
+
+    // Seal 后写入 NVS
+    bool Save();
+
+private:
+    CalibStoreImage image_;
+    bool valid_;
+};
+
+#endif // CALIBRATION_STORE_H
@@ -0,0 +1,68 @@
+#include "MultiTurnTracker.h"
+
+void MultiTurnTracker::Reset() {
+    turns_ = 0;
+    lastUs_ = 0;
+    raw_ = 0;
+    speed_ = 0;
+    flags_ = 0;
+}
+
+void MultiTurnTracker::Restore(int32_t turnCount, int16_t lastRawPos) {
+    turns_ = turnCount;
+    raw_ = lastRawPos;
+    speed_ = 0;
+    lastUs_ = 0;
+    flags_ = FLAG_INITIALIZED | FLAG_RESTORED;
+    Refresh();
+}
+
+void MultiTurnTracker::Update(int16_t rawPos, int16_t speed, uint32_t sampleUs, bool speedValid) {
+    if (!(flags_ & FLAG_INITIALIZED)) {
+        turns_ = 0;
+        raw_ = rawPos;
+        speed_ = speedValid ? speed : 0;
+        lastUs_ = sampleUs;
+        flags_ = FLAG_INITIALIZED;
+        Refresh();
+        return;
+    }
+
+    // 观测到的单圈位移，落在 (-4096, 4096)
+    int32_t observed = (int32_t)rawPos - raw_;
+
+    // 预测位移：前后两次速度的平均值 × 实际采样间隔
+    int32_t predicted = 0;
+    bool usePrediction = speedValid && !(flags_ & FLAG_RESTORED);
+    if (usePrediction) {
+        int64_t dtUs = (uint32_t)(sampleUs - lastUs_);
+        int64_t avgSpeed2 = (int64_t)speed_ + speed;           // 2 × 平均速度
+        predicted = (int32_t)(avgSpeed2 * dtUs / 2000000);
+    }
+
+    // 选取 k 使 observed + k*4096 最接近 predicted（四舍五入到最近整圈）
+    int32_t diff = predicted - observed;
+    int32_t k = (diff >= 0) ? (diff + STEPS_PER_TURN / 2) / STEPS_PER_TURN
+                            : -((-diff + STEPS_PER_TURN / 2 - 1) / STEPS_PER_TURN);
+    int32_t residual = observed + k * STEPS_PER_TURN - predicted;
+
+    turns_ += k;
+    raw_ = rawPos;
+    speed_ = speedValid ? speed : 0;
+    lastUs_ = sampleUs;
+
+    flags_ &= ~(FLAG_RESTORED | FLAG_SUSPECT);
+    if (usePrediction && (residual > SUSPECT_RESIDUAL || residual < -SUSPECT_RESIDUAL)) {
+        flags_ |= FLAG_SUSPECT;
+    }
+    Refresh();
+}
+
+void MultiTurnTracker::Refresh() {
+    int32_t absPos = Absolute();
+    if (absPos > POSITION_LIMIT || absPos < -POSITION_LIMIT) {
+        flags_ |= FLAG_SATURATED;
+    } else {
+        flags_ &= ~FLAG_SATURATED;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef MULTI_TURN_TRACKER_H
+#define MULTI_TURN_TRACKER_H
+
+#include <stdint.h>
+
+// 多圈位置估计器（ServoManager 与 ServoBusManager 共用）
+//
+// 舵机只返回单圈位置 (0-4095)，跨圈需要由主机推断。固定 ±2048 阈值在
+// 漏掉一个周期、且关节转速较快时会判错圈数；这里改用速度寄存器和实际采样
+// 间隔预测本周期的位移，在所有 “观测位移 + k*4096” 候选中选取最接近预测
+// 值的一个。无速度信息时退化为原来的最近跨圈判断。
+//
+// 仅依赖 <stdint.h>，可以直接在 Linux 主机上编译做单元测试。
+class MultiTurnTracker {
+public:
+    static const int32_t STEPS_PER_TURN = 4096;
+    static const int32_t POSITION_LIMIT = 30719;   // 舵机多圈目标位置的有效范围 ±30719
+
+    // 预测残差超过该值时认为本次判圈不可信（置 FLAG_SUSPECT）
+    static const int32_t SUSPECT_RESIDUAL = STEPS_PER_TURN / 4;
+
+    enum Flags : uint8_t {
+        FLAG_INITIALIZED = 0x01,   // 已有参考位置
+        FLAG_SATURATED   = 0x02,   // 绝对位置超出 ±POSITION_LIMIT（不再静默截断）
+        FLAG_SUSPECT     = 0x04,   // 最近一次判圈残差过大（采样间隔太长或数据异常）
+        FLAG_RESTORED    = 0x08,   // 圈数来自持久化数据，下一次更新不使用速度预测
+    };
+
+    MultiTurnTracker() { Reset(); }
+
+    // 清空状态，下一次样本作为初值（圈数归零）
+    void Reset();
+
+    // 从持久化数据恢复圈数与最后一次单圈位置（复位后继续计圈）
+    void Restore(int32_t turnCount, int16_t lastRawPos);
+
+    /**
+     * @brief 输入一次新采样
+     * @param rawPos    单圈位置 (0-4095)
+     * @param speed     速度寄存器值（步/秒，带符号）
+     * @param sampleUs  采样时间戳（微秒，允许 32 位回绕）
+     * @param speedValid 速度值是否有效（单独读位置时传 false）
+     */
+    void Update(int16_t rawPos, int16_t speed, uint32_t sampleUs, bool speedValid = true);
+
+    // 将当前位置设为零圈（绝对位置 = 当前单圈位置）
+    void ResetTurns() { turns_ = 0; Refresh(); }
+
+    int32_t Absolute()    const { return turns_ * STEPS_PER_TURN + raw_; }
+    int32_t TurnCount()   const { return turns_; }
+    int16_t Raw()         const { return raw_; }
+    int16_t Speed()       const { return speed_; }
+    uint8_t GetFlags()    const { return flags_; }
+    bool    Initialized() const { return flags_ & FLAG_INITIALIZED; }
+    bool    Saturated()   const { return flags_ & FLAG_SATURATED; }
+    bool    Suspect()     const { return flags_ & FLAG_SUSPECT; }
+
+private:
+    int32_t  turns_;
+    uint32_t lastUs_;
+    int16_t  raw_;
+    int16_t  speed_;
+    uint8_t  flags_;
+
+    void Refresh();   // 重新计算饱和标志
+};
+
+#endif // MULTI_TURN_TRACKER_H
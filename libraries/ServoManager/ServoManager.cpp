@@ -1,20 +1,49 @@
 #include "ServoManager.h"
+#include "DeferredLog.h"
 #define MAX_POSSIBLE_SERVO_NUM 254
+#define SYNC_READ_TIMEOUT_MS   10   // 单次同步读等待应答的超时
+#define SYNC_READ_BUDGET_MS    30   // 一次 SyncReadPosLoad（含重试）的总时间预算
 
 ServoManager::ServoManager(uint8_t servoNum) {
     numServos = servoNum;
     servoStates = new ServoState[numServos];
     virtual2ServoID = new uint8_t[numServos];
-    servo2VirtualID = new uint8_t[MAX_POSSIBLE_SERVO_NUM];
+    pendingIDs_ = new uint8_t[numServos];
+    pendingVirtual_ = new uint8_t[numServos];
+    cmdIDs_ = new uint8_t[numServos];
+    cmdPos_ = new int16_t[numServos];
+    zeroPos_ = new int16_t[numServos];
+    cmdSpeed_ = new uint16_t[numServos];
+    cmdAcc_ = new uint8_t[numServos];
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        virtual2ServoID[virtualID] = INVALID_VIRTUAL_ID;
+    }
 }
 
 ServoManager::~ServoManager() {
     delete[] servoStates;
     delete[] virtual2ServoID;
+    delete[] pendingIDs_;
+    delete[] pendingVirtual_;
+    delete[] cmdIDs_;
+    delete[] cmdPos_;
+    delete[] zeroPos_;
+    delete[] cmdSpeed_;
+    delete[] cmdAcc_;
     servoStates = nullptr;
     virtual2ServoID = nullptr;
 }
 
+uint8_t ServoManager::VirtualID(uint8_t servoID) const {
+    // 单总线舵机数很少（4~6 个），顺序查找比 254 字节的稀疏表更省内存且缓存友好
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        if (virtual2ServoID[virtualID] == servoID) {
+            return virtualID;
+        }
+    }
+    return INVALID_VIRTUAL_ID;
+}
+
 void ServoManager::begin(uint8_t busID_, uint8_t rxPin, uint8_t txPin, const uint8_t* servoIDs) {
     // 初始化串口通信
     busID = busID_;
@@ -29,13 +58,37 @@ void ServoManager::begin(uint8_t busID_, uint8_t rxPin, uint8_t txPin, const uin
             while(1) { ; }
     }
     
+    // 已有标定数据时使用记录的波特率
+    uint32_t baud = 1000000;
+    const CalibBusRecord* busRecord = (calib_ && calib_->IsValid()) ? calib_->Bus(busID) : nullptr;
+    if (busRecord && busRecord->baud != 0) {
+        baud = busRecord->baud;
+    }
+
     pinMode(rxPin, INPUT_PULLUP); // 防止悬空噪声
-    targetSerial->begin(1000000, SERIAL_8N1, rxPin, txPin);
+    targetSerial->begin(baud, SERIAL_8N1, rxPin, txPin);
     driver_.pSerial = targetSerial;
     while (!(*targetSerial)) {
         delay(10);
     }
 
+    // 建立编号映射（与扫描结果无关）
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        uint8_t servoID = (servoIDs != nullptr) ? servoIDs[virtualID] : virtualID;
+        servoStates[virtualID].id = servoID;
+        virtual2ServoID[virtualID] = servoID;
+    }
+    regCache_.Attach(&driver_, virtual2ServoID, numServos);
+
+    // 快速启动：标定库中的拓扑与期望一致时，只用一次同步读确认所有舵机在线
+    if (calib_ && calib_->MatchesTopology(busID, virtual2ServoID, numServos)) {
+        if (VerifyTopology()) {
+            Serial.printf("总线 %d 拓扑与标定数据一致，跳过扫描\n", busID);
+            return;
+        }
+        Serial.printf("总线 %d 同步读校验失败，回退到全量扫描\n", busID);
+    }
+
     // 扫描所有可能的ID (0-253)
     Serial.printf("正在扫描总线 %d ...\n", busID);
     uint8_t detectedIDs[MAX_POSSIBLE_SERVO_NUM];
@@ -82,24 +135,67 @@ void ServoManager::begin(uint8_t busID_, uint8_t rxPin, uint8_t txPin, const uin
         while (1) { delay(100); }
     }
     
-    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-        if (servoIDs != nullptr) {
-            servoStates[virtualID].id = servoIDs[virtualID];
-            virtual2ServoID[virtualID] = servoIDs[virtualID];
-            servo2VirtualID[servoIDs[virtualID]] = virtualID;
-        } else {
-            servoStates[virtualID].id = virtualID;
-            virtual2ServoID[virtualID] = virtualID;
-            servo2VirtualID[virtualID] = virtualID;
+    // 记录检测结果，下次启动可走快速路径
+    if (calib_) {
+        CalibBusRecord* record = calib_->Bus(busID);
+        if (record) {
+            record->baud = baud;
+            calib_->SetBusServos(busID, virtual2ServoID, numServos);
+            calib_->Save();
         }
     }
 
     Serial.println("总线扫描完成，等待指令初始化舵机...");
 }
 
+bool ServoManager::VerifyTopology() {
+    uint8_t rx_packet[2];
+    bool allOnline = true;
+
+    driver_.syncReadBegin(numServos, sizeof(rx_packet), 20);
+    driver_.syncReadPacketTx(virtual2ServoID, numServos, SMS_STS_PRESENT_POSITION_L, sizeof(rx_packet));
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        if (driver_.syncReadPacketRx(virtual2ServoID[virtualID], rx_packet) != sizeof(rx_packet)) {
+            allOnline = false;
+            break;
+        }
+    }
+    driver_.syncReadEnd();
+    return allOnline;
+}
+
+bool ServoManager::SaveCalibration() {
+    if (!calib_) {
+        return false;
+    }
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        const ServoState& servo = servoStates[virtualID];
+        CalibServoRecord* record = calib_->EnsureServo(busID, servo.id);
+        if (!record) {
+            return false;
+        }
+        if (servo.initialized) {
+            record->turns = servo.tracker.TurnCount();
+            record->lastRaw = servo.tracker.Raw();
+            record->flags |= CalibServoRecord::FLAG_TURNS;
+        }
+    }
+    return calib_->Save();
+}
+
 bool ServoManager::InitializeSingleServo(uint8_t servoID, float percent) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
     ResetServoState(servoStates[virtualID]);
+
+    // 标定库中已有多圈配置和极限位置时，跳过多圈配置、中位校准和极限查找
+    CalibServoRecord* record = (calib_ && calib_->IsValid()) ? calib_->FindServo(busID, servoID) : nullptr;
+    const uint8_t calibratedFlags = CalibServoRecord::FLAG_MULTI_TURN | CalibServoRecord::FLAG_LIMIT;
+    if (record && (record->flags & calibratedFlags) == calibratedFlags) {
+        return InitializeFromCalibration(servoID, *record, percent);
+    }
     
     // 1. 启用扭矩
     if (!EnableTorque(servoID, true)) {
@@ -133,59 +229,100 @@ bool ServoManager::InitializeSingleServo(uint8_t servoID, float percent) {
             return false;
         }
     }
+    // 校准后回读的位置即零位（寻找极限位置会移动舵机，先记下来）
+    int16_t zeroPos = (int16_t)servoStates[virtualID].absolutePos;
     
     // 4. 寻找极限位置
     if (!FindLimitPosition(servoID)) {
         return false;
     }
 
-    // 5. 根据百分比移动到指定位置 (2048 ~ limitPos)
-    int16_t targetPos = 2048 + (int16_t)((servoStates[virtualID].limitPos - 2048) * percent);
+    // 记录标定结果
+    if (calib_) {
+        record = calib_->EnsureServo(busID, servoID);
+        if (record) {
+            record->flags |= calibratedFlags;
+            record->zeroOffset = zeroPos;
+            record->limitPos = servoStates[virtualID].limitPos;
+            calib_->Save();
+        }
+    }
+
+    // 5. 根据百分比移动到指定位置 (zeroPos ~ limitPos)
+    int16_t targetPos = zeroPos + (int16_t)((servoStates[virtualID].limitPos - zeroPos) * percent);
     Serial.printf("初始化完成，移动到设定位置: %d (%.1f%%)\n", targetPos, percent * 100);
     MoveSingleServo(servoID, targetPos, 0, 0); 
 
     return true;
 }
 
-bool ServoManager::SetMultiTurnMode(uint8_t servoID) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+bool ServoManager::InitializeFromCalibration(uint8_t servoID, const CalibServoRecord& record, float percent) {
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
+    ServoState& servo = servoStates[virtualID];
 
-    // 解锁EPROM
-    driver_.unLockEprom(servoID);
-    servoStates[virtualID].lastCommTime = millis();
-    if (int result = driver_.getLastError()) {
-        Serial.printf("ServoManager::SetMultiTurnMode 解锁EPROM失败, 通信失败类型 %d \n", result);
-        servoStates[virtualID].lastError = ServoError::Communication;
+    if (!EnableTorque(servoID, true)) {
         return false;
     }
-    delay(100);
-    
-    // 设置角度限制为0（多圈模式）
-    uint8_t zero_data[4] = {0, 0, 0, 0};
-    driver_.genWrite(servoID, SMS_STS_MIN_ANGLE_LIMIT_L, zero_data, 4);
-    servoStates[virtualID].lastCommTime = millis();
-    if (int result = driver_.getLastError()) {
-        Serial.printf("ServoManager::SetMultiTurnMode 校准中心位置失败, 通信失败类型 %d \n", result);
+
+    servo.limitPos = record.limitPos;
+    if (record.flags & CalibServoRecord::FLAG_TURNS) {
+        servo.tracker.Restore(record.turns, record.lastRaw);
+        servo.initialized = true;
+    }
+    if (!ReadSinglePosLoad(servoID)) {
+        return false;
+    }
+
+    int16_t targetPos = record.zeroOffset + (int16_t)((servo.limitPos - record.zeroOffset) * percent);
+    Serial.printf("舵机 %d 使用已保存的标定数据，移动到设定位置: %d (%.1f%%)\n", servoID, targetPos, percent * 100);
+    return MoveSingleServo(servoID, targetPos, 0, 0);
+}
+
+bool ServoManager::SetMultiTurnMode(uint8_t servoID) {
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
+
+    // 读取角度限制（缓存未命中时读一次舵机），已是多圈模式则不再写 EPROM
+    uint16_t minLimit = 0, maxLimit = 0;
+    if (!regCache_.ReadWord(servoID, SMS_STS_MIN_ANGLE_LIMIT_L, minLimit) ||
+        !regCache_.ReadWord(servoID, SMS_STS_MAX_ANGLE_LIMIT_L, maxLimit)) {
+        Serial.printf("ServoManager::SetMultiTurnMode 读取角度限制失败, 通信失败类型 %d \n", driver_.getLastError());
         servoStates[virtualID].lastError = ServoError::Communication;
         return false;
     }
-    delay(100);
-    
-    // 锁定EPROM
-    driver_.LockEprom(servoID);
     servoStates[virtualID].lastCommTime = millis();
-    if (int result = driver_.getLastError()) {
-        Serial.printf("ServoManager::SetMultiTurnMode 锁定EPROM失败, 通信失败类型 %d \n", result);
+    if (minLimit == 0 && maxLimit == 0) {
+        return true;
+    }
+
+    // 设置角度限制为0（多圈模式），解锁/写入/加锁由 Flush 一并发出
+    regCache_.WriteWord(servoID, SMS_STS_MIN_ANGLE_LIMIT_L, 0);
+    regCache_.WriteWord(servoID, SMS_STS_MAX_ANGLE_LIMIT_L, 0);
+    regCache_.Flush();
+    delay(10);
+
+    // 同步写没有应答，回读一次确认写入成功
+    uint8_t limits[4];
+    if (driver_.Read(servoID, SMS_STS_MIN_ANGLE_LIMIT_L, limits, 4) != 4 ||
+        limits[0] | limits[1] | limits[2] | limits[3]) {
+        Serial.printf("ServoManager::SetMultiTurnMode 设置角度限制失败, 通信失败类型 %d \n", driver_.getLastError());
         servoStates[virtualID].lastError = ServoError::Communication;
+        regCache_.Invalidate(servoID);
         return false;
     }
-    delay(100);
-    
     return true;
 }
 
 bool ServoManager::CalibrateCenter(uint8_t servoID) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
 
     Serial.print("校准舵机 ");
     Serial.print(servoID);
@@ -221,6 +358,8 @@ bool ServoManager::CalibrateCenter(uint8_t servoID) {
     }
     delay(100);
     
+    regCache_.Invalidate(servoID);  // 位置校正写入了 EPROM
+
     // 4. 验证校准结果
     int current_pos = driver_.ReadPos(servoID);
     servoStates[virtualID].lastCommTime = millis();
@@ -242,10 +381,15 @@ bool ServoManager::CalibrateCenter(uint8_t servoID) {
 }
 
 bool ServoManager::EnableTorque(uint8_t servoID, bool enable) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
     driver_.EnableTorque(servoID, enable ? 1 : 0);
     servoStates[virtualID].lastCommTime = millis();
+    regCache_.AssumeByte(servoID, SMS_STS_TORQUE_ENABLE, enable ? 1 : 0);
     if (int result = driver_.getLastError()) {
+        regCache_.Invalidate(servoID);
         Serial.printf("ServoManager::EnableTorque 对总线%d上的舵机%d配置扭矩为%d失败, 通信失败类型 %d \n", busID, servoID, enable, result);
         servoStates[virtualID].lastError = ServoError::Communication;
         return false;
@@ -255,7 +399,10 @@ bool ServoManager::EnableTorque(uint8_t servoID, bool enable) {
 }
 
 bool ServoManager::MoveSingleServo(uint8_t servoID, int16_t position, uint16_t speed, uint16_t acc) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
 
     if (emergencyStop) {
         Serial.println("ServoManager::MoveSingleServo 已经紧急停机");
@@ -276,13 +423,16 @@ bool ServoManager::MoveSingleServo(uint8_t servoID, int16_t position, uint16_t s
 }
 
 bool ServoManager::ReadSinglePosLoad(uint8_t servoID, bool update) {
-    uint8_t virtualID = servo2VirtualID[servoID];
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
 
     int32_t pos = driver_.ReadPos(servoID);
     int32_t load = driver_.ReadLoad(servoID);
     servoStates[virtualID].lastCommTime = millis();
     if (int result = driver_.getLastError()) {
-        Serial.printf("ServoManager::readSinglePoseLoad 舵机 %d 读取指令失败, 通信错误类型 %d \n", servoID, result);
+        DLOG(SERVO_READ_SINGLE_FAIL, servoID, result);
         servoStates[virtualID].lastError = ServoError::Communication;
         delay(500); // 等待舵机自己恢复
         return false;
@@ -296,8 +446,11 @@ bool ServoManager::ReadSinglePosLoad(uint8_t servoID, bool update) {
 }
 
 bool ServoManager::FindLimitPosition(uint8_t servoID) {
-    uint8_t virtualID = servo2VirtualID[servoID];
-    Serial.printf("开始寻找舵机 %d 的极限位置...\n", servoID);
+    uint8_t virtualID = VirtualID(servoID);
+    if (virtualID == INVALID_VIRTUAL_ID) {
+        return false;
+    }
+    DLOG(SERVO_LIMIT_START, servoID);
     
     const int STEP_INCREMENT = 50; // 每次增加的位置步长
     unsigned long start_time = millis();
@@ -306,12 +459,7 @@ bool ServoManager::FindLimitPosition(uint8_t servoID) {
     while (millis() - start_time < 50000 && !limit_reached) {
         // 读取和打印当前状态
         if (ReadSinglePosLoad(servoID)) {
-            Serial.print("舵机 ");
-            Serial.print(servoID);
-            Serial.print(" - 当前位置: ");
-            Serial.print(servoStates[virtualID].absolutePos);
-            Serial.print(" | 负载: ");
-            Serial.println(servoStates[virtualID].currentLoad);
+            DLOG(SERVO_LIMIT_PROGRESS, servoID, servoStates[virtualID].absolutePos, servoStates[virtualID].currentLoad);
             
             // 计算并发送下一步移动指令
             int16_t nextTarget = servoStates[virtualID].absolutePos + STEP_INCREMENT;
@@ -319,13 +467,13 @@ bool ServoManager::FindLimitPosition(uint8_t servoID) {
             
             // 检查负载是否过大
             if (abs(servoStates[virtualID].currentLoad) > 150) {
-                Serial.println("检测到负载过大，记录极限位置");
                 servoStates[virtualID].limitPos = servoStates[virtualID].absolutePos;
+                DLOG(SERVO_LIMIT_FOUND, servoID, servoStates[virtualID].currentLoad, servoStates[virtualID].limitPos);
                 limit_reached = true;
             }
         } else {
             // 通信失败，等待后继续尝试
-            Serial.printf("读取总线%d上舵机%d失败，正进行下一次尝试\n", busID, servoID);
+            DLOG(SERVO_LIMIT_READ_RETRY, busID, servoID);
             delay(100);
         }
         
@@ -333,13 +481,172 @@ bool ServoManager::FindLimitPosition(uint8_t servoID) {
     }
     
     if (!limit_reached) {
-        Serial.println("寻找超时，使用保守值");
+        DLOG(SERVO_LIMIT_TIMEOUT, servoID);
         servoStates[virtualID].limitPos = 2048;
     }
     
     return true;
 }
 
+bool ServoManager::FindLimitPositionsAll(uint32_t timeoutMs) {
+    const int STEP_INCREMENT = 50;        // 每步增加的位置
+    const int32_t LIMIT_LOAD = 150;       // 判定到达极限的负载阈值
+    const uint16_t STEP_SPEED = 120;
+    const uint32_t STEP_PERIOD_MS = 100;  // 每步周期（含一次同步读 + 一次同步写）
+
+    uint8_t remaining = numServos;
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        servoStates[virtualID].limitSearch = LimitSearch::Stepping;
+    }
+
+    DLOG(SERVO_LIMIT_ALL_START, busID, numServos);
+    unsigned long start_time = millis();
+    while (remaining > 0 && !emergencyStop && millis() - start_time < timeoutMs) {
+        unsigned long step_start = millis();
+
+        // 一次同步读得到全部舵机的位置和负载；本步未读到的舵机暂不推进
+        SyncReadPosLoad(1, true);
+        {
+            uint8_t n = 0;
+            for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+                ServoState& servo = servoStates[virtualID];
+                if (servo.limitSearch != LimitSearch::Stepping || !servo.readStats.lastOk) {
+                    continue;
+                }
+                if (abs(servo.currentLoad) > LIMIT_LOAD) {
+                    servo.limitPos = servo.absolutePos;
+                    servo.limitSearch = LimitSearch::Found;
+                    remaining--;
+                    DLOG(SERVO_LIMIT_FOUND, servo.id, servo.currentLoad, servo.limitPos);
+                    continue;
+                }
+                cmdIDs_[n]   = servo.id;
+                cmdPos_[n]   = servo.absolutePos + STEP_INCREMENT;
+                cmdSpeed_[n] = STEP_SPEED;
+                cmdAcc_[n]   = 0;
+                n++;
+            }
+            // 仍在步进的舵机一起下发下一步目标
+            if (n > 0) {
+                driver_.SyncWritePosEx(cmdIDs_, n, cmdPos_, cmdSpeed_, cmdAcc_);
+            }
+        }
+
+        unsigned long elapsed = millis() - step_start;
+        if (elapsed < STEP_PERIOD_MS) {
+            delay(STEP_PERIOD_MS - elapsed);
+        }
+    }
+
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        ServoState& servo = servoStates[virtualID];
+        if (servo.limitSearch == LimitSearch::Stepping) {
+            DLOG(SERVO_LIMIT_TIMEOUT, servo.id);
+            servo.limitPos = 2048;
+            servo.limitSearch = LimitSearch::TimedOut;
+        }
+    }
+
+    return remaining == 0;
+}
+
+void ServoManager::SyncWriteSame(const uint8_t ids[], uint8_t count, uint8_t memAddr, const uint8_t* data, uint8_t len) {
+    // 急停路径调用，不从堆上分配；一帧同步写最多 251 字节（每个舵机 ID + len 字节），
+    // 舵机过多时分成多帧发出
+    uint8_t buf[251];
+    if (len == 0 || len >= sizeof(buf)) return;
+    const uint8_t perFrame = sizeof(buf) / (len + 1);
+    for (uint8_t i = 0; i < perFrame; i++) {
+        memcpy(buf + i * len, data, len);
+    }
+    for (uint16_t first = 0; first < count; first += perFrame) {
+        uint8_t n = (count - first < perFrame) ? (count - first) : perFrame;
+        driver_.syncWrite((uint8_t*)ids + first, n, memAddr, buf, len);
+    }
+}
+
+bool ServoManager::InitializeAllServos(float percent) {
+    if (emergencyStop) {
+        Serial.println("ServoManager::InitializeAllServos 已经紧急停机");
+        return false;
+    }
+
+    // 已有标定数据的舵机走单独的快速路径，其余舵机一起标定
+    const uint8_t calibratedFlags = CalibServoRecord::FLAG_MULTI_TURN | CalibServoRecord::FLAG_LIMIT;
+    bool allCalibrated = (calib_ != nullptr) && calib_->IsValid();
+    for (uint8_t virtualID = 0; virtualID < numServos && allCalibrated; virtualID++) {
+        const CalibServoRecord* record = calib_->FindServo(busID, virtual2ServoID[virtualID]);
+        allCalibrated = record && (record->flags & calibratedFlags) == calibratedFlags;
+    }
+    if (allCalibrated) {
+        bool ok = true;
+        for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+            ok &= InitializeSingleServo(virtual2ServoID[virtualID], percent);
+        }
+        return ok;
+    }
+
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        ResetServoState(servoStates[virtualID]);
+    }
+
+    // 1. 启用扭矩 + 2. 设置多圈模式（角度限制清零）
+    //    先同步读一次当前角度限制，已经清零的舵机不再写 EPROM；
+    //    Flush 只对需要的舵机解锁/写入/加锁，每步一帧同步写
+    const uint8_t zero_data[4] = {0, 0, 0, 0};
+    regCache_.SyncFetch(SMS_STS_MIN_ANGLE_LIMIT_L, 4);
+    regCache_.WriteByteAll(SMS_STS_TORQUE_ENABLE, 1);
+    regCache_.WriteBlockAll(SMS_STS_MIN_ANGLE_LIMIT_L, zero_data, 4);
+    regCache_.Flush();
+    delay(10);
+
+    // 3. 全部回到中位
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        cmdPos_[virtualID]   = 2048;
+        cmdSpeed_[virtualID] = 0;
+        cmdAcc_[virtualID]   = 0;
+    }
+    driver_.SyncWritePosEx(virtual2ServoID, numServos, cmdPos_, cmdSpeed_, cmdAcc_);
+    delay(1000);
+
+    // 4. 并行寻找极限位置
+    //    回到中位后读到的位置即各舵机零位（读取失败的舵机沿用中位 2048）
+    if (!SyncReadPosLoad(2, true)) {
+        DLOG(SERVO_INIT_READ_FAIL, busID);
+    }
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        const ServoState& servo = servoStates[virtualID];
+        zeroPos_[virtualID] = servo.readStats.lastOk ? (int16_t)servo.absolutePos : 2048;
+    }
+    // 查找过程中的同步读可能因过载触发急停；急停或未全部找到极限时不保存、不移动
+    bool limitsFound = FindLimitPositionsAll();
+    if (emergencyStop || !limitsFound) {
+        DLOG(SERVO_INIT_ABORT, busID, emergencyStop, limitsFound);
+        return false;
+    }
+
+    // 5. 记录标定结果，并按百分比移动到指定位置 (零位 ~ limitPos)
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        ServoState& servo = servoStates[virtualID];
+        if (calib_) {
+            CalibServoRecord* record = calib_->EnsureServo(busID, servo.id);
+            if (record) {
+                record->flags |= CalibServoRecord::FLAG_MULTI_TURN | CalibServoRecord::FLAG_LIMIT;
+                record->zeroOffset = zeroPos_[virtualID];
+                record->limitPos = servo.limitPos;
+            }
+        }
+        cmdPos_[virtualID]   = zeroPos_[virtualID] + (int16_t)((servo.limitPos - zeroPos_[virtualID]) * percent);
+        cmdSpeed_[virtualID] = 0;
+        cmdAcc_[virtualID]   = 0;
+    }
+    if (calib_) {
+        calib_->Save();
+    }
+    driver_.SyncWritePosEx(virtual2ServoID, numServos, cmdPos_, cmdSpeed_, cmdAcc_);
+    return true;
+}
+
 bool ServoManager::SyncMoveServos(const int16_t positions[], const uint16_t speeds[], const uint8_t accs[]) {
     if (emergencyStop) {
         Serial.println("ServoManager::SyncMoveServos 已经急停");
@@ -355,18 +662,8 @@ bool ServoManager::SyncMoveServos(const int16_t positions[], const uint16_t spee
         }
     }
     
-    int16_t pos_array[numServos];
-    uint16_t speed_array[numServos];
-    uint8_t acc_array[numServos];
-    
-    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-        pos_array[virtualID] = positions[virtualID];
-        speed_array[virtualID] = (speeds != nullptr) ? speeds[virtualID] : 0;
-        acc_array[virtualID] = (accs != nullptr) ? accs[virtualID] : 0;
-    }
-
-    // 同步写入
-    driver_.SyncWritePosEx(virtual2ServoID, numServos, pos_array, speed_array, acc_array);
+    // 同步写入（驱动不再修改传入的数组，速度/加速度为空时按 0 处理）
+    driver_.SyncWritePosEx(virtual2ServoID, numServos, positions, speeds, accs);
     
     uint32_t now = millis();
     for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
@@ -378,74 +675,142 @@ bool ServoManager::SyncMoveServos(const int16_t positions[], const uint16_t spee
 bool ServoManager::SyncReadPosLoad(uint8_t maxRetries, bool update) {
     uint8_t rx_packet[6]; // 位置2+速度2+负载2
     uint8_t retry_count = 0;
-    
-    while (retry_count <= maxRetries) {
-        bool success = true;
-        
-        // 开始同步读，读取位置和负载（共4字节）
-        driver_.syncReadBegin(numServos, sizeof(rx_packet), 500); // 500ms超时
-        driver_.syncReadPacketTx(virtual2ServoID, numServos, SMS_STS_PRESENT_POSITION_L, sizeof(rx_packet));
-        uint32_t now = millis();
-        for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-            servoStates[virtualID].lastCommTime = now;
-        }
-          
-        for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-            uint8_t servoID = virtual2ServoID[virtualID];
-            driver_.syncReadPacketRx(servoID, rx_packet);
-            if (int result = driver_.getLastError()) {
-                Serial.printf("ServoManager::SyncReadPosLoad 舵机ID %d 读取错误, 总线ID %d, 通信错误为 %d, 重试次数 %d\n", servoID, busID, result, retry_count);
-                servoStates[virtualID].lastError = ServoError::Communication;
-                success = false;
-                break;
+    bool overload = false;
+
+    // 第一轮读取全部舵机
+    uint8_t pending = numServos;
+    for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+        pendingIDs_[virtualID] = virtual2ServoID[virtualID];
+        pendingVirtual_[virtualID] = virtualID;
+        servoStates[virtualID].readStats.lastOk = false;
+    }
+
+    uint32_t start = millis();
+    while (pending > 0) {
+        driver_.syncReadBegin(pending, sizeof(rx_packet), SYNC_READ_TIMEOUT_MS);
+        driver_.syncReadPacketTx(pendingIDs_, pending, SMS_STS_PRESENT_POSITION_L, sizeof(rx_packet));
+
+        // 成功的舵机直接处理，失败的压缩到列表前部等待重试
+        uint8_t missing = 0;
+        for (uint8_t i = 0; i < pending; i++) {
+            uint8_t servoID = pendingIDs_[i];
+            uint8_t virtualID = pendingVirtual_[i];
+            ServoState& servo = servoStates[virtualID];
+            if (driver_.syncReadPacketRx(servoID, rx_packet) != sizeof(rx_packet)) {
+                pendingIDs_[missing] = servoID;
+                pendingVirtual_[missing] = virtualID;
+                missing++;
+                continue;
             }
-            
+
             // 解析位置数据（2字节）
             int32_t raw_position = (rx_packet[0] | (rx_packet[1] << 8));
             if(raw_position & (1<<15)){
                 raw_position = -(raw_position & ~(1<<15));
             }
-            
-            // 解析负载数据（2字节）
-            int32_t raw_load = (rx_packet[4] | (rx_packet[5] << 8));
-            if(raw_load & (1<<15)){
-                raw_load = -(raw_load & ~(1<<15));
+
+            // 解析速度数据（2字节）
+            int32_t raw_speed = (rx_packet[2] | (rx_packet[3] << 8));
+            if(raw_speed & (1<<15)){
+                raw_speed = -(raw_speed & ~(1<<15));
             }
-            
+
+            // 解析负载数据（2字节，符号位为 bit10）
+            int32_t raw_load = SMS_STS_Map::PresentLoad::Get<0>(rx_packet + 4);
+
             // 更新内部位置和负载状态
             if (update) {
-                UpdateServoPosLoad(servoStates[virtualID], raw_position, raw_load);
+                UpdateServoPosLoad(servo, raw_position, raw_load, raw_speed, true);
             }
 
-            // 查看负载是否超限
+            // 负载超限：读完本轮再停机，避免在接收过程中写总线；
+            // 读取成功即刷新错误状态，不保留之前轮次/调用留下的 Overload 或通信错误
             if (abs(raw_load) > EMERGENCY_LOAD) {
-                Serial.printf("ServoManager::SyncReadPosLoad 总线%d上的舵机%d的负载%d超限, 系统急停\n", busID, servoID, raw_load);
-                EmergencyStop();
+                servo.lastError = ServoError::Overload;
+                overload = true;
+            } else {
+                servo.lastError = ServoError::Success;
             }
-            
-            servoStates[virtualID].lastCommTime = millis();
+
+            servo.lastCommTime = millis();
+            servo.readStats.success++;
+            servo.readStats.lastOk = true;
         }
         driver_.syncReadEnd();
-        if (success) {
-            return true;
+        pending = missing;
+
+        if (pending == 0 || retry_count >= maxRetries || millis() - start >= SYNC_READ_BUDGET_MS) {
+            break;
         }
         retry_count++;
-        delay(10); // 重试前短暂延迟
+        for (uint8_t i = 0; i < pending; i++) {
+            servoStates[pendingVirtual_[i]].readStats.retries++;
+        }
     }
-    
-    // 所有重试都失败，记录错误
+
+    // 重试耗尽仍未应答的舵机记录通信错误
+    for (uint8_t i = 0; i < pending; i++) {
+        ServoState& servo = servoStates[pendingVirtual_[i]];
+        servo.lastError = ServoError::Communication;
+        servo.readStats.failures++;
+    }
+
+    if (overload) {
+        for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
+            if (servoStates[virtualID].lastError == ServoError::Overload) {
+                DLOG(SERVO_OVERLOAD, busID, servoStates[virtualID].id, servoStates[virtualID].currentLoad);
+            }
+        }
+        EmergencyStop();
+    }
+
+    return pending == 0;
+}
+
+void ServoManager::PrintReadStats() {
     for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-        servoStates[virtualID].lastError = ServoError::Communication;
+        const SyncReadStats& stats = servoStates[virtualID].readStats;
+        Serial.printf("总线 %d 舵机 %d: 成功 %lu, 重试 %lu, 失败 %lu\n", busID, virtual2ServoID[virtualID],
+                      (unsigned long)stats.success, (unsigned long)stats.retries, (unsigned long)stats.failures);
     }
-    
-    return false;
 }
 
 void ServoManager::EmergencyStop() {
+    FastStop(true);
+}
+
+void ServoManager::IssueTorqueOff() {
     emergencyStop = true;
+    const uint8_t torqueOff = 0;
+    SyncWriteSame(virtual2ServoID, numServos, SMS_STS_TORQUE_ENABLE, &torqueOff, 1);
+    regCache_.AssumeByteAll(SMS_STS_TORQUE_ENABLE, torqueOff);
+}
+
+uint8_t ServoManager::VerifyTorqueOff() {
+    uint8_t torque = 0;
+    uint8_t confirmed = 0;
+    driver_.syncReadBegin(numServos, 1, 5); // 5ms超时，急停路径不能长时间阻塞
+    driver_.syncReadPacketTx(virtual2ServoID, numServos, SMS_STS_TORQUE_ENABLE, 1);
     for (uint8_t virtualID = 0; virtualID < numServos; virtualID++) {
-        EnableTorque(virtual2ServoID[virtualID], false);
+        if (driver_.syncReadPacketRx(virtual2ServoID[virtualID], &torque) == 1 && torque == 0) {
+            confirmed++;
+        }
+    }
+    driver_.syncReadEnd();
+    return confirmed;
+}
+
+uint8_t ServoManager::FastStop(bool verify) {
+    IssueTorqueOff();
+    if (!verify) {
+        return 0;
+    }
+    uint8_t confirmed = VerifyTorqueOff();
+    if (confirmed < numServos) {
+        // 未确认的舵机再补发一次
+        IssueTorqueOff();
     }
+    return confirmed;
 }
 
 void ServoManager::Resume() {
@@ -503,21 +868,14 @@ void ServoManager::ClearErrors() {
     }
 }
 
-void ServoManager::UpdateServoPosLoad(ServoState& servo, int32_t newRawPos, int32_t newLoad) {
-    if (!servo.initialized) {
-        servo.absolutePos = newRawPos;
-        servo.initialized = true;
-    }
-    else {
-        int32_t diff = newRawPos - servo.currentRawPos;
-        // 检测跨圈
-        if (diff < -2048) {
-            servo.turns++;  // 顺时针跨圈
-        } else if (diff > 2048) {
-            servo.turns--;  // 逆时针跨圈
-        }
-        servo.absolutePos = servo.turns * 4096 + newRawPos;
-    }
+void ServoManager::UpdateServoPosLoad(ServoState& servo, int32_t newRawPos, int32_t newLoad,
+                                      int32_t newSpeed, bool speedValid) {
+    // 跨圈判断与 ServoBusManager 共用 MultiTurnTracker
+    servo.tracker.Update((int16_t)newRawPos, (int16_t)newSpeed, micros(), speedValid);
+    servo.turns = servo.tracker.TurnCount();
+    servo.absolutePos = servo.tracker.Absolute();
+    servo.saturated = servo.tracker.Saturated();
+    servo.initialized = true;
     servo.currentRawPos = newRawPos;
     servo.currentLoad = newLoad;
 }
@@ -526,6 +884,8 @@ bool ServoManager::ResetServoState(ServoState& servo) {
     servo.currentRawPos = 2048;
     servo.turns = 0;
     servo.absolutePos = 0;
+    servo.saturated = false;
+    servo.tracker.Reset();
     servo.initialized = false;
     servo.limitPos = 2048;
     servo.lastError = ServoError::Success;
@@ -3,6 +3,8 @@
 
 #include <SMS_STS.h>
 #include "ServoState.h"
+#include "CalibrationStore.h"
+#include "ServoRegisterCache.h"
 
 class ServoManager {
 public:
@@ -17,11 +19,23 @@ public:
     // 析构函数
     ~ServoManager();
     
+    // 绑定标定数据库（需在 begin 之前调用；不绑定则每次启动都全量扫描和标定）
+    void AttachCalibrationStore(CalibrationStore* store) { calib_ = store; }
+
     // 初始化串口通信 + 舵机极限位置
     void begin(uint8_t busID_, uint8_t rxPin, uint8_t txPin, const uint8_t* servoIDs = nullptr);
 
-    // 初始化单个舵机
+    // 初始化单个舵机（标定库有效时跳过极限查找）
     bool InitializeSingleServo(uint8_t servoID, float percent = 0.0);
+
+    // 同时初始化本总线全部舵机：同步写完成多圈配置，并行查找极限位置
+    bool InitializeAllServos(float percent = 0.0);
+
+    // 本总线全部舵机同时查找极限位置（一次同步读 + 一次同步写为一步）
+    bool FindLimitPositionsAll(uint32_t timeoutMs = 50000);
+
+    // 将当前圈数写入标定数据库
+    bool SaveCalibration();
     
     // 移动单个舵机到指定位置
     bool MoveSingleServo(uint8_t servoID, int16_t position, uint16_t speed = 0, uint16_t acc = 0);
@@ -33,13 +47,26 @@ public:
     bool SyncMoveServos(const int16_t positions[], const uint16_t speeds[] = nullptr, const uint8_t accs[] = nullptr);
 
     // 同步读取所有舵机位置负载
+    // 成功的应答直接保留，只对未应答的舵机重发缩小的同步读（总耗时受周期预算限制）
+    // 全部舵机都读到返回 true；各舵机结果见 servoStates[].readStats.lastOk
     bool SyncReadPosLoad(uint8_t maxRetries = 2, bool update = true);
+
+    // 打印各舵机的同步读统计
+    void PrintReadStats();
+
+    // 寄存器影子缓存：后台每次同步读一个缓存段校正缓存（空闲时调用）
+    void RefreshRegisterCache() { regCache_.RefreshNext(); }
+    ServoRegisterCache& RegisterCache() { return regCache_; }
     
     // 停止所有舵机
     void StopAll();
     
-    // 紧急停止
+    // 紧急停止（内部走 FastStop 路径，校验关扭矩并对未确认的舵机补发）
     void EmergencyStop();
+
+    // 快速停机：一次 SYNC_WRITE 关闭本总线全部舵机扭矩，不等应答、不延时
+    // verify 为 true 时随后同步读 TORQUE_ENABLE 校验，返回确认已关闭的舵机数
+    uint8_t FastStop(bool verify = true);
     
     // 从紧急停止恢复
     void Resume();
@@ -55,11 +82,41 @@ public:
 
 private:
     SMS_STS driver_; // 舵机驱动对象
+    CalibrationStore* calib_ = nullptr; // 标定数据库（可选）
+    ServoRegisterCache regCache_;       // 配置/控制寄存器影子缓存
+    static const uint8_t INVALID_VIRTUAL_ID = 0xFF;
+
     uint8_t* virtual2ServoID; // 从servoStates编号到物理ID
-    uint8_t* servo2VirtualID; // 从物理ID到servoStates编号
+    uint8_t* pendingIDs_;     // 同步读待读取的物理ID（重试时只含未应答的舵机）
+    uint8_t* pendingVirtual_; // 与 pendingIDs_ 对应的 servoStates 编号
+
+    // 同步写指令暂存（构造时按舵机数分配，标定路径复用）
+    uint8_t*  cmdIDs_;
+    int16_t*  cmdPos_;
+    int16_t*  zeroPos_;       // 标定时回中位后读到的零位
+    uint16_t* cmdSpeed_;
+    uint8_t*  cmdAcc_;
+
+    // 从物理ID到servoStates编号，未找到返回 INVALID_VIRTUAL_ID
+    uint8_t VirtualID(uint8_t servoID) const;
     
+    // 一次同步读确认所有期望的舵机在线
+    bool VerifyTopology();
+
+    // 使用已保存的标定数据初始化舵机
+    bool InitializeFromCalibration(uint8_t servoID, const CalibServoRecord& record, float percent);
+
     // 设置多圈模式
     bool SetMultiTurnMode(uint8_t servoID);
+
+    // 发出关扭矩同步写（不校验）
+    void IssueTorqueOff();
+
+    // 同步读 TORQUE_ENABLE，返回为 0 的舵机数
+    uint8_t VerifyTorqueOff();
+
+    // 同步写：对给定舵机列表写入相同的字节序列（无应答）
+    void SyncWriteSame(const uint8_t ids[], uint8_t count, uint8_t memAddr, const uint8_t* data, uint8_t len);
     
     // 校准中心位置
     bool CalibrateCenter(uint8_t servoID);
@@ -70,8 +127,9 @@ private:
     // 启用/禁用扭矩
     bool EnableTorque(uint8_t servoID, bool enable);
     
-    // 更新内部位置状态
-    void UpdateServoPosLoad(ServoState& servo, int32_t newRawPos, int32_t newLoad);
+    // 更新内部位置状态（speedValid 为 false 时不使用速度预测跨圈）
+    void UpdateServoPosLoad(ServoState& servo, int32_t newRawPos, int32_t newLoad,
+                            int32_t newSpeed = 0, bool speedValid = false);
 
     // 重新初始化舵机记录状态
     bool ResetServoState(ServoState& servo);
@@ -0,0 +1,339 @@
+#include "ServoRegisterCache.h"
+#include <string.h>
+
+// SMS_STS 后台刷新轮询的缓存段（静态配置 + 常用控制寄存器），未设置布局的舵机使用
+static const ServoRegisterRange kSmsStsRefreshRanges[] = {
+    {SMS_STS_MIN_ANGLE_LIMIT_L, 4},   // 角度限制（多圈模式为 0）
+    {SMS_STS_CW_DEAD,           2},   // 死区
+    {SMS_STS_OFS_L,             3},   // 位置校正 + 运行模式
+    {SMS_STS_TORQUE_ENABLE,     2},   // 扭矩开关 + 加速度
+    {SMS_STS_TORQUE_LIMIT_L,    2},   // 扭矩限制
+    {SMS_STS_LOCK,              1},   // EPROM 锁
+};
+static const uint8_t kSmsStsRefreshRangeCount = sizeof(kSmsStsRefreshRanges) / sizeof(kSmsStsRefreshRanges[0]);
+
+static_assert(SERVO_REG_MAX_SERVOS <= 8, "Flush 的锁掩码为 8 位");
+
+ServoRegisterCache::ServoRegisterCache() {
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+ServoRegisterCache::~ServoRegisterCache() {
+    delete[] shadows_;
+    shadows_ = nullptr;
+}
+
+void ServoRegisterCache::Attach(SMS_STS* driver, const uint8_t* ids, uint8_t count) {
+    delete[] shadows_;
+    if (count > SERVO_REG_MAX_SERVOS) count = SERVO_REG_MAX_SERVOS;
+    driver_ = driver;
+    count_ = count;
+    shadows_ = new ServoRegisterShadow[count];
+    for (uint8_t i = 0; i < count; i++) {
+        memset(&shadows_[i], 0, sizeof(ServoRegisterShadow));
+        shadows_[i].id = ids[i];
+        shadows_[i].ranges = kSmsStsRefreshRanges;
+        shadows_[i].rangeCount = kSmsStsRefreshRangeCount;
+        shadows_[i].lockAddr = SMS_STS_LOCK;
+    }
+    refreshSlot_ = 0;
+    refreshIndex_ = 0;
+}
+
+bool ServoRegisterCache::SetLayout(uint8_t servoID, const ServoRegisterRange* ranges, uint8_t rangeCount, uint8_t lockAddr) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow || !ranges || rangeCount == 0) return false;
+    shadow->ranges = ranges;
+    shadow->rangeCount = rangeCount;
+    shadow->lockAddr = lockAddr;
+    refreshSlot_ = 0;
+    refreshIndex_ = 0;
+    return true;
+}
+
+ServoRegisterShadow* ServoRegisterCache::Find(uint8_t servoID) {
+    for (uint8_t i = 0; i < count_; i++) {
+        if (shadows_[i].id == servoID) return &shadows_[i];
+    }
+    return nullptr;
+}
+
+bool ServoRegisterCache::IsValid(const ServoRegisterShadow& shadow, uint8_t addr, uint8_t len) const {
+    for (uint8_t i = 0; i < len; i++) {
+        if (!TestBit(shadow.valid, addr + i)) return false;
+    }
+    return true;
+}
+
+void ServoRegisterCache::Store(ServoRegisterShadow& shadow, uint8_t addr, const uint8_t* data, uint8_t len, bool overwriteDirty) {
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t a = addr + i;
+        if (!overwriteDirty && TestBit(shadow.dirty, a)) continue;   // 待写入的值优先
+        if (TestBit(shadow.valid, a) && shadow.mem[a] != data[i]) {
+            stats_.refreshFixes++;
+        }
+        shadow.mem[a] = data[i];
+        SetBit(shadow.valid, a);
+    }
+}
+
+/* ==================== 读取 ==================== */
+
+bool ServoRegisterCache::Fetch(ServoRegisterShadow& shadow, uint8_t addr, uint8_t len) {
+    uint8_t buf[SERVO_REG_TABLE_SIZE];
+    stats_.busReads++;
+    if (driver_->Read(shadow.id, addr, buf, len) != len) {
+        return false;
+    }
+    Store(shadow, addr, buf, len, false);
+    return true;
+}
+
+bool ServoRegisterCache::ReadByte(uint8_t servoID, uint8_t addr, uint8_t& value) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow || !Cacheable(addr, 1)) return false;
+
+    if (IsValid(*shadow, addr, 1)) {
+        stats_.cacheHits++;
+    } else if (!Fetch(*shadow, addr, 1)) {
+        return false;
+    }
+    value = shadow->mem[addr];
+    return true;
+}
+
+bool ServoRegisterCache::ReadWord(uint8_t servoID, uint8_t addrL, uint16_t& value) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow || !Cacheable(addrL, 2)) return false;
+
+    if (IsValid(*shadow, addrL, 2)) {
+        stats_.cacheHits++;
+    } else if (!Fetch(*shadow, addrL, 2)) {
+        return false;
+    }
+    value = shadow->mem[addrL] | (shadow->mem[addrL + 1] << 8);
+    return true;
+}
+
+uint8_t ServoRegisterCache::SyncFetch(uint8_t addr, uint8_t len, uint32_t timeoutMs) {
+    return FetchGroup(nullptr, addr, len, timeoutMs);
+}
+
+uint8_t ServoRegisterCache::FetchGroup(const ServoRegisterRange* ranges, uint8_t addr, uint8_t len, uint32_t timeoutMs) {
+    if (!driver_ || count_ == 0 || !Cacheable(addr, len)) return 0;
+
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count_; i++) {
+        if (!ranges || shadows_[i].ranges == ranges) {
+            ids_[n++] = shadows_[i].id;
+        }
+    }
+    if (n == 0) return 0;
+
+    uint8_t buf[SERVO_REG_TABLE_SIZE];
+    uint8_t ok = 0;
+    stats_.busReads++;
+    driver_->syncReadBegin(n, len, timeoutMs);
+    driver_->syncReadPacketTx(ids_, n, addr, len);
+    for (uint8_t i = 0; i < count_; i++) {
+        if (ranges && shadows_[i].ranges != ranges) continue;
+        if (driver_->syncReadPacketRx(shadows_[i].id, buf) == len) {
+            Store(shadows_[i], addr, buf, len, false);
+            ok++;
+        }
+    }
+    driver_->syncReadEnd();
+    return ok;
+}
+
+/* ==================== 写入 ==================== */
+
+bool ServoRegisterCache::WriteBlock(uint8_t servoID, uint8_t addr, const uint8_t* data, uint8_t len) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow || !Cacheable(addr, len)) return false;
+
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t a = addr + i;
+        if (TestBit(shadow->valid, a) && !TestBit(shadow->dirty, a) && shadow->mem[a] == data[i]) {
+            stats_.writesSkipped++;     // 舵机上已经是这个值
+            continue;
+        }
+        shadow->mem[a] = data[i];
+        SetBit(shadow->valid, a);
+        SetBit(shadow->dirty, a);
+        stats_.writesQueued++;
+    }
+    return true;
+}
+
+bool ServoRegisterCache::WriteByte(uint8_t servoID, uint8_t addr, uint8_t value) {
+    return WriteBlock(servoID, addr, &value, 1);
+}
+
+bool ServoRegisterCache::WriteWord(uint8_t servoID, uint8_t addrL, uint16_t value) {
+    uint8_t data[2] = {(uint8_t)(value & 0xFF), (uint8_t)(value >> 8)};
+    return WriteBlock(servoID, addrL, data, 2);
+}
+
+void ServoRegisterCache::WriteByteAll(uint8_t addr, uint8_t value) {
+    for (uint8_t i = 0; i < count_; i++) {
+        WriteBlock(shadows_[i].id, addr, &value, 1);
+    }
+}
+
+void ServoRegisterCache::WriteBlockAll(uint8_t addr, const uint8_t* data, uint8_t len) {
+    for (uint8_t i = 0; i < count_; i++) {
+        WriteBlock(shadows_[i].id, addr, data, len);
+    }
+}
+
+void ServoRegisterCache::AssumeByte(uint8_t servoID, uint8_t addr, uint8_t value) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow || !Cacheable(addr, 1)) return;
+    shadow->mem[addr] = value;
+    SetBit(shadow->valid, addr);
+    ClearBit(shadow->dirty, addr);
+}
+
+void ServoRegisterCache::AssumeByteAll(uint8_t addr, uint8_t value) {
+    for (uint8_t i = 0; i < count_; i++) {
+        AssumeByte(shadows_[i].id, addr, value);
+    }
+}
+
+bool ServoRegisterCache::HasDirty() const {
+    for (uint8_t i = 0; i < count_; i++) {
+        for (uint8_t b = 0; b < sizeof(shadows_[i].dirty); b++) {
+            if (shadows_[i].dirty[b]) return true;
+        }
+    }
+    return false;
+}
+
+void ServoRegisterCache::SyncWriteSame(const uint8_t* ids, uint8_t n, uint8_t addr, uint8_t value) {
+    uint8_t data[251];
+    if (n > sizeof(data)) n = sizeof(data);
+    memset(data, value, n);
+    if (driver_->syncWrite((uint8_t*)ids, n, addr, data, 1)) stats_.framesSent++;
+}
+
+void ServoRegisterCache::WriteLock(uint8_t mask, uint8_t value) {
+    uint8_t done = 0;
+    for (uint8_t i = 0; i < count_; i++) {
+        if (!(mask & (1 << i)) || (done & (1 << i))) continue;
+        uint8_t lockAddr = shadows_[i].lockAddr;
+        uint8_t n = 0;
+        for (uint8_t j = i; j < count_; j++) {
+            if ((mask & (1 << j)) && shadows_[j].lockAddr == lockAddr) {
+                lockIDs_[n++] = shadows_[j].id;
+                done |= 1 << j;
+            }
+        }
+        SyncWriteSame(lockIDs_, n, lockAddr, value);
+    }
+}
+
+uint8_t ServoRegisterCache::Flush() {
+    if (!driver_ || count_ == 0) return 0;
+
+    uint32_t framesBefore = stats_.framesSent;
+
+    // 1. 有 EPROM 脏字节的舵机先统一解锁
+    uint8_t epromMask = 0;
+    for (uint8_t i = 0; i < count_; i++) {
+        for (uint8_t a = 0; a < SERVO_REG_EPROM_END; a++) {
+            if (TestBit(shadows_[i].dirty, a)) {
+                epromMask |= 1 << i;
+                break;
+            }
+        }
+    }
+    if (epromMask) {
+        WriteLock(epromMask, 0);
+    }
+
+    // 单帧长度 (len + 1) * n + 4 不能超过 255
+    uint8_t maxRun = (uint8_t)(251 / count_ - 1);
+    if (maxRun > SERVO_REG_MAX_RUN) maxRun = SERVO_REG_MAX_RUN;
+
+    // 2. 每次取第一个仍有脏字节的舵机的第一个连续脏段，
+    //    所有在该段上全部为脏的舵机合并为一帧 SYNC_WRITE
+    uint8_t data[251];
+    for (;;) {
+        uint8_t start = 0, len = 0;
+        for (uint8_t i = 0; i < count_ && len == 0; i++) {
+            for (uint8_t a = 0; a < SERVO_REG_CACHE_END; a++) {
+                if (!TestBit(shadows_[i].dirty, a)) continue;
+                start = a;
+                while (a < SERVO_REG_CACHE_END && TestBit(shadows_[i].dirty, a) && len < maxRun) {
+                    a++;
+                    len++;
+                }
+                break;
+            }
+        }
+        if (len == 0) break;
+
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < count_; i++) {
+            bool covered = true;
+            for (uint8_t k = 0; k < len && covered; k++) {
+                covered = TestBit(shadows_[i].dirty, start + k);
+            }
+            if (!covered) continue;
+            ids_[n] = shadows_[i].id;
+            memcpy(data + n * len, shadows_[i].mem + start, len);
+            for (uint8_t k = 0; k < len; k++) {
+                ClearBit(shadows_[i].dirty, start + k);
+            }
+            n++;
+        }
+        if (driver_->syncWrite(ids_, n, start, data, len)) stats_.framesSent++;
+    }
+
+    // 3. 重新加锁
+    if (epromMask) {
+        WriteLock(epromMask, 1);
+    }
+
+    return (uint8_t)(stats_.framesSent - framesBefore);
+}
+
+/* ==================== 一致性 ==================== */
+
+void ServoRegisterCache::Invalidate(uint8_t servoID) {
+    ServoRegisterShadow* shadow = Find(servoID);
+    if (!shadow) return;
+    memset(shadow->valid, 0, sizeof(shadow->valid));
+    memset(shadow->dirty, 0, sizeof(shadow->dirty));
+}
+
+void ServoRegisterCache::InvalidateAll() {
+    for (uint8_t i = 0; i < count_; i++) {
+        memset(shadows_[i].valid, 0, sizeof(shadows_[i].valid));
+        memset(shadows_[i].dirty, 0, sizeof(shadows_[i].dirty));
+    }
+}
+
+void ServoRegisterCache::RefreshNext(uint32_t timeoutMs) {
+    if (!driver_ || count_ == 0) return;
+
+    const ServoRegisterShadow& lead = shadows_[refreshSlot_];
+    const ServoRegisterRange& range = lead.ranges[refreshIndex_];
+    FetchGroup(lead.ranges, range.addr, range.len, timeoutMs);
+
+    // 本段表的各段读完后，转到下一个使用不同段表的舵机（每个段表只从其第一个舵机开始）
+    if (++refreshIndex_ < lead.rangeCount) return;
+    refreshIndex_ = 0;
+    for (uint8_t next = refreshSlot_ + 1; next < count_; next++) {
+        bool first = true;
+        for (uint8_t i = 0; i < next && first; i++) {
+            first = shadows_[i].ranges != shadows_[next].ranges;
+        }
+        if (first) {
+            refreshSlot_ = next;
+            return;
+        }
+    }
+    refreshSlot_ = 0;
+}
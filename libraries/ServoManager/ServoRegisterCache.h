@@ -0,0 +1,128 @@
+#ifndef SERVO_REGISTER_CACHE_H
+#define SERVO_REGISTER_CACHE_H
+
+#include <SMS_STS.h>
+
+// 舵机内存表影子缓存（按总线一份，覆盖内存表 0 ~ 70）
+//
+// - EPROM 区 (0 ~ 39) 与 RAM 控制区 (40 ~ 55) 的读取优先命中缓存；
+//   反馈区 (56 ~ 70) 随时变化，不缓存，始终返回 false。
+// - 写入只修改影子并置脏，值与缓存相同时直接忽略；Flush() 把各舵机的脏字节
+//   按连续地址段合并，地址段相同的舵机合并为一帧 SYNC_WRITE；
+//   涉及 EPROM 的写入前后统一用 SYNC_WRITE 解锁/加锁（锁地址相同的舵机一帧）。
+// - SYNC_WRITE 没有应答，缓存与舵机的一致性由 RefreshNext() 周期性同步读校正。
+// - 各型号的刷新段与锁地址不同，由 SetLayout() 按舵机设置；未设置时按 SMS_STS。
+
+#define SERVO_REG_TABLE_SIZE   71   // SMS_STS_PRESENT_CURRENT_H + 1
+#define SERVO_REG_EPROM_END    40   // [0, 40) 为 EPROM 区（SMS_STS_TORQUE_ENABLE 之前）
+#define SERVO_REG_CACHE_END    56   // [0, 56) 可缓存（SMS_STS_PRESENT_POSITION_L 之前）
+#define SERVO_REG_MAX_RUN      16   // 单帧 SYNC_WRITE 的最大段长（受帧长 255 字节限制）
+#define SERVO_REG_MAX_SERVOS   8    // 单总线最多缓存的舵机数（多出的舵机不缓存）
+
+// 后台刷新轮询的一个缓存段
+struct ServoRegisterRange {
+    uint8_t addr;
+    uint8_t len;
+};
+
+struct ServoRegisterShadow {
+    uint8_t id;
+    const ServoRegisterRange* ranges;   // 刷新段表（同一段表的舵机一起同步读）
+    uint8_t rangeCount;
+    uint8_t lockAddr;                   // EPROM 锁地址
+    uint8_t mem[SERVO_REG_TABLE_SIZE];
+    uint8_t valid[(SERVO_REG_TABLE_SIZE + 7) / 8];
+    uint8_t dirty[(SERVO_REG_TABLE_SIZE + 7) / 8];
+};
+
+// 缓存统计
+struct ServoRegisterCacheStats {
+    uint32_t cacheHits;      // 由缓存直接返回的读取
+    uint32_t busReads;       // 实际发到总线上的读帧（含同步读）
+    uint32_t writesSkipped;  // 与缓存值相同而省略的写入字节
+    uint32_t writesQueued;   // 置脏的写入字节
+    uint32_t framesSent;     // Flush 发出的 SYNC_WRITE 帧（含解锁/加锁）
+    uint32_t refreshFixes;   // 后台刷新发现并修正的不一致字节
+};
+
+class ServoRegisterCache {
+public:
+    ServoRegisterCache();
+    ~ServoRegisterCache();
+
+    // 绑定驱动与舵机列表（缓存全部置为无效，布局恢复为 SMS_STS）
+    void Attach(SMS_STS* driver, const uint8_t* ids, uint8_t count);
+
+    // 设置舵机的型号布局：后台刷新段表与 EPROM 锁地址（ranges 需长期有效）
+    bool SetLayout(uint8_t servoID, const ServoRegisterRange* ranges, uint8_t rangeCount, uint8_t lockAddr);
+
+    /* ========== 读取 ========== */
+
+    // 缓存命中时直接返回；未命中时读取一次 [addr, addr+len) 并写入缓存
+    bool ReadByte(uint8_t servoID, uint8_t addr, uint8_t& value);
+    bool ReadWord(uint8_t servoID, uint8_t addrL, uint16_t& value);
+
+    // 对全部舵机同步读 [addr, addr+len)，填充缓存（脏字节不覆盖），返回成功的舵机数
+    uint8_t SyncFetch(uint8_t addr, uint8_t len, uint32_t timeoutMs = 10);
+
+    /* ========== 写入（置脏，Flush 时发出） ========== */
+
+    bool WriteByte(uint8_t servoID, uint8_t addr, uint8_t value);
+    bool WriteWord(uint8_t servoID, uint8_t addrL, uint16_t value);   // 小端序，与 SMS_STS 一致
+    bool WriteBlock(uint8_t servoID, uint8_t addr, const uint8_t* data, uint8_t len);
+
+    // 对全部舵机写入相同的值
+    void WriteByteAll(uint8_t addr, uint8_t value);
+    void WriteBlockAll(uint8_t addr, const uint8_t* data, uint8_t len);
+
+    // 绕过缓存直接写入舵机后调用，使缓存与已知写入值一致（不置脏）
+    void AssumeByte(uint8_t servoID, uint8_t addr, uint8_t value);
+    void AssumeByteAll(uint8_t addr, uint8_t value);
+
+    // 发出所有脏数据，返回发出的帧数
+    uint8_t Flush();
+
+    bool HasDirty() const;
+
+    /* ========== 一致性 ========== */
+
+    // 丢弃某个舵机的全部缓存（例如舵机重新上电）
+    void Invalidate(uint8_t servoID);
+    void InvalidateAll();
+
+    // 后台刷新：每次同步读一个缓存段，修正与舵机不一致的字节。
+    // 使用同一段表的舵机一起读；依次轮询各段表的各段，每次调用最多一帧同步读。
+    // timeoutMs 为同步读的接收超时，调度方据此估算最坏耗时
+    void RefreshNext(uint32_t timeoutMs = 10);
+
+    const ServoRegisterCacheStats& Stats() const { return stats_; }
+
+private:
+    SMS_STS* driver_ = nullptr;
+    ServoRegisterShadow* shadows_ = nullptr;
+    uint8_t count_ = 0;
+    uint8_t refreshSlot_ = 0;      // 当前刷新段表的第一个舵机
+    uint8_t refreshIndex_ = 0;     // 段表中的下一段
+    ServoRegisterCacheStats stats_;
+    uint8_t ids_[SERVO_REG_MAX_SERVOS];       // 同步读/写的 ID 列表
+    uint8_t lockIDs_[SERVO_REG_MAX_SERVOS];   // Flush 中需要解锁/加锁的 ID
+
+    ServoRegisterShadow* Find(uint8_t servoID);
+    bool Cacheable(uint8_t addr, uint8_t len) const {
+        return len > 0 && (uint16_t)addr + len <= SERVO_REG_CACHE_END;
+    }
+    static bool TestBit(const uint8_t* bits, uint8_t i) { return bits[i >> 3] & (1 << (i & 7)); }
+    static void SetBit(uint8_t* bits, uint8_t i) { bits[i >> 3] |= (1 << (i & 7)); }
+    static void ClearBit(uint8_t* bits, uint8_t i) { bits[i >> 3] &= ~(1 << (i & 7)); }
+
+    bool Fetch(ServoRegisterShadow& shadow, uint8_t addr, uint8_t len);
+    bool IsValid(const ServoRegisterShadow& shadow, uint8_t addr, uint8_t len) const;
+    void Store(ServoRegisterShadow& shadow, uint8_t addr, const uint8_t* data, uint8_t len, bool overwriteDirty);
+    void SyncWriteSame(const uint8_t* ids, uint8_t n, uint8_t addr, uint8_t value);
+    // 对 mask 中的舵机写锁寄存器，锁地址相同的舵机一帧
+    void WriteLock(uint8_t mask, uint8_t value);
+    // 同步读 [addr, addr+len)：ranges 为 nullptr 时读全部舵机，否则只读使用该段表的舵机
+    uint8_t FetchGroup(const ServoRegisterRange* ranges, uint8_t addr, uint8_t len, uint32_t timeoutMs);
+};
+
+#endif // SERVO_REGISTER_CACHE_H
@@ -2,8 +2,16 @@
 #define SERVO_STATE_H
 
 #include <Arduino.h>
+#include "MultiTurnTracker.h"
 
-#define EMERGENCY_LOAD 5000 // TODO
+// 负载满量程（最大力矩的 0.1%），与 ServoModel.h 相同
+#ifndef SERVO_TORQUE_LIMIT_MAX
+#define SERVO_TORQUE_LIMIT_MAX 1000
+#endif
+
+// 单次读数超过满量程的 95% 立即停机（只有堵转、撞限位才会出现）；
+// 低于此值的持续过载由固件的 LoadProtector 按 LOAD_* 参数累计处理
+#define EMERGENCY_LOAD (SERVO_TORQUE_LIMIT_MAX * 95 / 100)
 
 // 舵机错误类型枚举
 enum class ServoError {
@@ -16,17 +24,37 @@ enum class ServoError {
     InvalidPosition
 };
 
+// 极限位置查找状态（并行标定时每个舵机独立推进）
+enum class LimitSearch {
+    Idle,
+    Stepping,       // 正在步进
+    Found,          // 负载超过阈值，已记录极限位置
+    TimedOut        // 超时，使用保守值
+};
+
+// 同步读统计（按舵机累计）
+struct SyncReadStats {
+    uint32_t success = 0;     // 成功读取次数（含重试后成功）
+    uint32_t retries = 0;     // 进入重试子集的次数
+    uint32_t failures = 0;    // 重试耗尽仍失败的次数
+    bool lastOk = false;      // 最近一次同步读是否拿到数据
+};
+
 // 简化的舵机状态结构体（不包含成员函数）
 struct ServoState {
     uint8_t id = 0;
     uint16_t currentRawPos = 2048;// 原始位置值 (0-4095)
     int32_t turns = 0;              // 转过的圈数
-    int32_t absolutePos = 0;       // 绝对位置
+    int32_t absolutePos = 0;       // 绝对位置（不截断）
+    bool saturated = false;         // 绝对位置超出 ±30719
+    MultiTurnTracker tracker;       // 多圈估计器
     int32_t currentLoad = 0;       // 当前负载值
     bool initialized = false;       // 是否已初始化
     uint16_t limitPos = 2048;      // 极限位置（默认保守值）
+    LimitSearch limitSearch = LimitSearch::Idle;
     ServoError lastError = ServoError::Success;
     uint32_t lastCommTime = 0;
+    SyncReadStats readStats;
 };
 
 #endif // SERVO_STATE_H
\ No newline at end of file
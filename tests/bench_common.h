@@ -0,0 +1,27 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+// 基准计时：steady_clock，结果按每次调用纳秒输出。
+// 主机上的绝对数值与 ESP32-P4 不同，只用于比较同一台机器上的不同实现。
+#include <chrono>
+#include <stdio.h>
+
+template <typename Fn>
+static double benchNsPerCall(const char* name, long iterations, Fn&& fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    printf("%-40s %10.1f ns/call  (%ld 次)\n", name, ns, iterations);
+    return ns;
+}
+
+// 防止编译器把基准循环中的结果优化掉
+template <typename T>
+static inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif // BENCH_COMMON_H
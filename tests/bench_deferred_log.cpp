@@ -0,0 +1,80 @@
+// 延迟日志调用开销：DLOG() 入队 vs. 直接格式化（原 Serial.printf 在发送前的 CPU 开销）
+#include "bench_common.h"
+#include "DeferredLog.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static std::atomic<uint32_t> s_sunk(0);
+static void countingSink(const LogEntry& entry) {
+    if (entry.formatId == DLOG_SERVO_LIMIT_START) s_sunk++;
+}
+
+int main() {
+    const long N = 2000000;
+    DeferredLog::SetSink(countingSink);
+
+    // 1. 热路径：三个整数参数，每 32 条排空一次（缓冲区不会满）
+    double logNs = benchNsPerCall("DLOG 3 参数 (含 1/32 排空)", N, [](long i) {
+        DLOG(SERVO_LIMIT_PROGRESS, (int)i, (int)(i * 2), (int)-i);
+        if ((i & 31) == 31) DeferredLog::Drain();
+    });
+    DeferredLog::Drain();
+
+    // 2. 缓冲区已满时的丢弃路径
+    for (int i = 0; i < DLOG_RING_SIZE; i++) DLOG(SERVO_LIMIT_START, i);
+    uint32_t droppedBefore = DeferredLog::Dropped(0);
+    benchNsPerCall("DLOG 缓冲区满 (丢弃)", N, [](long i) {
+        DLOG(SERVO_LIMIT_START, (int)i);
+    });
+    uint32_t dropped = DeferredLog::Dropped(0) - droppedBefore;
+    DeferredLog::Drain();
+
+    // 3. 对照：在调用处直接格式化同一条日志
+    char text[128];
+    double fmtNs = benchNsPerCall("snprintf 同一格式串", N, [&](long i) {
+        snprintf(text, sizeof(text), kLogFormats[DLOG_SERVO_LIMIT_PROGRESS], (int)i, (int)(i * 2), (int)-i);
+        benchKeep(text);
+    });
+
+    // 4. 排空侧：FormatEntry 把一条记录还原为文本
+    LogEntry entry = {};
+    entry.formatId = DLOG_SERVO_LIMIT_PROGRESS;
+    entry.argc = 3;
+    benchNsPerCall("FormatEntry (排空任务)", N, [&](long i) {
+        entry.args[0] = (uint32_t)i;
+        DeferredLog::FormatEntry(entry, text, sizeof(text));
+        benchKeep(text);
+    });
+
+    printf("DLOG / snprintf = %.2f\n", logNs / fmtNs);
+
+    // 5. 多生产者：每条日志要么被排空，要么计入丢弃，不会丢失或重复
+    s_sunk = 0;
+    droppedBefore = DeferredLog::Dropped(0);
+    const int THREADS = 4, PER_THREAD = 20000;
+    std::atomic<bool> producing(true);
+    std::thread drainer([&] {
+        while (producing) DeferredLog::Drain();
+    });
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; t++) {
+        producers.emplace_back([] {
+            for (int i = 0; i < PER_THREAD; i++) {
+                DLOG(SERVO_LIMIT_START, i);
+                if ((i & 15) == 15) std::this_thread::yield();   // 给排空线程机会，模拟突发写入
+            }
+        });
+    }
+    for (auto& p : producers) p.join();
+    producing = false;
+    drainer.join();
+    DeferredLog::Drain();
+
+    uint32_t lost = DeferredLog::Dropped(0) - droppedBefore;
+    printf("多生产者: 写入 %d, 排空 %u, 丢弃 %u\n", THREADS * PER_THREAD, (unsigned)s_sunk, lost);
+
+    bool ok = dropped == (uint32_t)N && s_sunk + lost == (uint32_t)(THREADS * PER_THREAD);
+    if (!ok) printf("FAIL: 丢弃计数或多生产者结果不一致\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// 磁编调理：合成毛刺轨迹上的单帧开销与误差。
+// 21 路关节按不同相位做正弦运动并缓慢漂移（反复经过 0/360°），以 OUTER_LOOP_PERIOD_MS 采样，
+// 按固定比例注入 0xFFFF/0x3FFF、错误标记与远离真实位置的毛刺（含连续两帧的毛刺），
+// 通道 7 在中途整体偏移（掌部板重新上电）。比较直接换算的原始读数与调理输出相对真实角度的误差
+#include "bench_common.h"
+#include "EncoderConditioner.h"
+#include <math.h>
+#include <vector>
+
+static const int FRAMES = 20000;
+static const float DEG_PER_COUNT = 360.0f / ENC_COUNTS_PER_REV;
+static const int RELOCK_CHANNEL = 7;
+static const int RELOCK_FRAME = FRAMES / 2;
+static const int32_t RELOCK_OFFSET = 5000;
+
+struct Trace {
+    std::vector<uint16_t> raw;     // FRAMES × 21
+    std::vector<uint8_t>  flags;
+    std::vector<float>    truth;   // 真实的连续角度 (°)
+    uint32_t invalid = 0;          // 注入的无效读数（真实位置恰为 0x3FFF 的读数同样无效）
+    uint32_t spikes = 0;           // 注入的毛刺
+};
+
+static uint32_t s_rng = 12345;
+static uint32_t nextRand() {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+static Trace makeTrace() {
+    Trace t;
+    t.raw.resize(FRAMES * ENCODER_TOTAL_NUM);
+    t.flags.resize(FRAMES * ENCODER_TOTAL_NUM);
+    t.truth.resize(FRAMES * ENCODER_TOTAL_NUM);
+    const float dt = OUTER_LOOP_PERIOD_MS * 1e-3f;
+    int spikeRun[ENCODER_TOTAL_NUM] = {};
+
+    for (int f = 0; f < FRAMES; f++) {
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+            float s = f * dt;
+            float deg = 90.0f * sinf(2.0f * (float)M_PI * 0.5f * s + i) + 20.0f * s + 17.0f * i;
+            int32_t counts = (int32_t)lroundf(deg / DEG_PER_COUNT);
+            if (i == RELOCK_CHANNEL && f >= RELOCK_FRAME) counts += RELOCK_OFFSET;
+            t.truth[f * ENCODER_TOTAL_NUM + i] = counts * DEG_PER_COUNT;
+
+            uint16_t v = (uint16_t)(counts & (ENC_COUNTS_PER_REV - 1));
+            uint8_t flag = 0;
+            bool spike = false;
+            uint32_t r = nextRand() % 1000;
+            if (spikeRun[i] > 0) {
+                // 连续第二帧毛刺：与前一个相近（不足以重新锁定）
+                v = (uint16_t)((v + ENC_COUNTS_PER_REV / 2) & (ENC_COUNTS_PER_REV - 1));
+                spikeRun[i]--;
+                spike = true;
+                t.spikes++;
+            } else if (r < 10) {
+                v = 0xFFFF;
+                t.invalid++;
+            } else if (r < 13) {
+                v = 0x3FFF;
+                t.invalid++;
+            } else if (r < 15) {
+                flag = 1;
+                t.invalid++;
+            } else if (r < 20) {
+                // 远离真实位置的毛刺（至少 4000 计数），其中一部分连续两帧
+                v = (uint16_t)((v + 4000 + nextRand() % 8000) & (ENC_COUNTS_PER_REV - 1));
+                spikeRun[i] = (r == 19) ? 1 : 0;
+                spike = true;
+                t.spikes++;
+            }
+            if (v == 0x3FFF && spike) v = 0x3FFE;           // 毛刺不取无效值
+            else if (v == 0x3FFF && r >= 20) t.invalid++;   // 真实位置恰为 0x3FFF
+            t.raw[f * ENCODER_TOTAL_NUM + i] = v;
+            t.flags[f * ENCODER_TOTAL_NUM + i] = flag;
+        }
+    }
+    return t;
+}
+
+int main() {
+    Trace trace = makeTrace();
+    float out[ENCODER_TOTAL_NUM];
+
+    // 1. 误差：原始读数直接换算 vs 调理输出（重新锁定前后各 10 帧不计）
+    // 调理输出从首个读数的单圈角度开始，比较时扣除真实角度的初始整圈
+    EncoderConditioner cond;
+    float turns[ENCODER_TOTAL_NUM];
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        turns[i] = 360.0f * roundf((trace.truth[i] - trace.raw[i] * DEG_PER_COUNT) / 360.0f);
+    }
+    float rawMax = 0.0f, condMax = 0.0f;
+    double condSum = 0.0;
+    long condCount = 0, rawBad = 0, condBad = 0;
+    for (int f = 0; f < FRAMES; f++) {
+        const uint16_t* raw = &trace.raw[f * ENCODER_TOTAL_NUM];
+        cond.process(raw, &trace.flags[f * ENCODER_TOTAL_NUM], out);
+        if (f < 10 || (f >= RELOCK_FRAME - 10 && f < RELOCK_FRAME + 10)) continue;
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+            float truth = trace.truth[f * ENCODER_TOTAL_NUM + i];
+            // 原始读数只能给出单圈角度：按最近的整圈比较，只统计毛刺/无效值带来的误差
+            float rawDeg = raw[i] * DEG_PER_COUNT;
+            float rawErr = fabsf(remainderf(rawDeg - truth, 360.0f));
+            float condErr = fabsf(out[i] + turns[i] - truth);
+            rawMax = fmaxf(rawMax, rawErr);
+            condMax = fmaxf(condMax, condErr);
+            condSum += condErr;
+            condCount++;
+            rawBad += rawErr > 5.0f;
+            condBad += condErr > 5.0f;
+        }
+    }
+    const EncoderConditionerStats& s = cond.stats();
+    printf("注入: 无效 %u, 毛刺 %u | 调理统计: 无效 %u, 毛刺 %u, 重新锁定 %u\n",
+           trace.invalid, trace.spikes, s.invalid, s.glitches, s.relocks);
+    printf("误差 > 5°: 原始 %ld 次 (最大 %.1f°), 调理后 %ld 次 (最大 %.2f°, 平均 %.3f°)\n",
+           rawBad, rawMax, condBad, condMax, condSum / condCount);
+
+    // 2. 单帧开销（21 路）
+    EncoderConditioner timed;
+    benchNsPerCall("process 21 路 (毛刺轨迹)", 2000000, [&](long n) {
+        int f = (int)(n % FRAMES);
+        timed.process(&trace.raw[f * ENCODER_TOTAL_NUM], &trace.flags[f * ENCODER_TOTAL_NUM], out);
+        benchKeep(out);
+    });
+
+    // 重新锁定前的 ENC_GLITCH_RELOCK - 1 个读数同样计为毛刺。
+    // 调理输出的误差来自中值/低通的延迟（峰值约 300°/s 时约 2 帧）与坏读数期间的保持
+    bool ok = s.invalid == trace.invalid && s.glitches == trace.spikes + ENC_GLITCH_RELOCK - 1 && s.relocks == 1
+           && condMax < 10.0f && condBad * 10 < rawBad;
+    if (!ok) printf("FAIL: 毛刺未全部剔除或调理输出误差过大\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+// 舵机协议层经 CRTP 传输层的单事务开销（串口桩模拟 8 个舵机的应答），
+// 并检查每个事务的驱动调用次数：每帧只写一次
+#include "bench_common.h"
+#include "SCServo.h"
+
+static const uint8_t kIds[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+static uint8_t s_mem[256][SMS_STS_PRESENT_CURRENT_H + 1];
+
+static void appendStatus(std::vector<uint8_t>& out, uint8_t id, const uint8_t* data, uint8_t len) {
+    uint8_t sum = id + (len + 2);
+    out.push_back(0xff); out.push_back(0xff); out.push_back(id); out.push_back(len + 2); out.push_back(0);
+    for (uint8_t i = 0; i < len; i++) { out.push_back(data[i]); sum += data[i]; }
+    out.push_back((uint8_t)~sum);
+}
+
+// 写入内存表；舵机“立即到位”，目标位置同时作为当前位置
+static void applyWrite(uint8_t id, uint8_t addr, const uint8_t* data, uint8_t len) {
+    memcpy(&s_mem[id][addr], data, len);
+    s_mem[id][SMS_STS_PRESENT_POSITION_L] = s_mem[id][SMS_STS_GOAL_POSITION_L];
+    s_mem[id][SMS_STS_PRESENT_POSITION_H] = s_mem[id][SMS_STS_GOAL_POSITION_H];
+}
+
+// 舵机模拟：解析写出的每一帧（拼接发送时一次写出多帧），写指令更新内存表，读指令立即应答
+static void emulateServos(HardwareSerial& port, const uint8_t* buf, size_t len) {
+    std::vector<uint8_t> reply;
+    size_t pos = 0;
+    while (pos + 5 < len && buf[pos] == 0xff && buf[pos + 1] == 0xff) {
+        const uint8_t id = buf[pos + 2];
+        const uint8_t msgLen = buf[pos + 3];
+        const uint8_t inst = buf[pos + 4];
+        const uint8_t* p = buf + pos + 5;
+        switch (inst) {
+        case INST_WRITE:
+            applyWrite(id, p[0], p + 1, msgLen - 3);
+            appendStatus(reply, id, nullptr, 0);
+            break;
+        case INST_READ:
+            appendStatus(reply, id, &s_mem[id][p[0]], p[1]);
+            break;
+        case INST_SYNC_WRITE:
+            for (uint8_t k = 0; k < (msgLen - 4) / (p[1] + 1); k++) {
+                const uint8_t* entry = p + 2 + k * (p[1] + 1);
+                applyWrite(entry[0], p[0], entry + 1, p[1]);
+            }
+            break;
+        case INST_SYNC_READ:
+            for (uint8_t k = 0; k < msgLen - 4; k++) appendStatus(reply, p[2 + k], &s_mem[p[2 + k]][p[0]], p[1]);
+            break;
+        }
+        pos += 4 + msgLen;
+    }
+    port.reply(reply.data(), reply.size());
+}
+
+static bool checkBurstOrder() {
+    // 拼接缓冲放不下时先写出已拼接的帧，总线上的顺序与调用顺序一致
+    HardwareSerial serial;
+    SMS_STS sts(0, 0);
+    sts.pSerial = &serial;
+    int16_t pos[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t ids[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    int a = sts.SyncWritePosEx(ids, 1, pos, NULL, NULL);       // 16 字节
+    int b = sts.SyncWritePosEx(ids, 8, pos, NULL, NULL);       // 72 字节
+    std::vector<uint8_t> expect = serial.tx;
+    serial.tx.clear();
+
+    uint8_t burst[40];
+    sts.txBurstBegin(burst, sizeof(burst));
+    sts.SyncWritePosEx(ids, 1, pos, NULL, NULL);               // 进入缓冲
+    sts.SyncWritePosEx(ids, 8, pos, NULL, NULL);               // 超过缓冲：先写出前一帧，再直接写出
+    sts.RegWriteAction();                                      // 重新进入缓冲
+    int total = sts.txBurstEnd();
+    expect.insert(expect.end(), { 0xff, 0xff, 0xfe, 0x02, INST_REG_ACTION, 0xfa });
+
+    bool ok = serial.tx == expect && total == a + b + 6 && a == 16 && b == 72;
+    if (!ok) printf("FAIL: 拼接缓冲溢出后帧顺序或字节数不一致\n");
+    return ok;
+}
+
+static bool checkSyncWriteLimit() {
+    // 超出单帧上限时整帧不发送并返回 0，不再截断舵机列表
+    HardwareSerial serial;
+    SMS_STS sts(0, 0);
+    sts.pSerial = &serial;
+    uint8_t ids[40] = {};
+    int16_t pos[40] = {};
+    uint8_t data[40 * 7] = {};
+    bool ok = sts.SyncWritePosEx(ids, SMS_STS_Map::PosEx::MaxSyncIDN + 1, pos, NULL, NULL) == 0
+           && sts.getLastError() == ERR_BUFF_LEN
+           && sts.syncWrite(ids, 40, SMS_STS_ACC, data, 7) == 0
+           && serial.writeCalls == 0
+           && sts.SyncWritePosEx(ids, SMS_STS_Map::PosEx::MaxSyncIDN, pos, NULL, NULL) == 7 + 31 * 8 + 1;
+    if (!ok) printf("FAIL: 超长 SYNC_WRITE 未返回错误\n");
+    return ok;
+}
+
+static bool checkSyncReadLimit() {
+    // 接收缓冲在驱动对象内：放不下应答的同步读被拒绝且不发送请求，放得下的照常读取
+    HardwareSerial serial;
+    serial.onWrite = emulateServos;
+    SMS_STS sts;
+    sts.pSerial = &serial;
+    const uint8_t tooMany = SCS_SYNC_READ_BUF_LEN / (6 + 6) + 1;   // 6 字节应答放不下的舵机数
+    uint8_t ids[tooMany];
+    for (int k = 0; k < tooMany; k++) ids[k] = (uint8_t)(k + 1);
+    uint8_t data[SCS_SYNC_READ_MAX_LEN + 1];
+
+    bool ok = sts.syncReadBegin(tooMany, 6, 10) == 0
+           && sts.getLastError() == ERR_BUFF_LEN
+           && sts.syncReadPacketTx(ids, tooMany, SMS_STS_PRESENT_POSITION_L, 6) == 0
+           && sts.syncReadPacketRx(1, data) == 0
+           && serial.writeCalls == 0;
+    sts.syncReadEnd();
+    ok = ok && sts.syncReadBegin(SCS_SYNC_READ_MAX_IDN, SCS_SYNC_READ_MAX_LEN + 1, 10) == 0;
+    sts.syncReadEnd();
+
+    // 请求比 syncReadBegin 声明的更长同样拒绝
+    ok = ok && sts.syncReadBegin(2, 2, 10) == 1
+            && sts.syncReadPacketTx(ids, 2, SMS_STS_PRESENT_POSITION_L, 6) == 0
+            && serial.writeCalls == 0;
+    sts.syncReadEnd();
+
+    ok = ok && sts.syncReadBegin(SCS_SYNC_READ_MAX_IDN, SCS_SYNC_READ_MAX_LEN, 10) == 1
+            && sts.syncReadPacketTx(ids, SCS_SYNC_READ_MAX_IDN, 0, SCS_SYNC_READ_MAX_LEN)
+               == SCS_SYNC_READ_MAX_IDN * (SCS_SYNC_READ_MAX_LEN + 6)
+            && sts.syncReadPacketRx(ids[SCS_SYNC_READ_MAX_IDN - 1], data) == SCS_SYNC_READ_MAX_LEN;
+    sts.syncReadEnd();
+    if (!ok) printf("FAIL: 同步读接收缓冲的上限检查\n");
+    return ok;
+}
+
+int main() {
+    const long N = 200000;
+    HardwareSerial serial;
+    serial.onWrite = emulateServos;
+    SMS_STS sts;
+    sts.pSerial = &serial;
+    bool ok = true;
+
+    // 每个事务的驱动调用次数
+    auto perCall = [&](const char* name, long n, unsigned long writes0, unsigned long calls0, unsigned long frames) {
+        double w = (double)(serial.writeCalls - writes0) / n;
+        printf("  %-24s 写 %.2f 次/事务, 驱动调用 %.2f 次/事务\n", name, w, (double)(serial.calls - calls0) / n);
+        if (w != (double)frames) {
+            printf("FAIL: %s 每事务应写出 %lu 次\n", name, frames);
+            ok = false;
+        }
+    };
+    unsigned long w0, c0;
+
+    w0 = serial.writeCalls; c0 = serial.calls;
+    int acks = 0;
+    benchNsPerCall("writeByte 带应答", N, [&](long i) {
+        acks += sts.writeByte(kIds[i & 7], SMS_STS_ACC, (uint8_t)i);
+    });
+    perCall("writeByte 带应答", N, w0, c0, 1);
+    ok = ok && acks == N;
+
+    s_mem[3][SMS_STS_PRESENT_POSITION_L] = 0x34;
+    s_mem[3][SMS_STS_PRESENT_POSITION_H] = 0x82;
+    w0 = serial.writeCalls; c0 = serial.calls;
+    long readBytes = 0;
+    uint8_t buf[8];
+    benchNsPerCall("Read 4 字节", N, [&](long) {
+        readBytes += sts.Read(3, SMS_STS_PRESENT_POSITION_L, buf, 4);
+    });
+    perCall("Read 4 字节", N, w0, c0, 1);
+    ok = ok && readBytes == 4 * N;
+
+    long posSum = 0;
+    benchNsPerCall("ReadPos", N, [&](long) {
+        posSum += sts.ReadPos(3);
+    });
+    ok = ok && posSum == -0x0234L * N;
+
+    // 8 个舵机的同步写，随后的同步读应读回写入的位置
+    int16_t targets[8];
+    uint16_t speeds[8];
+    uint8_t accs[8];
+    for (int k = 0; k < 8; k++) { targets[k] = (int16_t)(k * 100 - 300); speeds[k] = 1000; accs[k] = 50; }
+    w0 = serial.writeCalls; c0 = serial.calls;
+    benchNsPerCall("SyncWritePosEx x8", N, [&](long) {
+        sts.SyncWritePosEx((u8*)kIds, 8, targets, speeds, accs);
+    });
+    perCall("SyncWritePosEx x8", N, w0, c0, 1);
+
+    sts.syncReadBegin(8, 6, 10);
+    w0 = serial.writeCalls; c0 = serial.calls;
+    long decoded = 0;
+    benchNsPerCall("同步读 8 x 6 字节 + 解码", N / 4, [&](long) {
+        sts.syncReadPacketTx((u8*)kIds, 8, SMS_STS_PRESENT_POSITION_L, 6);
+        for (int k = 0; k < 8; k++) {
+            uint8_t data[6];
+            if (sts.syncReadPacketRx(kIds[k], data) == 6) {
+                decoded += SMS_STS_Map::PresentPosition::Get<0>(data) == targets[k];
+            }
+        }
+    });
+    perCall("同步读 8 x 6 字节 + 解码", N / 4, w0, c0, 1);
+    ok = ok && decoded == 8 * (N / 4);
+
+    // 流水线周期：写入帧与同步读请求拼接后一次写出
+    uint8_t burst[192];
+    w0 = serial.writeCalls; c0 = serial.calls;
+    benchNsPerCall("拼接周期 (写 x8 + 同步读)", N / 4, [&](long) {
+        sts.txBurstBegin(burst, sizeof(burst));
+        sts.SyncWritePosEx((u8*)kIds, 8, targets, speeds, accs);
+        sts.syncReadPacketSend((u8*)kIds, 8, SMS_STS_PRESENT_POSITION_L, 6);
+        sts.txBurstEnd();
+        sts.syncReadPacketCollect();
+        uint8_t data[6];
+        for (int k = 0; k < 8; k++) sts.syncReadPacketRx(kIds[k], data);
+        benchKeep(data);
+    });
+    perCall("拼接周期 (写 x8 + 同步读)", N / 4, w0, c0, 1);
+    sts.syncReadEnd();
+
+    ok = checkBurstOrder() && ok;
+    ok = checkSyncWriteLimit() && ok;
+    ok = checkSyncReadLimit() && ok;
+    if (!ok) printf("FAIL: 传输层结果不一致\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// 舵机速度/加速度前馈的跟踪滞后：总线模型上比较固定上限（SERVO_DEFAULT_*）与
+// servoProfileLimits 逐周期计算的上限。舵机按写入的速度/加速度做梯形规划追目标，
+// 控制周期 SOLVER_PERIOD_MS，反馈为上一周期末的位置/速度。
+// 型号能力之内的目标，前馈应至少把平均滞后减半；超出能力（所需速度/加速度大于型号上限）的只报告
+#include "bench_common.h"
+#include "ServoProfile.h"
+#include "TaskSharedData.h"
+#include <math.h>
+
+static const float kPeriodS = SOLVER_PERIOD_MS * 1e-3f;
+static const float kStepS = 0.0005f;   // 舵机内部积分步长
+
+struct TrackResult {
+    float meanLag;     // 平均 |目标 - 位置| (步)
+    float maxLag;
+    int saturated;     // 需要的速度超过型号上限的周期数
+};
+
+// 目标：关节角度正弦（减速比 1），幅值 amplitude (°)，频率 freq (Hz)
+static TrackResult track(const ServoModelPolicy& policy, bool feedforward, float amplitude, float freq,
+                         float center) {
+    const float w = 2.0f * (float)M_PI * freq;
+    float pos = center, vel = 0.0f;
+    int16_t lastPulse = (int16_t)center;
+    bool primed = false;
+    TrackResult r = { 0.0f, 0.0f, 0 };
+    int samples = 0;
+
+    for (int cycle = 0; cycle * kPeriodS < 4.0f; cycle++) {
+        float t = cycle * kPeriodS;
+        int16_t pulse = (int16_t)lroundf(center + amplitude * sinf(w * t) * policy.stepsPerDeg);
+        float ffSpeed = amplitude * w * cosf(w * t) * policy.stepsPerDeg;
+        float ffAccel = -amplitude * w * w * sinf(w * t) * policy.stepsPerDeg;
+
+        uint16_t speed = SERVO_DEFAULT_SPEED;
+        uint8_t acc = SERVO_DEFAULT_ACC;
+        if (feedforward) {
+            // 与 AngleSolver::computeProfile 相同：前馈与目标变化量取绝对值大者
+            float stepSpeed = primed ? (pulse - lastPulse) / kPeriodS : 0.0f;
+            float target = (fabsf(stepSpeed) > fabsf(ffSpeed)) ? stepSpeed : ffSpeed;
+            r.saturated += servoProfileLimits(policy, target, ffAccel, pulse - pos, vel, speed, acc);
+        }
+        lastPulse = pulse;
+        primed = true;
+
+        // 舵机：没有加速度寄存器的型号按加速度不受限处理
+        float vmax = speed;
+        float amax = policy.accUnit ? (float)acc * policy.accUnit : 1e9f;
+        for (int k = 0; k < (int)lroundf(kPeriodS / kStepS); k++) {
+            float d = pulse - pos;
+            float vdes = copysignf(fminf(vmax, sqrtf(2.0f * amax * fabsf(d))), d);
+            float dv = fmaxf(-amax * kStepS, fminf(amax * kStepS, vdes - vel));
+            vel += dv;
+            pos += vel * kStepS;
+        }
+
+        if (t >= 1.0f) {   // 跳过起步过程
+            float lag = fabsf(pulse - pos);
+            r.meanLag += lag;
+            r.maxLag = fmaxf(r.maxLag, lag);
+            samples++;
+        }
+    }
+    r.meanLag /= samples;
+    return r;
+}
+
+int main() {
+    struct Case { uint8_t model; float amplitude; float freq; float center; bool feasible; };
+    static const Case kCases[] = {
+        { SERVO_MODEL_STS,   10.0f, 1.0f, 2048.0f, true },
+        { SERVO_MODEL_STS,   30.0f, 1.0f, 2048.0f, true },
+        { SERVO_MODEL_STS,   20.0f, 2.0f, 2048.0f, false },   // 峰值加速度约 35800 步/s²，超过 254 ×100
+        { SERVO_MODEL_STS,   60.0f, 1.5f, 2048.0f, false },   // 峰值速度约 6400 步/s，超过 3400
+        { SERVO_MODEL_HLS,   30.0f, 1.0f, 2048.0f, true },
+        { SERVO_MODEL_SCSCL, 30.0f, 1.0f, 512.0f,  true },
+        { SERVO_MODEL_SCSCL, 60.0f, 1.0f, 512.0f,  true },    // 超过默认速度，未超过 SCSCL 上限
+    };
+
+    bool ok = true;
+    printf("%-6s %5s %4s | %-17s | %-17s | %s\n", "型号", "幅值", "Hz", "固定 平均/最大", "前馈 平均/最大", "饱和周期");
+    for (const Case& c : kCases) {
+        const ServoModelPolicy& policy = servoModelPolicy(c.model);
+        TrackResult fixed = track(policy, false, c.amplitude, c.freq, c.center);
+        TrackResult ff = track(policy, true, c.amplitude, c.freq, c.center);
+        printf("%-6s %5.0f %4.1f | %7.1f / %7.1f | %7.1f / %7.1f | %d%s\n", policy.name, c.amplitude, c.freq,
+               fixed.meanLag, fixed.maxLag, ff.meanLag, ff.maxLag, ff.saturated,
+               c.feasible ? "" : "  (超出型号能力)");
+        if (c.feasible && ff.meanLag > fmaxf(0.5f * fixed.meanLag, 1.0f)) {
+            printf("FAIL: %s %.0f° %.1f Hz 前馈没有减小跟踪滞后\n", policy.name, c.amplitude, c.freq);
+            ok = false;
+        }
+    }
+
+    // 每周期 21 个关节的计算开销
+    const ServoModelPolicy& sts = servoModelPolicy(SERVO_MODEL_STS);
+    uint16_t speeds[ENCODER_TOTAL_NUM];
+    uint8_t accs[ENCODER_TOTAL_NUM];
+    benchNsPerCall("servoProfileLimits x21", 200000, [&](long i) {
+        for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+            servoProfileLimits(sts, (float)(i & 1023) + j, 5000.0f, (float)(j - 10), 800.0f, speeds[j], accs[j]);
+        }
+        benchKeep(speeds);
+        benchKeep(accs);
+    });
+
+    return ok ? 0 : 1;
+}
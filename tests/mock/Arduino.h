@@ -0,0 +1,78 @@
+// 主机测试用 Arduino 桩：只提供被测模块实际用到的接口
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define __NOINIT_ATTR
+#define SERIAL_8N1 0x800001c
+
+// 模拟时钟：每次读取前进 stepUs（默认 1 ms），超时等待循环在主机上很快结束；
+// 需要控制时间的测试直接设置 us 与 stepUs
+struct MockClock {
+    unsigned long us = 0;
+    unsigned long stepUs = 1000;
+};
+inline MockClock& mockClock() {
+    static MockClock clock;
+    return clock;
+}
+inline unsigned long micros() {
+    MockClock& c = mockClock();
+    unsigned long now = c.us;
+    c.us += c.stepUs;
+    return now;
+}
+inline unsigned long millis() { return micros() / 1000UL; }
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// 串口桩：写出的字节追加到 tx（设置 onWrite 时交给回调，可用来模拟舵机应答），
+// 读取从 rx 取；驱动调用次数计入 calls
+class HardwareSerial {
+public:
+    std::vector<uint8_t> tx;
+    std::vector<uint8_t> rx;
+    size_t rxPos = 0;
+    void (*onWrite)(HardwareSerial& port, const uint8_t* buf, size_t len) = nullptr;
+    unsigned long writeCalls = 0;
+    unsigned long calls = 0;
+
+    size_t write(const uint8_t* buf, size_t len) {
+        calls++;
+        writeCalls++;
+        if (onWrite) onWrite(*this, buf, len);
+        else tx.insert(tx.end(), buf, buf + len);
+        return len;
+    }
+    size_t write(uint8_t b) { return write(&b, 1); }
+    int available() { calls++; return (int)(rx.size() - rxPos); }
+    int read() { calls++; return rxPos < rx.size() ? rx[rxPos++] : -1; }
+    size_t read(uint8_t* buf, size_t len) {
+        calls++;
+        size_t n = 0;
+        while (n < len && rxPos < rx.size()) buf[n++] = rx[rxPos++];
+        return n;
+    }
+    void flush() {}
+    void begin(unsigned long /*baud*/, uint32_t /*config*/ = SERIAL_8N1, int /*rxPin*/ = -1, int /*txPin*/ = -1) {}
+
+    // 追加应答字节（之前的已读取部分丢弃）
+    void reply(const uint8_t* buf, size_t len) {
+        rx.erase(rx.begin(), rx.begin() + rxPos);
+        rxPos = 0;
+        rx.insert(rx.end(), buf, buf + len);
+    }
+};
+
+// 舵机总线串口（ESP32-P4 的 UART1 ~ UART4）
+inline HardwareSerial Serial1;
+inline HardwareSerial Serial2;
+inline HardwareSerial Serial3;
+inline HardwareSerial Serial4;
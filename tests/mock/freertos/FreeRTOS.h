@@ -0,0 +1,12 @@
+// 主机测试用 FreeRTOS 桩：只提供 TaskSharedData.h 中用到的类型，不提供任务/队列的实现
+// （任务函数中的 API 只有声明，测试以 --gc-sections 链接，未被调用的任务代码不参与链接）
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
@@ -0,0 +1,7 @@
+#pragma once
+#include "queue.h"
+
+typedef void* SemaphoreHandle_t;
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,9 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskDelayUntil(TickType_t* prevWake, TickType_t increment);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
@@ -0,0 +1,115 @@
+#ifndef SERVO_SIM_H
+#define SERVO_SIM_H
+
+// 舵机总线模拟：挂在串口桩的 onWrite 上，解析写出的每一帧（拼接发送时一次写出多帧），
+// 写指令更新各舵机的内存表，读指令立即应答；收到的帧按顺序记录在 frames 中供测试检查。
+// 只应答 online 的舵机，用来模拟掉线
+#include <Arduino.h>
+#include <map>
+#include <vector>
+#include "INST.h"
+
+#define SERVO_SIM_MEM_SIZE 128
+
+struct SimFrame {
+    uint8_t inst;
+    uint8_t addr;
+    uint8_t len;                  // 数据长度（同步读写为每个舵机的长度）
+    std::vector<uint8_t> ids;     // 单舵机指令为目标 ID，同步指令为 ID 列表
+    std::vector<uint8_t> data;    // 写入的数据（同步写按 ID 顺序拼接）
+};
+
+struct ServoSim {
+    uint8_t mem[256][SERVO_SIM_MEM_SIZE];
+    bool online[256];
+    std::vector<SimFrame> frames;
+
+    ServoSim() {
+        memset(mem, 0, sizeof(mem));
+        for (int i = 0; i < 256; i++) online[i] = true;
+    }
+
+    void attach(HardwareSerial& port) {
+        registry()[&port] = this;
+        port.onWrite = onWrite;
+    }
+
+    // 指定指令的帧数
+    size_t count(uint8_t inst) const {
+        size_t n = 0;
+        for (const SimFrame& f : frames) n += f.inst == inst;
+        return n;
+    }
+
+private:
+    static std::map<HardwareSerial*, ServoSim*>& registry() {
+        static std::map<HardwareSerial*, ServoSim*> sims;
+        return sims;
+    }
+
+    static void status(std::vector<uint8_t>& out, uint8_t id, const uint8_t* data, uint8_t len) {
+        uint8_t sum = id + (len + 2);
+        out.push_back(0xff); out.push_back(0xff); out.push_back(id); out.push_back(len + 2); out.push_back(0);
+        for (uint8_t i = 0; i < len; i++) { out.push_back(data[i]); sum += data[i]; }
+        out.push_back((uint8_t)~sum);
+    }
+
+    static void onWrite(HardwareSerial& port, const uint8_t* buf, size_t len) {
+        ServoSim& sim = *registry()[&port];
+        std::vector<uint8_t> reply;
+        size_t pos = 0;
+        while (pos + 5 < len && buf[pos] == 0xff && buf[pos + 1] == 0xff) {
+            const uint8_t id = buf[pos + 2];
+            const uint8_t msgLen = buf[pos + 3];
+            const uint8_t inst = buf[pos + 4];
+            const uint8_t* p = buf + pos + 5;
+            SimFrame f = { inst, 0, 0, {}, {} };
+            switch (inst) {
+            case INST_WRITE:
+            case INST_REG_WRITE:
+                f.addr = p[0];
+                f.len = msgLen - 3;
+                f.ids.push_back(id);
+                f.data.assign(p + 1, p + 1 + f.len);
+                if (sim.online[id]) {
+                    memcpy(&sim.mem[id][f.addr], p + 1, f.len);
+                    if (id != 0xfe) status(reply, id, nullptr, 0);
+                }
+                break;
+            case INST_READ:
+                f.addr = p[0];
+                f.len = p[1];
+                f.ids.push_back(id);
+                if (sim.online[id]) status(reply, id, &sim.mem[id][f.addr], f.len);
+                break;
+            case INST_SYNC_WRITE:
+                f.addr = p[0];
+                f.len = p[1];
+                for (uint8_t k = 0; k < (msgLen - 4) / (f.len + 1); k++) {
+                    const uint8_t* entry = p + 2 + k * (f.len + 1);
+                    f.ids.push_back(entry[0]);
+                    f.data.insert(f.data.end(), entry + 1, entry + 1 + f.len);
+                    if (sim.online[entry[0]]) memcpy(&sim.mem[entry[0]][f.addr], entry + 1, f.len);
+                }
+                break;
+            case INST_SYNC_READ:
+                f.addr = p[0];
+                f.len = p[1];
+                for (uint8_t k = 0; k < msgLen - 4; k++) {
+                    uint8_t target = p[2 + k];
+                    f.ids.push_back(target);
+                    if (sim.online[target]) status(reply, target, &sim.mem[target][f.addr], f.len);
+                }
+                break;
+            default:
+                f.ids.push_back(id);
+                break;
+            }
+            sim.frames.push_back(f);
+            pos += 4 + msgLen;
+        }
+        port.reply(reply.data(), reply.size());
+    }
+};
+
+#endif // SERVO_SIM_H
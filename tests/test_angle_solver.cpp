@@ -0,0 +1,102 @@
+// AngleSolver 零位：内环输出脉冲以标定零位为基准，舵机反馈按零位换算为角度，
+// 柔顺误差在同一基准上计算
+#include "test_common.h"
+#include "AngleSolver.h"
+#include <math.h>
+
+static bool near(float a, float b) { return fabsf(a - b) < 1e-3f; }
+
+// 与 SystemTask.cpp 相同的 PID 参数
+static void setup(AngleSolver& s, int16_t zero) {
+    int16_t zeros[JOINT_COUNT];
+    float ratios[JOINT_COUNT];
+    int8_t dirs[JOINT_COUNT];
+    for (int i = 0; i < JOINT_COUNT; i++) {
+        zeros[i] = zero + i;
+        ratios[i] = 1.0f;
+        dirs[i] = 1;
+    }
+    s.init(zeros, ratios, dirs);
+    float pid[2][PID_PARAMETER_NUM] = {
+        {20.0f, 0, 0, 0, 0, 3000.0f},
+        {5.0f, 0, 0, 0, 0, 30719.0f},
+    };
+    s.setPIDParams(pid);
+}
+
+/* ==================== 内环输出 ==================== */
+
+static void testZeroOffsetShiftsCommandedPulse() {
+    AngleSolver a, b;
+    setup(a, 0);
+    setup(b, 2048);
+
+    float corrections[JOINT_COUNT];
+    float servoDegs[JOINT_COUNT];
+    for (int i = 0; i < JOINT_COUNT; i++) {
+        corrections[i] = 1.5f * (i - 10);
+        servoDegs[i] = 3.0f * i;
+    }
+    int16_t pa[JOINT_COUNT], pb[JOINT_COUNT];
+    a.computeInner(corrections, servoDegs, pa);
+    b.computeInner(corrections, servoDegs, pb);
+    for (int i = 0; i < JOINT_COUNT; i++) {
+        CHECK_EQ(pa[i], i + (int)(5.0f * corrections[i]));
+        CHECK_EQ(pb[i] - pa[i], 2048);
+    }
+}
+
+static void testCommandedPulseStaysInPositionRange() {
+    AngleSolver s;
+    setup(s, 30000);
+    float corrections[JOINT_COUNT];
+    float servoDegs[JOINT_COUNT] = {0};
+    for (int i = 0; i < JOINT_COUNT; i++) corrections[i] = 3000.0f;
+    int16_t pulses[JOINT_COUNT];
+    s.computeInner(corrections, servoDegs, pulses);
+    for (int i = 0; i < JOINT_COUNT; i++) CHECK_EQ(pulses[i], 30719);
+
+    setup(s, -30000);
+    for (int i = 0; i < JOINT_COUNT; i++) corrections[i] = -3000.0f;
+    s.computeInner(corrections, servoDegs, pulses);
+    for (int i = 0; i < JOINT_COUNT; i++) CHECK_EQ(pulses[i], -30719);
+}
+
+/* ==================== 反馈换算 ==================== */
+
+static void testServoDegreesRelativeToZero() {
+    AngleSolver s;
+    setup(s, 1000);
+    for (int i = 0; i < JOINT_COUNT; i++) {
+        float spd = servoModelPolicy(kJointMap[i].model).stepsPerDeg;
+        int32_t zero = 1000 + i;
+        CHECK(near(s.servoDegrees(i, zero), 0.0f));
+        CHECK(near(s.servoDegrees(i, zero + (int32_t)lroundf(90.0f * spd)), 90.0f));
+        CHECK(near(s.servoDegrees(i, zero - (int32_t)lroundf(45.0f * spd)), -45.0f));
+    }
+}
+
+// 舵机停在零位、目标也是零位：柔顺误差为 0，不因零位产生力矩
+static void testComplianceErrorUsesSameBasis() {
+    AngleSolver s;
+    setup(s, 2048);
+    int16_t pulses[JOINT_COUNT];
+    float velocity[JOINT_COUNT] = {0};
+    float servoDegs[JOINT_COUNT];
+    float speeds[JOINT_COUNT] = {0};
+    for (int i = 0; i < JOINT_COUNT; i++) {
+        pulses[i] = 2048 + i;
+        servoDegs[i] = s.servoDegrees(i, pulses[i]);
+    }
+    int16_t torques[JOINT_COUNT];
+    CHECK_EQ(s.computeCompliance(pulses, velocity, servoDegs, speeds, torques), 0);
+    for (int i = 0; i < JOINT_COUNT; i++) CHECK_EQ(torques[i], 0);
+}
+
+int main() {
+    RUN_TEST(testZeroOffsetShiftsCommandedPulse);
+    RUN_TEST(testCommandedPulseStaysInPositionRange);
+    RUN_TEST(testServoDegreesRelativeToZero);
+    RUN_TEST(testComplianceErrorUsesSameBasis);
+    return TEST_RESULT();
+}
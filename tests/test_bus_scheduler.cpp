@@ -0,0 +1,111 @@
+// BusScheduler 缓存刷新的预算：只在 “当前时间 + 最坏耗时” 不越过本周期截止时间时启动，
+// 否则记为推迟；按刷新间隔每次一条总线，依次轮询
+#include "test_common.h"
+#include "servo_sim.h"
+#include "BusScheduler.h"
+
+static const uint32_t PERIOD_US = SOLVER_PERIOD_MS * 1000;
+// 缓存刷新的最坏耗时：一次同步读等满应答超时（millis 粒度再加 1ms）
+static const uint32_t REFRESH_WORST_US = (SERVO_TX_TIMEOUT_MS + 1) * 1000;
+static const uint32_t DEADLINE_US = PERIOD_US - BUS_SCHED_GUARD_US;
+
+static const uint8_t kIds[2] = { 1, 2 };
+
+static ServoSim s_sims[NUM_BUSES];
+static ServoBusManager s_buses[NUM_BUSES];
+static ServoBusManager* const s_busPtrs[NUM_BUSES] = { &s_buses[0], &s_buses[1], &s_buses[2], &s_buses[3] };
+static HardwareSerial* const s_ports[NUM_BUSES] = { &Serial1, &Serial2, &Serial3, &Serial4 };
+
+static void setup() {
+    for (uint8_t b = 0; b < NUM_BUSES; b++) {
+        s_sims[b].attach(*s_ports[b]);
+        s_buses[b].begin(b, -1, -1, kIds, 2, 1000000);
+        s_sims[b].frames.clear();
+    }
+}
+
+static size_t refreshFrames(uint8_t bus) {
+    return s_sims[bus].count(INST_SYNC_READ);
+}
+
+// 把时钟设到本周期起点之后 offsetUs（时钟每次读取只前进 1us）
+static void at(uint32_t cycleStartUs, uint32_t offsetUs) {
+    mockClock().us = cycleStartUs + offsetUs;
+}
+
+static void testRefreshRunsOnlyWithinBudget() {
+    BusScheduler sched(s_busPtrs, NUM_BUSES, PERIOD_US);
+    const BusTxStats& st = sched.stats(BUS_TX_REFRESH);
+
+    // 刚好放得下：启动，刷新 0 号总线
+    uint32_t t = 1000000;
+    at(t, 0);
+    sched.beginCycle();
+    at(t, DEADLINE_US - REFRESH_WORST_US - 100);
+    sched.runBackground();
+    CHECK_EQ(st.count, 1);
+    CHECK_EQ(st.deferred, 0);
+    CHECK_EQ(refreshFrames(0), 1);
+
+    // 下一次刷新到期，但剩余时间不够最坏耗时：推迟，不发帧
+    t += BUS_SCHED_REFRESH_PERIOD_MS * 1000;
+    at(t, 0);
+    sched.beginCycle();
+    at(t, DEADLINE_US - REFRESH_WORST_US + 100);
+    sched.runBackground();
+    CHECK_EQ(st.count, 1);
+    CHECK_EQ(st.deferred, 1);
+    CHECK_EQ(refreshFrames(1), 0);
+
+    // 下一周期时间充足：执行被推迟的刷新（1 号总线）
+    t += PERIOD_US;
+    at(t, 0);
+    sched.beginCycle();
+    sched.runBackground();
+    CHECK_EQ(st.count, 2);
+    CHECK_EQ(refreshFrames(1), 1);
+
+    // 实测耗时远小于估计后，预算仍按应答超时计算（舵机掉线时同步读要等满超时）
+    for (int i = 0; i < 20; i++) {
+        t += BUS_SCHED_REFRESH_PERIOD_MS * 1000;
+        at(t, 0);
+        sched.beginCycle();
+        sched.runBackground();
+    }
+    uint32_t done = st.count;
+    t += BUS_SCHED_REFRESH_PERIOD_MS * 1000;
+    at(t, 0);
+    sched.beginCycle();
+    at(t, DEADLINE_US - REFRESH_WORST_US + 100);
+    sched.runBackground();
+    CHECK_EQ(st.count, done);
+    CHECK_EQ(st.deferred, 2);
+}
+
+static void testRefreshIntervalAndRoundRobin() {
+    BusScheduler sched(s_busPtrs, NUM_BUSES, PERIOD_US);
+    const BusTxStats& st = sched.stats(BUS_TX_REFRESH);
+    size_t before[NUM_BUSES];
+    for (uint8_t b = 0; b < NUM_BUSES; b++) before[b] = refreshFrames(b);
+
+    // 每个周期都有时间，但刷新间隔未到时不执行
+    uint32_t t = 50000000;
+    uint32_t cycles = BUS_SCHED_REFRESH_PERIOD_MS * 1000 / PERIOD_US;
+    for (uint32_t c = 0; c < 4 * cycles; c++) {
+        at(t, 0);
+        sched.beginCycle();
+        sched.runBackground();
+        t += PERIOD_US;
+    }
+    CHECK_EQ(st.count, 4);
+    CHECK_EQ(st.deferred, 0);
+    for (uint8_t b = 0; b < NUM_BUSES; b++) CHECK_EQ(refreshFrames(b) - before[b], 1);
+}
+
+int main() {
+    mockClock().stepUs = 1;
+    setup();
+    RUN_TEST(testRefreshRunsOnlyWithinBudget);
+    RUN_TEST(testRefreshIntervalAndRoundRobin);
+    return TEST_RESULT();
+}
@@ -0,0 +1,182 @@
+// CalibrationStore 镜像格式：CRC32、Seal/Validate 与记录操作
+#include "test_common.h"
+#include "CalibrationStore.h"
+#include <string.h>
+
+static void testCrc32KnownVector() {
+    // CRC-32 (IEEE 802.3) 标准校验值
+    const char* msg = "123456789";
+    CHECK_EQ(CalibrationStore::Crc32((const uint8_t*)msg, 9), 0xCBF43926u);
+    CHECK_EQ(CalibrationStore::Crc32((const uint8_t*)msg, 0), 0u);
+}
+
+static void testClearedImageIsValid() {
+    // 新建的存储镜像格式有效，但在 Load/Clear 之前不代表已有标定
+    CalibrationStore store;
+    CHECK(!store.IsValid());
+    CHECK(CalibrationStore::Validate(store.Image()));
+    store.Clear();
+    CHECK(store.IsValid());
+    CHECK_EQ(store.Image().magic, CALIB_STORE_MAGIC);
+    CHECK_EQ(store.Image().version, CALIB_STORE_VERSION);
+    CHECK_EQ(store.Image().size, sizeof(CalibStoreImage));
+}
+
+static void testEveryByteIsCovered() {
+    // 翻转 crc 之前的任意一位都必须校验失败
+    CalibrationStore store;
+    store.SetBusServos(1, (const uint8_t*)"\x01\x02\x03", 3);
+    CalibrationStore::Seal(store.Image());
+    CHECK(CalibrationStore::Validate(store.Image()));
+
+    const size_t covered = offsetof(CalibStoreImage, crc);
+    int undetected = 0;
+    for (size_t i = 0; i < covered; i++) {
+        CalibStoreImage copy = store.Image();
+        ((uint8_t*)&copy)[i] ^= 0x10;
+        if (CalibrationStore::Validate(copy)) undetected++;
+    }
+    CHECK_EQ(undetected, 0);
+
+    CalibStoreImage badCrc = store.Image();
+    badCrc.crc ^= 1;
+    CHECK(!CalibrationStore::Validate(badCrc));
+}
+
+static void testHeaderChecks() {
+    // 头部字段错误时即使 CRC 正确也拒绝（防止旧版本/其他结构体误读）
+    CalibrationStore store;
+    CalibStoreImage img = store.Image();
+
+    img.magic = 0x12345678;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+
+    img = store.Image();
+    img.version = CALIB_STORE_VERSION + 1;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+
+    img = store.Image();
+    img.size = sizeof(CalibStoreImage) - 4;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+}
+
+static void testFieldRangeChecks() {
+    CalibrationStore store;
+
+    // 舵机数超过容量
+    CalibStoreImage img = store.Image();
+    img.buses[0].count = CALIB_MAX_SERVOS_PER_BUS + 1;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+
+    // 广播/非法 ID
+    img = store.Image();
+    img.buses[2].count = 1;
+    img.buses[2].servos[0].id = 0xFE;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+
+    // 同一总线重复 ID
+    img = store.Image();
+    img.buses[3].count = 2;
+    img.buses[3].servos[0].id = 5;
+    img.buses[3].servos[1].id = 5;
+    CalibrationStore::Seal(img);
+    CHECK(!CalibrationStore::Validate(img));
+
+    // 不同总线可以使用相同 ID
+    img = store.Image();
+    img.buses[0].count = 1;
+    img.buses[0].servos[0].id = 5;
+    img.buses[1].count = 1;
+    img.buses[1].servos[0].id = 5;
+    CalibrationStore::Seal(img);
+    CHECK(CalibrationStore::Validate(img));
+}
+
+static void testSetBusServosKeepsCalibration() {
+    CalibrationStore store;
+    const uint8_t ids[] = { 1, 2, 3, 4 };
+    CHECK(store.SetBusServos(0, ids, 4));
+
+    CalibServoRecord* rec = store.FindServo(0, 3);
+    CHECK(rec != nullptr);
+    CHECK_EQ(rec->zeroOffset, 2048);
+    rec->zeroOffset = 1234;
+    rec->limitPos = 3500;
+    rec->flags = CalibServoRecord::FLAG_MULTI_TURN | CalibServoRecord::FLAG_LIMIT;
+
+    // 拓扑变化：已有舵机保留标定值，新舵机使用默认值，移除的舵机丢弃
+    const uint8_t ids2[] = { 3, 7, 1 };
+    CHECK(store.SetBusServos(0, ids2, 3));
+    CHECK_EQ(store.Bus(0)->count, 3);
+    rec = store.FindServo(0, 3);
+    CHECK(rec != nullptr);
+    CHECK_EQ(rec->zeroOffset, 1234);
+    CHECK_EQ(rec->limitPos, 3500);
+    CHECK_EQ(store.FindServo(0, 7)->zeroOffset, 2048);
+    CHECK(store.FindServo(0, 2) == nullptr);
+
+    uint8_t tooMany[CALIB_MAX_SERVOS_PER_BUS + 1] = {};
+    CHECK(!store.SetBusServos(0, tooMany, CALIB_MAX_SERVOS_PER_BUS + 1));
+    CHECK(!store.SetBusServos(CALIB_MAX_BUSES, ids, 4));
+}
+
+static void testEnsureServoCapacity() {
+    CalibrationStore store;
+    for (uint8_t id = 0; id < CALIB_MAX_SERVOS_PER_BUS; id++) {
+        CHECK(store.EnsureServo(1, id) != nullptr);
+    }
+    // 已有记录直接返回，总线已满时新增失败
+    CHECK(store.EnsureServo(1, 0) == store.FindServo(1, 0));
+    CHECK(store.EnsureServo(1, 100) == nullptr);
+    CHECK(store.EnsureServo(CALIB_MAX_BUSES, 1) == nullptr);
+}
+
+static void testMatchesTopology() {
+    CalibrationStore store;
+    const uint8_t ids[] = { 1, 2, 3 };
+    const uint8_t shuffled[] = { 3, 1, 2 };
+    const uint8_t other[] = { 1, 2, 4 };
+    store.SetBusServos(2, ids, 3);
+    CHECK(store.Save());
+
+    CHECK(store.MatchesTopology(2, shuffled, 3));   // 与顺序无关
+    CHECK(!store.MatchesTopology(2, other, 3));
+    CHECK(!store.MatchesTopology(2, ids, 2));
+    CHECK(!store.MatchesTopology(1, ids, 3));
+}
+
+static void testSaveLoadRoundTrip() {
+    CalibrationStore store;
+    CalibServoRecord* rec = store.EnsureServo(3, 6);
+    rec->zeroOffset = -1500;
+    rec->turns = -2;
+    rec->lastRaw = 4000;
+    rec->flags = CalibServoRecord::FLAG_TURNS;
+    store.Bus(3)->baud = 1000000;
+    CHECK(store.Save());
+    CHECK(store.Load());
+    CHECK_EQ(store.FindServo(3, 6)->zeroOffset, -1500);
+
+    // 镜像被破坏后 Load 失败
+    store.Image().buses[3].servos[0].zeroOffset = 0;
+    CHECK(!store.Load());
+    CHECK(!store.IsValid());
+}
+
+int main() {
+    RUN_TEST(testCrc32KnownVector);
+    RUN_TEST(testClearedImageIsValid);
+    RUN_TEST(testEveryByteIsCovered);
+    RUN_TEST(testHeaderChecks);
+    RUN_TEST(testFieldRangeChecks);
+    RUN_TEST(testSetBusServosKeepsCalibration);
+    RUN_TEST(testEnsureServoCapacity);
+    RUN_TEST(testMatchesTopology);
+    RUN_TEST(testSaveLoadRoundTrip);
+    return TEST_RESULT();
+}
@@ -0,0 +1,33 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+// 极简断言宏：失败时打印位置并计数，main() 返回 TEST_RESULT()
+#include <stdio.h>
+
+static int g_testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        g_testFailures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _va = (long long)(a), _vb = (long long)(b); \
+    if (_va != _vb) { \
+        printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+               __FILE__, __LINE__, #a, #b, _va, _vb); \
+        g_testFailures++; \
+    } \
+} while (0)
+
+#define RUN_TEST(fn) do { \
+    int _before = g_testFailures; \
+    fn(); \
+    printf("[%s] %s\n", g_testFailures == _before ? " OK " : "FAIL", #fn); \
+} while (0)
+
+#define TEST_RESULT() (g_testFailures == 0 ? 0 : 1)
+
+#endif // TEST_COMMON_H
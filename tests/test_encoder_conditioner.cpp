@@ -0,0 +1,205 @@
+// EncoderConditioner：有效性、毛刺剔除与重新锁定、跨圈展开、中值滤波、通道相互独立
+#include "test_common.h"
+#include "EncoderConditioner.h"
+#include <math.h>
+
+static const float DEG_PER_COUNT = 360.0f / ENC_COUNTS_PER_REV;
+
+// 全部通道同一读数的一帧；需要时逐通道改写
+struct Frame {
+    uint16_t raw[ENCODER_TOTAL_NUM];
+    uint8_t  flags[ENCODER_TOTAL_NUM];
+    float    out[ENCODER_TOTAL_NUM];
+
+    explicit Frame(uint16_t v = 0) { fill(v); }
+    void fill(uint16_t v) {
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) { raw[i] = v; flags[i] = 0; }
+    }
+    uint32_t feed(EncoderConditioner& c) { return c.process(raw, flags, out); }
+};
+
+static bool near(float a, float b) { return fabsf(a - b) < 1e-3f; }
+
+/* ==================== 有效性 ==================== */
+
+static void testFirstReadingPrimes() {
+    // 首个有效读数直接作为输出，不经过低通爬升
+    EncoderConditioner c;
+    Frame f(4096);
+    CHECK_EQ(f.feed(c), ENC_VALID_ALL);
+    CHECK(near(f.out[0], 90.0f));
+    CHECK(near(f.out[ENCODER_TOTAL_NUM - 1], 90.0f));
+    CHECK_EQ(c.stats().invalidMask, 0);
+}
+
+static void testInvalidReadingsHoldOutput() {
+    EncoderConditioner c;
+    Frame f(1000);
+    f.feed(c);
+
+    // 0xFFFF、0x3FFF、超出 14 位、errorFlags 置位：通道本帧无效，输出保持
+    f.raw[0] = 0xFFFF;
+    f.raw[1] = 0x3FFF;
+    f.raw[2] = ENC_COUNTS_PER_REV;
+    f.flags[3] = 1;
+    uint32_t valid = f.feed(c);
+    CHECK_EQ(valid, ENC_VALID_ALL & ~0xFUL);
+    CHECK_EQ(c.stats().invalidMask, 0xF);
+    CHECK_EQ(c.stats().invalid, 4);
+    for (int i = 0; i < 4; i++) CHECK(near(f.out[i], 1000 * DEG_PER_COUNT));
+
+    // 从未有过有效读数的通道输出为 0
+    EncoderConditioner fresh;
+    Frame bad(0xFFFF);
+    CHECK_EQ(bad.feed(fresh), 0);
+    CHECK(near(bad.out[0], 0.0f));
+    CHECK_EQ(fresh.stats().invalidMask, ENC_VALID_ALL);
+}
+
+/* ==================== 跨圈展开 ==================== */
+
+static void testUnwrapAcrossZero() {
+    // 正向经过 16383 -> 0：输出连续不减（中值延迟一帧），超过 360°
+    EncoderConditioner c;
+    Frame f;
+    int32_t truth = ENC_COUNTS_PER_REV - 1000;
+    float last = -1e9f;
+    for (int k = 0; k < 40; k++, truth += 200) {
+        f.fill((uint16_t)(truth & (ENC_COUNTS_PER_REV - 1)));
+        CHECK_EQ(f.feed(c), ENC_VALID_ALL);
+        CHECK(f.out[0] >= last);
+        last = f.out[0];
+    }
+    CHECK(last > 360.0f);
+    CHECK_EQ(c.stats().glitches, 0);
+
+    // 反向经过 0 -> 16383：输出为负角度
+    EncoderConditioner back;
+    truth = 1000;
+    for (int k = 0; k < 40; k++, truth -= 200) {
+        f.fill((uint16_t)(truth & (ENC_COUNTS_PER_REV - 1)));
+        back.process(f.raw, f.flags, f.out);
+    }
+    CHECK(f.out[0] < 0.0f);
+    CHECK(f.out[0] > -360.0f);
+}
+
+/* ==================== 毛刺 ==================== */
+
+static void testSingleSpikeRejected() {
+    EncoderConditioner c;
+    Frame f(2000);
+    f.feed(c);
+
+    f.raw[5] = 2000 + ENC_GLITCH_MAX_STEP + 1;
+    uint32_t valid = f.feed(c);
+    CHECK_EQ(valid, ENC_VALID_ALL & ~(1UL << 5));
+    CHECK_EQ(c.stats().glitches, 1);
+    CHECK(near(f.out[5], 2000 * DEG_PER_COUNT));
+    // 毛刺不计为无效读数，但本帧同样不在有效掩码中
+    CHECK_EQ(c.stats().invalid, 0);
+    CHECK_EQ(c.stats().invalidMask, 1UL << 5);
+
+    // 恢复正常读数后立即接受，且毛刺没有进入滤波器
+    f.raw[5] = 2000;
+    CHECK_EQ(f.feed(c), ENC_VALID_ALL);
+    CHECK(near(f.out[5], 2000 * DEG_PER_COUNT));
+
+    // 跨圈方向的毛刺按最短路径判断
+    Frame w(100);
+    EncoderConditioner cw;
+    w.feed(cw);
+    w.raw[0] = ENC_COUNTS_PER_REV - 100;      // 相差 200，不是毛刺
+    w.raw[1] = ENC_COUNTS_PER_REV - 2000;     // 相差 2100，是毛刺
+    CHECK_EQ(w.feed(cw) & 3, 1);
+    w.raw[1] = 100;
+    for (int k = 0; k < 30; k++) w.feed(cw);
+    CHECK(near(w.out[0], -100 * DEG_PER_COUNT));   // 展开为 -100，而不是 +16284
+    CHECK(near(w.out[1], 100 * DEG_PER_COUNT));
+}
+
+static void testRelockAfterConsistentJump() {
+    // 位置确实跳变（掌部板重新上电）：连续 ENC_GLITCH_RELOCK 个一致读数后重新锁定，输出从新位置开始
+    EncoderConditioner c;
+    Frame f(1000);
+    f.feed(c);
+
+    f.raw[0] = 9000;
+    for (int k = 1; k < ENC_GLITCH_RELOCK; k++) {
+        CHECK_EQ(f.feed(c) & 1, 0);
+        CHECK(near(f.out[0], 1000 * DEG_PER_COUNT));
+    }
+    f.raw[0] = 9010;   // 相互一致即可，不要求完全相同
+    CHECK_EQ(f.feed(c) & 1, 1);
+    CHECK_EQ(c.stats().relocks, 1);
+    CHECK_EQ(c.stats().glitches, ENC_GLITCH_RELOCK - 1);
+    // 新位置按最短路径展开：9010 - 1000 = 8010，在半圈以内
+    CHECK(near(f.out[0], 9010 * DEG_PER_COUNT));
+}
+
+static void testInconsistentGlitchesNeverRelock() {
+    // 互不一致的毛刺（例如随机噪声）不会累计成重新锁定
+    EncoderConditioner c;
+    Frame f(1000);
+    f.feed(c);
+    for (int k = 0; k < 20; k++) {
+        f.raw[0] = (k & 1) ? 6000 : 12000;
+        CHECK_EQ(f.feed(c) & 1, 0);
+    }
+    CHECK_EQ(c.stats().relocks, 0);
+    CHECK_EQ(c.stats().glitches, 20);
+    CHECK(near(f.out[0], 1000 * DEG_PER_COUNT));
+
+    // 中间夹一个正常读数时重新计数
+    Frame g(1000);
+    EncoderConditioner c2;
+    g.feed(c2);
+    for (int k = 0; k < 3 * ENC_GLITCH_RELOCK; k++) {
+        g.raw[0] = (k % ENC_GLITCH_RELOCK == ENC_GLITCH_RELOCK - 1) ? 1000 : 9000;
+        g.feed(c2);
+    }
+    CHECK_EQ(c2.stats().relocks, 0);
+}
+
+/* ==================== 滤波 ==================== */
+
+static void testMedianRemovesSmallOutlier() {
+    // 未超过毛刺阈值的单点离群由三点中值去掉，输出不受影响
+    EncoderConditioner c;
+    Frame f(3000);
+    for (int k = 0; k < 4; k++) f.feed(c);
+    f.raw[0] = 3000 + ENC_GLITCH_MAX_STEP / 2;
+    CHECK_EQ(f.feed(c) & 1, 1);
+    CHECK(near(f.out[0], 3000 * DEG_PER_COUNT));
+    f.raw[0] = 3000;
+    f.feed(c);
+    CHECK(near(f.out[0], 3000 * DEG_PER_COUNT));
+    CHECK_EQ(c.stats().glitches, 0);
+}
+
+static void testStepSettles() {
+    // 阈值以内的阶跃：中值延迟一帧，随后按 ENC_IIR_ALPHA 收敛
+    EncoderConditioner c;
+    Frame f(3000);
+    for (int k = 0; k < 4; k++) f.feed(c);
+    f.fill(3500);
+    float prev = 3000 * DEG_PER_COUNT;
+    for (int k = 0; k < 30; k++) {
+        f.feed(c);
+        CHECK(f.out[0] >= prev - 1e-4f);
+        prev = f.out[0];
+    }
+    CHECK(near(f.out[0], 3500 * DEG_PER_COUNT));
+}
+
+int main() {
+    RUN_TEST(testFirstReadingPrimes);
+    RUN_TEST(testInvalidReadingsHoldOutput);
+    RUN_TEST(testUnwrapAcrossZero);
+    RUN_TEST(testSingleSpikeRejected);
+    RUN_TEST(testRelockAfterConsistentJump);
+    RUN_TEST(testInconsistentGlitchesNeverRelock);
+    RUN_TEST(testMedianRemovesSmallOutlier);
+    RUN_TEST(testStepSettles);
+    return TEST_RESULT();
+}
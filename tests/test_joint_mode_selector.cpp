@@ -0,0 +1,243 @@
+// JointModeSelector 故障注入：磁编失效/恢复、样本过期、舵机快照缺失或离线，
+// 以及随机故障序列下的不变量（健康关节不受影响、模式互斥、只有可估计的关节进入 SERVO_ONLY）
+#include "test_common.h"
+#include "JointModeSelector.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t ALL = ENC_VALID_ALL;
+
+static uint32_t bit(int i) { return 1UL << i; }
+static bool near(float a, float b) { return fabsf(a - b) < 1e-4f; }
+
+// 每关节磁编角度 10 + i，舵机角度 100 + i，舵机全部在线
+struct Rig {
+    JointModeSelector sel;
+    ServoAngleSnapshot_t servo;
+    float mag[ENCODER_TOTAL_NUM];
+
+    Rig() {
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) servo.degs[i] = 100.0f + i;
+        servo.onlineMask = ALL;
+        servo.timeMs = 0;
+        resetMag();
+    }
+    void resetMag() {
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) mag[i] = 10.0f + i;
+    }
+    void update(uint32_t valid, bool fresh = true, bool withServo = true) {
+        sel.update(valid, fresh, withServo ? &servo : nullptr, mag);
+    }
+    uint32_t full() const { return ALL & ~(sel.servoOnlyMask() | sel.holdMask()); }
+};
+
+/* ==================== 启动 ==================== */
+
+static void testBootHoldsUntilFirstValidFrame() {
+    Rig r;
+    CHECK_EQ(r.sel.holdMask(), ALL);
+    CHECK(!r.sel.healthy(ALL, true));
+
+    // 从未有过有效磁编：即使舵机在线也不能估计
+    r.update(0);
+    CHECK_EQ(r.sel.holdMask(), ALL);
+    CHECK_EQ(r.sel.servoOnlyMask(), 0);
+
+    r.update(ALL);
+    CHECK_EQ(r.full(), ALL);
+    CHECK(r.sel.healthy(ALL, true));
+    CHECK(!r.sel.healthy(ALL, false));
+    CHECK(!r.sel.healthy(ALL & ~bit(4), true));
+}
+
+static void testNeverPrimedJointStaysInHold() {
+    // 关节 6 的磁编从上电起就无效：舵机在线也只能 HOLD，其他关节正常
+    Rig r;
+    r.update(ALL & ~bit(6));
+    r.update(ALL & ~bit(6));
+    CHECK_EQ(r.sel.holdMask(), bit(6));
+    CHECK_EQ(r.sel.servoOnlyMask(), 0);
+    CHECK(near(r.mag[6], 16.0f));
+}
+
+/* ==================== 单关节故障 ==================== */
+
+static void testFaultWithoutSnapshotHolds() {
+    Rig r;
+    r.update(ALL);
+
+    // 刚失效、还没有舵机快照：HOLD；其他关节的磁编角度原样保留
+    r.update(ALL & ~bit(3), true, false);
+    CHECK_EQ(r.sel.holdMask(), bit(3));
+    CHECK_EQ(r.sel.servoOnlyMask(), 0);
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) CHECK(near(r.mag[i], 10.0f + i));
+}
+
+static void testServoOnlyTracksServoWithRecordedOffset() {
+    Rig r;
+    r.update(ALL);
+    r.update(ALL & ~bit(3), true, false);
+
+    // 快照到达：SERVO_ONLY，估计值 = 舵机角度 + 进入时的 (磁编 - 舵机)
+    r.update(ALL & ~bit(3));
+    CHECK_EQ(r.sel.servoOnlyMask(), bit(3));
+    CHECK_EQ(r.sel.holdMask(), 0);
+    CHECK(near(r.mag[3], 13.0f));
+
+    // 舵机转动 7°：估计值跟随，偏差不重新记录
+    r.servo.degs[3] += 7.0f;
+    r.resetMag();
+    r.update(ALL & ~bit(3));
+    CHECK(near(r.mag[3], 20.0f));
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        if (i != 3) CHECK(near(r.mag[i], 10.0f + i));
+    }
+    CHECK(!r.sel.healthy(ALL, true));   // 有降级关节时不走快速路径
+}
+
+static void testServoOfflineFallsBackToHold() {
+    Rig r;
+    r.update(ALL);
+    r.update(ALL & ~bit(8));
+    CHECK_EQ(r.sel.servoOnlyMask(), bit(8));
+
+    // 降级关节的舵机离线：无法估计，HOLD
+    r.servo.onlineMask = ALL & ~bit(8);
+    r.update(ALL & ~bit(8));
+    CHECK_EQ(r.sel.servoOnlyMask(), 0);
+    CHECK_EQ(r.sel.holdMask(), bit(8));
+
+    // 舵机离线但磁编有效的关节不受影响
+    r.servo.onlineMask = ALL & ~bit(9);
+    r.update(ALL & ~bit(8));
+    CHECK_EQ(r.sel.servoOnlyMask(), bit(8));
+    CHECK(r.full() & bit(9));
+}
+
+static void testRecoveryAndReentryRecordsFreshOffset() {
+    Rig r;
+    r.update(ALL);
+    r.update(ALL & ~bit(2));
+    CHECK_EQ(r.sel.servoOnlyMask(), bit(2));
+
+    // 磁编恢复：直接回到 FULL，磁编角度不再被替换
+    r.mag[2] = 40.0f;
+    r.update(ALL);
+    CHECK_EQ(r.full(), ALL);
+    CHECK(near(r.mag[2], 40.0f));
+    CHECK(r.sel.healthy(ALL, true));
+
+    // 再次失效：按新的 (磁编 - 舵机) 记录偏差
+    r.servo.degs[2] = 50.0f;
+    r.update(ALL & ~bit(2));
+    CHECK(near(r.mag[2], 40.0f));
+    r.servo.degs[2] = 55.0f;
+    r.update(ALL & ~bit(2));
+    CHECK(near(r.mag[2], 45.0f));
+}
+
+/* ==================== 整帧故障 ==================== */
+
+static void testStaleSampleDegradesAllJoints() {
+    Rig r;
+    r.update(ALL);
+
+    // 样本过期：有效掩码不可信，全部关节降级；舵机离线的关节 HOLD
+    r.servo.onlineMask = ALL & ~bit(0);
+    r.update(ALL, false);
+    CHECK_EQ(r.sel.servoOnlyMask(), ALL & ~bit(0));
+    CHECK_EQ(r.sel.holdMask(), bit(0));
+    CHECK(near(r.mag[5], 15.0f));   // 刚进入：估计值等于最后的磁编角度
+
+    // 样本恢复新鲜：全部回到 FULL
+    r.update(ALL, true);
+    CHECK_EQ(r.full(), ALL);
+}
+
+static void testTransitionStats() {
+    Rig r;
+    r.update(ALL);                              // 21 个关节 HOLD -> FULL
+    CHECK_EQ(r.sel.stats().transitions, ENCODER_TOTAL_NUM);
+    r.update(ALL & ~bit(1), true, false);       // FULL -> HOLD
+    r.update(ALL & ~bit(1));                    // HOLD -> SERVO_ONLY
+    r.update(ALL & ~bit(1));                    // 保持
+    r.update(ALL);                              // SERVO_ONLY -> FULL
+    const JointModeStats& s = r.sel.stats();
+    CHECK_EQ(s.transitions, ENCODER_TOTAL_NUM + 3);
+    CHECK_EQ(s.holdTicks, 1);
+    CHECK_EQ(s.servoOnlyTicks, 2);
+}
+
+/* ==================== 随机故障序列 ==================== */
+
+static uint32_t s_rng = 2024;
+static uint32_t nextRand() {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+// 每个周期随机：少数关节磁编失效、偶尔整帧过期、快照缺失、舵机离线、舵机角度变化
+static void testRandomFaultInvariants() {
+    Rig r;
+    uint32_t primed = 0;
+    float offset[ENCODER_TOTAL_NUM] = {};
+    uint32_t prevServoOnly = 0;
+    long servoOnlyCycles = 0, holdCycles = 0;
+
+    for (int cycle = 0; cycle < 20000; cycle++) {
+        uint32_t valid = ALL;
+        for (int k = nextRand() % 4; k > 0; k--) valid &= ~bit(nextRand() % ENCODER_TOTAL_NUM);
+        bool fresh = nextRand() % 50 != 0;
+        bool withServo = nextRand() % 10 != 0;
+        r.servo.onlineMask = ALL;
+        if (nextRand() % 5 == 0) r.servo.onlineMask &= ~bit(nextRand() % ENCODER_TOTAL_NUM);
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+            r.servo.degs[i] = (float)(nextRand() % 3600) * 0.1f;
+            r.mag[i] = (float)(nextRand() % 3600) * 0.1f;
+        }
+        float before[ENCODER_TOTAL_NUM];
+        memcpy(before, r.mag, sizeof(before));
+
+        r.update(valid, fresh, withServo);
+
+        uint32_t encOk = fresh ? valid : 0;
+        primed |= encOk;
+        uint32_t servoOk = withServo ? r.servo.onlineMask : 0;
+        uint32_t so = r.sel.servoOnlyMask();
+        uint32_t hold = r.sel.holdMask();
+
+        CHECK_EQ(so & hold, 0);
+        CHECK_EQ(r.full(), encOk);                     // 磁编有效且新鲜的关节一定 FULL
+        CHECK_EQ(so, ~encOk & primed & servoOk & ALL);  // 只有可估计的关节 SERVO_ONLY
+        CHECK_EQ(r.sel.healthy(valid, fresh), encOk == ALL && (so | hold) == 0);
+
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+            if (so & bit(i)) {
+                if (!(prevServoOnly & bit(i))) offset[i] = before[i] - r.servo.degs[i];
+                CHECK(near(r.mag[i], r.servo.degs[i] + offset[i]));
+            } else {
+                CHECK(r.mag[i] == before[i]);           // 非 SERVO_ONLY 关节的角度不被改写
+            }
+        }
+        prevServoOnly = so;
+        servoOnlyCycles += so != 0;
+        holdCycles += hold != 0;
+        if (g_testFailures) break;
+    }
+    // 序列确实覆盖了两种降级
+    CHECK(servoOnlyCycles > 1000);
+    CHECK(holdCycles > 1000);
+}
+
+int main() {
+    RUN_TEST(testBootHoldsUntilFirstValidFrame);
+    RUN_TEST(testNeverPrimedJointStaysInHold);
+    RUN_TEST(testFaultWithoutSnapshotHolds);
+    RUN_TEST(testServoOnlyTracksServoWithRecordedOffset);
+    RUN_TEST(testServoOfflineFallsBackToHold);
+    RUN_TEST(testRecoveryAndReentryRecordsFreshOffset);
+    RUN_TEST(testStaleSampleDegradesAllJoints);
+    RUN_TEST(testTransitionStats);
+    RUN_TEST(testRandomFaultInvariants);
+    return TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+// LoadProtector：按默认 LOAD_* 参数的降额/关扭矩阈值、逐级恢复、短时峰值与离线关节，
+// 以及 ServoManager 立即停机阈值与负载满量程的关系
+#include "test_common.h"
+#include "LoadProtector.h"
+#include "ServoModel.h"
+#include "ServoState.h"
+#include <math.h>
+
+static_assert(EMERGENCY_LOAD > LOAD_CONT_DEFAULT && EMERGENCY_LOAD <= SERVO_TORQUE_LIMIT_MAX,
+              "立即停机阈值必须落在负载满量程内，且高于可持续负载");
+
+static const uint32_t ALL = ENC_VALID_ALL;
+static const float DT = SOLVER_PERIOD_MS * 1e-3f;
+
+struct Rig {
+    LoadProtector lp;
+    int16_t loads[ENCODER_TOTAL_NUM];
+
+    Rig() { set(0); }
+    void set(int16_t load) {
+        for (int i = 0; i < ENCODER_TOTAL_NUM; i++) loads[i] = load;
+    }
+    void run(int cycles, uint32_t online = ALL) {
+        for (int c = 0; c < cycles; c++) lp.update(loads, online, DT);
+    }
+};
+
+// 满负载时 heat 每秒增加 (1000/500)² - 1 = 3，空载时每秒减少 1
+static int cyclesFor(float heat, float ratePerS) { return (int)lroundf(heat / ratePerS / DT); }
+
+/* ==================== 阈值 ==================== */
+
+static void testContinuousLoadStaysNormal() {
+    Rig r;
+    r.set(LOAD_CONT_DEFAULT);
+    r.run(1000);
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) {
+        CHECK_EQ(r.lp.state(i), LOAD_STATE_NORMAL);
+        CHECK_EQ(r.lp.torqueLimit(i), SERVO_TORQUE_LIMIT_MAX);
+    }
+    CHECK_EQ(r.lp.derateMask(), 0);
+    CHECK_EQ(r.lp.stats().peakLoad, LOAD_CONT_DEFAULT);
+    CHECK_EQ(r.lp.stats().peakHeatPct, 0);
+}
+
+static void testStallDeratesThenCuts() {
+    Rig r;
+    r.set(-SERVO_TORQUE_LIMIT_MAX);   // 负载带符号，按绝对值累计
+
+    int toDerate = cyclesFor(LOAD_DERATE_HEAT_S, 3.0f);
+    r.run(toDerate - 1);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_NORMAL);
+    r.run(2);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_DERATE);
+    CHECK_EQ(r.lp.derateMask(), ALL);
+    CHECK_EQ(r.lp.torqueLimit(0), LOAD_DERATE_TORQUE_DEFAULT);
+    CHECK_EQ(r.lp.stats().derates, ENCODER_TOTAL_NUM);
+
+    int toCut = cyclesFor(LOAD_CUT_HEAT_S, 3.0f);
+    r.run(toCut - toDerate - 2);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_DERATE);
+    r.run(3);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_CUT);
+    CHECK_EQ(r.lp.cutMask(), ALL);
+    CHECK_EQ(r.lp.derateMask(), 0);
+    CHECK_EQ(r.lp.torqueLimit(0), 0);
+    CHECK_EQ(r.lp.stats().cuts, ENCODER_TOTAL_NUM);
+    CHECK_EQ(r.lp.stats().peakHeatPct, 100);
+}
+
+// 短时峰值（低于降额所需时间）不触发
+static void testShortPeakIgnored() {
+    Rig r;
+    r.loads[3] = SERVO_TORQUE_LIMIT_MAX;
+    r.run(cyclesFor(LOAD_DERATE_HEAT_S, 3.0f) - 3);
+    r.loads[3] = 0;
+    r.run(100);
+    CHECK_EQ(r.lp.state(3), LOAD_STATE_NORMAL);
+    CHECK_EQ(r.lp.stats().derates, 0);
+    CHECK_EQ(r.lp.stats().peakLoad, SERVO_TORQUE_LIMIT_MAX);
+}
+
+/* ==================== 恢复 ==================== */
+
+// CUT 冷却到降额阈值以下回到 DERATE，再冷却到 降额阈值 × LOAD_RELEASE_RATIO 以下回到 NORMAL
+static void testRecoveryStepsThroughDerate() {
+    Rig r;
+    r.set(SERVO_TORQUE_LIMIT_MAX);
+    r.run(cyclesFor(LOAD_CUT_HEAT_S, 3.0f) + 10);   // heat 限制在关扭矩阈值
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_CUT);
+
+    r.set(0);
+    int toDerate = cyclesFor(LOAD_CUT_HEAT_S - LOAD_DERATE_HEAT_S, 1.0f);
+    r.run(toDerate - 2);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_CUT);
+    r.run(4);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_DERATE);
+    CHECK_EQ(r.lp.torqueLimit(0), LOAD_DERATE_TORQUE_DEFAULT);
+    CHECK_EQ(r.lp.stats().releases, 0);
+
+    int toRelease = cyclesFor(LOAD_DERATE_HEAT_S * (1.0f - LOAD_RELEASE_RATIO), 1.0f);
+    r.run(toRelease - 4);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_DERATE);
+    r.run(4);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_NORMAL);
+    CHECK_EQ(r.lp.torqueLimit(0), SERVO_TORQUE_LIMIT_MAX);
+    CHECK_EQ(r.lp.stats().releases, ENCODER_TOTAL_NUM);
+    CHECK_EQ(r.lp.cutMask() | r.lp.derateMask(), 0);
+}
+
+// 离线关节保持状态与热量，不随空载冷却
+static void testOfflineJointKeepsState() {
+    Rig r;
+    r.set(SERVO_TORQUE_LIMIT_MAX);
+    r.run(cyclesFor(LOAD_DERATE_HEAT_S, 3.0f) + 2);
+    CHECK_EQ(r.lp.state(5), LOAD_STATE_DERATE);
+
+    r.set(0);
+    r.run(500, ALL & ~(1UL << 5));
+    CHECK_EQ(r.lp.state(5), LOAD_STATE_DERATE);
+    CHECK_EQ(r.lp.state(4), LOAD_STATE_NORMAL);
+    CHECK(r.lp.derateMask() == (1UL << 5));
+}
+
+/* ==================== 限制表 ==================== */
+
+// 无效的行沿用原有限制，有效的行在下一次 update 生效，降额力矩限制在满量程内
+static void testRequestLimitsValidatesRows() {
+    Rig r;
+    LoadLimitTable table;
+    for (int i = 0; i < ENCODER_TOTAL_NUM; i++) table.joint[i] = r.lp.limit(i);
+    table.joint[0] = { 250, 2000, 0.5f, 1.0f };
+    table.joint[1] = { 0, 100, 0.5f, 1.0f };        // 持续负载为 0
+    table.joint[2] = { 250, 100, 1.0f, 1.0f };      // 阈值不递增
+    r.lp.requestLimits(table);
+    r.run(1);
+
+    CHECK_EQ(r.lp.limit(0).contLoad, 250);
+    CHECK_EQ(r.lp.limit(0).derateTorque, SERVO_TORQUE_LIMIT_MAX);
+    CHECK_EQ(r.lp.limit(1).contLoad, LOAD_CONT_DEFAULT);
+    CHECK_EQ(r.lp.limit(2).contLoad, LOAD_CONT_DEFAULT);
+
+    // 新的持续负载下，原本可持续的负载开始累计
+    r.set(LOAD_CONT_DEFAULT);
+    r.run(cyclesFor(0.5f, 3.0f) + 2);
+    CHECK_EQ(r.lp.state(0), LOAD_STATE_DERATE);
+    CHECK_EQ(r.lp.state(1), LOAD_STATE_NORMAL);
+}
+
+int main() {
+    RUN_TEST(testContinuousLoadStaysNormal);
+    RUN_TEST(testStallDeratesThenCuts);
+    RUN_TEST(testShortPeakIgnored);
+    RUN_TEST(testRecoveryStepsThroughDerate);
+    RUN_TEST(testOfflineJointKeepsState);
+    RUN_TEST(testRequestLimitsValidatesRows);
+    return TEST_RESULT();
+}
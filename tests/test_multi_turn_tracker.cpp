@@ -0,0 +1,208 @@
+// MultiTurnTracker 判圈边界用例：±半圈、长采样间隔、反向运动
+#include "test_common.h"
+#include "MultiTurnTracker.h"
+
+static const int32_t TURN = MultiTurnTracker::STEPS_PER_TURN;
+
+static int16_t wrapRaw(int32_t absPos) {
+    return (int16_t)(((absPos % TURN) + TURN) % TURN);
+}
+
+// 以初值 start 建立参考，随后按 (位移, 速度, 间隔) 依次喂样本，返回累计绝对位置
+struct Sim {
+    MultiTurnTracker t;
+    int32_t truth;
+    uint32_t us;
+
+    Sim(int32_t start, uint32_t startUs = 0) : truth(start), us(startUs) {
+        t.Update(wrapRaw(start), 0, us, false);
+    }
+
+    void step(int32_t delta, int16_t speed, uint32_t dtUs, bool speedValid = true) {
+        truth += delta;
+        us += dtUs;
+        t.Update(wrapRaw(truth), speed, us, speedValid);
+    }
+
+    // 跟踪器只知道初始单圈位置，比较时扣除初始整圈
+    int32_t tracked() const { return t.Absolute(); }
+    int32_t expected(int32_t start) const { return truth - (start - wrapRaw(start)); }
+};
+
+/* ==================== ±半圈 ==================== */
+
+static void testHalfTurnWithoutSpeed() {
+    // 无速度信息时退化为最近跨圈判断；恰好半圈时固定判为正向
+    Sim fwd(0);
+    fwd.step(TURN / 2, 0, 1000, false);
+    CHECK_EQ(fwd.tracked(), TURN / 2);
+
+    Sim back(TURN / 2);
+    back.step(-TURN / 2, 0, 1000, false);
+    CHECK_EQ(back.t.TurnCount(), 1);
+    CHECK_EQ(back.tracked(), TURN);
+
+    // 半圈以内按真实方向
+    Sim below(100);
+    below.step(TURN / 2 - 1, 0, 1000, false);
+    CHECK_EQ(below.tracked(), 100 + TURN / 2 - 1);
+
+    Sim belowNeg(3000);
+    belowNeg.step(-(TURN / 2 - 1), 0, 1000, false);
+    CHECK_EQ(belowNeg.tracked(), 3000 - (TURN / 2 - 1));
+
+    // 超过半圈一步时无速度只能判反
+    Sim over(0);
+    over.step(TURN / 2 + 1, 0, 1000, false);
+    CHECK_EQ(over.tracked(), TURN / 2 + 1 - TURN);
+}
+
+static void testHalfTurnWithSpeed() {
+    // 速度预测使超过半圈的位移也能判对（正反两个方向）
+    const uint32_t dtUs = 1000000;   // 1 s
+    Sim fwd(200);
+    fwd.step(0, 2600, 1000);         // 先给出速度
+    fwd.step(2600, 2600, dtUs);
+    CHECK_EQ(fwd.tracked(), fwd.expected(200));
+    CHECK(!fwd.t.Suspect());
+
+    Sim back(200);
+    back.step(0, -2600, 1000);
+    back.step(-2600, -2600, dtUs);
+    CHECK_EQ(back.tracked(), back.expected(200));
+    CHECK(!back.t.Suspect());
+
+    // 恰好 ±半圈且速度一致
+    Sim half(4000);
+    half.step(0, -2048, 1000);
+    half.step(-TURN / 2, -2048, dtUs);
+    CHECK_EQ(half.tracked(), half.expected(4000));
+}
+
+static void testBoundaryCrossing() {
+    // 0/4095 附近小步往返，不应凭空增减圈数
+    Sim s(TURN - 3);
+    const int32_t deltas[] = { 2, 2, 2, -1, -3, -4, 5, 1, -2 };
+    for (int32_t d : deltas) {
+        s.step(d, (int16_t)(d * 1000), 1000);
+        CHECK_EQ(s.tracked(), s.expected(TURN - 3));
+    }
+}
+
+/* ==================== 长采样间隔 ==================== */
+
+static void testLargeDt() {
+    // 漏掉多个周期：1.5 s 内以 3400 步/秒走了 5100 步（超过一整圈）
+    Sim s(1000);
+    s.step(34, 3400, 10000);
+    s.step(5100, 3400, 1500000);
+    CHECK_EQ(s.tracked(), s.expected(1000));
+    CHECK(!s.t.Suspect());
+
+    // 5 s 长间隔（总线掉线后恢复）：17000 步，四圈以上
+    Sim far(0);
+    far.step(-34, -3400, 10000);
+    far.step(-17000, -3400, 5000000);
+    CHECK_EQ(far.tracked(), far.expected(0));
+    CHECK_EQ(far.t.TurnCount(), -5);
+}
+
+static void testTimestampWrap() {
+    // micros() 32 位回绕时仍使用正确的采样间隔
+    Sim s(500, 0xFFFFFFFFu - 200000);
+    s.step(300, 3000, 100000);
+    s.step(3000, 3000, 1000000);   // 跨越回绕点
+    CHECK_EQ(s.tracked(), s.expected(500));
+    CHECK(!s.t.Suspect());
+}
+
+static void testSuspectFlag() {
+    // 速度寄存器与实际位移严重不符：判圈以预测为准并置可疑标志
+    Sim s(0);
+    s.step(0, 3000, 1000);
+    s.step(100, 3000, 1000000);   // 预测 3000，实际只有 100
+    CHECK(s.t.Suspect());
+
+    // 下一次正常样本清除可疑标志
+    s.step(3, 3, 1000);
+    CHECK(!s.t.Suspect());
+}
+
+/* ==================== 反向运动 ==================== */
+
+static void testReversal() {
+    // 高速正转后急停反转：两次速度平均接近 0，退化为最近跨圈
+    Sim s(2000);
+    s.step(0, 3000, 1000);
+    for (int i = 0; i < 20; i++) s.step(30, 3000, 10000);
+    s.step(-20, -2000, 10000);
+    for (int i = 0; i < 20; i++) s.step(-30, -3000, 10000);
+    CHECK_EQ(s.tracked(), s.expected(2000));
+    CHECK(!s.t.Suspect());
+
+    // 在长间隔内反向：平均速度给出的预测小于半圈，仍能判对
+    Sim r(3900);
+    r.step(0, 3000, 1000);
+    r.step(600, -1000, 400000);   // 前 0.4 s 内先正后反，净位移 +600
+    CHECK_EQ(r.tracked(), r.expected(3900));
+}
+
+static void testSweepRatesAndSkips() {
+    // 各种采样率 × 速度，周期性漏帧，长时间累计不应丢圈
+    const double rates[] = { 50.0, 100.0, 200.0, 1000.0 };
+    const int16_t speeds[] = { -3400, -1500, 500, 3000 };
+    for (double rate : rates) {
+        for (int16_t v : speeds) {
+            Sim s(100000 % TURN);
+            int64_t posMilli = (int64_t)(100000 % TURN) * 1000;
+            for (int i = 0; i < 2000; i++) {
+                int skip = (i % 7 == 3) ? 3 : 1;
+                uint32_t dtUs = (uint32_t)(skip * 1e6 / rate);
+                posMilli += (int64_t)v * dtUs / 1000;
+                int32_t next = (int32_t)(posMilli / 1000);
+                s.step(next - s.truth, v, dtUs);
+            }
+            CHECK_EQ(s.tracked(), s.expected(100000 % TURN));
+        }
+    }
+}
+
+/* ==================== 恢复与饱和 ==================== */
+
+static void testRestoreSkipsPrediction() {
+    MultiTurnTracker t;
+    t.Restore(3, 4000);
+    CHECK(t.Initialized());
+    CHECK_EQ(t.Absolute(), 3 * TURN + 4000);
+
+    // 恢复后的首个样本不使用速度预测（上电前的时间戳无意义）
+    t.Update(10, 3400, 123456789, true);
+    CHECK_EQ(t.TurnCount(), 4);
+    CHECK(!t.Suspect());
+    CHECK(!(t.GetFlags() & MultiTurnTracker::FLAG_RESTORED));
+}
+
+static void testSaturation() {
+    MultiTurnTracker t;
+    t.Restore(7, 2000);   // 7*4096+2000 = 30672
+    CHECK(!t.Saturated());
+    t.Update(2100, 0, 0, false);
+    CHECK(t.Saturated());
+    t.ResetTurns();
+    CHECK(!t.Saturated());
+    CHECK_EQ(t.Absolute(), 2100);
+}
+
+int main() {
+    RUN_TEST(testHalfTurnWithoutSpeed);
+    RUN_TEST(testHalfTurnWithSpeed);
+    RUN_TEST(testBoundaryCrossing);
+    RUN_TEST(testLargeDt);
+    RUN_TEST(testTimestampWrap);
+    RUN_TEST(testSuspectFlag);
+    RUN_TEST(testReversal);
+    RUN_TEST(testSweepRatesAndSkips);
+    RUN_TEST(testRestoreSkipsPrediction);
+    RUN_TEST(testSaturation);
+    return TEST_RESULT();
+}
@@ -0,0 +1,297 @@
+// SCSRegMap 编解码与旧版逐字段编码逐字节比对
+//
+// legacy:: 下的函数照抄寄存器描述引入之前的 WritePosEx / SyncWritePosEx 等实现
+// （Host2SCS 逐字段拆分 + 手工符号位），新实现经串口桩写出的整帧必须与之完全一致。
+#include "test_common.h"
+#include "SCServo.h"
+#include "ServoModel.h"
+#include <vector>
+
+typedef std::vector<uint8_t> Bytes;
+
+namespace legacy {
+
+static void host2scs(uint8_t end, uint8_t* l, uint8_t* h, uint16_t v) {
+    if (end) { *l = (uint8_t)(v >> 8); *h = (uint8_t)(v & 0xff); }
+    else     { *h = (uint8_t)(v >> 8); *l = (uint8_t)(v & 0xff); }
+}
+
+static uint16_t signMag(int16_t v, int bit) {
+    if (v < 0) {
+        v = -v;
+        v |= (1 << bit);
+    }
+    return (uint16_t)v;
+}
+
+// SCS::writeBuf 的帧格式
+static Bytes frame(uint8_t id, uint8_t addr, const uint8_t* dat, uint8_t len, uint8_t fun) {
+    Bytes f = { 0xff, 0xff, id, (uint8_t)(len + 3), fun, addr };
+    uint8_t sum = id + (len + 3) + fun + addr;
+    for (uint8_t i = 0; i < len; i++) { f.push_back(dat[i]); sum += dat[i]; }
+    f.push_back((uint8_t)~sum);
+    return f;
+}
+
+// SCS::syncWrite 的帧格式
+static Bytes syncFrame(const uint8_t* id, uint8_t idn, uint8_t addr, const uint8_t* dat, uint8_t len) {
+    uint8_t mesLen = (uint8_t)((len + 1) * idn + 4);
+    Bytes f = { 0xff, 0xff, 0xfe, mesLen, INST_SYNC_WRITE, addr, len };
+    uint8_t sum = 0xfe + mesLen + INST_SYNC_WRITE + addr + len;
+    for (uint8_t i = 0; i < idn; i++) {
+        f.push_back(id[i]); sum += id[i];
+        for (uint8_t j = 0; j < len; j++) { f.push_back(dat[i * len + j]); sum += dat[i * len + j]; }
+    }
+    f.push_back((uint8_t)~sum);
+    return f;
+}
+
+// ACC, 位置, 时间/力矩, 速度（SMS_STS / HLSCL 的 PosEx 与 WriteSpe）
+static void posEx(uint8_t end, uint8_t* b, uint8_t acc, uint16_t pos, uint16_t mid, uint16_t spd) {
+    b[0] = acc;
+    host2scs(end, b + 1, b + 2, pos);
+    host2scs(end, b + 3, b + 4, mid);
+    host2scs(end, b + 5, b + 6, spd);
+}
+
+static void scsclPos(uint8_t end, uint8_t* b, uint16_t pos, uint16_t time, uint16_t spd) {
+    host2scs(end, b + 0, b + 1, pos);
+    host2scs(end, b + 2, b + 3, time);
+    host2scs(end, b + 4, b + 5, spd);
+}
+
+static int decode(int raw, int bit) {
+    if (raw & (1 << bit)) raw = -(raw & ~(1 << bit));
+    return raw;
+}
+
+} // namespace legacy
+
+// 每个型号一根串口桩；Level=0 时写指令不等待应答
+struct Bus {
+    HardwareSerial serial;
+    SMS_STS sts;
+    HLSCL hls;
+    SCSCL scscl;
+
+    explicit Bus(uint8_t end) : sts(end, 0), hls(end, 0), scscl(end, 0) {
+        sts.pSerial = &serial;
+        hls.pSerial = &serial;
+        scscl.pSerial = &serial;
+    }
+
+    Bytes take() {
+        Bytes out;
+        out.swap(serial.tx);
+        return out;
+    }
+};
+
+static Bytes concat(const Bytes& a, const Bytes& b) {
+    Bytes out = a;
+    out.insert(out.end(), b.begin(), b.end());
+    return out;
+}
+
+/* ==================== 单舵机写指令 ==================== */
+
+static void testSingleWritesAllValues() {
+    // 全部 s16 取值 × 两种字节序，速度/ACC/力矩由取值派生以覆盖各字节
+    for (uint8_t end = 0; end < 2; end++) {
+        Bus bus(end);
+        int mismatches = 0;
+        for (int v = -32768; v <= 32767; v++) {
+            const int16_t p = (int16_t)v;
+            const uint16_t spd = (uint16_t)(v * 7 + 3);
+            const uint8_t acc = (uint8_t)v;
+            const uint16_t tq = (uint16_t)(v * 13);
+            uint8_t b[7];
+            Bytes expect;
+
+            legacy::posEx(end, b, acc, legacy::signMag(p, 15), 0, spd);
+            expect = concat(legacy::frame(1, SMS_STS_ACC, b, 7, INST_WRITE),
+                            legacy::frame(2, SMS_STS_ACC, b, 7, INST_REG_WRITE));
+            bus.sts.WritePosEx(1, p, spd, acc);
+            bus.sts.RegWritePosEx(2, p, spd, acc);
+
+            legacy::posEx(end, b, acc, 0, 0, legacy::signMag(p, 15));
+            expect = concat(expect, legacy::frame(3, SMS_STS_ACC, b, 7, INST_WRITE));
+            bus.sts.WriteSpe(3, p, acc);
+
+            legacy::scsclPos(end, b, (uint16_t)v, spd, (uint16_t)(v ^ 0x5a5a));
+            expect = concat(expect, legacy::frame(4, SCSCL_GOAL_POSITION_L, b, 6, INST_WRITE));
+            legacy::scsclPos(end, b, (uint16_t)v, spd, spd);
+            expect = concat(expect, legacy::frame(5, SCSCL_GOAL_POSITION_L, b, 6, INST_REG_WRITE));
+            legacy::host2scs(end, b, b + 1, legacy::signMag(p, 10));
+            expect = concat(expect, legacy::frame(6, SCSCL_GOAL_TIME_L, b, 2, INST_WRITE));
+            bus.scscl.WritePos(4, (uint16_t)v, spd, (uint16_t)(v ^ 0x5a5a));
+            bus.scscl.RegWritePos(5, (uint16_t)v, spd, spd);
+            bus.scscl.WritePWM(6, p);
+
+            legacy::posEx(end, b, acc, legacy::signMag(p, 15), tq, spd);
+            expect = concat(expect, legacy::frame(7, HLSCL_ACC, b, 7, INST_WRITE));
+            legacy::posEx(end, b, acc, legacy::signMag(p, 15), (uint16_t)v, spd);
+            expect = concat(expect, legacy::frame(8, HLSCL_ACC, b, 7, INST_REG_WRITE));
+            legacy::posEx(end, b, acc, 0, spd, legacy::signMag(p, 15));
+            expect = concat(expect, legacy::frame(9, HLSCL_ACC, b, 7, INST_WRITE));
+            legacy::host2scs(end, b, b + 1, legacy::signMag(p, 15));
+            expect = concat(expect, legacy::frame(10, HLSCL_GOAL_TORQUE_L, b, 2, INST_WRITE));
+            bus.hls.WritePosEx(7, p, spd, acc, tq);
+            bus.hls.RegWritePosEx(8, p, spd, acc, (uint16_t)v);
+            bus.hls.WriteSpe(9, p, acc, spd);
+            bus.hls.WriteEle(10, p);
+
+            if (bus.take() != expect) mismatches++;
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+}
+
+/* ==================== 同步写 ==================== */
+
+static void testSyncWritesRandomBatches() {
+    // 随机批次（含空的可选数组，旧实现中等价于全 0），舵机数不超过单帧上限
+    unsigned seed = 12345;
+    auto rnd = [&seed] { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+    const uint8_t maxIdn = SMS_STS_Map::PosEx::MaxSyncIDN;
+    CHECK_EQ(maxIdn, 31);
+    CHECK_EQ(SCSCL_Map::Pos::MaxSyncIDN, 35);
+
+    for (uint8_t end = 0; end < 2; end++) {
+        Bus bus(end);
+        int mismatches = 0;
+        for (int iter = 0; iter < 20000; iter++) {
+            const uint8_t n = (uint8_t)(1 + rnd() % maxIdn);
+            uint8_t id[64], acc[64];
+            int16_t pos[64];
+            uint16_t spd[64], tq[64], upos[64];
+            const uint16_t zero16[64] = {};
+            const uint8_t zero8[64] = {};
+            for (int i = 0; i < n; i++) {
+                id[i] = (uint8_t)rnd(); pos[i] = (int16_t)rnd(); spd[i] = (uint16_t)rnd();
+                acc[i] = (uint8_t)rnd(); tq[i] = (uint16_t)rnd(); upos[i] = (uint16_t)rnd();
+            }
+            const bool nul = iter % 3 == 0;
+            const uint16_t* rs = nul ? zero16 : spd;
+            const uint8_t* ra = nul ? zero8 : acc;
+            const uint16_t* rt = nul ? zero16 : tq;
+
+            uint8_t dat[7 * 64];
+            Bytes expect;
+            for (int i = 0; i < n; i++) legacy::posEx(end, dat + i * 7, ra[i], legacy::signMag(pos[i], 15), 0, rs[i]);
+            expect = legacy::syncFrame(id, n, SMS_STS_ACC, dat, 7);
+            for (int i = 0; i < n; i++) legacy::posEx(end, dat + i * 7, ra[i], 0, 0, legacy::signMag(pos[i], 15));
+            expect = concat(expect, legacy::syncFrame(id, n, SMS_STS_ACC, dat, 7));
+            for (int i = 0; i < n; i++) legacy::scsclPos(end, dat + i * 6, upos[i], rs[i], rt[i]);
+            expect = concat(expect, legacy::syncFrame(id, n, SCSCL_GOAL_POSITION_L, dat, 6));
+            for (int i = 0; i < n; i++) legacy::posEx(end, dat + i * 7, ra[i], legacy::signMag(pos[i], 15), rt[i], spd[i]);
+            expect = concat(expect, legacy::syncFrame(id, n, HLSCL_ACC, dat, 7));
+            for (int i = 0; i < n; i++) legacy::posEx(end, dat + i * 7, ra[i], 0, rt[i], legacy::signMag(pos[i], 15));
+            expect = concat(expect, legacy::syncFrame(id, n, HLSCL_ACC, dat, 7));
+
+            const int16_t* posIn = pos;
+            bus.sts.SyncWritePosEx(id, n, posIn, nul ? NULL : spd, nul ? NULL : acc);
+            bus.sts.SyncWriteSpe(id, n, posIn, nul ? NULL : acc);
+            bus.scscl.SyncWritePos(id, n, upos, nul ? NULL : spd, nul ? NULL : tq);
+            bus.hls.SyncWritePosEx(id, n, posIn, spd, nul ? NULL : acc, nul ? NULL : tq);
+            bus.hls.SyncWriteSpe(id, n, posIn, nul ? NULL : acc, nul ? NULL : tq);
+
+            if (bus.take() != expect) mismatches++;
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+}
+
+static void testSyncWriteKeepsInputs() {
+    // 新实现不再原地改写调用者的位置/速度数组
+    Bus bus(0);
+    uint8_t id[3] = { 1, 2, 3 };
+    int16_t pos[3] = { -100, 200, -32768 };
+    uint16_t spd[3] = { 10, 20, 30 };
+    uint8_t acc[3] = { 0, 5, 255 };
+    bus.sts.SyncWritePosEx(id, 3, pos, spd, acc);
+    bus.sts.SyncWriteSpe(id, 3, pos, acc);
+    CHECK_EQ(pos[0], -100);
+    CHECK_EQ(pos[2], -32768);
+}
+
+/* ==================== 解码 ==================== */
+
+static void testDecodeMatchesLegacy() {
+    // 所有 16 位原始值以及读失败时的 -1
+    int mismatches = 0;
+    for (int raw = -1; raw <= 0xffff; raw++) {
+        if (SMS_STS_Map::PresentPosition::Decode(raw) != legacy::decode(raw, 15)) mismatches++;
+        if (SMS_STS_Map::PresentSpeed::Decode(raw) != legacy::decode(raw, 15)) mismatches++;
+        if (SMS_STS_Map::PresentLoad::Decode(raw) != legacy::decode(raw, 10)) mismatches++;
+        if (SMS_STS_Map::PresentCurrent::Decode(raw) != legacy::decode(raw, 15)) mismatches++;
+        if (HLSCL_Map::PresentLoad::Decode(raw) != legacy::decode(raw, 10)) mismatches++;
+        if (SCSCL_Map::PresentSpeed::Decode(raw) != legacy::decode(raw, 15)) mismatches++;
+        if (SCSCL_Map::PresentPosition::Decode(raw) != raw) mismatches++;   // 无符号
+    }
+    CHECK_EQ(mismatches, 0);
+
+    // Get<End> 的字节序
+    const uint8_t le[2] = { 0x34, 0x82 };
+    CHECK_EQ(SMS_STS_Map::PresentPosition::Get<0>(le), -0x0234);
+    CHECK_EQ(SMS_STS_Map::PresentPosition::Get<1>(le), 0x3482);
+}
+
+/* ==================== 型号策略的单位换算 ==================== */
+
+// HLS：接口速度（步/s）按 speedUnit 向上取整写入寄存器，反馈的寄存器速度按同一单位换算回来
+static void testHlsPackDecodeRoundTrip() {
+    const ServoModelPolicy& hls = servoModelPolicy(SERVO_MODEL_HLS);
+    CHECK_EQ(hls.speedUnit, 50);
+    CHECK_EQ(hls.accUnit, 100);
+
+    const uint8_t speedAt = HLSCL_Map::GoalSpeed::Addr - HLSCL_Map::PosEx::Addr;
+    const uint8_t accAt = HLSCL_Map::Acc::Addr - HLSCL_Map::PosEx::Addr;
+    const uint16_t speeds[] = { 0, 1, 49, 50, 51, 1000, 3400 };
+    for (uint16_t speed : speeds) {
+        uint8_t target[HLSCL_Map::PosEx::Len];
+        hls.packTarget(target, -1234, speed, 30, 500);
+        int raw = HLSCL_Map::GoalSpeed::Get<0>(target + speedAt);
+        CHECK_EQ(raw, (speed + hls.speedUnit - 1) / hls.speedUnit);
+        CHECK_EQ(HLSCL_Map::Acc::Get<0>(target + accAt), 30);
+
+        // 舵机以写入的速度运行时反馈同一寄存器值：换算回接口单位后不小于请求值，误差小于一个单位
+        for (int sign = -1; sign <= 1; sign += 2) {
+            uint8_t fb[6] = { 0 };
+            HLSCL_Map::PresentPosition::Put<0>(fb, -1234);
+            HLSCL_Map::PresentSpeed::Put<0>(fb + 2, sign * raw);
+            HLSCL_Map::PresentLoad::Put<0>(fb + 4, -200);
+            int16_t position, decoded, load;
+            hls.decodeFeedback(fb, position, decoded, load);
+            CHECK_EQ(position, -1234);
+            CHECK_EQ(decoded, sign * raw * hls.speedUnit);
+            CHECK_EQ(load, -200);
+            CHECK(sign * decoded >= speed && sign * decoded < speed + hls.speedUnit);
+        }
+    }
+
+    // 加速度不超过型号上限；寄存器满量程的反馈速度饱和而不回绕
+    uint8_t target[HLSCL_Map::PosEx::Len];
+    hls.packTarget(target, 0, 0, 255, 0);
+    CHECK_EQ(HLSCL_Map::Acc::Get<0>(target + accAt), hls.maxAcc * SERVO_ACC_UNIT / hls.accUnit);
+    uint8_t fb[6] = { 0 };
+    HLSCL_Map::PresentSpeed::Put<0>(fb + 2, -32767);
+    int16_t position, decoded, load;
+    hls.decodeFeedback(fb, position, decoded, load);
+    CHECK_EQ(decoded, INT16_MIN);
+
+    // STS 的寄存器单位即接口单位
+    const ServoModelPolicy& sts = servoModelPolicy(SERVO_MODEL_STS);
+    uint8_t stsTarget[SMS_STS_Map::PosEx::Len];
+    sts.packTarget(stsTarget, 100, 1000, 30, 0);
+    CHECK_EQ(SMS_STS_Map::GoalSpeed::Get<0>(stsTarget + (SMS_STS_Map::GoalSpeed::Addr - SMS_STS_Map::PosEx::Addr)), 1000);
+}
+
+int main() {
+    RUN_TEST(testSingleWritesAllValues);
+    RUN_TEST(testSyncWritesRandomBatches);
+    RUN_TEST(testSyncWriteKeepsInputs);
+    RUN_TEST(testDecodeMatchesLegacy);
+    RUN_TEST(testHlsPackDecodeRoundTrip);
+    return TEST_RESULT();
+}
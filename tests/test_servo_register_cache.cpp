@@ -0,0 +1,211 @@
+// ServoRegisterCache：读取命中、写入合并与 Flush、后台刷新校正，以及按舵机布局的刷新段与锁地址
+#include "test_common.h"
+#include "servo_sim.h"
+#include "ServoRegisterCache.h"
+#include "SMS_STS.h"
+
+static const uint8_t kIds[4] = { 1, 2, 3, 4 };
+
+// 第 4 个舵机使用的布局（与 STS 不同的段表和锁地址）
+static const ServoRegisterRange kOtherRanges[] = {
+    {9, 4},
+    {40, 1},
+};
+static const uint8_t OTHER_LOCK = 48;
+
+struct Rig {
+    HardwareSerial serial;
+    ServoSim sim;
+    SMS_STS sms;
+    ServoRegisterCache cache;
+
+    Rig() : sms(0, 1) {
+        sim.attach(serial);
+        sms.pSerial = &serial;
+        sms.IOTimeOut = 2;
+        cache.Attach(&sms, kIds, 4);
+        for (uint8_t id : kIds) {
+            sim.mem[id][SMS_STS_CW_DEAD] = 10 + id;
+            sim.mem[id][SMS_STS_LOCK] = 1;
+        }
+    }
+};
+
+/* ==================== 读取 ==================== */
+
+static void testReadHitsCacheAfterFirstFetch() {
+    Rig r;
+    uint8_t v = 0;
+    CHECK(r.cache.ReadByte(2, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(v, 12);
+    CHECK_EQ(r.sim.count(INST_READ), 1);
+    CHECK_EQ(r.cache.Stats().busReads, 1);
+
+    // 再次读取（含同一段中的字）由缓存返回，不再发帧
+    r.sim.mem[2][SMS_STS_CW_DEAD] = 99;
+    CHECK(r.cache.ReadByte(2, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(v, 12);
+    CHECK_EQ(r.sim.count(INST_READ), 1);
+    CHECK_EQ(r.cache.Stats().cacheHits, 1);
+
+    // 反馈区不缓存，未知舵机返回 false
+    CHECK(!r.cache.ReadByte(2, SMS_STS_PRESENT_POSITION_L, v));
+    CHECK(!r.cache.ReadByte(9, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(r.sim.frames.size(), 1);
+}
+
+static void testSyncFetchFillsAllServosInOneFrame() {
+    Rig r;
+    CHECK_EQ(r.cache.SyncFetch(SMS_STS_CW_DEAD, 2), 4);
+    CHECK_EQ(r.sim.count(INST_SYNC_READ), 1);
+    CHECK_EQ(r.sim.frames[0].ids.size(), 4);
+    for (uint8_t id : kIds) {
+        uint8_t v = 0;
+        CHECK(r.cache.ReadByte(id, SMS_STS_CW_DEAD, v));
+        CHECK_EQ(v, 10 + id);
+    }
+    CHECK_EQ(r.sim.frames.size(), 1);
+
+    // 掉线的舵机不计入，缓存仍无效
+    Rig s;
+    s.sim.online[3] = false;
+    CHECK_EQ(s.cache.SyncFetch(SMS_STS_CW_DEAD, 2), 3);
+    size_t frames = s.sim.frames.size();
+    uint8_t v = 0;
+    CHECK(!s.cache.ReadByte(3, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(s.sim.frames.size(), frames + 1);
+}
+
+/* ==================== 写入与 Flush ==================== */
+
+static void testFlushMergesDirtyBytesIntoSyncWrite() {
+    Rig r;
+    r.cache.SyncFetch(SMS_STS_TORQUE_ENABLE, 2);
+    r.sim.frames.clear();
+
+    // 与缓存相同的值不置脏
+    r.cache.WriteByteAll(SMS_STS_TORQUE_ENABLE, 0);
+    CHECK(!r.cache.HasDirty());
+    CHECK_EQ(r.cache.Stats().writesSkipped, 4);
+    CHECK_EQ(r.cache.Flush(), 0);
+    CHECK(r.sim.frames.empty());
+
+    // RAM 区写入：一帧 SYNC_WRITE，不解锁
+    r.cache.WriteByteAll(SMS_STS_TORQUE_ENABLE, 1);
+    r.cache.WriteByte(3, SMS_STS_ACC, 50);
+    CHECK(r.cache.HasDirty());
+    CHECK_EQ(r.cache.Flush(), 2);
+    CHECK(!r.cache.HasDirty());
+    CHECK_EQ(r.sim.count(INST_SYNC_WRITE), 2);
+    CHECK_EQ(r.sim.frames[0].addr, SMS_STS_TORQUE_ENABLE);
+    for (uint8_t id : kIds) CHECK_EQ(r.sim.mem[id][SMS_STS_TORQUE_ENABLE], 1);
+    CHECK_EQ(r.sim.mem[3][SMS_STS_ACC], 50);
+
+    // Flush 之后缓存即为写入值
+    uint8_t v = 0;
+    CHECK(r.cache.ReadByte(3, SMS_STS_ACC, v));
+    CHECK_EQ(v, 50);
+    CHECK_EQ(r.sim.count(INST_READ), 0);
+}
+
+static void testEpromFlushUnlocksPerLockAddress() {
+    Rig r;
+    CHECK(r.cache.SetLayout(4, kOtherRanges, 2, OTHER_LOCK));
+    CHECK(!r.cache.SetLayout(9, kOtherRanges, 2, OTHER_LOCK));
+    r.sim.mem[4][OTHER_LOCK] = 1;
+
+    const uint8_t zero[4] = { 0, 0, 0, 0 };
+    r.sim.mem[1][SMS_STS_MIN_ANGLE_LIMIT_L] = 7;
+    r.sim.mem[4][SMS_STS_MIN_ANGLE_LIMIT_L] = 7;
+    r.cache.WriteBlock(1, SMS_STS_MIN_ANGLE_LIMIT_L, zero, 4);
+    r.cache.WriteBlock(4, SMS_STS_MIN_ANGLE_LIMIT_L, zero, 4);
+    r.cache.Flush();
+
+    // 解锁（两个锁地址各一帧）-> 写入（一帧）-> 加锁（各一帧）
+    CHECK_EQ(r.sim.frames.size(), 5);
+    CHECK_EQ(r.sim.frames[0].addr, SMS_STS_LOCK);
+    CHECK(r.sim.frames[0].ids == std::vector<uint8_t>({ 1 }));
+    CHECK_EQ(r.sim.frames[0].data[0], 0);
+    CHECK_EQ(r.sim.frames[1].addr, OTHER_LOCK);
+    CHECK(r.sim.frames[1].ids == std::vector<uint8_t>({ 4 }));
+    CHECK_EQ(r.sim.frames[2].addr, SMS_STS_MIN_ANGLE_LIMIT_L);
+    CHECK(r.sim.frames[2].ids == std::vector<uint8_t>({ 1, 4 }));
+    CHECK_EQ(r.sim.frames[3].addr, SMS_STS_LOCK);
+    CHECK_EQ(r.sim.frames[3].data[0], 1);
+    CHECK_EQ(r.sim.frames[4].addr, OTHER_LOCK);
+    CHECK_EQ(r.sim.frames[4].data[0], 1);
+
+    CHECK_EQ(r.sim.mem[1][SMS_STS_MIN_ANGLE_LIMIT_L], 0);
+    CHECK_EQ(r.sim.mem[4][SMS_STS_MIN_ANGLE_LIMIT_L], 0);
+    CHECK_EQ(r.sim.mem[1][SMS_STS_LOCK], 1);
+    CHECK_EQ(r.sim.mem[4][OTHER_LOCK], 1);
+    // 没有 EPROM 脏字节的舵机不解锁
+    for (const SimFrame& f : r.sim.frames) {
+        for (uint8_t id : f.ids) CHECK(id == 1 || id == 4);
+    }
+}
+
+/* ==================== 后台刷新 ==================== */
+
+// 默认布局：每次调用同步读一段，修正与舵机不一致的字节，脏字节不被覆盖
+static void testRefreshCorrectsDivergedBytes() {
+    Rig r;
+    r.cache.SyncFetch(SMS_STS_CW_DEAD, 2);
+    r.cache.WriteByte(2, SMS_STS_CW_DEAD, 77);   // 待写入
+
+    // 舵机上的值被绕过缓存改掉（例如重新上电或其它主机写入）
+    r.sim.mem[1][SMS_STS_CW_DEAD] = 33;
+    r.sim.mem[2][SMS_STS_CW_DEAD] = 44;
+
+    // 第二段为死区
+    r.cache.RefreshNext();
+    r.cache.RefreshNext();
+    CHECK_EQ(r.sim.frames[1].inst, INST_SYNC_READ);
+    CHECK_EQ(r.sim.frames[2].addr, SMS_STS_CW_DEAD);
+    CHECK_EQ(r.cache.Stats().refreshFixes, 1);
+
+    uint8_t v = 0;
+    CHECK(r.cache.ReadByte(1, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(v, 33);
+    CHECK(r.cache.ReadByte(2, SMS_STS_CW_DEAD, v));
+    CHECK_EQ(v, 77);
+    r.cache.Flush();
+    CHECK_EQ(r.sim.mem[2][SMS_STS_CW_DEAD], 77);
+}
+
+// 不同布局的舵机分开同步读，各自轮询自己的段表，每次调用一帧
+static void testRefreshFollowsPerServoRanges() {
+    Rig r;
+    r.cache.SetLayout(4, kOtherRanges, 2, OTHER_LOCK);
+
+    const int stsRanges = 6;
+    const int cycle = stsRanges + 2;
+    for (int i = 0; i < 2 * cycle; i++) r.cache.RefreshNext();
+
+    CHECK_EQ(r.sim.frames.size(), 2 * cycle);
+    for (int i = 0; i < 2 * cycle; i++) {
+        const SimFrame& f = r.sim.frames[i];
+        CHECK_EQ(f.inst, INST_SYNC_READ);
+        int k = i % cycle;
+        if (k < stsRanges) {
+            CHECK(f.ids == std::vector<uint8_t>({ 1, 2, 3 }));
+        } else {
+            CHECK(f.ids == std::vector<uint8_t>({ 4 }));
+            CHECK_EQ(f.addr, kOtherRanges[k - stsRanges].addr);
+            CHECK_EQ(f.len, kOtherRanges[k - stsRanges].len);
+        }
+    }
+    CHECK_EQ(r.sim.frames[0].addr, SMS_STS_MIN_ANGLE_LIMIT_L);
+    CHECK_EQ(r.sim.frames[stsRanges - 1].addr, SMS_STS_LOCK);
+}
+
+int main() {
+    mockClock().stepUs = 10;
+    RUN_TEST(testReadHitsCacheAfterFirstFetch);
+    RUN_TEST(testSyncFetchFillsAllServosInOneFrame);
+    RUN_TEST(testFlushMergesDirtyBytesIntoSyncWrite);
+    RUN_TEST(testEpromFlushUnlocksPerLockAddress);
+    RUN_TEST(testRefreshCorrectsDivergedBytes);
+    RUN_TEST(testRefreshFollowsPerServoRanges);
+    return TEST_RESULT();
+}
@@ -0,0 +1,196 @@
+// SetpointJitterBuffer：按播放延迟回放、区间插值、丢包隐藏与乱序补回、迟到/重复包、
+// 欠载统计与复位
+#include "test_common.h"
+#include "SetpointJitterBuffer.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t B = 1000000;         // 设备时钟与主机时钟之差
+static const uint32_t TRANSIT = 2000;      // 最快一次的传输时间
+static const uint32_t PERIOD = 10000;      // 主机发包间隔
+static const uint32_t DELAY = SETPOINT_PLAYOUT_DELAY_MS * 1000;
+
+static bool near(float a, float b, float tol) { return fabsf(a - b) < tol; }
+
+// 播放主机时刻 hostUs 的目标点时的设备时刻
+static uint32_t playAt(uint32_t hostUs) { return B + TRANSIT + DELAY + hostUs; }
+
+struct Rig {
+    SetpointJitterBuffer sjb;
+    float pos[ENCODER_TOTAL_NUM];
+    float vel[ENCODER_TOTAL_NUM];
+
+    Rig() {
+        for (int j = 0; j < ENCODER_TOTAL_NUM; j++) pos[j] = -1.0f;
+    }
+    // 第 seq 个包（主机时刻 seq × PERIOD），各关节目标 value + 关节号
+    void arrive(uint16_t seq, float value, uint32_t extraTransitUs = 0) {
+        SetpointPacket pkt;
+        pkt.seq = seq;
+        pkt.hostTimeUs = seq * PERIOD;
+        pkt.arrivalUs = B + pkt.hostTimeUs + TRANSIT + extraTransitUs;
+        for (int j = 0; j < ENCODER_TOTAL_NUM; j++) pkt.pos[j] = value + j;
+        CHECK(sjb.push(pkt));
+    }
+    bool sample(uint32_t nowUs) { return sjb.sample(nowUs, pos, vel); }
+    bool at(float value, float velocity) const {
+        for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+            if (!near(pos[j], value + j, 1e-3f) || !near(vel[j], velocity, 1e-2f)) return false;
+        }
+        return true;
+    }
+};
+
+/* ==================== 回放 ==================== */
+
+// 第一个点在 到达 + 播放延迟 时开始播放，之前保持调用者的快照
+static void testStartsAfterPlayoutDelay() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(1, 10.0f);
+    CHECK(!r.sample(B + TRANSIT));
+    CHECK(!r.sample(playAt(0) - 1));
+    CHECK(near(r.pos[0], -1.0f, 1e-6f));
+
+    CHECK(r.sample(playAt(0)));
+    CHECK(r.at(0.0f, 10.0f / 0.01f));
+    CHECK_EQ(r.sjb.stats().received, 2);
+    CHECK_EQ(r.sjb.stats().waitAvgUs, DELAY);
+    CHECK_EQ(r.sjb.stats().waitMaxUs, DELAY);
+}
+
+// 区间内线性插值，斜率作为速度；没有下一个点时保持最后一个点
+static void testInterpolatesThenHoldsLastPoint() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(1, 10.0f);
+    r.arrive(2, 30.0f);
+    CHECK(r.sample(playAt(PERIOD / 2)));
+    CHECK(r.at(5.0f, 1000.0f));
+    CHECK(r.sample(playAt(PERIOD + PERIOD / 4)));
+    CHECK(r.at(15.0f, 2000.0f));
+
+    // 流结束：保持，且流结束后的保持不计为欠载
+    CHECK(r.sample(playAt(3 * PERIOD)));
+    CHECK(r.at(30.0f, 0.0f));
+    CHECK(r.sample(playAt(4 * PERIOD)));
+    CHECK(r.at(30.0f, 0.0f));
+    CHECK_EQ(r.sjb.stats().underrunTicks, 0);
+}
+
+// 传输时间有抖动：时钟偏移取最快的包，较慢的包的额外延迟被播放延迟吸收
+static void testSlowPacketsAbsorbedByDelay() {
+    Rig r;
+    for (uint16_t k = 0; k < 6; k++) {
+        r.arrive(k, 10.0f * k, (k % 2) ? 8000 : 0);
+        r.sample(B + k * PERIOD + TRANSIT + 8000);
+    }
+    CHECK(r.sample(playAt(2 * PERIOD)));
+    CHECK(r.at(20.0f, 1000.0f));
+    CHECK(r.sjb.stats().jitterUs > 0);
+    CHECK_EQ(r.sjb.stats().late, 0);
+}
+
+/* ==================== 丢包与乱序 ==================== */
+
+// 缺一个序号：计为丢包，跨缺口插值（丢包隐藏）
+static void testConcealsLostPacket() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(1, 10.0f);
+    r.arrive(3, 30.0f);
+    CHECK(r.sample(playAt(PERIOD)));
+    CHECK_EQ(r.sjb.stats().lost, 1);
+    CHECK(r.sample(playAt(2 * PERIOD)));
+    CHECK(r.at(20.0f, 1000.0f));
+    CHECK(r.sjb.stats().concealedTicks >= 1);
+}
+
+// 播放之前乱序到达：扣除丢包，按序号插入后正常插值
+static void testReorderedPacketRecovered() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(2, 20.0f);
+    CHECK(!r.sample(B + TRANSIT + 2 * PERIOD));
+    CHECK_EQ(r.sjb.stats().lost, 1);
+    r.arrive(1, 50.0f, PERIOD + 1000);
+    CHECK(!r.sample(B + TRANSIT + 2 * PERIOD + 1000));
+    CHECK_EQ(r.sjb.stats().lost, 0);
+
+    CHECK(r.sample(playAt(PERIOD / 2)));
+    CHECK(r.at(25.0f, 5000.0f));
+    CHECK(r.sample(playAt(PERIOD + PERIOD / 2)));
+    CHECK(r.at(35.0f, -3000.0f));
+    CHECK_EQ(r.sjb.stats().concealedTicks, 0);
+}
+
+// 重复的包只计数；所在区间已经开始播放的包计为迟到并丢弃
+static void testDuplicateAndLatePackets() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(0, 0.0f);
+    r.arrive(2, 20.0f);
+    CHECK(r.sample(playAt(PERIOD + PERIOD / 2)));
+    CHECK_EQ(r.sjb.stats().duplicates, 1);
+    CHECK_EQ(r.sjb.stats().received, 2);
+    CHECK(r.at(15.0f, 1000.0f));
+
+    // 序号 1 补到时，0~2 的区间已经播放过
+    r.arrive(1, 99.0f, DELAY + 7000);
+    CHECK(r.sample(playAt(PERIOD + 8000)));
+    CHECK_EQ(r.sjb.stats().late, 1);
+    CHECK_EQ(r.sjb.stats().lost, 0);
+    CHECK(r.at(18.0f, 1000.0f));
+}
+
+/* ==================== 欠载与复位 ==================== */
+
+// 断流期间保持；之后又有新包到达时，保持的周期计为欠载
+static void testUnderrunCountedWhenStreamResumes() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(1, 10.0f);
+    for (uint32_t t = PERIOD; t < 4 * PERIOD; t += PERIOD / 2) {
+        CHECK(r.sample(playAt(t)));
+        CHECK(r.at(10.0f, 0.0f));
+    }
+    CHECK_EQ(r.sjb.stats().underrunTicks, 0);
+
+    r.arrive(5, 50.0f);
+    CHECK(r.sample(playAt(4 * PERIOD)));
+    CHECK_EQ(r.sjb.stats().underrunTicks, 6);
+    CHECK_EQ(r.sjb.stats().lost, 3);
+}
+
+// 复位：停止回放，交还给调用者，之后重新估计偏移并从新的流开始
+static void testResetStopsPlayback() {
+    Rig r;
+    r.arrive(0, 0.0f);
+    r.arrive(1, 10.0f);
+    CHECK(r.sample(playAt(PERIOD / 2)));
+
+    r.sjb.requestReset();
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) r.pos[j] = -1.0f;
+    CHECK(!r.sample(playAt(PERIOD)));
+    CHECK(near(r.pos[0], -1.0f, 1e-6f));
+
+    // 新的流：传输时间更长，按新的偏移回放
+    r.arrive(10, 100.0f, 5000);
+    r.arrive(11, 110.0f, 5000);
+    CHECK(!r.sample(playAt(10 * PERIOD)));
+    CHECK(r.sample(playAt(10 * PERIOD) + 5000));
+    CHECK(r.at(100.0f, 1000.0f));
+    CHECK_EQ(r.sjb.stats().lost, 0);
+}
+
+int main() {
+    RUN_TEST(testStartsAfterPlayoutDelay);
+    RUN_TEST(testInterpolatesThenHoldsLastPoint);
+    RUN_TEST(testSlowPacketsAbsorbedByDelay);
+    RUN_TEST(testConcealsLostPacket);
+    RUN_TEST(testReorderedPacketRecovered);
+    RUN_TEST(testDuplicateAndLatePackets);
+    RUN_TEST(testUnderrunCountedWhenStreamResumes);
+    RUN_TEST(testResetStopsPlayback);
+    return TEST_RESULT();
+}
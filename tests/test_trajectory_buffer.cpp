@@ -0,0 +1,246 @@
+// TrajectoryBuffer：三次/五次段的系数（端点状态与段间衔接）、清空与缓冲耗尽
+#include "test_common.h"
+#include "TrajectoryBuffer.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t T0 = 1000000;
+static const uint32_t SEG_US = 100000;   // 0.1s
+
+static bool near(float a, float b, float tol) { return fabsf(a - b) < tol; }
+
+// 全部关节同一终点状态的段
+static TrajectorySegment segment(uint8_t type, float pos, float vel, float acc, uint32_t durationUs = SEG_US) {
+    TrajectorySegment seg;
+    seg.type = type;
+    seg.durationUs = durationUs;
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        seg.pos[j] = pos + j;
+        seg.vel[j] = vel;
+        seg.acc[j] = acc;
+    }
+    return seg;
+}
+
+struct Out {
+    float pos[ENCODER_TOTAL_NUM];
+    float vel[ENCODER_TOTAL_NUM];
+    float acc[ENCODER_TOTAL_NUM];
+    bool engaged;
+};
+
+// snapshot 为 targetAngles 快照（全部关节相同加关节号）
+static Out sample(TrajectoryBuffer& tb, uint32_t nowUs, float snapshot = 0.0f) {
+    Out o;
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) o.pos[j] = snapshot + j;
+    o.engaged = tb.sample(nowUs, o.pos, o.vel, o.acc);
+    return o;
+}
+
+/* ==================== 三次段 ==================== */
+
+// 静止起步到 10°（终点速度 0）：Hermite 曲线中点位置 d/2、速度 1.5d/T，起点加速度 6d/T²
+static void testCubicFromRest() {
+    static TrajectoryBuffer tb;
+    CHECK(tb.push(segment(TRAJ_SEGMENT_CUBIC, 10.0f, 0.0f, 0.0f)));
+
+    Out o = sample(tb, T0);
+    CHECK(o.engaged);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], j, 1e-4f));
+        CHECK(near(o.vel[j], 0.0f, 1e-3f));
+        CHECK(near(o.acc[j], 6.0f * 10.0f / (0.1f * 0.1f), 0.5f));
+    }
+
+    o = sample(tb, T0 + SEG_US / 2);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 5.0f + j, 1e-3f));
+        CHECK(near(o.vel[j], 1.5f * 10.0f / 0.1f, 1e-2f));
+        CHECK(near(o.acc[j], 0.0f, 0.5f));
+    }
+}
+
+// 终点速度非零：段末位置/速度等于终点状态，下一段从这里首尾相接。
+// 三次段的终点加速度 p''(1) = (2c2 + 6c3) / T² 交给下一段，接五次段时加速度也连续
+static void testCubicEndStateCarriesIntoNextSegment() {
+    static TrajectoryBuffer tb;
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 10.0f, 50.0f, 0.0f));
+    tb.push(segment(TRAJ_SEGMENT_QUINTIC, 15.0f, 0.0f, 0.0f));
+
+    sample(tb, T0);
+    Out before = sample(tb, T0 + SEG_US - 1);
+    Out at = sample(tb, T0 + SEG_US);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(before.pos[j], 10.0f + j, 1e-2f));
+        CHECK(near(before.vel[j], 50.0f, 0.1f));
+        CHECK(near(at.pos[j], 10.0f + j, 1e-4f));
+        CHECK(near(at.vel[j], 50.0f, 1e-2f));
+        CHECK(near(at.acc[j], before.acc[j], 1.0f));
+    }
+    CHECK_EQ(tb.status().segments, 2);
+}
+
+/* ==================== 五次段 ==================== */
+
+// 静止到静止：最小冲击曲线，中点速度 1.875d/T，两端加速度为 0
+static void testQuinticRestToRest() {
+    static TrajectoryBuffer tb;
+    tb.push(segment(TRAJ_SEGMENT_QUINTIC, 10.0f, 0.0f, 0.0f));
+
+    Out o = sample(tb, T0);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], j, 1e-4f));
+        CHECK(near(o.acc[j], 0.0f, 1e-2f));
+    }
+    o = sample(tb, T0 + SEG_US / 2);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 5.0f + j, 1e-3f));
+        CHECK(near(o.vel[j], 1.875f * 10.0f / 0.1f, 1e-2f));
+    }
+    o = sample(tb, T0 + SEG_US - 1);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 10.0f + j, 1e-3f));
+        CHECK(near(o.vel[j], 0.0f, 0.1f));
+        CHECK(near(o.acc[j], 0.0f, 5.0f));
+    }
+}
+
+// 终点速度与加速度都非零：段末三阶状态全部满足，下一段起点与之相同
+static void testQuinticMatchesEndVelocityAndAcceleration() {
+    static TrajectoryBuffer tb;
+    tb.push(segment(TRAJ_SEGMENT_QUINTIC, 8.0f, 40.0f, -200.0f));
+    tb.push(segment(TRAJ_SEGMENT_QUINTIC, 12.0f, 0.0f, 0.0f));
+
+    sample(tb, T0);
+    Out before = sample(tb, T0 + SEG_US - 1);
+    Out at = sample(tb, T0 + SEG_US);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(before.pos[j], 8.0f + j, 1e-2f));
+        CHECK(near(before.vel[j], 40.0f, 0.1f));
+        CHECK(near(before.acc[j], -200.0f, 5.0f));
+        CHECK(near(at.pos[j], 8.0f + j, 1e-4f));
+        CHECK(near(at.vel[j], 40.0f, 1e-2f));
+        CHECK(near(at.acc[j], -200.0f, 0.5f));
+    }
+}
+
+/* ==================== 缓冲耗尽 ==================== */
+
+// 运动中耗尽计为欠载，停在终点；终点速度为 0 时耗尽不计
+static void testUnderrunHoldsAtEnd() {
+    static TrajectoryBuffer tb;
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 10.0f, 50.0f, 0.0f));
+    sample(tb, T0);
+
+    Out o = sample(tb, T0 + SEG_US + 5000);
+    CHECK(o.engaged);
+    CHECK_EQ(tb.status().underruns, 1);
+    CHECK_EQ(tb.status().bufferedUs, 0);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 10.0f + j, 1e-4f));
+        CHECK(near(o.vel[j], 0.0f, 1e-6f));
+    }
+
+    // 停住期间收到新段：从收到时开始，起点速度为 0
+    uint32_t t = T0 + 2 * SEG_US;
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 20.0f, 0.0f, 0.0f));
+    o = sample(tb, t);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 10.0f + j, 1e-4f));
+        CHECK(near(o.vel[j], 0.0f, 1e-3f));
+    }
+    sample(tb, t + SEG_US + 1000);
+    CHECK_EQ(tb.status().underruns, 1);
+    CHECK_EQ(tb.status().segments, 2);
+}
+
+/* ==================== 清空 ==================== */
+
+// 保持：丢弃队列，停在清空时刻的输出，仍由轨迹提供目标
+static void testFlushHoldStopsAtCurrentOutput() {
+    static TrajectoryBuffer tb;
+    for (int k = 1; k <= 4; k++) tb.push(segment(TRAJ_SEGMENT_CUBIC, 10.0f * k, 0.0f, 0.0f));
+    sample(tb, T0);
+    sample(tb, T0 + SEG_US / 2);
+    CHECK_EQ(tb.status().queued, 3);
+
+    // 清空在 s = 0.6 时生效：p(s) = p0 + d(3s² - 2s³)
+    tb.requestFlush(true);
+    sample(tb, T0 + SEG_US * 6 / 10);
+    Out o = sample(tb, T0 + SEG_US * 2);
+    CHECK(o.engaged);
+    TrajectoryStatus st = tb.status();
+    CHECK_EQ(st.engaged, 1);
+    CHECK_EQ(st.queued, 0);
+    CHECK_EQ(st.bufferedUs, 0);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], j + 10.0f * (3 * 0.36f - 2 * 0.216f), 1e-3f));
+        CHECK(near(o.vel[j], 0.0f, 1e-6f));
+    }
+}
+
+// 交还：丢弃队列并退出轨迹，输出回到 targetAngles 快照
+static void testFlushReleaseReturnsToSnapshot() {
+    static TrajectoryBuffer tb;
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 10.0f, 0.0f, 0.0f));
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 20.0f, 0.0f, 0.0f));
+    sample(tb, T0);
+
+    tb.requestFlush(false);
+    Out o = sample(tb, T0 + 10000, 30.0f);
+    CHECK(!o.engaged);
+    CHECK_EQ(tb.status().engaged, 0);
+    CHECK_EQ(tb.status().queued, 0);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 30.0f + j, 1e-6f));
+        CHECK(near(o.vel[j], 0.0f, 1e-6f));
+    }
+
+    // 之后的新段以快照为起点
+    tb.push(segment(TRAJ_SEGMENT_CUBIC, 40.0f, 0.0f, 0.0f));
+    o = sample(tb, T0 + 20000, 30.0f);
+    CHECK(o.engaged);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) CHECK(near(o.pos[j], 30.0f + j, 1e-4f));
+}
+
+// 清空之后的第一批路径点不与清空前的点做差分
+static void testFlushForgetsLastWaypoint() {
+    static TrajectoryBuffer tb;
+    float p[ENCODER_TOTAL_NUM];
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) p[j] = 50.0f;
+    CHECK_EQ(tb.pushWaypoints(p, 1, SEG_US), 1);
+    sample(tb, T0, 0.0f);
+
+    tb.requestFlush(false);
+    sample(tb, T0 + 1000, 0.0f);
+
+    // 单个点：没有上一个点时单侧差分为 0，段末速度为 0
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) p[j] = 10.0f;
+    CHECK_EQ(tb.pushWaypoints(p, 1, SEG_US), 1);
+    sample(tb, T0 + 2000, 0.0f);
+    Out o = sample(tb, T0 + 2000 + SEG_US - 1, 0.0f);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) {
+        CHECK(near(o.pos[j], 10.0f, 1e-2f));
+        CHECK(near(o.vel[j], 0.0f, 0.1f));
+    }
+
+    // 不清空时，下一个点与上一个点做单侧差分
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) p[j] = 20.0f;
+    tb.pushWaypoints(p, 1, SEG_US);
+    uint32_t t = T0 + 2000 + SEG_US;
+    sample(tb, t, 0.0f);
+    o = sample(tb, t + SEG_US - 1, 0.0f);
+    for (int j = 0; j < ENCODER_TOTAL_NUM; j++) CHECK(near(o.vel[j], 10.0f / 0.1f, 0.1f));
+}
+
+int main() {
+    RUN_TEST(testCubicFromRest);
+    RUN_TEST(testCubicEndStateCarriesIntoNextSegment);
+    RUN_TEST(testQuinticRestToRest);
+    RUN_TEST(testQuinticMatchesEndVelocityAndAcceleration);
+    RUN_TEST(testUnderrunHoldsAtEnd);
+    RUN_TEST(testFlushHoldStopsAtCurrentOutput);
+    RUN_TEST(testFlushReleaseReturnsToSnapshot);
+    RUN_TEST(testFlushForgetsLastWaypoint);
+    return TEST_RESULT();
+}